@@ -84,8 +84,13 @@ const std::map<const int, const std::shared_ptr<StatusProperties>>
     {0x9000, std::make_shared<StatusProperties>("Success")},
 };
 
-AbstractApduCommand::AbstractApduCommand(const CardCommand& commandRef, const int expectedResponseLength)
-: mCommandRef(commandRef), mExpectedResponseLength(expectedResponseLength), mName(commandRef.getName()) {}
+AbstractApduCommand::AbstractApduCommand(const CardCommand& commandRef,
+                                         const int expectedResponseLength,
+                                         const CommandFamily commandFamily)
+: mCommandRef(commandRef),
+  mCommandFamily(commandFamily),
+  mExpectedResponseLength(expectedResponseLength),
+  mName(commandRef.getName()) {}
 
 void AbstractApduCommand::addSubName(const std::string& subName)
 {
@@ -172,28 +177,18 @@ void AbstractApduCommand::checkStatus()
              *      exceptions.
              *      Copy/pasted the function content here.
              */
-            try {
+            CalypsoApduCommandException ex =
+                buildUnexpectedResponseLengthException(
+                    StringUtils::format("Incorrect APDU response length (expected: %d, " \
+                                        "actual: %d)",
+                                        mExpectedResponseLength,
+                                        mApduResponse->getDataOut().size()));
 
-                /* Try with Card Command first */
-                (void)dynamic_cast<const CalypsoCardCommand&>(getCommandRef());
-                CalypsoApduCommandException ex =
-                    buildUnexpectedResponseLengthException(
-                        StringUtils::format("Incorrect APDU response length (expected: %d, " \
-                                            "actual: %d)",
-                                            mExpectedResponseLength,
-                                            mApduResponse->getDataOut().size()));
+            if (mCommandFamily == CommandFamily::CARD) {
 
                 throw static_cast<const CardUnexpectedResponseLengthException&>(ex);
 
-            } catch (const std::bad_cast& e) {
-
-                /* Assume it's Sam Command then */
-                CalypsoApduCommandException ex =
-                    buildUnexpectedResponseLengthException(
-                        StringUtils::format("Incorrect APDU response length (expected: %d, " \
-                                            "actual: %d)",
-                                            mExpectedResponseLength,
-                                            mApduResponse->getDataOut().size()));
+            } else {
 
                 throw static_cast<const CalypsoSamUnexpectedResponseLengthException&>(ex);
             }
@@ -221,10 +216,9 @@ void AbstractApduCommand::checkStatus()
      */
     //throw buildCommandException(exceptionClass, message);
 
-    try {
+    if (mCommandFamily == CommandFamily::CARD) {
 
-        /* Try with Card Command first */
-        const auto& command = dynamic_cast<const CalypsoCardCommand&>(getCommandRef());
+        const auto& command = static_cast<const CalypsoCardCommand&>(getCommandRef());
         const auto statusWord = std::make_shared<int>(getApduResponse()->getStatusWord());
 
         if (exceptionClass == typeid(CardAccessForbiddenException)) {
@@ -272,10 +266,9 @@ void AbstractApduCommand::checkStatus()
             throw CardUnknownStatusException(message, command, statusWord);
         }
 
-    } catch (const std::bad_cast& e) {
+    } else {
 
-        /* It's a Sam Command */
-        const auto& command = dynamic_cast<const CalypsoSamCommand&>(getCommandRef());
+        const auto& command = static_cast<const CalypsoSamCommand&>(getCommandRef());
         const auto statusWord = std::make_shared<int>(getApduResponse()->getStatusWord());
 
         if (exceptionClass == typeid(CalypsoSamAccessForbiddenException)) {
@@ -128,15 +128,34 @@ public:
      */
     static const std::map<const int, const std::shared_ptr<StatusProperties>> STATUS_TABLE;
 
+    /**
+     * (package-private)<br>
+     * Family of the command.
+     *
+     * <p>C++: specific to this implementation, used by the status checks and the card command
+     * dispatch to identify the type of the command reference without RTTI. The concrete command is
+     * then reached with a static cast after checking its command reference. Other parts of the
+     * transaction (exception causes, file data, readers and settings) still use dynamic casts.
+     *
+     * @since 2.2.5.6
+     */
+    enum class CommandFamily {
+        CARD,
+        SAM
+    };
+
     /**
      * (package-private)<br>
      * Constructor
      *
      * @param commandRef The command reference.
      * @param expectedResponseLength The expected response length or -1 if not specified.
+     * @param commandFamily The family of the command (C++: specific to this implementation).
      * @since 2.0.1
      */
-    AbstractApduCommand(const CardCommand& commandRef, const int expectedResponseLength);
+    AbstractApduCommand(const CardCommand& commandRef,
+                        const int expectedResponseLength,
+                        const CommandFamily commandFamily);
 
     /**
      * (package-private)<br>
@@ -273,6 +292,11 @@ private:
      */
     const CardCommand& mCommandRef;
 
+    /**
+     *
+     */
+    const CommandFamily mCommandFamily;
+
     /**
      *
      */
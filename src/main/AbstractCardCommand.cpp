@@ -34,11 +34,12 @@ namespace calypso {
 AbstractCardCommand::AbstractCardCommand(const CalypsoCardCommand& commandRef,
                                          const int expectedResponseLength,
                                          const std::shared_ptr<CalypsoCardAdapter> calypsoCard)
-: AbstractApduCommand(commandRef, expectedResponseLength), mCalypsoCard(calypsoCard) {}
+: AbstractApduCommand(commandRef, expectedResponseLength, CommandFamily::CARD), mCalypsoCard(calypsoCard) {}
 
 const CalypsoCardCommand& AbstractCardCommand::getCommandRef() const
 {
-    return dynamic_cast<const CalypsoCardCommand&>(AbstractApduCommand::getCommandRef());
+    /* C++: the family of the command identifies the type of its reference */
+    return static_cast<const CalypsoCardCommand&>(AbstractApduCommand::getCommandRef());
 }
 
 const CalypsoApduCommandException AbstractCardCommand::buildCommandException(
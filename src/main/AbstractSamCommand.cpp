@@ -34,7 +34,7 @@ const std::map<const int, const std::shared_ptr<StatusProperties>>
 AbstractSamCommand::AbstractSamCommand(const CalypsoSamCommand& commandRef,
                                        const int expectedResponseLength,
                                        const std::shared_ptr<CalypsoSamAdapter> calypsoSam)
-: AbstractApduCommand(commandRef, expectedResponseLength), mCalypsoSam(calypsoSam) {}
+: AbstractApduCommand(commandRef, expectedResponseLength, CommandFamily::SAM), mCalypsoSam(calypsoSam) {}
 
 const std::shared_ptr<CalypsoSamAdapter> AbstractSamCommand::getCalypsoSam() const
 {
@@ -43,7 +43,8 @@ const std::shared_ptr<CalypsoSamAdapter> AbstractSamCommand::getCalypsoSam() con
 
 const CalypsoSamCommand& AbstractSamCommand::getCommandRef() const
 {
-    return dynamic_cast<const CalypsoSamCommand&>(AbstractApduCommand::getCommandRef());
+    /* C++: the family of the command identifies the type of its reference */
+    return static_cast<const CalypsoSamCommand&>(AbstractApduCommand::getCommandRef());
 }
 
 const CalypsoApduCommandException AbstractSamCommand::buildCommandException(
@@ -0,0 +1,296 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "ApduTraceRecorder.h"
+
+/* Calypsonet Terminal Card */
+#include "CardBrokenCommunicationException.h"
+#include "ReaderBrokenCommunicationException.h"
+#include "UnexpectedStatusWordException.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
+#include "KeypleAssert.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+const uint16_t ApduTraceRecorder::VERSION = 1;
+const uint32_t ApduTraceRecorder::MAGIC = 0x5441434B;
+
+const uint8_t ApduTraceRecorder::RECORD_CHANNEL = 0;
+const uint8_t ApduTraceRecorder::RECORD_EXCHANGE = 1;
+
+const uint8_t ApduTraceRecorder::CF_CONTACTLESS = 0x01;
+
+const uint8_t ApduTraceRecorder::OUTCOME_SUCCESS = 0;
+const uint8_t ApduTraceRecorder::OUTCOME_UNEXPECTED_STATUS_WORD = 1;
+const uint8_t ApduTraceRecorder::OUTCOME_CARD_BROKEN_COMMUNICATION = 2;
+const uint8_t ApduTraceRecorder::OUTCOME_READER_BROKEN_COMMUNICATION = 3;
+
+const uint8_t ApduTraceRecorder::EF_STOP_ON_UNSUCCESSFUL_STATUS_WORD = 0x01;
+const uint8_t ApduTraceRecorder::EF_CLOSE_AFTER = 0x02;
+const uint8_t ApduTraceRecorder::EF_RESPONSE_PRESENT = 0x04;
+const uint8_t ApduTraceRecorder::EF_LOGICAL_CHANNEL_OPEN = 0x08;
+const uint8_t ApduTraceRecorder::EF_CARD_RESPONSE_COMPLETE = 0x10;
+
+/* RECORDING READER ----------------------------------------------------------------------------- */
+
+ApduTraceRecorder::RecordingReader::RecordingReader(const std::shared_ptr<Output> output,
+                                                    const uint8_t channel,
+                                                    const std::shared_ptr<CardReader> reader)
+: mOutput(output),
+  mChannel(channel),
+  mReader(reader),
+  mProxyReader(std::dynamic_pointer_cast<ProxyReaderApi>(reader)) {}
+
+const std::string& ApduTraceRecorder::RecordingReader::getName() const
+{
+    return mReader->getName();
+}
+
+bool ApduTraceRecorder::RecordingReader::isContactless()
+{
+    return mReader->isContactless();
+}
+
+bool ApduTraceRecorder::RecordingReader::isCardPresent()
+{
+    return mReader->isCardPresent();
+}
+
+const std::shared_ptr<CardResponseApi> ApduTraceRecorder::RecordingReader::transmitCardRequest(
+    const std::shared_ptr<CardRequestSpi> cardRequest,
+    const ChannelControl channelControl)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    try {
+
+        const std::shared_ptr<CardResponseApi> cardResponse =
+            mProxyReader->transmitCardRequest(cardRequest, channelControl);
+
+        writeExchange(*mOutput,
+                      mChannel,
+                      cardRequest,
+                      channelControl,
+                      cardResponse,
+                      OUTCOME_SUCCESS,
+                      true,
+                      start);
+
+        return cardResponse;
+
+    } catch (const UnexpectedStatusWordException& e) {
+
+        writeExchange(*mOutput,
+                      mChannel,
+                      cardRequest,
+                      channelControl,
+                      e.getCardResponse(),
+                      OUTCOME_UNEXPECTED_STATUS_WORD,
+                      e.isCardResponseComplete(),
+                      start);
+        throw;
+
+    } catch (const CardBrokenCommunicationException& e) {
+
+        writeExchange(*mOutput,
+                      mChannel,
+                      cardRequest,
+                      channelControl,
+                      e.getCardResponse(),
+                      OUTCOME_CARD_BROKEN_COMMUNICATION,
+                      e.isCardResponseComplete(),
+                      start);
+        throw;
+
+    } catch (const ReaderBrokenCommunicationException& e) {
+
+        writeExchange(*mOutput,
+                      mChannel,
+                      cardRequest,
+                      channelControl,
+                      e.getCardResponse(),
+                      OUTCOME_READER_BROKEN_COMMUNICATION,
+                      e.isCardResponseComplete(),
+                      start);
+        throw;
+    }
+}
+
+void ApduTraceRecorder::RecordingReader::releaseChannel()
+{
+    mProxyReader->releaseChannel();
+}
+
+/* APDU TRACE RECORDER -------------------------------------------------------------------------- */
+
+ApduTraceRecorder::ApduTraceRecorder(std::ostream& out)
+: mOutput(std::make_shared<Output>(out))
+{
+    std::vector<uint8_t> header;
+    putU32(header, MAGIC);
+    putU16(header, VERSION);
+    putU16(header, 0);
+
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+}
+
+ApduTraceRecorder::~ApduTraceRecorder()
+{
+    std::lock_guard<std::mutex> lock(mOutput->mMutex);
+
+    mOutput->mOut = nullptr;
+}
+
+const std::shared_ptr<CardReader> ApduTraceRecorder::record(
+    const std::shared_ptr<CardReader> reader)
+{
+    Assert::getInstance().notNull(reader, "reader");
+
+    if (std::dynamic_pointer_cast<ProxyReaderApi>(reader) == nullptr) {
+        throw IllegalArgumentException("The reader must implement ProxyReaderApi.");
+    }
+
+    std::lock_guard<std::mutex> lock(mOutput->mMutex);
+
+    if (mOutput->mChannelCount > 0xFF) {
+        throw IllegalStateException("Too many recorded readers.");
+    }
+
+    const uint8_t channel = static_cast<uint8_t>(mOutput->mChannelCount++);
+    const std::string& name = reader->getName();
+
+    std::vector<uint8_t> buffer;
+    putU8(buffer, RECORD_CHANNEL);
+    putU8(buffer, channel);
+    putU8(buffer, reader->isContactless() ? CF_CONTACTLESS : 0);
+    putBytes(buffer, std::vector<uint8_t>(name.begin(), name.end()));
+
+    mOutput->mOut->write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    return std::make_shared<RecordingReader>(mOutput, channel, reader);
+}
+
+long ApduTraceRecorder::getExchangeCount() const
+{
+    std::lock_guard<std::mutex> lock(mOutput->mMutex);
+
+    return mOutput->mExchangeCount;
+}
+
+void ApduTraceRecorder::writeExchange(Output& output,
+                                      const uint8_t channel,
+                                      const std::shared_ptr<CardRequestSpi> cardRequest,
+                                      const ChannelControl channelControl,
+                                      const std::shared_ptr<CardResponseApi> cardResponse,
+                                      const uint8_t outcome,
+                                      const bool isCardResponseComplete,
+                                      const std::chrono::steady_clock::time_point& start)
+{
+    const auto end = std::chrono::steady_clock::now();
+
+    uint8_t flags = 0;
+    if (cardRequest->stopOnUnsuccessfulStatusWord()) {
+        flags |= EF_STOP_ON_UNSUCCESSFUL_STATUS_WORD;
+    }
+    if (channelControl == ChannelControl::CLOSE_AFTER) {
+        flags |= EF_CLOSE_AFTER;
+    }
+    if (cardResponse != nullptr) {
+        flags |= EF_RESPONSE_PRESENT;
+        if (cardResponse->isLogicalChannelOpen()) {
+            flags |= EF_LOGICAL_CHANNEL_OPEN;
+        }
+    }
+    if (isCardResponseComplete) {
+        flags |= EF_CARD_RESPONSE_COMPLETE;
+    }
+
+    const std::vector<std::shared_ptr<ApduRequestSpi>>& apduRequests =
+        cardRequest->getApduRequests();
+
+    std::vector<uint8_t> buffer;
+    putU8(buffer, RECORD_EXCHANGE);
+    putU8(buffer, channel);
+    putU8(buffer, outcome);
+    putU8(buffer, flags);
+    putU64(buffer,
+           std::chrono::duration_cast<std::chrono::microseconds>(start - output.mStart).count());
+    putU32(buffer,
+           static_cast<uint32_t>(
+               std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()));
+
+    putU16(buffer, static_cast<uint16_t>(apduRequests.size()));
+    for (const auto& apduRequest : apduRequests) {
+        putBytes(buffer, apduRequest->getApdu());
+    }
+
+    if (cardResponse != nullptr) {
+        const std::vector<std::shared_ptr<ApduResponseApi>>& apduResponses =
+            cardResponse->getApduResponses();
+        putU16(buffer, static_cast<uint16_t>(apduResponses.size()));
+        for (const auto& apduResponse : apduResponses) {
+            putBytes(buffer, apduResponse->getApdu());
+        }
+    } else {
+        putU16(buffer, 0);
+    }
+
+    std::lock_guard<std::mutex> lock(output.mMutex);
+
+    if (output.mOut == nullptr) {
+        return;
+    }
+
+    output.mOut->write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    output.mExchangeCount++;
+}
+
+void ApduTraceRecorder::putU8(std::vector<uint8_t>& buffer, const uint8_t value)
+{
+    buffer.push_back(value);
+}
+
+void ApduTraceRecorder::putU16(std::vector<uint8_t>& buffer, const uint16_t value)
+{
+    buffer.push_back(static_cast<uint8_t>(value));
+    buffer.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void ApduTraceRecorder::putU32(std::vector<uint8_t>& buffer, const uint32_t value)
+{
+    putU16(buffer, static_cast<uint16_t>(value));
+    putU16(buffer, static_cast<uint16_t>(value >> 16));
+}
+
+void ApduTraceRecorder::putU64(std::vector<uint8_t>& buffer, const uint64_t value)
+{
+    putU32(buffer, static_cast<uint32_t>(value));
+    putU32(buffer, static_cast<uint32_t>(value >> 32));
+}
+
+void ApduTraceRecorder::putBytes(std::vector<uint8_t>& buffer, const std::vector<uint8_t>& data)
+{
+    putU16(buffer, static_cast<uint16_t>(data.size()));
+    buffer.insert(buffer.end(), data.begin(), data.end());
+}
+
+}
+}
+}
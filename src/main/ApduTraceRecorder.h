@@ -0,0 +1,270 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* Calypsonet Terminal Card */
+#include "ChannelControl.h"
+#include "ProxyReaderApi.h"
+
+/* Calypsonet Terminal Reader */
+#include "CardReader.h"
+
+/* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::card;
+using namespace calypsonet::terminal::card::spi;
+using namespace calypsonet::terminal::reader;
+
+/**
+ * Records all the exchanges made with one or more readers into a compact binary trace, which can
+ * be replayed later with ApduTraceReplayer.
+ *
+ * <p>Each reader to be recorded is wrapped with {@link #record(const std::shared_ptr<CardReader>)}
+ * and the returned reader is provided to the transaction managers in place of the original one.
+ * The readers are identified in the trace by a channel number allocated in the order of the calls
+ * (typically 0 for the card reader and 1 for the SAM reader).
+ *
+ * <p>Layout (all integers are little-endian):
+ *
+ * <ul>
+ *   <li>Header (8 bytes): magic "KCAT", version, reserved.
+ *   <li>Channel record: type (0), channel, flags (contactless), name length (2), name.
+ *   <li>Exchange record: type (1), channel, outcome, flags, timestamp in microseconds since the
+ *       creation of the recorder (8), duration in microseconds (4), number of C-APDUs (2) followed
+ *       by each C-APDU (length (2), bytes), number of R-APDUs (2) followed by each R-APDU.
+ * </ul>
+ *
+ * <p>The outcome tells whether the request succeeded or raised an UnexpectedStatusWordException,
+ * a CardBrokenCommunicationException or a ReaderBrokenCommunicationException; in the latter cases
+ * the partial card response carried by the exception is recorded.
+ *
+ * <p>C++: the output stream must outlive the recorder. The readers returned by the recorder may
+ * outlive it: once the recorder is destroyed, they keep on forwarding the requests to the
+ * decorated readers but no longer write anything. The records are written under a lock so that
+ * the recorded readers can be used from different threads.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API ApduTraceRecorder final {
+public:
+    /**
+     * Current version of the trace format.
+     *
+     * @since 2.2.5.6
+     */
+    static const uint16_t VERSION;
+
+    /**
+     * Creates a recorder and writes the trace header to the provided stream.
+     *
+     * @param out The output stream (opened in binary mode).
+     * @since 2.2.5.6
+     */
+    explicit ApduTraceRecorder(std::ostream& out);
+
+    /**
+     * Detaches the output stream from the readers returned by the recorder.
+     *
+     * @since 2.2.5.6
+     */
+    ~ApduTraceRecorder();
+
+    /**
+     *
+     */
+    ApduTraceRecorder(const ApduTraceRecorder&) = delete;
+    ApduTraceRecorder& operator=(const ApduTraceRecorder&) = delete;
+
+    /**
+     * Wraps a reader so that all its exchanges are recorded, and declares its channel in the
+     * trace.
+     *
+     * @param reader The reader to record.
+     * @return A reader to use in place of the provided one.
+     * @throw IllegalArgumentException If the reader is null or does not implement ProxyReaderApi.
+     * @throw IllegalStateException If 256 readers have already been recorded.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardReader> record(const std::shared_ptr<CardReader> reader);
+
+    /**
+     * Gets the number of exchanges recorded so far, all channels included.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    long getExchangeCount() const;
+
+private:
+    /**
+     * Friend class sharing the format constants.
+     */
+    friend class ApduTraceReplayer;
+
+    /**
+     * (private)<br>
+     * Output shared by the recorder and the readers it returns, detached when the recorder is
+     * destroyed.
+     */
+    struct Output final {
+        explicit Output(std::ostream& out)
+        : mOut(&out), mStart(std::chrono::steady_clock::now()), mChannelCount(0), mExchangeCount(0)
+        {}
+
+        std::ostream* mOut;
+        const std::chrono::steady_clock::time_point mStart;
+        int mChannelCount;
+        long mExchangeCount;
+        std::mutex mMutex;
+    };
+
+    /**
+     * (private)<br>
+     * Reader recording the exchanges of the reader it decorates.
+     */
+    class RecordingReader final : public CardReader, public ProxyReaderApi {
+    public:
+        /**
+         *
+         */
+        RecordingReader(const std::shared_ptr<Output> output,
+                        const uint8_t channel,
+                        const std::shared_ptr<CardReader> reader);
+
+        /**
+         * {@inheritDoc}
+         */
+        const std::string& getName() const override;
+
+        /**
+         * {@inheritDoc}
+         */
+        bool isContactless() override;
+
+        /**
+         * {@inheritDoc}
+         */
+        bool isCardPresent() override;
+
+        /**
+         * {@inheritDoc}
+         */
+        const std::shared_ptr<CardResponseApi> transmitCardRequest(
+            const std::shared_ptr<CardRequestSpi> cardRequest,
+            const ChannelControl channelControl) override;
+
+        /**
+         * {@inheritDoc}
+         */
+        void releaseChannel() override;
+
+    private:
+        /**
+         *
+         */
+        const std::shared_ptr<Output> mOutput;
+
+        /**
+         *
+         */
+        const uint8_t mChannel;
+
+        /**
+         *
+         */
+        const std::shared_ptr<CardReader> mReader;
+
+        /**
+         *
+         */
+        const std::shared_ptr<ProxyReaderApi> mProxyReader;
+    };
+
+    /**
+     * Magic number ("KCAT" read as a little-endian integer).
+     */
+    static const uint32_t MAGIC;
+
+    /**
+     * Record types.
+     */
+    static const uint8_t RECORD_CHANNEL;
+    static const uint8_t RECORD_EXCHANGE;
+
+    /**
+     * Channel record flags.
+     */
+    static const uint8_t CF_CONTACTLESS;
+
+    /**
+     * Exchange outcomes.
+     */
+    static const uint8_t OUTCOME_SUCCESS;
+    static const uint8_t OUTCOME_UNEXPECTED_STATUS_WORD;
+    static const uint8_t OUTCOME_CARD_BROKEN_COMMUNICATION;
+    static const uint8_t OUTCOME_READER_BROKEN_COMMUNICATION;
+
+    /**
+     * Exchange record flags.
+     */
+    static const uint8_t EF_STOP_ON_UNSUCCESSFUL_STATUS_WORD;
+    static const uint8_t EF_CLOSE_AFTER;
+    static const uint8_t EF_RESPONSE_PRESENT;
+    static const uint8_t EF_LOGICAL_CHANNEL_OPEN;
+    static const uint8_t EF_CARD_RESPONSE_COMPLETE;
+
+    /**
+     *
+     */
+    const std::shared_ptr<Output> mOutput;
+
+    /**
+     * (private)<br>
+     * Writes an exchange record, unless the output has been detached.
+     */
+    static void writeExchange(Output& output,
+                              const uint8_t channel,
+                              const std::shared_ptr<CardRequestSpi> cardRequest,
+                              const ChannelControl channelControl,
+                              const std::shared_ptr<CardResponseApi> cardResponse,
+                              const uint8_t outcome,
+                              const bool isCardResponseComplete,
+                              const std::chrono::steady_clock::time_point& start);
+
+    /**
+     * (private)<br>
+     * Appends a little-endian unsigned integer or a length-prefixed byte array to a buffer.
+     */
+    static void putU8(std::vector<uint8_t>& buffer, const uint8_t value);
+    static void putU16(std::vector<uint8_t>& buffer, const uint16_t value);
+    static void putU32(std::vector<uint8_t>& buffer, const uint32_t value);
+    static void putU64(std::vector<uint8_t>& buffer, const uint64_t value);
+    static void putBytes(std::vector<uint8_t>& buffer, const std::vector<uint8_t>& data);
+};
+
+}
+}
+}
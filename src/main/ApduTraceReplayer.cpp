@@ -0,0 +1,302 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "ApduTraceReplayer.h"
+
+/* Calypsonet Terminal Card */
+#include "CardBrokenCommunicationException.h"
+#include "ReaderBrokenCommunicationException.h"
+#include "UnexpectedStatusWordException.h"
+
+/* Keyple Card Calypso */
+#include "ApduTraceRecorder.h"
+#include "LocalApduResponseAdapter.h"
+#include "LocalCardResponseAdapter.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp;
+using namespace keyple::core::util::cpp::exception;
+
+/* REPLAY READER -------------------------------------------------------------------------------- */
+
+ApduTraceReplayer::ReplayReader::ReplayReader(const std::shared_ptr<Trace> trace,
+                                              const uint8_t channel)
+: mTrace(trace), mChannel(channel) {}
+
+const std::string& ApduTraceReplayer::ReplayReader::getName() const
+{
+    return getChannel(*mTrace, mChannel).mName;
+}
+
+bool ApduTraceReplayer::ReplayReader::isContactless()
+{
+    return getChannel(*mTrace, mChannel).mIsContactless;
+}
+
+bool ApduTraceReplayer::ReplayReader::isCardPresent()
+{
+    return true;
+}
+
+const std::shared_ptr<CardResponseApi> ApduTraceReplayer::ReplayReader::transmitCardRequest(
+    const std::shared_ptr<CardRequestSpi> cardRequest,
+    const ChannelControl channelControl)
+{
+    return replay(*mTrace, mChannel, cardRequest, channelControl);
+}
+
+void ApduTraceReplayer::ReplayReader::releaseChannel()
+{
+    /* Nothing to do */
+}
+
+/* APDU TRACE REPLAYER -------------------------------------------------------------------------- */
+
+ApduTraceReplayer::ApduTraceReplayer(const std::vector<uint8_t>& trace)
+: mTrace(std::make_shared<Trace>())
+{
+    size_t offset = 0;
+
+    if (getUnsigned(trace, offset, 4) != ApduTraceRecorder::MAGIC) {
+        throw IllegalArgumentException("Not an APDU trace.");
+    }
+
+    const uint64_t version = getUnsigned(trace, offset, 2);
+    if (version != ApduTraceRecorder::VERSION) {
+        throw IllegalArgumentException("Unsupported APDU trace version: " +
+                                       std::to_string(version));
+    }
+
+    /* Reserved */
+    getUnsigned(trace, offset, 2);
+
+    while (offset < trace.size()) {
+
+        const uint8_t type = static_cast<uint8_t>(getUnsigned(trace, offset, 1));
+        const uint8_t channel = static_cast<uint8_t>(getUnsigned(trace, offset, 1));
+
+        if (type == ApduTraceRecorder::RECORD_CHANNEL) {
+
+            if (channel != mTrace->mChannels.size()) {
+                throw IllegalArgumentException("Unexpected channel number: " +
+                                               std::to_string(channel));
+            }
+
+            Channel c;
+            c.mIsContactless = (getUnsigned(trace, offset, 1) &
+                                ApduTraceRecorder::CF_CONTACTLESS) != 0;
+            const std::vector<uint8_t> name = getBytes(trace, offset);
+            c.mName = std::string(name.begin(), name.end());
+            c.mNextExchange = 0;
+            mTrace->mChannels.push_back(c);
+
+        } else if (type == ApduTraceRecorder::RECORD_EXCHANGE) {
+
+            Exchange exchange;
+            exchange.mOutcome = static_cast<uint8_t>(getUnsigned(trace, offset, 1));
+            exchange.mFlags = static_cast<uint8_t>(getUnsigned(trace, offset, 1));
+            exchange.mTimestamp = getUnsigned(trace, offset, 8);
+            exchange.mDuration = static_cast<uint32_t>(getUnsigned(trace, offset, 4));
+
+            if (exchange.mOutcome > ApduTraceRecorder::OUTCOME_READER_BROKEN_COMMUNICATION) {
+                throw IllegalArgumentException("Unknown exchange outcome: " +
+                                               std::to_string(exchange.mOutcome));
+            }
+
+            const size_t apduRequestCount = static_cast<size_t>(getUnsigned(trace, offset, 2));
+            for (size_t i = 0; i < apduRequestCount; i++) {
+                exchange.mApduRequests.push_back(getBytes(trace, offset));
+            }
+
+            std::vector<std::shared_ptr<ApduResponseApi>> apduResponses;
+            const size_t apduResponseCount = static_cast<size_t>(getUnsigned(trace, offset, 2));
+            for (size_t i = 0; i < apduResponseCount; i++) {
+                const std::vector<uint8_t> apdu = getBytes(trace, offset);
+                if (apdu.size() < 2) {
+                    throw IllegalArgumentException("Bad R-APDU length.");
+                }
+                apduResponses.push_back(std::make_shared<LocalApduResponseAdapter>(apdu));
+            }
+
+            if ((exchange.mFlags & ApduTraceRecorder::EF_RESPONSE_PRESENT) != 0) {
+                exchange.mCardResponse =
+                    std::make_shared<LocalCardResponseAdapter>(
+                        apduResponses,
+                        (exchange.mFlags & ApduTraceRecorder::EF_LOGICAL_CHANNEL_OPEN) != 0);
+            }
+
+            getChannel(*mTrace, channel).mExchanges.push_back(exchange);
+
+        } else {
+
+            throw IllegalArgumentException("Unknown record type: " + std::to_string(type));
+        }
+    }
+}
+
+int ApduTraceReplayer::getChannelCount() const
+{
+    return static_cast<int>(mTrace->mChannels.size());
+}
+
+const std::shared_ptr<CardReader> ApduTraceReplayer::getReader(const uint8_t channel)
+{
+    /* Checks the channel */
+    getChannel(*mTrace, channel);
+
+    return std::make_shared<ReplayReader>(mTrace, channel);
+}
+
+int ApduTraceReplayer::getExchangeCount(const uint8_t channel) const
+{
+    return static_cast<int>(getChannel(*mTrace, channel).mExchanges.size());
+}
+
+int ApduTraceReplayer::getReplayedExchangeCount(const uint8_t channel) const
+{
+    const Channel& c = getChannel(*mTrace, channel);
+
+    std::lock_guard<std::mutex> lock(mTrace->mMutex);
+
+    return static_cast<int>(c.mNextExchange);
+}
+
+uint64_t ApduTraceReplayer::getRecordedDuration(const uint8_t channel) const
+{
+    uint64_t duration = 0;
+    for (const auto& exchange : getChannel(*mTrace, channel).mExchanges) {
+        duration += exchange.mDuration;
+    }
+
+    return duration;
+}
+
+void ApduTraceReplayer::rewind()
+{
+    std::lock_guard<std::mutex> lock(mTrace->mMutex);
+
+    for (auto& channel : mTrace->mChannels) {
+        channel.mNextExchange = 0;
+    }
+}
+
+ApduTraceReplayer::Channel& ApduTraceReplayer::getChannel(Trace& trace, const uint8_t channel)
+{
+    if (channel >= trace.mChannels.size()) {
+        throw IllegalArgumentException("Unknown channel: " + std::to_string(channel));
+    }
+
+    return trace.mChannels[channel];
+}
+
+const std::shared_ptr<CardResponseApi> ApduTraceReplayer::replay(
+    Trace& trace,
+    const uint8_t channel,
+    const std::shared_ptr<CardRequestSpi> cardRequest,
+    const ChannelControl channelControl)
+{
+    Channel& c = getChannel(trace, channel);
+
+    std::lock_guard<std::mutex> lock(trace.mMutex);
+
+    if (c.mNextExchange >= c.mExchanges.size()) {
+        throw IllegalStateException("No more recorded exchanges on channel " +
+                                    std::to_string(channel) + ".");
+    }
+
+    const Exchange& exchange = c.mExchanges[c.mNextExchange];
+    const std::vector<std::shared_ptr<ApduRequestSpi>>& apduRequests =
+        cardRequest->getApduRequests();
+
+    bool isIdentical =
+        apduRequests.size() == exchange.mApduRequests.size() &&
+        (channelControl == ChannelControl::CLOSE_AFTER) ==
+            ((exchange.mFlags & ApduTraceRecorder::EF_CLOSE_AFTER) != 0);
+
+    for (size_t i = 0; isIdentical && i < apduRequests.size(); i++) {
+        isIdentical = apduRequests[i]->getApdu() == exchange.mApduRequests[i];
+    }
+
+    if (!isIdentical) {
+        throw IllegalStateException("The request differs from the recorded exchange " +
+                                    std::to_string(c.mNextExchange) +
+                                    " of channel " +
+                                    std::to_string(channel) + ".");
+    }
+
+    c.mNextExchange++;
+
+    const bool isCardResponseComplete =
+        (exchange.mFlags & ApduTraceRecorder::EF_CARD_RESPONSE_COMPLETE) != 0;
+
+    if (exchange.mOutcome == ApduTraceRecorder::OUTCOME_UNEXPECTED_STATUS_WORD) {
+        throw UnexpectedStatusWordException(exchange.mCardResponse,
+                                            isCardResponseComplete,
+                                            "Replayed unexpected status word.");
+
+    } else if (exchange.mOutcome == ApduTraceRecorder::OUTCOME_CARD_BROKEN_COMMUNICATION) {
+        throw CardBrokenCommunicationException(exchange.mCardResponse,
+                                               isCardResponseComplete,
+                                               "Replayed card communication failure.");
+
+    } else if (exchange.mOutcome == ApduTraceRecorder::OUTCOME_READER_BROKEN_COMMUNICATION) {
+        throw ReaderBrokenCommunicationException(exchange.mCardResponse,
+                                                 isCardResponseComplete,
+                                                 "Replayed reader communication failure.");
+    }
+
+    return exchange.mCardResponse;
+}
+
+uint64_t ApduTraceReplayer::getUnsigned(const std::vector<uint8_t>& trace,
+                                        size_t& offset,
+                                        const size_t length)
+{
+    if (offset + length > trace.size()) {
+        throw IllegalArgumentException("Truncated APDU trace.");
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < length; i++) {
+        value |= static_cast<uint64_t>(trace[offset + i]) << (8 * i);
+    }
+
+    offset += length;
+
+    return value;
+}
+
+const std::vector<uint8_t> ApduTraceReplayer::getBytes(const std::vector<uint8_t>& trace,
+                                                       size_t& offset)
+{
+    const size_t length = static_cast<size_t>(getUnsigned(trace, offset, 2));
+    if (offset + length > trace.size()) {
+        throw IllegalArgumentException("Truncated APDU trace.");
+    }
+
+    const std::vector<uint8_t> bytes(trace.begin() + offset, trace.begin() + offset + length);
+    offset += length;
+
+    return bytes;
+}
+
+}
+}
+}
@@ -0,0 +1,294 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Calypsonet Terminal Card */
+#include "CardResponseApi.h"
+#include "ChannelControl.h"
+#include "ProxyReaderApi.h"
+
+/* Calypsonet Terminal Reader */
+#include "CardReader.h"
+
+/* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::card;
+using namespace calypsonet::terminal::card::spi;
+using namespace calypsonet::terminal::reader;
+
+/**
+ * Replays a trace produced by ApduTraceRecorder.
+ *
+ * <p>The reader returned by {@link #getReader(const uint8_t)} for a channel serves the recorded
+ * responses of this channel in order, without any I/O: the recorded exceptions are raised again
+ * and the card name and contactless flag are the recorded ones. Each request must be identical
+ * (same C-APDUs and same channel control) to the recorded one, which makes it possible to run a
+ * new build of the library against production traces and compare its CPU time, allocations and
+ * number of exchanges with the recorded ones.
+ *
+ * <p>The whole trace is decoded and checked by the constructor.
+ *
+ * <p>C++: the readers returned by the replayer may outlive it, the decoded trace is shared with
+ * them. The replay position is updated under a lock so that the readers can be used from
+ * different threads.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API ApduTraceReplayer final {
+public:
+    /**
+     * Decodes a trace.
+     *
+     * @param trace The trace content.
+     * @throw IllegalArgumentException If the trace is not valid or has an unsupported version.
+     * @since 2.2.5.6
+     */
+    explicit ApduTraceReplayer(const std::vector<uint8_t>& trace);
+
+    /**
+     *
+     */
+    ApduTraceReplayer(const ApduTraceReplayer&) = delete;
+    ApduTraceReplayer& operator=(const ApduTraceReplayer&) = delete;
+
+    /**
+     * Gets the number of recorded channels.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getChannelCount() const;
+
+    /**
+     * Gets the reader replaying a channel.
+     *
+     * @param channel The channel number.
+     * @return A reader to provide to the transaction managers in place of the recorded one.
+     * @throw IllegalArgumentException If the channel is unknown.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardReader> getReader(const uint8_t channel);
+
+    /**
+     * Gets the number of exchanges recorded on a channel.
+     *
+     * @param channel The channel number.
+     * @return A positive or zero int.
+     * @throw IllegalArgumentException If the channel is unknown.
+     * @since 2.2.5.6
+     */
+    int getExchangeCount(const uint8_t channel) const;
+
+    /**
+     * Gets the number of exchanges replayed so far on a channel.
+     *
+     * @param channel The channel number.
+     * @return A positive or zero int.
+     * @throw IllegalArgumentException If the channel is unknown.
+     * @since 2.2.5.6
+     */
+    int getReplayedExchangeCount(const uint8_t channel) const;
+
+    /**
+     * Gets the total time spent in the recorded exchanges of a channel (I/O included).
+     *
+     * @param channel The channel number.
+     * @return A duration in microseconds.
+     * @throw IllegalArgumentException If the channel is unknown.
+     * @since 2.2.5.6
+     */
+    uint64_t getRecordedDuration(const uint8_t channel) const;
+
+    /**
+     * Restarts the replay of all channels from the beginning of the trace.
+     *
+     * @since 2.2.5.6
+     */
+    void rewind();
+
+private:
+    /**
+     * (private)<br>
+     * Decoded exchange record.
+     */
+    struct Exchange final {
+        /**
+         *
+         */
+        uint8_t mOutcome;
+
+        /**
+         *
+         */
+        uint8_t mFlags;
+
+        /**
+         * Timestamp and duration in microseconds.
+         */
+        uint64_t mTimestamp;
+        uint32_t mDuration;
+
+        /**
+         *
+         */
+        std::vector<std::vector<uint8_t>> mApduRequests;
+
+        /**
+         *
+         */
+        std::shared_ptr<CardResponseApi> mCardResponse;
+    };
+
+    /**
+     * (private)<br>
+     * Decoded channel with its exchanges.
+     */
+    struct Channel final {
+        /**
+         *
+         */
+        std::string mName;
+
+        /**
+         *
+         */
+        bool mIsContactless;
+
+        /**
+         *
+         */
+        std::vector<Exchange> mExchanges;
+
+        /**
+         * Index of the next exchange to replay.
+         */
+        size_t mNextExchange;
+    };
+
+    /**
+     * (private)<br>
+     * Decoded trace shared by the replayer and the readers it returns.
+     */
+    struct Trace final {
+        /**
+         * Channels indexed by channel number.
+         */
+        std::vector<Channel> mChannels;
+
+        /**
+         * Protects the replay positions of the channels.
+         */
+        std::mutex mMutex;
+    };
+
+    /**
+     * (private)<br>
+     * Reader serving the recorded exchanges of a channel.
+     */
+    class ReplayReader final : public CardReader, public ProxyReaderApi {
+    public:
+        /**
+         *
+         */
+        ReplayReader(const std::shared_ptr<Trace> trace, const uint8_t channel);
+
+        /**
+         * {@inheritDoc}
+         */
+        const std::string& getName() const override;
+
+        /**
+         * {@inheritDoc}
+         */
+        bool isContactless() override;
+
+        /**
+         * {@inheritDoc}
+         */
+        bool isCardPresent() override;
+
+        /**
+         * {@inheritDoc}
+         */
+        const std::shared_ptr<CardResponseApi> transmitCardRequest(
+            const std::shared_ptr<CardRequestSpi> cardRequest,
+            const ChannelControl channelControl) override;
+
+        /**
+         * {@inheritDoc}
+         */
+        void releaseChannel() override;
+
+    private:
+        /**
+         *
+         */
+        const std::shared_ptr<Trace> mTrace;
+
+        /**
+         *
+         */
+        const uint8_t mChannel;
+    };
+
+    /**
+     *
+     */
+    const std::shared_ptr<Trace> mTrace;
+
+    /**
+     * (private)<br>
+     * Gets a channel.
+     *
+     * @throw IllegalArgumentException If the channel is unknown.
+     */
+    static Channel& getChannel(Trace& trace, const uint8_t channel);
+
+    /**
+     * (private)<br>
+     * Reads a little-endian unsigned integer or a length-prefixed byte array and moves the offset
+     * forward.
+     *
+     * @throw IllegalArgumentException If the trace is truncated.
+     */
+    static uint64_t getUnsigned(const std::vector<uint8_t>& trace,
+                                size_t& offset,
+                                const size_t length);
+    static const std::vector<uint8_t> getBytes(const std::vector<uint8_t>& trace, size_t& offset);
+
+    /**
+     * (private)<br>
+     * Replays the next exchange of a channel.
+     */
+    static const std::shared_ptr<CardResponseApi> replay(
+        Trace& trace,
+        const uint8_t channel,
+        const std::shared_ptr<CardRequestSpi> cardRequest,
+        const ChannelControl channelControl);
+};
+
+}
+}
+}
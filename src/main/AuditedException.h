@@ -0,0 +1,114 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+/* Keyple Card Calypso */
+#include "TransactionAuditData.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+/**
+ * (package-private)<br>
+ * Exception thrown by the transaction managers, carrying a snapshot of the transaction audit data
+ * in addition to the exception it is built from.
+ *
+ * <p>The audit data is formatted and appended to the message of the exception only when what() is
+ * called, and only once. Building the exception therefore costs neither the hexadecimal dump of
+ * the exchanged APDUs nor the formatting of the card and SAM images, which matters when failures
+ * occur in bursts (e.g. under bad RF conditions).
+ *
+ * <p>The exception is caught as its base type E. Since Exception::getMessage() is not virtual,
+ * getMessage() returns the message of the base exception, without the audit data, which remains
+ * available through what() or CommonTransactionManager::getTransactionAuditData().
+ *
+ * <p>C++: specific to this implementation.
+ *
+ * @param <E> The type of the exception defined by the API.
+ * @since 2.2.5.6
+ */
+template <typename E>
+class AuditedException final : public E {
+public:
+    /**
+     * (package-private)<br>
+     * Constructor.
+     *
+     * @param exception The exception to complete.
+     * @param transactionAuditData The snapshot of the transaction audit data.
+     * @since 2.2.5.6
+     */
+    AuditedException(const E& exception,
+                     const std::shared_ptr<const TransactionAuditData> transactionAuditData)
+    : E(exception),
+      mTransactionAuditData(transactionAuditData),
+      mFullMessage(std::make_shared<FullMessage>()) {}
+
+    /**
+     * (package-private)<br>
+     * Gets the snapshot of the transaction audit data.
+     *
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<const TransactionAuditData> getTransactionAuditData() const
+    {
+        return mTransactionAuditData;
+    }
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>The transaction audit data is formatted on first call.
+     *
+     * @since 2.2.5.6
+     */
+    const char* what() const noexcept override
+    {
+        std::call_once(mFullMessage->mFlag, [this]() {
+            mFullMessage->mValue = this->getMessage() + mTransactionAuditData->toString();
+        });
+
+        return mFullMessage->mValue.c_str();
+    }
+
+private:
+    /**
+     * (private)<br>
+     * Lazily built message, shared between the copies of the exception.
+     */
+    struct FullMessage final {
+        std::once_flag mFlag;
+        std::string mValue;
+    };
+
+    /**
+     *
+     */
+    std::shared_ptr<const TransactionAuditData> mTransactionAuditData;
+
+    /**
+     *
+     */
+    std::shared_ptr<FullMessage> mFullMessage;
+};
+
+}
+}
+}
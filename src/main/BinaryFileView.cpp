@@ -0,0 +1,177 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#include "BinaryFileView.h"
+
+#include <algorithm>
+#include <utility>
+
+/* Keyple Card Calypso */
+#include "CalypsoCardConstant.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
+#include "KeypleAssert.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+BinaryFileView::BinaryFileView(const std::shared_ptr<CardTransactionManager> cardTransaction,
+                               const uint8_t sfi,
+                               const int fileSize)
+: mCardTransaction(std::dynamic_pointer_cast<CardTransactionManagerAdapter>(cardTransaction)),
+  mCard(mCardTransaction != nullptr ?
+            std::dynamic_pointer_cast<CalypsoCardAdapter>(mCardTransaction->getCalypsoCard()) :
+            nullptr),
+  mSfi(sfi),
+  mFileSize(fileSize),
+  mChunkSize(mCard != nullptr ? mCard->getPayloadCapacity() : 0)
+{
+    if (mCardTransaction == nullptr) {
+        throw IllegalArgumentException("The provided card transaction manager must be an " \
+                                       "instance of 'CardTransactionManagerAdapter'");
+    }
+
+    Assert::getInstance().isInRange(sfi, 1, CalypsoCardConstant::SFI_MAX, "sfi")
+                         .isInRange(fileSize,
+                                    1,
+                                    CalypsoCardConstant::OFFSET_BINARY_MAX + 1,
+                                    "fileSize");
+
+    mIsChunkRequested.resize((fileSize + mChunkSize - 1) / mChunkSize);
+}
+
+BinaryFileView& BinaryFileView::prefetch(const int offset, const int length)
+{
+    checkRange(offset, length);
+
+    for (int i = offset / mChunkSize; i <= (offset + length - 1) / mChunkSize; i++) {
+        mIsChunkRequested[i] = !isChunkKnown(i);
+    }
+
+    return *this;
+}
+
+const std::vector<uint8_t> BinaryFileView::read(const int offset, const int length)
+{
+    prefetch(offset, length);
+
+    readRequestedChunks();
+
+    /* The card may have returned less data than expected (file smaller than declared) */
+    const std::shared_ptr<FileDataAdapter> fileData = getFileData();
+    if (fileData == nullptr || !fileData->isContentKnown(1, offset, length)) {
+        throw IllegalStateException("The requested range has not been returned by the card.");
+    }
+
+    const std::vector<uint8_t>& content = fileData->getAllRecordsContent().at(1);
+    if (static_cast<int>(content.size()) < offset + length) {
+        throw IllegalStateException("The requested range has not been returned by the card.");
+    }
+
+    return std::vector<uint8_t>(content.begin() + offset, content.begin() + offset + length);
+}
+
+bool BinaryFileView::isKnown(const int offset, const int length) const
+{
+    checkRange(offset, length);
+
+    for (int i = offset / mChunkSize; i <= (offset + length - 1) / mChunkSize; i++) {
+        if (!isChunkKnown(i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int BinaryFileView::getReadChunkCount() const
+{
+    return mReadChunkCount;
+}
+
+void BinaryFileView::checkRange(const int offset, const int length) const
+{
+    Assert::getInstance().isInRange(offset, 0, mFileSize - 1, "offset")
+                         .isInRange(length, 1, mFileSize - offset, "length");
+}
+
+const std::shared_ptr<FileDataAdapter> BinaryFileView::getFileData() const
+{
+    /* C++: getFileBySfi is not used since it logs a warning when the file is not in the image */
+    for (const auto& ef : mCard->getFiles()) {
+        if (ef->getSfi() == mSfi) {
+            return std::dynamic_pointer_cast<FileDataAdapter>(ef->getData());
+        }
+    }
+
+    return nullptr;
+}
+
+bool BinaryFileView::isChunkKnown(const int chunkIndex) const
+{
+    const std::shared_ptr<FileDataAdapter> fileData = getFileData();
+    const int chunkOffset = chunkIndex * mChunkSize;
+
+    return fileData != nullptr &&
+           fileData->isContentKnown(1,
+                                    chunkOffset,
+                                    std::min(mChunkSize, mFileSize - chunkOffset));
+}
+
+void BinaryFileView::readRequestedChunks()
+{
+    /* Adjacent chunks are coalesced into a single range */
+    std::vector<std::pair<int, int>> ranges;
+    std::vector<int> chunks;
+
+    for (int i = 0; i < static_cast<int>(mIsChunkRequested.size()); i++) {
+
+        if (!mIsChunkRequested[i]) {
+            continue;
+        }
+
+        const int chunkOffset = i * mChunkSize;
+        const int chunkLength = std::min(mChunkSize, mFileSize - chunkOffset);
+
+        if (!ranges.empty() && ranges.back().first + ranges.back().second == chunkOffset) {
+            ranges.back().second += chunkLength;
+        } else {
+            ranges.push_back(std::make_pair(chunkOffset, chunkLength));
+        }
+
+        chunks.push_back(i);
+    }
+
+    if (ranges.empty()) {
+        return;
+    }
+
+    mCardTransaction->prepareReadBinaryRanges(mSfi, ranges);
+    mCardTransaction->processCommands();
+
+    for (const int i : chunks) {
+        mIsChunkRequested[i] = false;
+    }
+
+    mReadChunkCount += static_cast<int>(chunks.size());
+}
+
+}
+}
+}
@@ -0,0 +1,160 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* Calypsonet Terminal Calypso */
+#include "CardTransactionManager.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "CardTransactionManagerAdapter.h"
+#include "FileDataAdapter.h"
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::calypso::transaction;
+
+/**
+ * View of a binary file of the card, read on demand by chunks.
+ *
+ * <p>The file is divided into chunks of the payload capacity of the card, aligned on offset 0.
+ * Only the chunks covering the bytes actually requested are read, each at most once: the ranges
+ * requested with prefetch are accumulated, then the missing chunks are read together, the adjacent
+ * ones being coalesced into a single range, in a single card request on the next read. The bytes
+ * already known are served from the card image.
+ *
+ * <p>The view keeps no state on the content: a chunk is known when all its bytes are known in the
+ * card image. The data written to the file with the transaction manager, as well as the restoring
+ * of the image when a secure session is cancelled, are thus reflected in the view.
+ *
+ * <p>C++: specific to this implementation.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API BinaryFileView final {
+public:
+    /**
+     * Creates a view of a binary file.
+     *
+     * @param cardTransaction The card transaction manager used to read the file.
+     * @param sfi The SFI of the file.
+     * @param fileSize The size of the file in bytes.
+     * @throw IllegalArgumentException If the transaction manager is null or not provided by this
+     *        library, or if one of the arguments is out of range.
+     * @since 2.2.5.6
+     */
+    BinaryFileView(const std::shared_ptr<CardTransactionManager> cardTransaction,
+                   const uint8_t sfi,
+                   const int fileSize);
+
+    /**
+     * Requests a range of bytes, read with the other requested ranges on the next call to read.
+     *
+     * @param offset The offset of the first byte.
+     * @param length The number of bytes.
+     * @return The current instance.
+     * @throw IllegalArgumentException If the range is out of the file.
+     * @since 2.2.5.6
+     */
+    BinaryFileView& prefetch(const int offset, const int length);
+
+    /**
+     * Gets a range of bytes of the file, reading the missing chunks and the ones requested with
+     * prefetch if needed.
+     *
+     * <p>The card commands already prepared in the transaction manager are processed with the
+     * reading of the chunks.
+     *
+     * @param offset The offset of the first byte.
+     * @param length The number of bytes.
+     * @return A not empty array.
+     * @throw IllegalArgumentException If the range is out of the file.
+     * @throw IllegalStateException If the card did not return the whole range (e.g. file smaller
+     *        than the size provided to the view).
+     * @throw CardTransactionException If the reading of the chunks failed (see
+     *        CardTransactionManager::processCommands).
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> read(const int offset, const int length);
+
+    /**
+     * Indicates if a range of bytes is known without reading the card.
+     *
+     * @param offset The offset of the first byte.
+     * @param length The number of bytes.
+     * @return True if all the chunks of the range are known in the card image.
+     * @throw IllegalArgumentException If the range is out of the file.
+     * @since 2.2.5.6
+     */
+    bool isKnown(const int offset, const int length) const;
+
+    /**
+     * Gets the number of chunks read from the card.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getReadChunkCount() const;
+
+private:
+    /**
+     *
+     */
+    const std::shared_ptr<CardTransactionManagerAdapter> mCardTransaction;
+    const std::shared_ptr<CalypsoCardAdapter> mCard;
+    const uint8_t mSfi;
+    const int mFileSize;
+    const int mChunkSize;
+
+    /**
+     * Chunks to read on the next read.
+     */
+    std::vector<bool> mIsChunkRequested;
+    int mReadChunkCount = 0;
+
+    /**
+     * (private)<br>
+     * Checks that a range is in the file.
+     */
+    void checkRange(const int offset, const int length) const;
+
+    /**
+     * (private)<br>
+     * Gets the content of the file in the card image, null if the file is not in the image.
+     */
+    const std::shared_ptr<FileDataAdapter> getFileData() const;
+
+    /**
+     * (private)<br>
+     * Indicates if all the bytes of a chunk are known in the card image.
+     */
+    bool isChunkKnown(const int chunkIndex) const;
+
+    /**
+     * (private)<br>
+     * Reads the requested chunks not already known, in a single card request.
+     */
+    void readRequestedChunks();
+};
+
+}
+}
+}
@@ -40,6 +40,9 @@ using namespace keyple::core::util::cpp::exception;
 
 /* CALYPSO CARD ADAPTER ------------------------------------------------------------------------- */
 
+const std::unique_ptr<Logger> CalypsoCardAdapter::mLogger =
+    LoggerFactory::getLogger(typeid(CalypsoCardAdapter));
+
 const std::string CalypsoCardAdapter::PATTERN_1_BYTE_HEX = "%02Xh";
 const std::string CalypsoCardAdapter::PATTERN_2_BYTES_HEX = "%04Xh";
 
@@ -68,10 +71,8 @@ const std::vector<int> CalypsoCardAdapter::BUFFER_SIZE_INDICATOR_TO_BUFFER_SIZE
     220435, 262144, 311743, 370727, 440871, 524288, 623487, 741455, 881743, 1048576
 };
 
-const std::vector<std::shared_ptr<CalypsoCardAdapter::PatchRev3>>
-    CalypsoCardAdapter::mPatchesRev3 = initPatchRev3();
-const std::vector<std::shared_ptr<CalypsoCardAdapter::PatchRev12>>
-    CalypsoCardAdapter::mPatchesRev12 = initPatchRev12();
+constexpr CalypsoCardAdapter::Patch CalypsoCardAdapter::PATCHES_REV3[];
+constexpr CalypsoCardAdapter::Patch CalypsoCardAdapter::PATCHES_REV12[];
 
 CalypsoCardAdapter::CalypsoCardAdapter() {}
 
@@ -80,62 +81,23 @@ void CalypsoCardAdapter::initialize(
 {
     if (cardSelectionResponse != nullptr) {
 
-        if (cardSelectionResponse->getSelectApplicationResponse() != nullptr) {
-
-            initializeWithFci(cardSelectionResponse->getSelectApplicationResponse());
-
-        } else if (cardSelectionResponse->getPowerOnData() != "") {
-
-            initializeWithPowerOnData(cardSelectionResponse->getPowerOnData());
-        }
+        initialize(cardSelectionResponse->getSelectApplicationResponse(),
+                   cardSelectionResponse->getPowerOnData());
     }
 }
 
-const std::vector<std::shared_ptr<CalypsoCardAdapter::PatchRev12>>
-    CalypsoCardAdapter::initPatchRev12()
-{
-    std::shared_ptr<PatchRev12> p = nullptr;
-    std::vector<std::shared_ptr<PatchRev12>> v;
-
-    /* Patches for revision 1 & 2 */
-
-    /* 06 XX 01 03 XX XX XX */
-    p = std::shared_ptr<PatchRev12>(new PatchRev12("06000103000000", "FF00FFFF000000"));
-    p->setCounterValuePostponed();
-    v.push_back(p);
-
-    /* 06 0A 01 02 XX XX XX */
-    p = std::shared_ptr<PatchRev12>(new PatchRev12("060A0102000000", "FFFFFFFF000000"));
-    p->setCounterValuePostponed();
-    v.push_back(p);
-
-    /* XX XX 0X XX 15 XX XX */
-    p = std::shared_ptr<PatchRev12>(new PatchRev12("00000000150000", "0000F000FF0000"));
-    p->setCounterValuePostponed();
-    v.push_back(p);
-
-    /* XX XX 1X XX 15 XX XX */
-    p = std::shared_ptr<PatchRev12>(new PatchRev12("00001000150000", "0000F000FF0000"));
-    p->setCounterValuePostponed();
-    v.push_back(p);
-
-    return v;
-}
-
-const std::vector<std::shared_ptr<CalypsoCardAdapter::PatchRev3>>
-    CalypsoCardAdapter::initPatchRev3()
+void CalypsoCardAdapter::initialize(
+    const std::shared_ptr<ApduResponseApi> selectApplicationResponse,
+    const std::string& powerOnData)
 {
-    std::shared_ptr<PatchRev3> p = nullptr;
-    std::vector<std::shared_ptr<PatchRev3>> v;
+    if (selectApplicationResponse != nullptr) {
 
-    /* Patches for revision 3 */
+        initializeWithFci(selectApplicationResponse);
 
-    /* XX 3C XX XX XX 10 XX */
-    p = std::shared_ptr<PatchRev3>(new PatchRev3("003C0000001000", "00FF000000FF00"));
-    p->setPayloadCapacity(235);
-    v.push_back(p);
+    } else if (powerOnData != "") {
 
-    return v;
+        initializeWithPowerOnData(powerOnData);
+    }
 }
 
 void CalypsoCardAdapter::initializeWithPowerOnData(const std::string& powerOnData)
@@ -426,8 +388,8 @@ bool CalypsoCardAdapter::isDfInvalidated() const
 
 bool CalypsoCardAdapter::isDfRatified() const
 {
-    if (mIsDfRatified != nullptr) {
-        return *mIsDfRatified.get();
+    if (mIsDfRatified.isPresent()) {
+        return mIsDfRatified.get();
     }
 
     throw IllegalStateException("Unable to determine the ratification status. No session was " \
@@ -436,17 +398,17 @@ bool CalypsoCardAdapter::isDfRatified() const
 
 int CalypsoCardAdapter::getTransactionCounter() const
 {
-    if (mTransactionCounter == nullptr) {
+    if (!mTransactionCounter.isPresent()) {
         throw IllegalStateException("Unable to determine the transaction counter. No session was " \
                                     "opened.");
     }
 
-    return *mTransactionCounter.get();
+    return mTransactionCounter.get();
 }
 
 void CalypsoCardAdapter::setTransactionCounter(const int transactionCounter)
 {
-    mTransactionCounter = std::make_shared<int>(transactionCounter);
+    mTransactionCounter = transactionCounter;
 }
 
 void CalypsoCardAdapter::setSvData(const uint8_t svKvc,
@@ -460,7 +422,7 @@ void CalypsoCardAdapter::setSvData(const uint8_t svKvc,
     mSvKvc = svKvc;
     mSvGetHeader = svGetHeader;
     mSvGetData = svGetData;
-    mSvBalance = std::make_shared<int>(svBalance);
+    mSvBalance = svBalance;
     mSvLastTNum = svLastTNum;
 
     /* Update logs, do not overwrite existing values (case of double reading) */
@@ -475,17 +437,17 @@ void CalypsoCardAdapter::setSvData(const uint8_t svKvc,
 
 int CalypsoCardAdapter::getSvBalance() const
 {
-    if (mSvBalance == nullptr) {
+    if (!mSvBalance.isPresent()) {
         throw IllegalStateException("No SV Get command has been executed.");
     }
 
-    return *mSvBalance.get();
+    return mSvBalance.get();
 }
 
 int CalypsoCardAdapter::getSvLastTNum() const
 {
-    if (mSvBalance == nullptr) {
-         new IllegalStateException("No SV Get command has been executed.");
+    if (!mSvBalance.isPresent()) {
+        throw IllegalStateException("No SV Get command has been executed.");
     }
 
     return mSvLastTNum;
@@ -539,9 +501,44 @@ const std::vector<std::shared_ptr<SvDebitLogRecord>> CalypsoCardAdapter::getSvDe
     return svDebitLogRecords;
 }
 
+const std::vector<std::shared_ptr<SvDebitLogRecord>> CalypsoCardAdapter::getSvDebitLogRecordsSince(
+    const int svTNum) const
+{
+    std::vector<std::shared_ptr<SvDebitLogRecord>> svDebitLogRecords;
+
+    /* Get the logs from the file data */
+    const std::shared_ptr<ElementaryFile> ef =
+        getFileBySfi(CalypsoCardConstant::SV_DEBIT_LOG_FILE_SFI);
+    if (ef == nullptr) {
+        return svDebitLogRecords;
+    }
+
+    /* The most recent record is the first one of the cyclic file */
+    const std::map<const uint8_t, std::vector<uint8_t>>& logRecords =
+        ef->getData()->getAllRecordsContent();
+    for (const auto& entry : logRecords) {
+
+        const auto svDebitLogRecord = std::make_shared<SvDebitLogRecordAdapter>(entry.second, 0);
+        if (!isSvTNumMoreRecent(svDebitLogRecord->getSvTNum(), svTNum)) {
+            break;
+        }
+
+        svDebitLogRecords.push_back(svDebitLogRecord);
+    }
+
+    return svDebitLogRecords;
+}
+
+bool CalypsoCardAdapter::isSvTNumMoreRecent(const int svTNum, const int knownSvTNum)
+{
+    const int delta = (svTNum - knownSvTNum) & 0xFFFF;
+
+    return delta != 0 && delta < 0x8000;
+}
+
 void CalypsoCardAdapter::setDfRatified(const bool dfRatified)
 {
-    mIsDfRatified = std::make_shared<bool>(dfRatified);
+    mIsDfRatified = dfRatified;
 }
 
 CalypsoCardClass CalypsoCardAdapter::getCardClass() const
@@ -658,16 +655,16 @@ bool CalypsoCardAdapter::isPinBlocked() const
 
 int CalypsoCardAdapter::getPinAttemptRemaining() const
 {
-    if (mPinAttemptCounter == nullptr) {
+    if (!mPinAttemptCounter.isPresent()) {
         throw IllegalStateException("PIN status has not been checked.");
     }
 
-    return *mPinAttemptCounter.get();
+    return mPinAttemptCounter.get();
 }
 
 void CalypsoCardAdapter::setPinAttemptRemaining(const int pinAttemptCounter)
 {
-    mPinAttemptCounter = std::make_shared<int>(pinAttemptCounter);
+    mPinAttemptCounter = pinAttemptCounter;
 }
 
 void CalypsoCardAdapter::setFileHeader(const uint8_t sfi,
@@ -678,11 +675,34 @@ void CalypsoCardAdapter::setFileHeader(const uint8_t sfi,
 
         ef->setHeader(header);
 
-    } else {
+    } else if (std::dynamic_pointer_cast<FileHeaderAdapter>(ef->getHeader())
+                   ->isMissingInfoIn(header)) {
+
+        /* C++: the header may be shared with other cards (see FileHeaderCache), update a copy */
+        auto updatedHeader = std::make_shared<FileHeaderAdapter>(ef->getHeader());
+        updatedHeader->updateMissingInfoFrom(header);
+        ef->setHeader(updatedHeader);
+    }
+}
+
+void CalypsoCardAdapter::setFileHeaderIfMissing(const uint8_t sfi,
+                                                const std::shared_ptr<FileHeaderAdapter> header)
+{
+    for (const auto& ef : mFiles) {
 
-        std::dynamic_pointer_cast<FileHeaderAdapter>(ef->getHeader())
-            ->updateMissingInfoFrom(header);
+        if (ef->getSfi() == sfi) {
+
+            if (ef->getHeader() == nullptr) {
+                std::dynamic_pointer_cast<ElementaryFileAdapter>(ef)->setHeader(header);
+            }
+
+            return;
+        }
     }
+
+    auto ef = std::make_shared<ElementaryFileAdapter>(sfi);
+    ef->setHeader(header);
+    mFiles.push_back(ef);
 }
 
 void CalypsoCardAdapter::setContent(const uint8_t sfi,
@@ -818,107 +838,33 @@ void CalypsoCardAdapter::applyPatchIfNeeded()
 
     if (mProductType == ProductType::PRIME_REVISION_3) {
 
-        std::vector<std::shared_ptr<CalypsoCardAdapter::Patch>> v;
-        for (const auto& p : mPatchesRev3) {
-
-            v.push_back(std::dynamic_pointer_cast<CalypsoCardAdapter::Patch>(p));
-        }
-
-        applyPatchIfNeededForRevision(v, startupInfoLong);
+        applyPatchIfNeededForRevision(PATCHES_REV3, startupInfoLong);
 
     } else if (mProductType == ProductType::PRIME_REVISION_2 ||
                mProductType == ProductType::PRIME_REVISION_1) {
 
         mPayloadCapacity = 128;
 
-        std::vector<std::shared_ptr<CalypsoCardAdapter::Patch>> v;
-        for (const auto& p : mPatchesRev12) {
-
-            v.push_back(std::dynamic_pointer_cast<CalypsoCardAdapter::Patch>(p));
-        }
-
-        applyPatchIfNeededForRevision(v, startupInfoLong);
+        applyPatchIfNeededForRevision(PATCHES_REV12, startupInfoLong);
     }
 }
 
-void CalypsoCardAdapter::applyPatchIfNeededForRevision(
-    const std::vector<std::shared_ptr<CalypsoCardAdapter::Patch>>& patches,
-    const uint64_t startupInfoLong)
+void CalypsoCardAdapter::applyPatch(const Patch& patch)
 {
-    for (const auto& patch : patches) {
+    if (patch.mPayloadCapacity != 0) {
 
-        if (patch->isApplicableTo(startupInfoLong)) {
-
-            patch->apply(this);
-            return;
-        }
+        mPayloadCapacity = patch.mPayloadCapacity;
     }
-}
-
-bool CalypsoCardAdapter::isCounterValuePostponed() const
-{
-    return mIsCounterValuePostponed;
-}
 
-/* PATCH ---------------------------------------------------------------------------------------- */
+    if (patch.mIsCounterValuePostponed) {
 
-CalypsoCardAdapter::Patch::Patch(const std::string& startupInfo)
-: mStartupInfo(HexUtil::toLong(startupInfo)) {}
-
-CalypsoCardAdapter::Patch::Patch(const std::string& startupInfo, const std::string& mask)
-: mStartupInfo(HexUtil::toLong(startupInfo)),
-  mMask(HexUtil::toLong(mask)) {}
-
-bool CalypsoCardAdapter::Patch::isApplicableTo(const uint64_t startupInfo) const
-{
-    return mStartupInfo == (startupInfo & mMask);
-}
-
-/* PATCH REV 3 ---------------------------------------------------------------------------------- */
-
-CalypsoCardAdapter::PatchRev3::PatchRev3(const std::string& startupInfo)
-: CalypsoCardAdapter::Patch(startupInfo) {}
-
-CalypsoCardAdapter::PatchRev3::PatchRev3(const std::string& startupInfo, const std::string& mask)
-: CalypsoCardAdapter::Patch(startupInfo, mask) {}
-
-CalypsoCardAdapter::PatchRev3& CalypsoCardAdapter::PatchRev3::setPayloadCapacity(
-    const int payloadCapacity)
-{
-    mPayloadCapacity = std::make_shared<int>(payloadCapacity);
-
-    return *this;
-}
-
-void CalypsoCardAdapter::PatchRev3::apply(CalypsoCardAdapter* calypsoCard)
-{
-    if (mPayloadCapacity != nullptr) {
-
-        calypsoCard->mPayloadCapacity = *mPayloadCapacity;
+        mIsCounterValuePostponed = true;
     }
 }
 
-/* PATCH REV 12 --------------------------------------------------------------------------------- */
-
-CalypsoCardAdapter::PatchRev12::PatchRev12(const std::string& startupInfo)
-: CalypsoCardAdapter::Patch(startupInfo) {}
-
-CalypsoCardAdapter::PatchRev12::PatchRev12(const std::string& startupInfo, const std::string& mask)
-: CalypsoCardAdapter::Patch(startupInfo, mask) {}
-
-CalypsoCardAdapter::PatchRev12& CalypsoCardAdapter::PatchRev12::setCounterValuePostponed()
-{
-    mIsCounterValuePostponed = std::make_shared<bool>(true);
-
-    return *this;
-}
-
-void CalypsoCardAdapter::PatchRev12::apply(CalypsoCardAdapter* calypsoCard)
+bool CalypsoCardAdapter::isCounterValuePostponed() const
 {
-    if (mIsCounterValuePostponed != nullptr) {
-
-        calypsoCard->mIsCounterValuePostponed = *mIsCounterValuePostponed;
-    }
+    return mIsCounterValuePostponed;
 }
 
 /* ---------------------------------------------------------------------------------------------- */
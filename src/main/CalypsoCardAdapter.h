@@ -33,6 +33,7 @@
 #include "CmdCardGetDataFci.h"
 #include "ElementaryFileAdapter.h"
 #include "KeypleCardCalypsoExport.h"
+#include "Optional.h"
 
 /* Keyple Core Util */
 #include "LoggerFactory.h"
@@ -48,6 +49,7 @@ using namespace calypsonet::terminal::card::spi;
 using namespace keyple::core::util::cpp;
 
 /* Forward declaration */
+class CalypsoCardSnapshot;
 class CmdCardGetDataFci;
 
 /**
@@ -77,6 +79,21 @@ public:
      */
     void initialize(const std::shared_ptr<CardSelectionResponseApi> cardSelectionResponse);
 
+    /**
+     * (package-private)<br>
+     * Post-construction initialization function, from the response to the select application
+     * command if available, or from the power-on data otherwise.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param selectApplicationResponse The select application response (may be null).
+     * @param powerOnData The card's power-on data (may be empty).
+     * @throw IllegalArgumentException If the FCI or the power-on data are inconsistent.
+     * @since 2.2.5.6
+     */
+    void initialize(const std::shared_ptr<ApduResponseApi> selectApplicationResponse,
+                    const std::string& powerOnData);
+
     /**
      * (package-private)<br>
      * Initializes or post-initializes the object with the application FCI data.
@@ -345,6 +362,35 @@ public:
      */
     const std::vector<std::shared_ptr<SvDebitLogRecord>> getSvDebitLogAllRecords() const override;
 
+    /**
+     * (package-private)<br>
+     * Gets the SV debit log records more recent than a known SV transaction, the most recent
+     * first.
+     *
+     * <p>The records are parsed in the order of the file and the parsing stops at the first record
+     * which is not more recent than the known transaction.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param svTNum The SV transaction number of the last known operation.
+     * @return An empty vector if there is no new record or if the records have not been read.
+     * @since 2.2.5.6
+     */
+    const std::vector<std::shared_ptr<SvDebitLogRecord>> getSvDebitLogRecordsSince(
+        const int svTNum) const;
+
+    /**
+     * (package-private)<br>
+     * Indicates if an SV transaction number is more recent than another one, taking into account
+     * the rollover of the 2-byte counter.
+     *
+     * @param svTNum The SV transaction number to check.
+     * @param knownSvTNum The SV transaction number of the last known operation.
+     * @return True if svTNum follows knownSvTNum.
+     * @since 2.2.5.6
+     */
+    static bool isSvTNumMoreRecent(const int svTNum, const int knownSvTNum);
+
     /**
      * (package-private)<br>
      * Sets the ratification status
@@ -447,6 +493,21 @@ public:
      */
     void setFileHeader(const uint8_t sfi, const std::shared_ptr<FileHeaderAdapter> header);
 
+    /**
+     * (package-private)<br>
+     * Sets the header of a file identified by its SFI if it is not already known, without
+     * changing the current file.<br>
+     * If EF does not exist, then it is created.
+     *
+     * <p>C++: specific to this implementation (see FileHeaderCache). The header may be shared with
+     * other cards.
+     *
+     * @param sfi the SFI.
+     * @param header the file header (should be not null).
+     * @since 2.2.5.6
+     */
+    void setFileHeaderIfMissing(const uint8_t sfi, const std::shared_ptr<FileHeaderAdapter> header);
+
     /**
      * (package-private)<br>
      * Set or replace the entire content of the specified record #numRecord of the current selected
@@ -659,141 +720,54 @@ public:
     friend KEYPLECARDCALYPSO_API std::ostream& operator<<(
         std::ostream& os, const std::shared_ptr<CalypsoCardAdapter> cca);
 
-private:
-    /**
-     * (private)<br>
-     * POJO containing card specificities to be applied according to startup info.
-     */
-    class Patch {
-    public:
-        /**
-         *
-         */
-        friend class CalypsoCardAdapter;
-
-        /**
-         *
-         */
-        virtual void apply(CalypsoCardAdapter* calypsoCard) = 0;
-
-    private:
-        /**
-         *
-         */
-        const uint64_t mStartupInfo;
-
-        /**
-         *
-         */
-        const uint64_t mMask = ~0;
-
-        /**
-         *
-         */
-        Patch(const std::string& startupInfo);
-
-        /**
-         *
-         */
-        Patch(const std::string& startupInfo, const std::string& mask);
-
-        /**
-         *
-         */
-        bool isApplicableTo(const uint64_t startupInfo) const;
-    };
-
     /**
-     * (private)<br>
-     * POJO containing card rev 3 specificities to be applied according to startup info.
+     * C++: the snapshot reads and restores the whole card image without extending the public
+     * interface with setters.
      */
-    class PatchRev3 : public Patch {
-    public:
-        /**
-         *
-         */
-        friend class CalypsoCardAdapter;
-
-        /**
-         *
-         */
-        virtual ~PatchRev3() = default;
-
-        /**
-         *
-         */
-        void apply(CalypsoCardAdapter* calypsoCard) override;
-
-    private:
-        /**
-         *
-         */
-        std::shared_ptr<int> mPayloadCapacity;
-
-        /**
-         *
-         */
-        PatchRev3(const std::string& startupInfo);
-
-        /**
-         *
-         */
-        PatchRev3(const std::string& startupInfo, const std::string& mask);
-
-
-        /**
-         *
-         */
-        PatchRev3& setPayloadCapacity(const int payloadCapacity);
-    };
+    friend class CalypsoCardSnapshot;
 
+private:
     /**
      * (private)<br>
-     * POJO containing card rev 1 & 2 specificities to be applied according to startup info.
+     * Plain data record containing card specificities to be applied according to startup info.
+     *
+     * <p>C++: patches are compile-time constants evaluated without heap allocation nor virtual
+     * dispatch.
      */
-    class PatchRev12 : public Patch {
-    public:
+    struct Patch final {
         /**
-         *
-         */
-        friend class CalypsoCardAdapter;
-
-        /**
-         *
-         */
-        virtual ~PatchRev12() = default;
-
-        /**
-         *
+         * Expected startup info value once masked.
          */
-        void apply(CalypsoCardAdapter* calypsoCard) override;
+        const uint64_t mStartupInfo;
 
-    private:
         /**
-         *
+         * Mask applied to the card startup info before comparison.
          */
-        std::shared_ptr<bool> mIsCounterValuePostponed;
+        const uint64_t mMask;
 
         /**
-         *
+         * Payload capacity to apply, 0 if unchanged.
          */
-        PatchRev12(const std::string& startupInfo);
+        const int mPayloadCapacity;
 
         /**
-         *
+         * True if counter values must be considered as postponed.
          */
-        PatchRev12(const std::string& startupInfo, const std::string& mask);
+        const bool mIsCounterValuePostponed;
 
         /**
          *
          */
-        PatchRev12& setCounterValuePostponed();
+        constexpr bool isApplicableTo(const uint64_t startupInfo) const
+        {
+            return mStartupInfo == (startupInfo & mMask);
+        }
     };
 
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CalypsoCardAdapter));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -928,22 +902,22 @@ private:
     /**
      *
      */
-    std::shared_ptr<bool> mIsDfRatified;
+    Optional<bool> mIsDfRatified;
 
     /**
      *
      */
-    std::shared_ptr<int> mTransactionCounter = nullptr;
+    Optional<int> mTransactionCounter;
 
     /**
      *
      */
-    std::shared_ptr<int> mPinAttemptCounter;
+    Optional<int> mPinAttemptCounter;
 
     /**
      *
      */
-    std::shared_ptr<int> mSvBalance;
+    Optional<int> mSvBalance;
 
     /**
      *
@@ -1021,14 +995,26 @@ private:
     bool mIsCounterValuePostponed = false;
 
     /**
-     *
+     * Patches for revision 3
      */
-    static const std::vector<std::shared_ptr<PatchRev3>> mPatchesRev3;
+    static constexpr Patch PATCHES_REV3[] = {
+        /* XX 3C XX XX XX 10 XX */
+        {0x003C0000001000ULL, 0x00FF000000FF00ULL, 235, false}
+    };
 
     /**
-     *
+     * Patches for revision 1 & 2
      */
-    static const std::vector<std::shared_ptr<PatchRev12>> mPatchesRev12;
+    static constexpr Patch PATCHES_REV12[] = {
+        /* 06 XX 01 03 XX XX XX */
+        {0x06000103000000ULL, 0xFF00FFFF000000ULL, 0, true},
+        /* 06 0A 01 02 XX XX XX */
+        {0x060A0102000000ULL, 0xFFFFFFFF000000ULL, 0, true},
+        /* XX XX 0X XX 15 XX XX */
+        {0x00000000150000ULL, 0x0000F000FF0000ULL, 0, true},
+        /* XX XX 1X XX 15 XX XX */
+        {0x00001000150000ULL, 0x0000F000FF0000ULL, 0, true}
+    };
 
     /**
      * Resolve the card product type from the application type byte
@@ -1085,27 +1071,39 @@ private:
     void initializeWithFci(const std::shared_ptr<ApduResponseApi> selectApplicationResponse);
 
     /**
-     *
+     * (private)<br>
+     * Some cards have specific features that need to be taken into account. This method identifies
+     * them and applies the necessary modifications.
      */
-    static const std::vector<std::shared_ptr<PatchRev12>> initPatchRev12();
+    void applyPatchIfNeeded();
 
     /**
+     * (private)<br>
+     * Applies the first patch of the provided table matching the startup info, if any.
      *
+     * @param patches The patch table.
+     * @param startupInfoLong The startup info.
      */
-    static const std::vector<std::shared_ptr<PatchRev3>> initPatchRev3();
+    template <size_t N>
+    void applyPatchIfNeededForRevision(const Patch (&patches)[N], const uint64_t startupInfoLong)
+    {
+        for (size_t i = 0; i < N; i++) {
 
-    /**
-     * (private)<br>
-     * Some cards have specific features that need to be taken into account. This method identifies
-     * them and applies the necessary modifications.
-     */
-    void applyPatchIfNeeded();
+            if (patches[i].isApplicableTo(startupInfoLong)) {
+
+                applyPatch(patches[i]);
+                return;
+            }
+        }
+    }
 
     /**
+     * (private)<br>
+     * Applies the provided patch.
      *
+     * @param patch The patch.
      */
-    void applyPatchIfNeededForRevision(const std::vector<std::shared_ptr<Patch>>& patches,
-                                       const uint64_t startupInfoLong);
+    void applyPatch(const Patch& patch);
 };
 
 }
@@ -12,6 +12,8 @@
 
 #include "CalypsoCardSelectionAdapter.h"
 
+#include <algorithm>
+
 /* Calypsonet Terminal Card */
 #include "ParseException.h"
 
@@ -31,8 +33,11 @@
 #include "CmdCardGetDataFcp.h"
 #include "CmdCardGetDataEfList.h"
 #include "CmdCardGetDataTraceabilityInformation.h"
+#include "CmdCardReadBinary.h"
+#include "CmdCardReadRecordMultiple.h"
 #include "CmdCardReadRecords.h"
 #include "CmdCardSelectFile.h"
+#include "CmdCardSvGet.h"
 #include "UnsupportedOperationException.h"
 
 /* Keyple Card Generic */
@@ -61,6 +66,7 @@ const int CalypsoCardSelectionAdapter::AID_MAX_LENGTH = 16;
 const int CalypsoCardSelectionAdapter::SW_CARD_INVALIDATED = 0x6283;
 const std::string CalypsoCardSelectionAdapter::MSG_CARD_COMMAND_ERROR =
     "A card command error occurred ";
+const int CalypsoCardSelectionAdapter::SELECTION_PAYLOAD_CAPACITY = 128;
 
 CalypsoCardSelectionAdapter::CalypsoCardSelectionAdapter()
 : mCardSelector(std::make_shared<CardSelectorAdapter>()) {}
@@ -240,6 +246,139 @@ CalypsoCardSelection& CalypsoCardSelectionAdapter::prepareSelectFile(
     return *this;
 }
 
+CalypsoCardSelectionAdapter& CalypsoCardSelectionAdapter::prepareReadRecords(
+    const uint8_t sfi,
+    const uint8_t fromRecordNumber,
+    const uint8_t toRecordNumber,
+    const uint8_t recordSize)
+{
+    Assert::getInstance().isInRange(sfi,
+                                    CalypsoCardConstant::SFI_MIN,
+                                    CalypsoCardConstant::SFI_MAX,
+                                    "sfi")
+                         .isInRange(fromRecordNumber,
+                                    CalypsoCardConstant::NB_REC_MIN,
+                                    CalypsoCardConstant::NB_REC_MAX,
+                                    "fromRecordNumber")
+                         .isInRange(toRecordNumber,
+                                    fromRecordNumber,
+                                    CalypsoCardConstant::NB_REC_MAX,
+                                    "toRecordNumber")
+                         .isInRange(recordSize,
+                                    CalypsoCardConstant::DATA_LENGTH_MIN,
+                                    SELECTION_PAYLOAD_CAPACITY - 2,
+                                    "recordSize");
+
+    for (const auto& chunk : CmdCardReadRecords::splitRecords(fromRecordNumber,
+                                                              toRecordNumber,
+                                                              recordSize,
+                                                              SELECTION_PAYLOAD_CAPACITY)) {
+        mCommands.push_back(
+            std::make_shared<CmdCardReadRecords>(CalypsoCardClass::ISO,
+                                                 sfi,
+                                                 chunk.mFirstRecordNumber,
+                                                 chunk.mReadMode,
+                                                 chunk.mExpectedLength));
+    }
+
+    return *this;
+}
+
+CalypsoCardSelectionAdapter& CalypsoCardSelectionAdapter::prepareReadRecordsPartially(
+    const uint8_t sfi,
+    const uint8_t fromRecordNumber,
+    const uint8_t toRecordNumber,
+    const uint8_t offset,
+    const uint8_t nbBytesToRead)
+{
+    Assert::getInstance().isInRange(sfi,
+                                    CalypsoCardConstant::SFI_MIN,
+                                    CalypsoCardConstant::SFI_MAX,
+                                    "sfi")
+                         .isInRange(fromRecordNumber,
+                                    CalypsoCardConstant::NB_REC_MIN,
+                                    CalypsoCardConstant::NB_REC_MAX,
+                                    "fromRecordNumber")
+                         .isInRange(toRecordNumber,
+                                    fromRecordNumber,
+                                    CalypsoCardConstant::NB_REC_MAX,
+                                    "toRecordNumber")
+                         .isInRange(offset,
+                                    CalypsoCardConstant::OFFSET_MIN,
+                                    CalypsoCardConstant::OFFSET_MAX,
+                                    "offset")
+                         .isInRange(nbBytesToRead,
+                                    CalypsoCardConstant::DATA_LENGTH_MIN,
+                                    std::min(CalypsoCardConstant::DATA_LENGTH_MAX - offset,
+                                             SELECTION_PAYLOAD_CAPACITY - 2),
+                                    "nbBytesToRead");
+
+    const int nbRecordsPerApdu = std::max(SELECTION_PAYLOAD_CAPACITY / nbBytesToRead, 1);
+
+    for (int currentRecordNumber = fromRecordNumber;
+         currentRecordNumber <= toRecordNumber;
+         currentRecordNumber += nbRecordsPerApdu) {
+
+        mCommands.push_back(
+            std::make_shared<CmdCardReadRecordMultiple>(
+                CalypsoCardClass::ISO,
+                sfi,
+                static_cast<uint8_t>(currentRecordNumber),
+                offset,
+                nbBytesToRead));
+    }
+
+    return *this;
+}
+
+CalypsoCardSelectionAdapter& CalypsoCardSelectionAdapter::prepareReadBinary(
+    const uint8_t sfi, const int offset, const int nbBytesToRead)
+{
+    Assert::getInstance().isInRange(sfi,
+                                    CalypsoCardConstant::SFI_MIN,
+                                    CalypsoCardConstant::SFI_MAX,
+                                    "sfi")
+                         .isInRange(offset,
+                                    CalypsoCardConstant::OFFSET_MIN,
+                                    CalypsoCardConstant::OFFSET_BINARY_MAX,
+                                    "offset")
+                         .greaterOrEqual(nbBytesToRead, 1, "nbBytesToRead");
+
+    if (sfi > 0 && offset > 255) {
+
+        /* Tips to select the file: add a "Read Binary" command (read one byte at offset 0). */
+        mCommands.push_back(std::make_shared<CmdCardReadBinary>(CalypsoCardClass::ISO, sfi, 0, 1));
+    }
+
+    int currentLength;
+    int currentOffset = offset;
+    int nbBytesRemainingToRead = nbBytesToRead;
+
+    do {
+
+        currentLength = std::min(nbBytesRemainingToRead, SELECTION_PAYLOAD_CAPACITY);
+        mCommands.push_back(
+            std::make_shared<CmdCardReadBinary>(CalypsoCardClass::ISO,
+                                                sfi,
+                                                currentOffset,
+                                                currentLength));
+
+        currentOffset += currentLength;
+        nbBytesRemainingToRead -= currentLength;
+
+    } while (nbBytesRemainingToRead > 0);
+
+    return *this;
+}
+
+CalypsoCardSelectionAdapter& CalypsoCardSelectionAdapter::prepareSvGet(
+    const SvOperation svOperation)
+{
+    mCommands.push_back(std::make_shared<CmdCardSvGet>(CalypsoCardClass::ISO, svOperation, false));
+
+    return *this;
+}
+
 const std::shared_ptr<CardSelectionRequestSpi>
     CalypsoCardSelectionAdapter::getCardSelectionRequest()
 {
@@ -267,10 +406,18 @@ const std::shared_ptr<SmartCardSpi> CalypsoCardSelectionAdapter::parse(
 {
     const std::shared_ptr<CardResponseApi> cardResponse = cardSelectionResponse->getCardResponse();
 
-    std::vector<std::shared_ptr<ApduResponseApi>> apduResponses =
-        cardResponse != nullptr ?
-        cardResponse->getApduResponses() : std::vector<std::shared_ptr<ApduResponseApi>>();
+    return parse(cardSelectionResponse->getSelectApplicationResponse(),
+                 cardSelectionResponse->getPowerOnData(),
+                 cardResponse != nullptr ?
+                     cardResponse->getApduResponses() :
+                     std::vector<std::shared_ptr<ApduResponseApi>>());
+}
 
+const std::shared_ptr<CalypsoCardAdapter> CalypsoCardSelectionAdapter::parse(
+    const std::shared_ptr<ApduResponseApi> selectApplicationResponse,
+    const std::string& powerOnData,
+    const std::vector<std::shared_ptr<ApduResponseApi>>& apduResponses)
+{
     if (mCommands.size() != apduResponses.size()) {
 
         throw ParseException("Mismatch in the number of requests/responses.");
@@ -281,7 +428,7 @@ const std::shared_ptr<SmartCardSpi> CalypsoCardSelectionAdapter::parse(
     try {
 
         calypsoCard = std::make_shared<CalypsoCardAdapter>();
-        calypsoCard->initialize(cardSelectionResponse);
+        calypsoCard->initialize(selectApplicationResponse, powerOnData);
 
         if (!mCommands.empty()) {
 
@@ -295,8 +442,8 @@ const std::shared_ptr<SmartCardSpi> CalypsoCardSelectionAdapter::parse(
     }
 
     if (calypsoCard->getProductType() == CalypsoCard::ProductType::UNKNOWN &&
-        cardSelectionResponse->getSelectApplicationResponse() == nullptr &&
-        cardSelectionResponse->getPowerOnData() == "") {
+        selectApplicationResponse == nullptr &&
+        powerOnData == "") {
 
         throw ParseException("Unable to create a CalypsoCard: no power-on data and no FCI " \
                              "provided.");
@@ -346,7 +493,9 @@ void CalypsoCardSelectionAdapter::parseApduResponses(
 
                 (void)dynamic_cast<const CardDataAccessException&>(e);
 
-                if (commandRef == CalypsoCardCommand::READ_RECORDS) {
+                if (commandRef == CalypsoCardCommand::READ_RECORDS ||
+                    commandRef == CalypsoCardCommand::READ_RECORD_MULTIPLE ||
+                    commandRef == CalypsoCardCommand::READ_BINARY) {
 
                     /*
                      * Best effort mode, do not throw exception for "file not found" and "record not
@@ -19,6 +19,7 @@
 
 /* Calypsonet Terminal Calypso */
 #include "CalypsoCardSelection.h"
+#include "SvOperation.h"
 
 /* Calypsonet Terminal Card */
 #include "CardSelectorSpi.h"
@@ -26,6 +27,7 @@
 
 /* Keyple Card Calypso */
 #include "AbstractCardCommand.h"
+#include "CalypsoCardAdapter.h"
 #include "CardSelectorAdapter.h"
 #include "KeypleCardCalypsoExport.h"
 
@@ -34,6 +36,7 @@ namespace card {
 namespace calypso {
 
 using namespace calypsonet::terminal::calypso::card;
+using namespace calypsonet::terminal::calypso::transaction;
 using namespace calypsonet::terminal::card::spi;
 
 /**
@@ -157,6 +160,94 @@ public:
      */
     CalypsoCardSelection& prepareSelectFile(const SelectFileControl selectControl) override;
 
+    /**
+     * Adds a command APDU to read one or more records from the indicated EF during the selection
+     * process.
+     *
+     * <p>The card revision being unknown at this stage, the reading is split according to the
+     * lowest payload capacity of the Calypso cards. The records read are placed in the CalypsoCard
+     * image returned by the selection.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param sfi The SFI of the EF.
+     * @param fromRecordNumber The number of the first record to read.
+     * @param toRecordNumber The number of the last record to read.
+     * @param recordSize The record length.
+     * @return The current instance.
+     * @throw IllegalArgumentException If one of the provided arguments is out of range.
+     * @see CardTransactionManager::prepareReadRecords
+     * @since 2.2.5.6
+     */
+    CalypsoCardSelectionAdapter& prepareReadRecords(const uint8_t sfi,
+                                                    const uint8_t fromRecordNumber,
+                                                    const uint8_t toRecordNumber,
+                                                    const uint8_t recordSize);
+
+    /**
+     * Adds one or more "Read Record Multiple" commands to read a part of one or more records of
+     * the indicated EF during the selection process.
+     *
+     * <p>The command is only supported by the Calypso Prime revision 3 and Light cards: it must
+     * only be used when the selected cards are known to support it. As for prepareReadRecords, the
+     * number of bytes to read is limited by the lowest payload capacity of the Calypso cards.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param sfi The SFI of the EF.
+     * @param fromRecordNumber The number of the first record to read.
+     * @param toRecordNumber The number of the last record to read.
+     * @param offset The offset in the records where to start reading.
+     * @param nbBytesToRead The number of bytes to read from each record.
+     * @return The current instance.
+     * @throw IllegalArgumentException If one of the provided arguments is out of range.
+     * @see CardTransactionManager::prepareReadRecordsPartially
+     * @since 2.2.5.6
+     */
+    CalypsoCardSelectionAdapter& prepareReadRecordsPartially(const uint8_t sfi,
+                                                             const uint8_t fromRecordNumber,
+                                                             const uint8_t toRecordNumber,
+                                                             const uint8_t offset,
+                                                             const uint8_t nbBytesToRead);
+
+    /**
+     * Adds one or more "Read Binary" commands to read a part of a binary EF during the selection
+     * process.
+     *
+     * <p>The command is only supported by the Calypso Prime revision 3 cards: it must only be
+     * used when the selected cards are known to support it.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param sfi The SFI of the EF.
+     * @param offset The offset.
+     * @param nbBytesToRead The number of bytes to read.
+     * @return The current instance.
+     * @throw IllegalArgumentException If one of the provided arguments is out of range.
+     * @see CardTransactionManager::prepareReadBinary
+     * @since 2.2.5.6
+     */
+    CalypsoCardSelectionAdapter& prepareReadBinary(const uint8_t sfi,
+                                                   const int offset,
+                                                   const int nbBytesToRead);
+
+    /**
+     * Adds a "SV Get" command in compatibility mode during the selection process, making the SV
+     * balance and the load or debit log available in the CalypsoCard image returned by the
+     * selection.
+     *
+     * <p>The SV data obtained this way is meant to be consulted only: a SV operation still
+     * requires CardTransactionManager::prepareSvGet to be invoked in the card transaction.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param svOperation Informs about the nature of the log to read (load or debit).
+     * @return The current instance.
+     * @see CardTransactionManager::prepareSvGet
+     * @since 2.2.5.6
+     */
+    CalypsoCardSelectionAdapter& prepareSvGet(const SvOperation svOperation);
+
     /**
      * {@inheritDoc}
      *
@@ -172,6 +263,25 @@ public:
     const std::shared_ptr<SmartCardSpi> parse(
         const std::shared_ptr<CardSelectionResponseApi> cardSelectionResponse) override;
 
+    /**
+     * (package-private)<br>
+     * Creates the card image from the responses to the selection, without the need of a
+     * CardSelectionResponseApi (selection made directly by CalypsoExtensionService::processTap).
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param selectApplicationResponse The select application response (may be null).
+     * @param powerOnData The card's power-on data (may be empty).
+     * @param apduResponses The responses to the commands prepared in this selection.
+     * @return A not null reference.
+     * @throw ParseException If the responses are invalid.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CalypsoCardAdapter> parse(
+        const std::shared_ptr<ApduResponseApi> selectApplicationResponse,
+        const std::string& powerOnData,
+        const std::vector<std::shared_ptr<ApduResponseApi>>& apduResponses);
+
 private:
     /**
      *
@@ -181,6 +291,12 @@ private:
     static const int SW_CARD_INVALIDATED;
     static const std::string MSG_CARD_COMMAND_ERROR;
 
+    /**
+     * Payload capacity used to split the readings, the card revision being unknown during the
+     * selection (capacity of the Calypso Prime revisions 1 and 2).
+     */
+    static const int SELECTION_PAYLOAD_CAPACITY;
+
 
     /**
      * C++: vector of AbstractApduCommand instead of AbstractCardCommand because of vector
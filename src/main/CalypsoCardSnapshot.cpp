@@ -0,0 +1,665 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CalypsoCardSnapshot.h"
+
+/* Calypsonet Terminal Calypso */
+#include "WriteAccessLevel.h"
+
+/* Keyple Card Calypso */
+#include "DirectoryHeaderAdapter.h"
+#include "ElementaryFileAdapter.h"
+#include "FileDataAdapter.h"
+#include "FileHeaderAdapter.h"
+#include "LocalApduResponseAdapter.h"
+#include "SvDebitLogRecordAdapter.h"
+#include "SvLoadLogRecordAdapter.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+#include "KeypleAssert.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::calypso;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp;
+using namespace keyple::core::util::cpp::exception;
+
+/* BYTES ---------------------------------------------------------------------------------------- */
+
+CalypsoCardSnapshot::Bytes::Bytes(const uint8_t* data, const uint32_t length)
+: mData(data), mLength(length) {}
+
+const uint8_t* CalypsoCardSnapshot::Bytes::data() const
+{
+    return mData;
+}
+
+uint32_t CalypsoCardSnapshot::Bytes::size() const
+{
+    return mLength;
+}
+
+const std::vector<uint8_t> CalypsoCardSnapshot::Bytes::toVector() const
+{
+    return mLength == 0 ? std::vector<uint8_t>() : std::vector<uint8_t>(mData, mData + mLength);
+}
+
+/* WRITER --------------------------------------------------------------------------------------- */
+
+CalypsoCardSnapshot::Writer::Writer(const uint32_t dataOffset) : mBuffer(dataOffset) {}
+
+void CalypsoCardSnapshot::Writer::putU8(const uint32_t offset, const uint8_t value)
+{
+    mBuffer[offset] = value;
+}
+
+void CalypsoCardSnapshot::Writer::putU16(const uint32_t offset, const uint16_t value)
+{
+    mBuffer[offset] = static_cast<uint8_t>(value);
+    mBuffer[offset + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+void CalypsoCardSnapshot::Writer::putU32(const uint32_t offset, const uint32_t value)
+{
+    mBuffer[offset] = static_cast<uint8_t>(value);
+    mBuffer[offset + 1] = static_cast<uint8_t>(value >> 8);
+    mBuffer[offset + 2] = static_cast<uint8_t>(value >> 16);
+    mBuffer[offset + 3] = static_cast<uint8_t>(value >> 24);
+}
+
+void CalypsoCardSnapshot::Writer::putBytes(const uint32_t offset,
+                                           const uint8_t* data,
+                                           const size_t length)
+{
+    putU32(offset, static_cast<uint32_t>(mBuffer.size()));
+    putU32(offset + 4, static_cast<uint32_t>(length));
+    mBuffer.insert(mBuffer.end(), data, data + length);
+}
+
+void CalypsoCardSnapshot::Writer::putBytes(const uint32_t offset, const std::vector<uint8_t>& data)
+{
+    putBytes(offset, data.data(), data.size());
+}
+
+std::vector<uint8_t>& CalypsoCardSnapshot::Writer::getBuffer()
+{
+    return mBuffer;
+}
+
+/* CALYPSO CARD SNAPSHOT ------------------------------------------------------------------------ */
+
+const uint16_t CalypsoCardSnapshot::VERSION = 1;
+
+const uint32_t CalypsoCardSnapshot::MAGIC = 0x5343434B;
+
+const uint32_t CalypsoCardSnapshot::HEADER_SIZE = 32;
+const uint32_t CalypsoCardSnapshot::H_MAGIC = 0;
+const uint32_t CalypsoCardSnapshot::H_VERSION = 4;
+const uint32_t CalypsoCardSnapshot::H_SIZE = 8;
+const uint32_t CalypsoCardSnapshot::H_CARD_OFFSET = 12;
+const uint32_t CalypsoCardSnapshot::H_FILE_TABLE_OFFSET = 16;
+const uint32_t CalypsoCardSnapshot::H_FILE_COUNT = 20;
+const uint32_t CalypsoCardSnapshot::H_RECORD_TABLE_OFFSET = 24;
+const uint32_t CalypsoCardSnapshot::H_RECORD_COUNT = 28;
+
+const uint32_t CalypsoCardSnapshot::CARD_SECTION_SIZE = 168;
+const uint32_t CalypsoCardSnapshot::C_FLAGS = 0;
+const uint32_t CalypsoCardSnapshot::C_CARD_CLASS = 4;
+const uint32_t CalypsoCardSnapshot::C_PRODUCT_TYPE = 5;
+const uint32_t CalypsoCardSnapshot::C_APPLICATION_TYPE = 6;
+const uint32_t CalypsoCardSnapshot::C_APPLICATION_SUBTYPE = 7;
+const uint32_t CalypsoCardSnapshot::C_SESSION_MODIFICATION = 8;
+const uint32_t CalypsoCardSnapshot::C_SV_KVC = 9;
+const uint32_t CalypsoCardSnapshot::C_MODIFICATIONS_COUNTER_MAX = 12;
+const uint32_t CalypsoCardSnapshot::C_PAYLOAD_CAPACITY = 16;
+const uint32_t CalypsoCardSnapshot::C_TRANSACTION_COUNTER = 20;
+const uint32_t CalypsoCardSnapshot::C_PIN_ATTEMPT_COUNTER = 24;
+const uint32_t CalypsoCardSnapshot::C_SV_BALANCE = 28;
+const uint32_t CalypsoCardSnapshot::C_SV_LAST_TNUM = 32;
+const uint32_t CalypsoCardSnapshot::C_SV_LOAD_LOG_OFFSET = 36;
+const uint32_t CalypsoCardSnapshot::C_SV_DEBIT_LOG_OFFSET = 40;
+const uint32_t CalypsoCardSnapshot::C_DIR_LID = 44;
+const uint32_t CalypsoCardSnapshot::C_DIR_DF_STATUS = 46;
+const uint32_t CalypsoCardSnapshot::C_DIR_KIFS = 47;
+const uint32_t CalypsoCardSnapshot::C_DIR_KVCS = 50;
+const uint32_t CalypsoCardSnapshot::C_POWER_ON_DATA = 56;
+const uint32_t CalypsoCardSnapshot::C_SELECT_APPLICATION_RESPONSE = 64;
+const uint32_t CalypsoCardSnapshot::C_CALYPSO_SERIAL_NUMBER = 72;
+const uint32_t CalypsoCardSnapshot::C_STARTUP_INFO = 80;
+const uint32_t CalypsoCardSnapshot::C_DF_NAME = 88;
+const uint32_t CalypsoCardSnapshot::C_CARD_CHALLENGE = 96;
+const uint32_t CalypsoCardSnapshot::C_TRACEABILITY_INFORMATION = 104;
+const uint32_t CalypsoCardSnapshot::C_SV_GET_HEADER = 112;
+const uint32_t CalypsoCardSnapshot::C_SV_GET_DATA = 120;
+const uint32_t CalypsoCardSnapshot::C_SV_OPERATION_SIGNATURE = 128;
+const uint32_t CalypsoCardSnapshot::C_SV_LOAD_LOG = 136;
+const uint32_t CalypsoCardSnapshot::C_SV_DEBIT_LOG = 144;
+const uint32_t CalypsoCardSnapshot::C_DIR_ACCESS_CONDITIONS = 152;
+const uint32_t CalypsoCardSnapshot::C_DIR_KEY_INDEXES = 160;
+
+const uint32_t CalypsoCardSnapshot::CF_EXTENDED_MODE = 1 << 0;
+const uint32_t CalypsoCardSnapshot::CF_RATIFICATION_ON_DESELECT = 1 << 1;
+const uint32_t CalypsoCardSnapshot::CF_SV_FEATURE = 1 << 2;
+const uint32_t CalypsoCardSnapshot::CF_PIN_FEATURE = 1 << 3;
+const uint32_t CalypsoCardSnapshot::CF_PKI_MODE = 1 << 4;
+const uint32_t CalypsoCardSnapshot::CF_DF_INVALIDATED = 1 << 5;
+const uint32_t CalypsoCardSnapshot::CF_MODIFICATION_COUNTER_IN_BYTES = 1 << 6;
+const uint32_t CalypsoCardSnapshot::CF_HCE = 1 << 7;
+const uint32_t CalypsoCardSnapshot::CF_COUNTER_VALUE_POSTPONED = 1 << 8;
+const uint32_t CalypsoCardSnapshot::CF_DF_RATIFIED_PRESENT = 1 << 9;
+const uint32_t CalypsoCardSnapshot::CF_DF_RATIFIED = 1 << 10;
+const uint32_t CalypsoCardSnapshot::CF_TRANSACTION_COUNTER_PRESENT = 1 << 11;
+const uint32_t CalypsoCardSnapshot::CF_PIN_ATTEMPT_COUNTER_PRESENT = 1 << 12;
+const uint32_t CalypsoCardSnapshot::CF_SV_BALANCE_PRESENT = 1 << 13;
+const uint32_t CalypsoCardSnapshot::CF_DIRECTORY_HEADER_PRESENT = 1 << 14;
+const uint32_t CalypsoCardSnapshot::CF_SELECT_APPLICATION_RESPONSE_PRESENT = 1 << 15;
+const uint32_t CalypsoCardSnapshot::CF_SV_LOAD_LOG_PRESENT = 1 << 16;
+const uint32_t CalypsoCardSnapshot::CF_SV_DEBIT_LOG_PRESENT = 1 << 17;
+
+const uint32_t CalypsoCardSnapshot::FILE_ENTRY_SIZE = 40;
+const uint32_t CalypsoCardSnapshot::F_SFI = 0;
+const uint32_t CalypsoCardSnapshot::F_FLAGS = 1;
+const uint32_t CalypsoCardSnapshot::F_LID = 2;
+const uint32_t CalypsoCardSnapshot::F_TYPE = 4;
+const uint32_t CalypsoCardSnapshot::F_DF_STATUS = 5;
+const uint32_t CalypsoCardSnapshot::F_SHARED_REFERENCE = 6;
+const uint32_t CalypsoCardSnapshot::F_RECORDS_NUMBER = 8;
+const uint32_t CalypsoCardSnapshot::F_RECORD_SIZE = 12;
+const uint32_t CalypsoCardSnapshot::F_ACCESS_CONDITIONS = 16;
+const uint32_t CalypsoCardSnapshot::F_KEY_INDEXES = 24;
+const uint32_t CalypsoCardSnapshot::F_FIRST_RECORD = 32;
+const uint32_t CalypsoCardSnapshot::F_RECORD_COUNT = 36;
+
+const uint8_t CalypsoCardSnapshot::FF_HEADER_PRESENT = 1 << 0;
+const uint8_t CalypsoCardSnapshot::FF_DF_STATUS_PRESENT = 1 << 1;
+const uint8_t CalypsoCardSnapshot::FF_SHARED_REFERENCE_PRESENT = 1 << 2;
+
+const uint32_t CalypsoCardSnapshot::RECORD_ENTRY_SIZE = 12;
+const uint32_t CalypsoCardSnapshot::R_NUMBER = 0;
+const uint32_t CalypsoCardSnapshot::R_DATA = 4;
+
+const std::vector<uint8_t> CalypsoCardSnapshot::write(
+    const std::shared_ptr<CalypsoCardAdapter> card)
+{
+    Assert::getInstance().notNull(card, "card");
+
+    const std::vector<std::shared_ptr<ElementaryFile>>& files = card->mFiles;
+
+    uint32_t recordCount = 0;
+    for (const auto& ef : files) {
+        recordCount += static_cast<uint32_t>(ef->getData()->getAllRecordsContent().size());
+    }
+
+    const uint32_t cardOffset = HEADER_SIZE;
+    const uint32_t fileTableOffset = cardOffset + CARD_SECTION_SIZE;
+    const uint32_t recordTableOffset =
+        fileTableOffset + static_cast<uint32_t>(files.size()) * FILE_ENTRY_SIZE;
+
+    Writer writer(recordTableOffset + recordCount * RECORD_ENTRY_SIZE);
+
+    /* Header */
+    writer.putU32(H_MAGIC, MAGIC);
+    writer.putU16(H_VERSION, VERSION);
+    writer.putU32(H_CARD_OFFSET, cardOffset);
+    writer.putU32(H_FILE_TABLE_OFFSET, fileTableOffset);
+    writer.putU32(H_FILE_COUNT, static_cast<uint32_t>(files.size()));
+    writer.putU32(H_RECORD_TABLE_OFFSET, recordTableOffset);
+    writer.putU32(H_RECORD_COUNT, recordCount);
+
+    /* Card section */
+    uint32_t flags = 0;
+    flags |= card->mIsExtendedModeSupported ? CF_EXTENDED_MODE : 0;
+    flags |= card->mIsRatificationOnDeselectSupported ? CF_RATIFICATION_ON_DESELECT : 0;
+    flags |= card->mIsSvFeatureAvailable ? CF_SV_FEATURE : 0;
+    flags |= card->mIsPinFeatureAvailable ? CF_PIN_FEATURE : 0;
+    flags |= card->mIsPkiModeSupported ? CF_PKI_MODE : 0;
+    flags |= card->mIsDfInvalidated ? CF_DF_INVALIDATED : 0;
+    flags |= card->mIsModificationCounterInBytes ? CF_MODIFICATION_COUNTER_IN_BYTES : 0;
+    flags |= card->mIsHce ? CF_HCE : 0;
+    flags |= card->mIsCounterValuePostponed ? CF_COUNTER_VALUE_POSTPONED : 0;
+    flags |= card->mIsDfRatified.isPresent() ? CF_DF_RATIFIED_PRESENT : 0;
+    flags |= card->mIsDfRatified.orElse(false) ? CF_DF_RATIFIED : 0;
+    flags |= card->mTransactionCounter.isPresent() ? CF_TRANSACTION_COUNTER_PRESENT : 0;
+    flags |= card->mPinAttemptCounter.isPresent() ? CF_PIN_ATTEMPT_COUNTER_PRESENT : 0;
+    flags |= card->mSvBalance.isPresent() ? CF_SV_BALANCE_PRESENT : 0;
+    flags |= card->mDirectoryHeader != nullptr ? CF_DIRECTORY_HEADER_PRESENT : 0;
+    flags |= card->mSelectApplicationResponse != nullptr ?
+                 CF_SELECT_APPLICATION_RESPONSE_PRESENT : 0;
+    flags |= card->mSvLoadLogRecord != nullptr ? CF_SV_LOAD_LOG_PRESENT : 0;
+    flags |= card->mSvDebitLogRecord != nullptr ? CF_SV_DEBIT_LOG_PRESENT : 0;
+
+    writer.putU32(cardOffset + C_FLAGS, flags);
+    writer.putU8(cardOffset + C_CARD_CLASS, card->mCalypsoCardClass.getValue());
+    writer.putU8(cardOffset + C_PRODUCT_TYPE, static_cast<uint8_t>(card->mProductType));
+    writer.putU8(cardOffset + C_APPLICATION_TYPE, card->mApplicationType);
+    writer.putU8(cardOffset + C_APPLICATION_SUBTYPE, card->mApplicationSubType);
+    writer.putU8(cardOffset + C_SESSION_MODIFICATION, card->mSessionModification);
+    writer.putU8(cardOffset + C_SV_KVC, card->mSvKvc);
+    writer.putU32(cardOffset + C_MODIFICATIONS_COUNTER_MAX, card->mModificationsCounterMax);
+    writer.putU32(cardOffset + C_PAYLOAD_CAPACITY, card->mPayloadCapacity);
+    writer.putU32(cardOffset + C_TRANSACTION_COUNTER, card->mTransactionCounter.orElse(0));
+    writer.putU32(cardOffset + C_PIN_ATTEMPT_COUNTER, card->mPinAttemptCounter.orElse(0));
+    writer.putU32(cardOffset + C_SV_BALANCE, card->mSvBalance.orElse(0));
+    writer.putU32(cardOffset + C_SV_LAST_TNUM, card->mSvLastTNum);
+
+    writer.putBytes(cardOffset + C_POWER_ON_DATA,
+                    reinterpret_cast<const uint8_t*>(card->mPowerOnData.data()),
+                    card->mPowerOnData.size());
+    writer.putBytes(cardOffset + C_SELECT_APPLICATION_RESPONSE,
+                    card->getSelectApplicationResponse());
+    writer.putBytes(cardOffset + C_CALYPSO_SERIAL_NUMBER, card->mCalypsoSerialNumber);
+    writer.putBytes(cardOffset + C_STARTUP_INFO, card->mStartupInfo);
+    writer.putBytes(cardOffset + C_DF_NAME, card->mDfName);
+    writer.putBytes(cardOffset + C_CARD_CHALLENGE, card->mCardChallenge);
+    writer.putBytes(cardOffset + C_TRACEABILITY_INFORMATION, card->mTraceabilityInformation);
+    writer.putBytes(cardOffset + C_SV_GET_HEADER, card->mSvGetHeader);
+    writer.putBytes(cardOffset + C_SV_GET_DATA, card->mSvGetData);
+    writer.putBytes(cardOffset + C_SV_OPERATION_SIGNATURE, card->mSvOperationSignature);
+
+    if (card->mSvLoadLogRecord != nullptr) {
+        const auto log = std::dynamic_pointer_cast<SvLoadLogRecordAdapter>(card->mSvLoadLogRecord);
+        writer.putU32(cardOffset + C_SV_LOAD_LOG_OFFSET, log->getOffset());
+        writer.putBytes(cardOffset + C_SV_LOAD_LOG, log->getRawData());
+    }
+
+    if (card->mSvDebitLogRecord != nullptr) {
+        const auto log =
+            std::dynamic_pointer_cast<SvDebitLogRecordAdapter>(card->mSvDebitLogRecord);
+        writer.putU32(cardOffset + C_SV_DEBIT_LOG_OFFSET, log->getOffset());
+        writer.putBytes(cardOffset + C_SV_DEBIT_LOG, log->getRawData());
+    }
+
+    if (card->mDirectoryHeader != nullptr) {
+        const auto& header = card->mDirectoryHeader;
+        writer.putU16(cardOffset + C_DIR_LID, header->getLid());
+        writer.putU8(cardOffset + C_DIR_DF_STATUS, header->getDfStatus());
+        writer.putU8(cardOffset + C_DIR_KIFS, header->getKif(WriteAccessLevel::PERSONALIZATION));
+        writer.putU8(cardOffset + C_DIR_KIFS + 1, header->getKif(WriteAccessLevel::LOAD));
+        writer.putU8(cardOffset + C_DIR_KIFS + 2, header->getKif(WriteAccessLevel::DEBIT));
+        writer.putU8(cardOffset + C_DIR_KVCS, header->getKvc(WriteAccessLevel::PERSONALIZATION));
+        writer.putU8(cardOffset + C_DIR_KVCS + 1, header->getKvc(WriteAccessLevel::LOAD));
+        writer.putU8(cardOffset + C_DIR_KVCS + 2, header->getKvc(WriteAccessLevel::DEBIT));
+        writer.putBytes(cardOffset + C_DIR_ACCESS_CONDITIONS, header->getAccessConditions());
+        writer.putBytes(cardOffset + C_DIR_KEY_INDEXES, header->getKeyIndexes());
+    }
+
+    /* File and record tables */
+    uint32_t fileEntryOffset = fileTableOffset;
+    uint32_t recordIndex = 0;
+
+    for (const auto& ef : files) {
+
+        writer.putU8(fileEntryOffset + F_SFI, ef->getSfi());
+
+        const std::shared_ptr<FileHeader> header = ef->getHeader();
+        if (header != nullptr) {
+
+            uint8_t fileFlags = FF_HEADER_PRESENT;
+
+            if (header->getDfStatus() != nullptr) {
+                fileFlags |= FF_DF_STATUS_PRESENT;
+                writer.putU8(fileEntryOffset + F_DF_STATUS, *header->getDfStatus());
+            }
+
+            if (header->getSharedReference() != nullptr) {
+                fileFlags |= FF_SHARED_REFERENCE_PRESENT;
+                writer.putU16(fileEntryOffset + F_SHARED_REFERENCE, *header->getSharedReference());
+            }
+
+            writer.putU8(fileEntryOffset + F_FLAGS, fileFlags);
+            writer.putU16(fileEntryOffset + F_LID, header->getLid());
+            writer.putU8(fileEntryOffset + F_TYPE, static_cast<uint8_t>(header->getEfType()));
+            writer.putU32(fileEntryOffset + F_RECORDS_NUMBER, header->getRecordsNumber());
+            writer.putU32(fileEntryOffset + F_RECORD_SIZE, header->getRecordSize());
+            writer.putBytes(fileEntryOffset + F_ACCESS_CONDITIONS, header->getAccessConditions());
+            writer.putBytes(fileEntryOffset + F_KEY_INDEXES, header->getKeyIndexes());
+        }
+
+        const auto& records = ef->getData()->getAllRecordsContent();
+        writer.putU32(fileEntryOffset + F_FIRST_RECORD, recordIndex);
+        writer.putU32(fileEntryOffset + F_RECORD_COUNT, static_cast<uint32_t>(records.size()));
+
+        for (const auto& record : records) {
+
+            const uint32_t recordEntryOffset = recordTableOffset + recordIndex * RECORD_ENTRY_SIZE;
+            writer.putU8(recordEntryOffset + R_NUMBER, record.first);
+            writer.putBytes(recordEntryOffset + R_DATA, record.second);
+            recordIndex++;
+        }
+
+        fileEntryOffset += FILE_ENTRY_SIZE;
+    }
+
+    writer.putU32(H_SIZE, static_cast<uint32_t>(writer.getBuffer().size()));
+
+    return writer.getBuffer();
+}
+
+CalypsoCardSnapshot::CalypsoCardSnapshot(const uint8_t* data, const size_t size)
+: mData(data), mSize(0)
+{
+    if (data == nullptr) {
+        throw IllegalArgumentException("data is null.");
+    }
+
+    if (size < HEADER_SIZE || getU32(H_MAGIC) != MAGIC) {
+        throw IllegalArgumentException("Not a card snapshot.");
+    }
+
+    if (getU16(H_VERSION) != VERSION) {
+        throw IllegalArgumentException("Unsupported card snapshot version: " +
+                                       std::to_string(getU16(H_VERSION)));
+    }
+
+    const uint64_t totalSize = getU32(H_SIZE);
+    const uint64_t fileTableEnd = static_cast<uint64_t>(getU32(H_FILE_TABLE_OFFSET)) +
+                                  static_cast<uint64_t>(getU32(H_FILE_COUNT)) * FILE_ENTRY_SIZE;
+    const uint64_t recordTableEnd =
+        static_cast<uint64_t>(getU32(H_RECORD_TABLE_OFFSET)) +
+        static_cast<uint64_t>(getU32(H_RECORD_COUNT)) * RECORD_ENTRY_SIZE;
+
+    if (totalSize > size ||
+        static_cast<uint64_t>(getU32(H_CARD_OFFSET)) + CARD_SECTION_SIZE > totalSize ||
+        fileTableEnd > totalSize ||
+        recordTableEnd > totalSize) {
+        throw IllegalArgumentException("Corrupted card snapshot.");
+    }
+
+    mSize = static_cast<uint32_t>(totalSize);
+}
+
+uint16_t CalypsoCardSnapshot::getVersion() const
+{
+    return getU16(H_VERSION);
+}
+
+uint32_t CalypsoCardSnapshot::getSize() const
+{
+    return mSize;
+}
+
+const CalypsoCardSnapshot::Bytes CalypsoCardSnapshot::getDfName() const
+{
+    return getBytes(getU32(H_CARD_OFFSET) + C_DF_NAME);
+}
+
+const CalypsoCardSnapshot::Bytes CalypsoCardSnapshot::getCalypsoSerialNumberFull() const
+{
+    return getBytes(getU32(H_CARD_OFFSET) + C_CALYPSO_SERIAL_NUMBER);
+}
+
+const CalypsoCardSnapshot::Bytes CalypsoCardSnapshot::getStartupInfoRawData() const
+{
+    return getBytes(getU32(H_CARD_OFFSET) + C_STARTUP_INFO);
+}
+
+Optional<int> CalypsoCardSnapshot::getTransactionCounter() const
+{
+    if (!isCardFlagSet(CF_TRANSACTION_COUNTER_PRESENT)) {
+        return Optional<int>::empty();
+    }
+
+    return static_cast<int>(getU32(getU32(H_CARD_OFFSET) + C_TRANSACTION_COUNTER));
+}
+
+Optional<int> CalypsoCardSnapshot::getSvBalance() const
+{
+    if (!isCardFlagSet(CF_SV_BALANCE_PRESENT)) {
+        return Optional<int>::empty();
+    }
+
+    return static_cast<int>(getU32(getU32(H_CARD_OFFSET) + C_SV_BALANCE));
+}
+
+uint32_t CalypsoCardSnapshot::getFileCount() const
+{
+    return getU32(H_FILE_COUNT);
+}
+
+const CalypsoCardSnapshot::Bytes CalypsoCardSnapshot::getRecord(const uint8_t sfi,
+                                                                const uint8_t numRecord) const
+{
+    for (uint32_t i = 0; i < getFileCount(); i++) {
+
+        const uint32_t fileEntryOffset = getFileEntryOffset(i);
+        if (sfi == 0 || getU8(fileEntryOffset + F_SFI) != sfi) {
+            continue;
+        }
+
+        const uint32_t firstRecord = getU32(fileEntryOffset + F_FIRST_RECORD);
+        const uint32_t recordCount = getU32(fileEntryOffset + F_RECORD_COUNT);
+
+        for (uint32_t j = 0; j < recordCount; j++) {
+
+            const uint32_t recordEntryOffset = getRecordEntryOffset(firstRecord + j);
+            if (getU8(recordEntryOffset + R_NUMBER) == numRecord) {
+                return getBytes(recordEntryOffset + R_DATA);
+            }
+        }
+
+        break;
+    }
+
+    return Bytes(nullptr, 0);
+}
+
+const std::shared_ptr<CalypsoCardAdapter> CalypsoCardSnapshot::restore() const
+{
+    const uint32_t cardOffset = getU32(H_CARD_OFFSET);
+    auto card = std::make_shared<CalypsoCardAdapter>();
+
+    /* Selection data */
+    const Bytes powerOnData = getBytes(cardOffset + C_POWER_ON_DATA);
+    card->mPowerOnData = std::string(reinterpret_cast<const char*>(powerOnData.data()),
+                                     powerOnData.size());
+
+    if (isCardFlagSet(CF_SELECT_APPLICATION_RESPONSE_PRESENT)) {
+        card->mSelectApplicationResponse = std::make_shared<LocalApduResponseAdapter>(
+            getBytes(cardOffset + C_SELECT_APPLICATION_RESPONSE).toVector());
+    }
+
+    card->mIsExtendedModeSupported = isCardFlagSet(CF_EXTENDED_MODE);
+    card->mIsRatificationOnDeselectSupported = isCardFlagSet(CF_RATIFICATION_ON_DESELECT);
+    card->mIsSvFeatureAvailable = isCardFlagSet(CF_SV_FEATURE);
+    card->mIsPinFeatureAvailable = isCardFlagSet(CF_PIN_FEATURE);
+    card->mIsPkiModeSupported = isCardFlagSet(CF_PKI_MODE);
+    card->mIsDfInvalidated = isCardFlagSet(CF_DF_INVALIDATED);
+    card->mIsModificationCounterInBytes = isCardFlagSet(CF_MODIFICATION_COUNTER_IN_BYTES);
+    card->mIsHce = isCardFlagSet(CF_HCE);
+    card->mIsCounterValuePostponed = isCardFlagSet(CF_COUNTER_VALUE_POSTPONED);
+
+    const uint8_t cardClass = getU8(cardOffset + C_CARD_CLASS);
+    if (cardClass == CalypsoCardClass::LEGACY.getValue()) {
+        card->mCalypsoCardClass = CalypsoCardClass::LEGACY;
+    } else if (cardClass == CalypsoCardClass::LEGACY_STORED_VALUE.getValue()) {
+        card->mCalypsoCardClass = CalypsoCardClass::LEGACY_STORED_VALUE;
+    } else if (cardClass == CalypsoCardClass::ISO.getValue()) {
+        card->mCalypsoCardClass = CalypsoCardClass::ISO;
+    } else {
+        card->mCalypsoCardClass = CalypsoCardClass::UNKNOWN;
+    }
+
+    card->mProductType =
+        static_cast<CalypsoCard::ProductType>(getU8(cardOffset + C_PRODUCT_TYPE));
+    card->mApplicationType = getU8(cardOffset + C_APPLICATION_TYPE);
+    card->mApplicationSubType = getU8(cardOffset + C_APPLICATION_SUBTYPE);
+    card->mSessionModification = getU8(cardOffset + C_SESSION_MODIFICATION);
+    card->mModificationsCounterMax =
+        static_cast<int>(getU32(cardOffset + C_MODIFICATIONS_COUNTER_MAX));
+    card->mPayloadCapacity = static_cast<int>(getU32(cardOffset + C_PAYLOAD_CAPACITY));
+    card->mCalypsoSerialNumber = getBytes(cardOffset + C_CALYPSO_SERIAL_NUMBER).toVector();
+    card->mStartupInfo = getBytes(cardOffset + C_STARTUP_INFO).toVector();
+    card->mDfName = getBytes(cardOffset + C_DF_NAME).toVector();
+    card->mCardChallenge = getBytes(cardOffset + C_CARD_CHALLENGE).toVector();
+    card->mTraceabilityInformation = getBytes(cardOffset + C_TRACEABILITY_INFORMATION).toVector();
+
+    /* Session and PIN data */
+    if (isCardFlagSet(CF_DF_RATIFIED_PRESENT)) {
+        card->mIsDfRatified = isCardFlagSet(CF_DF_RATIFIED);
+    }
+
+    card->mTransactionCounter = getTransactionCounter();
+
+    if (isCardFlagSet(CF_PIN_ATTEMPT_COUNTER_PRESENT)) {
+        card->mPinAttemptCounter = static_cast<int>(getU32(cardOffset + C_PIN_ATTEMPT_COUNTER));
+    }
+
+    /* SV data */
+    card->mSvKvc = getU8(cardOffset + C_SV_KVC);
+    card->mSvGetHeader = getBytes(cardOffset + C_SV_GET_HEADER).toVector();
+    card->mSvGetData = getBytes(cardOffset + C_SV_GET_DATA).toVector();
+    card->mSvOperationSignature = getBytes(cardOffset + C_SV_OPERATION_SIGNATURE).toVector();
+    card->mSvBalance = getSvBalance();
+    card->mSvLastTNum = static_cast<int>(getU32(cardOffset + C_SV_LAST_TNUM));
+
+    if (isCardFlagSet(CF_SV_LOAD_LOG_PRESENT)) {
+        card->mSvLoadLogRecord = std::make_shared<SvLoadLogRecordAdapter>(
+            getBytes(cardOffset + C_SV_LOAD_LOG).toVector(),
+            static_cast<int>(getU32(cardOffset + C_SV_LOAD_LOG_OFFSET)));
+    }
+
+    if (isCardFlagSet(CF_SV_DEBIT_LOG_PRESENT)) {
+        card->mSvDebitLogRecord = std::make_shared<SvDebitLogRecordAdapter>(
+            getBytes(cardOffset + C_SV_DEBIT_LOG).toVector(),
+            static_cast<int>(getU32(cardOffset + C_SV_DEBIT_LOG_OFFSET)));
+    }
+
+    /* Directory header */
+    if (isCardFlagSet(CF_DIRECTORY_HEADER_PRESENT)) {
+        card->mDirectoryHeader =
+            DirectoryHeaderAdapter::builder()
+                ->lid(getU16(cardOffset + C_DIR_LID))
+                .accessConditions(getBytes(cardOffset + C_DIR_ACCESS_CONDITIONS).toVector())
+                .keyIndexes(getBytes(cardOffset + C_DIR_KEY_INDEXES).toVector())
+                .dfStatus(getU8(cardOffset + C_DIR_DF_STATUS))
+                .kif(WriteAccessLevel::PERSONALIZATION, getU8(cardOffset + C_DIR_KIFS))
+                .kif(WriteAccessLevel::LOAD, getU8(cardOffset + C_DIR_KIFS + 1))
+                .kif(WriteAccessLevel::DEBIT, getU8(cardOffset + C_DIR_KIFS + 2))
+                .kvc(WriteAccessLevel::PERSONALIZATION, getU8(cardOffset + C_DIR_KVCS))
+                .kvc(WriteAccessLevel::LOAD, getU8(cardOffset + C_DIR_KVCS + 1))
+                .kvc(WriteAccessLevel::DEBIT, getU8(cardOffset + C_DIR_KVCS + 2))
+                .build();
+    }
+
+    restoreFiles(card);
+
+    return card;
+}
+
+void CalypsoCardSnapshot::restoreFiles(const std::shared_ptr<CalypsoCardAdapter> card) const
+{
+    for (uint32_t i = 0; i < getFileCount(); i++) {
+
+        const uint32_t fileEntryOffset = getFileEntryOffset(i);
+        const uint8_t fileFlags = getU8(fileEntryOffset + F_FLAGS);
+        auto ef = std::make_shared<ElementaryFileAdapter>(getU8(fileEntryOffset + F_SFI));
+
+        if (fileFlags & FF_HEADER_PRESENT) {
+
+            auto builder = FileHeaderAdapter::builder()
+                               ->lid(getU16(fileEntryOffset + F_LID))
+                               .recordsNumber(static_cast<int>(
+                                   getU32(fileEntryOffset + F_RECORDS_NUMBER)))
+                               .recordSize(static_cast<int>(
+                                   getU32(fileEntryOffset + F_RECORD_SIZE)))
+                               .type(static_cast<ElementaryFile::Type>(
+                                   getU8(fileEntryOffset + F_TYPE)))
+                               .accessConditions(
+                                   getBytes(fileEntryOffset + F_ACCESS_CONDITIONS).toVector())
+                               .keyIndexes(getBytes(fileEntryOffset + F_KEY_INDEXES).toVector());
+
+            if (fileFlags & FF_DF_STATUS_PRESENT) {
+                builder = builder.dfStatus(getU8(fileEntryOffset + F_DF_STATUS));
+            }
+
+            if (fileFlags & FF_SHARED_REFERENCE_PRESENT) {
+                builder = builder.sharedReference(getU16(fileEntryOffset + F_SHARED_REFERENCE));
+            }
+
+            ef->setHeader(builder.build());
+        }
+
+        const auto data = std::dynamic_pointer_cast<FileDataAdapter>(ef->getData());
+        const uint32_t firstRecord = getU32(fileEntryOffset + F_FIRST_RECORD);
+        const uint32_t recordCount = getU32(fileEntryOffset + F_RECORD_COUNT);
+
+        for (uint32_t j = 0; j < recordCount; j++) {
+
+            const uint32_t recordEntryOffset = getRecordEntryOffset(firstRecord + j);
+            data->setContent(getU8(recordEntryOffset + R_NUMBER),
+                             getBytes(recordEntryOffset + R_DATA).toVector());
+        }
+
+        card->mFiles.push_back(ef);
+    }
+}
+
+uint8_t CalypsoCardSnapshot::getU8(const uint32_t offset) const
+{
+    return mData[offset];
+}
+
+uint16_t CalypsoCardSnapshot::getU16(const uint32_t offset) const
+{
+    return static_cast<uint16_t>(mData[offset] | (mData[offset + 1] << 8));
+}
+
+uint32_t CalypsoCardSnapshot::getU32(const uint32_t offset) const
+{
+    return static_cast<uint32_t>(mData[offset]) |
+           (static_cast<uint32_t>(mData[offset + 1]) << 8) |
+           (static_cast<uint32_t>(mData[offset + 2]) << 16) |
+           (static_cast<uint32_t>(mData[offset + 3]) << 24);
+}
+
+const CalypsoCardSnapshot::Bytes CalypsoCardSnapshot::getBytes(const uint32_t offset) const
+{
+    const uint32_t dataOffset = getU32(offset);
+    const uint32_t length = getU32(offset + 4);
+
+    if (length == 0) {
+        return Bytes(nullptr, 0);
+    }
+
+    if (dataOffset > mSize || length > mSize - dataOffset) {
+        throw IllegalArgumentException("Corrupted card snapshot.");
+    }
+
+    return Bytes(mData + dataOffset, length);
+}
+
+bool CalypsoCardSnapshot::isCardFlagSet(const uint32_t flag) const
+{
+    return (getU32(getU32(H_CARD_OFFSET) + C_FLAGS) & flag) != 0;
+}
+
+uint32_t CalypsoCardSnapshot::getFileEntryOffset(const uint32_t index) const
+{
+    return getU32(H_FILE_TABLE_OFFSET) + index * FILE_ENTRY_SIZE;
+}
+
+uint32_t CalypsoCardSnapshot::getRecordEntryOffset(const uint32_t index) const
+{
+    if (index >= getU32(H_RECORD_COUNT)) {
+        throw IllegalArgumentException("Corrupted card snapshot.");
+    }
+
+    return getU32(H_RECORD_TABLE_OFFSET) + index * RECORD_ENTRY_SIZE;
+}
+
+}
+}
+}
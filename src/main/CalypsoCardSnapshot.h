@@ -0,0 +1,439 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "KeypleCardCalypsoExport.h"
+#include "Optional.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+/**
+ * Versioned binary snapshot of a whole card image (FCI fields, directory header, file headers
+ * and records, SV state).
+ *
+ * <p>A snapshot is produced by {@link #write(const std::shared_ptr<CalypsoCardAdapter>)} as a
+ * single contiguous byte array that can be stored as is. It is read back through a
+ * CalypsoCardSnapshot instance built on top of the raw bytes (for example a memory-mapped file):
+ * the instance only checks the header and does not copy nor decode the content, each getter reads
+ * its value directly at a fixed offset. The card can also be fully restored with
+ * {@link #restore()}.
+ *
+ * <p>Layout (all integers are little-endian, all offsets are relative to the beginning of the
+ * snapshot):
+ *
+ * <ul>
+ *   <li>Header (32 bytes): magic "KCCS", version, total size, offsets and sizes of the sections.
+ *   <li>Card section (fixed size): flags, scalar fields and references to variable length data.
+ *   <li>File table: one fixed size entry per elementary file.
+ *   <li>Record table: one fixed size entry per record, grouped by file and sorted by record
+ *       number.
+ *   <li>Data area: variable length data referenced by (offset, length) pairs.
+ * </ul>
+ *
+ * <p>The backup of the files made at the opening of a secure session and the transient session
+ * data are not part of the snapshot.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API CalypsoCardSnapshot final {
+public:
+    /**
+     * Current version of the snapshot format.
+     *
+     * @since 2.2.5.6
+     */
+    static const uint16_t VERSION;
+
+    /**
+     * Read-only view on a byte sequence of the snapshot.
+     *
+     * @since 2.2.5.6
+     */
+    class Bytes final {
+    public:
+        /**
+         * Creates a view.
+         *
+         * @param data The first byte (may be null if length is 0).
+         * @param length The number of bytes.
+         * @since 2.2.5.6
+         */
+        Bytes(const uint8_t* data, const uint32_t length);
+
+        /**
+         * Gets the first byte.
+         *
+         * @return Null if empty.
+         * @since 2.2.5.6
+         */
+        const uint8_t* data() const;
+
+        /**
+         * Gets the number of bytes.
+         *
+         * @return A positive or zero int.
+         * @since 2.2.5.6
+         */
+        uint32_t size() const;
+
+        /**
+         * Copies the bytes.
+         *
+         * @return A new vector.
+         * @since 2.2.5.6
+         */
+        const std::vector<uint8_t> toVector() const;
+
+    private:
+        /**
+         *
+         */
+        const uint8_t* const mData;
+
+        /**
+         *
+         */
+        const uint32_t mLength;
+    };
+
+    /**
+     * Serializes a card image.
+     *
+     * @param card The card.
+     * @return A not empty byte array.
+     * @throw IllegalArgumentException If the card is null.
+     * @since 2.2.5.6
+     */
+    static const std::vector<uint8_t> write(const std::shared_ptr<CalypsoCardAdapter> card);
+
+    /**
+     * Creates a snapshot view on raw bytes, which must remain available during the whole life of
+     * the instance.
+     *
+     * <p>Only the header is checked, the references to variable length data are checked when they
+     * are accessed.
+     *
+     * @param data The raw bytes (e.g. the address of a memory-mapped file).
+     * @param size The number of available bytes.
+     * @throw IllegalArgumentException If data is null or if the header is not valid.
+     * @since 2.2.5.6
+     */
+    CalypsoCardSnapshot(const uint8_t* data, const size_t size);
+
+    /**
+     * Gets the version of the snapshot format.
+     *
+     * @return The version.
+     * @since 2.2.5.6
+     */
+    uint16_t getVersion() const;
+
+    /**
+     * Gets the total size of the snapshot.
+     *
+     * @return A positive int.
+     * @since 2.2.5.6
+     */
+    uint32_t getSize() const;
+
+    /**
+     * Gets the DF name.
+     *
+     * @return An empty view if the card was selected from its power-on data.
+     * @throw IllegalArgumentException If the snapshot is corrupted.
+     * @since 2.2.5.6
+     */
+    const Bytes getDfName() const;
+
+    /**
+     * Gets the full Calypso serial number.
+     *
+     * @return A view.
+     * @throw IllegalArgumentException If the snapshot is corrupted.
+     * @since 2.2.5.6
+     */
+    const Bytes getCalypsoSerialNumberFull() const;
+
+    /**
+     * Gets the startup info.
+     *
+     * @return A view.
+     * @throw IllegalArgumentException If the snapshot is corrupted.
+     * @since 2.2.5.6
+     */
+    const Bytes getStartupInfoRawData() const;
+
+    /**
+     * Gets the transaction counter.
+     *
+     * @return An empty optional if the counter was unknown.
+     * @since 2.2.5.6
+     */
+    Optional<int> getTransactionCounter() const;
+
+    /**
+     * Gets the SV balance.
+     *
+     * @return An empty optional if no SV Get command had been executed.
+     * @since 2.2.5.6
+     */
+    Optional<int> getSvBalance() const;
+
+    /**
+     * Gets the number of elementary files.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    uint32_t getFileCount() const;
+
+    /**
+     * Gets the content of a record.
+     *
+     * @param sfi The SFI of the file.
+     * @param numRecord The record number.
+     * @return An empty view if the record is not part of the snapshot.
+     * @throw IllegalArgumentException If the snapshot is corrupted.
+     * @since 2.2.5.6
+     */
+    const Bytes getRecord(const uint8_t sfi, const uint8_t numRecord) const;
+
+    /**
+     * Rebuilds the card image.
+     *
+     * @return A new card.
+     * @throw IllegalArgumentException If the snapshot is corrupted.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CalypsoCardAdapter> restore() const;
+
+private:
+    /**
+     * (private)<br>
+     * Builds a snapshot in memory.
+     */
+    class Writer final {
+    public:
+        /**
+         *
+         */
+        Writer(const uint32_t dataOffset);
+
+        /**
+         *
+         */
+        void putU8(const uint32_t offset, const uint8_t value);
+
+        /**
+         *
+         */
+        void putU16(const uint32_t offset, const uint16_t value);
+
+        /**
+         *
+         */
+        void putU32(const uint32_t offset, const uint32_t value);
+
+        /**
+         * Appends data to the data area and writes its reference at the provided offset.
+         */
+        void putBytes(const uint32_t offset, const uint8_t* data, const size_t length);
+
+        /**
+         *
+         */
+        void putBytes(const uint32_t offset, const std::vector<uint8_t>& data);
+
+        /**
+         *
+         */
+        std::vector<uint8_t>& getBuffer();
+
+    private:
+        /**
+         *
+         */
+        std::vector<uint8_t> mBuffer;
+    };
+
+    /**
+     * Magic number ("KCCS" read as a little-endian integer).
+     */
+    static const uint32_t MAGIC;
+
+    /**
+     * Header layout.
+     */
+    static const uint32_t HEADER_SIZE;
+    static const uint32_t H_MAGIC;
+    static const uint32_t H_VERSION;
+    static const uint32_t H_SIZE;
+    static const uint32_t H_CARD_OFFSET;
+    static const uint32_t H_FILE_TABLE_OFFSET;
+    static const uint32_t H_FILE_COUNT;
+    static const uint32_t H_RECORD_TABLE_OFFSET;
+    static const uint32_t H_RECORD_COUNT;
+
+    /**
+     * Card section layout.
+     */
+    static const uint32_t CARD_SECTION_SIZE;
+    static const uint32_t C_FLAGS;
+    static const uint32_t C_CARD_CLASS;
+    static const uint32_t C_PRODUCT_TYPE;
+    static const uint32_t C_APPLICATION_TYPE;
+    static const uint32_t C_APPLICATION_SUBTYPE;
+    static const uint32_t C_SESSION_MODIFICATION;
+    static const uint32_t C_SV_KVC;
+    static const uint32_t C_MODIFICATIONS_COUNTER_MAX;
+    static const uint32_t C_PAYLOAD_CAPACITY;
+    static const uint32_t C_TRANSACTION_COUNTER;
+    static const uint32_t C_PIN_ATTEMPT_COUNTER;
+    static const uint32_t C_SV_BALANCE;
+    static const uint32_t C_SV_LAST_TNUM;
+    static const uint32_t C_SV_LOAD_LOG_OFFSET;
+    static const uint32_t C_SV_DEBIT_LOG_OFFSET;
+    static const uint32_t C_DIR_LID;
+    static const uint32_t C_DIR_DF_STATUS;
+    static const uint32_t C_DIR_KIFS;
+    static const uint32_t C_DIR_KVCS;
+    static const uint32_t C_POWER_ON_DATA;
+    static const uint32_t C_SELECT_APPLICATION_RESPONSE;
+    static const uint32_t C_CALYPSO_SERIAL_NUMBER;
+    static const uint32_t C_STARTUP_INFO;
+    static const uint32_t C_DF_NAME;
+    static const uint32_t C_CARD_CHALLENGE;
+    static const uint32_t C_TRACEABILITY_INFORMATION;
+    static const uint32_t C_SV_GET_HEADER;
+    static const uint32_t C_SV_GET_DATA;
+    static const uint32_t C_SV_OPERATION_SIGNATURE;
+    static const uint32_t C_SV_LOAD_LOG;
+    static const uint32_t C_SV_DEBIT_LOG;
+    static const uint32_t C_DIR_ACCESS_CONDITIONS;
+    static const uint32_t C_DIR_KEY_INDEXES;
+
+    /**
+     * Card section flags.
+     */
+    static const uint32_t CF_EXTENDED_MODE;
+    static const uint32_t CF_RATIFICATION_ON_DESELECT;
+    static const uint32_t CF_SV_FEATURE;
+    static const uint32_t CF_PIN_FEATURE;
+    static const uint32_t CF_PKI_MODE;
+    static const uint32_t CF_DF_INVALIDATED;
+    static const uint32_t CF_MODIFICATION_COUNTER_IN_BYTES;
+    static const uint32_t CF_HCE;
+    static const uint32_t CF_COUNTER_VALUE_POSTPONED;
+    static const uint32_t CF_DF_RATIFIED_PRESENT;
+    static const uint32_t CF_DF_RATIFIED;
+    static const uint32_t CF_TRANSACTION_COUNTER_PRESENT;
+    static const uint32_t CF_PIN_ATTEMPT_COUNTER_PRESENT;
+    static const uint32_t CF_SV_BALANCE_PRESENT;
+    static const uint32_t CF_DIRECTORY_HEADER_PRESENT;
+    static const uint32_t CF_SELECT_APPLICATION_RESPONSE_PRESENT;
+    static const uint32_t CF_SV_LOAD_LOG_PRESENT;
+    static const uint32_t CF_SV_DEBIT_LOG_PRESENT;
+
+    /**
+     * File table entry layout and flags.
+     */
+    static const uint32_t FILE_ENTRY_SIZE;
+    static const uint32_t F_SFI;
+    static const uint32_t F_FLAGS;
+    static const uint32_t F_LID;
+    static const uint32_t F_TYPE;
+    static const uint32_t F_DF_STATUS;
+    static const uint32_t F_SHARED_REFERENCE;
+    static const uint32_t F_RECORDS_NUMBER;
+    static const uint32_t F_RECORD_SIZE;
+    static const uint32_t F_ACCESS_CONDITIONS;
+    static const uint32_t F_KEY_INDEXES;
+    static const uint32_t F_FIRST_RECORD;
+    static const uint32_t F_RECORD_COUNT;
+    static const uint8_t FF_HEADER_PRESENT;
+    static const uint8_t FF_DF_STATUS_PRESENT;
+    static const uint8_t FF_SHARED_REFERENCE_PRESENT;
+
+    /**
+     * Record table entry layout.
+     */
+    static const uint32_t RECORD_ENTRY_SIZE;
+    static const uint32_t R_NUMBER;
+    static const uint32_t R_DATA;
+
+    /**
+     *
+     */
+    const uint8_t* const mData;
+
+    /**
+     * Validated size of the snapshot.
+     */
+    uint32_t mSize;
+
+    /**
+     * (private)<br>
+     * Reads an unsigned integer at the provided offset, which must be in bounds.
+     */
+    uint8_t getU8(const uint32_t offset) const;
+    uint16_t getU16(const uint32_t offset) const;
+    uint32_t getU32(const uint32_t offset) const;
+
+    /**
+     * (private)<br>
+     * Gets the data referenced at the provided offset.
+     *
+     * @throw IllegalArgumentException If the reference is out of bounds.
+     */
+    const Bytes getBytes(const uint32_t offset) const;
+
+    /**
+     * (private)<br>
+     * Checks if a card flag is set.
+     */
+    bool isCardFlagSet(const uint32_t flag) const;
+
+    /**
+     * (private)<br>
+     * Gets the offset of the entry of a file in the file table.
+     */
+    uint32_t getFileEntryOffset(const uint32_t index) const;
+
+    /**
+     * (private)<br>
+     * Gets the offset of the entry of a record in the record table.
+     *
+     * @throw IllegalArgumentException If the index is out of bounds.
+     */
+    uint32_t getRecordEntryOffset(const uint32_t index) const;
+
+    /**
+     * (private)<br>
+     * Restores the headers and records of all files.
+     */
+    void restoreFiles(const std::shared_ptr<CalypsoCardAdapter> card) const;
+};
+
+}
+}
+}
@@ -12,19 +12,29 @@
 
 #include "CalypsoExtensionService.h"
 
+#include <chrono>
+
 /* Calypsonet Terminal Calypso */
+#include "CardIOException.h"
 #include "CardTransactionManagerAdapter.h"
+#include "ReaderIOException.h"
 
 /* Calypsonet Terminal Card */
 #include "CardApiProperties.h"
+#include "CardBrokenCommunicationException.h"
+#include "CardSelectorSpi.h"
+#include "ProxyReaderApi.h"
+#include "ReaderBrokenCommunicationException.h"
 
 /* Calypsonet Terminal Reader */
 #include "ReaderApiProperties.h"
 
 /* Keyple Card Calypso */
+#include "ApduRequestAdapter.h"
 #include "BasicSignatureComputationDataAdapter.h"
 #include "BasicSignatureVerificationDataAdapter.h"
 #include "CalypsoSamResourceProfileExtensionAdapter.h"
+#include "CardRequestAdapter.h"
 #include "CardSecuritySettingAdapter.h"
 #include "TraceableSignatureComputationDataAdapter.h"
 #include "TraceableSignatureVerificationDataAdapter.h"
@@ -33,6 +43,10 @@
 #include "CommonApiProperties.h"
 
 /* Keyple Core Util */
+#include "ApduUtil.h"
+#include "Arrays.h"
+#include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
 #include "KeypleAssert.h"
 
 namespace keyple {
@@ -41,9 +55,12 @@ namespace calypso {
 
 using namespace calypsonet::terminal::calypso;
 using namespace calypsonet::terminal::card;
+using namespace calypsonet::terminal::card::spi;
 using namespace calypsonet::terminal::reader;
 using namespace keyple::core::common;
 using namespace keyple::core::util;
+using namespace keyple::core::util::cpp;
+using namespace keyple::core::util::cpp::exception;
 
 std::shared_ptr<CalypsoExtensionService> CalypsoExtensionService::mInstance;
 
@@ -149,6 +166,127 @@ std::shared_ptr<CardTransactionManager>
     return createCardTransactionManagerAdapter(cardReader, calypsoCard, nullptr, false);
 }
 
+std::shared_ptr<CardTapResult> CalypsoExtensionService::processTap(
+        std::shared_ptr<CardReader> cardReader,
+        const std::shared_ptr<CalypsoCardSelection> cardSelection,
+        const std::shared_ptr<CardSecuritySetting> cardSecuritySetting,
+        const CardTransactionTemplate& readTemplate,
+        const WriteAccessLevel writeAccessLevel) const
+{
+    Assert::getInstance().notNull(cardReader, "card reader")
+                         .notNull(cardSelection, "card selection")
+                         .notNull(cardSecuritySetting, "card security setting");
+
+    if (readTemplate.getRecordDataCount() != 0 || readTemplate.getCounterValueCount() != 0) {
+        throw IllegalArgumentException("The provided 'readTemplate' must only contain reads");
+    }
+
+    const auto proxy = std::dynamic_pointer_cast<ProxyReaderApi>(cardReader);
+    if (!proxy) {
+        throw IllegalArgumentException("The provided 'cardReader' must implement 'ProxyReaderApi'");
+    }
+
+    const auto selection = std::dynamic_pointer_cast<CalypsoCardSelectionAdapter>(cardSelection);
+    if (!selection) {
+        throw IllegalArgumentException("The provided 'cardSelection' must be an instance of " \
+                                       "'CalypsoCardSelectionAdapter'");
+    }
+
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    const std::shared_ptr<CardSelectionRequestSpi> cardSelectionRequest =
+        selection->getCardSelectionRequest();
+    const std::shared_ptr<CardSelectorSpi> cardSelector = cardSelectionRequest->getCardSelector();
+
+    if (cardSelector->getAid().empty()) {
+        throw IllegalStateException("The card selection must filter by DF name.");
+    }
+
+    /* Build the "Select Application" command: P2 = file occurrence | file control information */
+    uint8_t p2 = 0x00;
+    switch (cardSelector->getFileOccurrence()) {
+    case CardSelectorSpi::FileOccurrence::FIRST:
+        p2 = 0x00;
+        break;
+    case CardSelectorSpi::FileOccurrence::LAST:
+        p2 = 0x01;
+        break;
+    case CardSelectorSpi::FileOccurrence::NEXT:
+        p2 = 0x02;
+        break;
+    case CardSelectorSpi::FileOccurrence::PREVIOUS:
+        p2 = 0x03;
+        break;
+    }
+
+    if (cardSelector->getFileControlInformation() ==
+            CardSelectorSpi::FileControlInformation::NO_RESPONSE) {
+        p2 |= 0x0C;
+    }
+
+    /* The commands prepared in the card selection follow the "Select Application" command */
+    std::vector<std::shared_ptr<ApduRequestSpi>> apduRequests = {
+        std::make_shared<ApduRequestAdapter>(
+            ApduUtil::build(0x00, 0xA4, 0x04, p2, cardSelector->getAid(), 0x00))
+    };
+
+    if (cardSelectionRequest->getCardRequest() != nullptr) {
+        const std::vector<std::shared_ptr<ApduRequestSpi>>& selectionApduRequests =
+            cardSelectionRequest->getCardRequest()->getApduRequests();
+        apduRequests.insert(apduRequests.end(),
+                            selectionApduRequests.begin(),
+                            selectionApduRequests.end());
+    }
+
+    std::shared_ptr<CardResponseApi> cardResponse;
+
+    try {
+        cardResponse =
+            proxy->transmitCardRequest(std::make_shared<CardRequestAdapter>(apduRequests, false),
+                                       ChannelControl::KEEP_OPEN);
+    } catch (const ReaderBrokenCommunicationException& e) {
+        throw ReaderIOException("A communication error with the card reader occurred while " \
+                                "selecting the card.",
+                                std::make_shared<ReaderBrokenCommunicationException>(e));
+    } catch (const CardBrokenCommunicationException& e) {
+        throw CardIOException("A communication error with the card occurred while selecting the " \
+                              "card.",
+                              std::make_shared<CardBrokenCommunicationException>(e));
+    }
+
+    const std::vector<std::shared_ptr<ApduResponseApi>>& apduResponses =
+        cardResponse->getApduResponses();
+
+    if (apduResponses.empty() ||
+        !Arrays::contains(cardSelector->getSuccessfulSelectionStatusWords(),
+                          apduResponses[0]->getStatusWord())) {
+        throw IllegalStateException("The card does not match the selection.");
+    }
+
+    /* Let the card selection parse the responses and create the card image */
+    const std::shared_ptr<CalypsoCardAdapter> calypsoCard =
+        selection->parse(apduResponses[0],
+                         "",
+                         std::vector<std::shared_ptr<ApduResponseApi>>(apduResponses.begin() + 1,
+                                                                       apduResponses.end()));
+
+    /* Open the secure session, reading the records of the template */
+    const std::shared_ptr<CardTransactionManagerAdapter> cardTransaction =
+        createCardTransactionManagerAdapter(cardReader, calypsoCard, cardSecuritySetting, true);
+
+    cardTransaction->prepareTemplate(readTemplate, {}, {});
+    cardTransaction->processOpening(writeAccessLevel);
+
+    const uint64_t latency =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTime).count();
+
+    return std::make_shared<CardTapResult>(calypsoCard,
+                                           cardTransaction,
+                                           1 + cardTransaction->getCardExchangeCount(),
+                                           latency);
+}
+
 std::shared_ptr<CardTransactionManagerAdapter>
     CalypsoExtensionService::createCardTransactionManagerAdapter(
         std::shared_ptr<CardReader> cardReader,
@@ -28,11 +28,14 @@
 #include "SamSecuritySetting.h"
 #include "SamTransactionManager.h"
 #include "SearchCommandData.h"
+#include "WriteAccessLevel.h"
 
 /* Keyple Card Calypso */
 #include "CalypsoCardSelectionAdapter.h"
 #include "CalypsoSamSelectionAdapter.h"
+#include "CardTapResult.h"
 #include "CardTransactionManagerAdapter.h"
+#include "CardTransactionTemplate.h"
 #include "KeypleCardCalypsoExport.h"
 #include "SamTransactionManagerAdapter.h"
 #include "SearchCommandDataAdapter.h"
@@ -226,6 +229,48 @@ public:
         std::shared_ptr<CardReader> cardReader,
         const std::shared_ptr<CalypsoCard> calypsoCard) const;
 
+    /**
+     * Processes the beginning of a validation in the fewest card exchanges: selection of the
+     * application, then opening of a secure session reading the records described by the
+     * provided template.
+     *
+     * <p>The "Select Application" command is built from the DF name of the card selection and is
+     * transmitted directly to the reader, together with the commands prepared in the card
+     * selection. The first record to read is read by the "Open Secure Session" command and the
+     * other ones are transmitted in the same card request. The tap thus only needs two card
+     * exchanges. The SAM challenge is still requested before the opening, unless it was
+     * prefetched at the closing of a previous session with the same card (see
+     * CardSecuritySettingAdapter::enableSamChallengePrefetch): the prefetched challenge is bound
+     * to the key diversifier, i.e. the serial number of the card.
+     *
+     * <p>The filters on the card protocol and on the power-on data of the card selection are not
+     * applied.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param cardReader The reader through which the card communicates.
+     * @param cardSelection The card selection, filtering by DF name.
+     * @param cardSecuritySetting The security settings.
+     * @param readTemplate The records to read, the template must only contain reads.
+     * @param writeAccessLevel The write access level of the secure session.
+     * @return A not null reference.
+     * @throw IllegalArgumentException If one of the provided argument is null or invalid, or if
+     *        the template contains other commands than reads.
+     * @throw IllegalStateException If the card selection does not filter by DF name or if the
+     *        card does not match the selection.
+     * @throw ParseException If the response to the selection is invalid.
+     * @throw ReaderIOException If a communication error with the card reader occurs.
+     * @throw CardIOException If a communication error with the card occurs.
+     * @see CardTransactionManager::processOpening
+     * @since 2.2.5.6
+     */
+    std::shared_ptr<CardTapResult> processTap(
+        std::shared_ptr<CardReader> cardReader,
+        const std::shared_ptr<CalypsoCardSelection> cardSelection,
+        const std::shared_ptr<CardSecuritySetting> cardSecuritySetting,
+        const CardTransactionTemplate& readTemplate,
+        const WriteAccessLevel writeAccessLevel) const;
+
     /**
      * Returns a new instance of SamSecuritySetting to use for secure SAM operations.
      *
@@ -28,6 +28,9 @@ using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 using namespace keyple::core::util::cpp::exception;
 
+const std::unique_ptr<Logger> CalypsoSamAdapter::mLogger =
+    LoggerFactory::getLogger(typeid(CalypsoSamAdapter));
+
 CalypsoSamAdapter::CalypsoSamAdapter(
     const std::shared_ptr<CardSelectionResponseApi> cardSelectionResponse)
 {
@@ -202,6 +205,118 @@ void CalypsoSamAdapter::putEventCeiling(const int eventCeilingNumber, const int
     mEventCeilings.insert({eventCeilingNumber, eventCeilingValue});
 }
 
+void CalypsoSamAdapter::setSelectedKeyDiversifier(const std::vector<uint8_t>& keyDiversifier)
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    mSelectedKeyDiversifier = keyDiversifier;
+}
+
+const std::vector<uint8_t> CalypsoSamAdapter::getSelectedKeyDiversifier() const
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    return mSelectedKeyDiversifier;
+}
+
+void CalypsoSamAdapter::setPrefetchedChallenge(const std::vector<uint8_t>& keyDiversifier,
+                                               const std::vector<uint8_t>& challenge)
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    mPrefetchedChallengeKeyDiversifier = keyDiversifier;
+    mPrefetchedChallenge = challenge;
+}
+
+const std::vector<uint8_t> CalypsoSamAdapter::takePrefetchedChallenge(
+    const std::vector<uint8_t>& keyDiversifier, const size_t length)
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    std::vector<uint8_t> challenge;
+
+    if (mPrefetchedChallenge.size() == length &&
+        mPrefetchedChallengeKeyDiversifier == keyDiversifier) {
+        challenge.swap(mPrefetchedChallenge);
+    }
+
+    mPrefetchedChallenge.clear();
+    mPrefetchedChallengeKeyDiversifier.clear();
+
+    return challenge;
+}
+
+void CalypsoSamAdapter::clearPrefetchedChallenge()
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    mPrefetchedChallenge.clear();
+    mPrefetchedChallengeKeyDiversifier.clear();
+}
+
+void CalypsoSamAdapter::setWorkKeyInventory(
+    const std::map<int, std::vector<uint8_t>>& workKeyParameters)
+{
+    std::map<uint16_t, int> workKeyRecordNumbers;
+    for (const auto& entry : workKeyParameters) {
+        workKeyRecordNumbers[static_cast<uint16_t>((entry.second[0] << 8) | entry.second[1])] =
+            entry.first;
+    }
+
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    mWorkKeyParameters = workKeyParameters;
+    mWorkKeyRecordNumbers = workKeyRecordNumbers;
+    mIsKeyInventoryAvailable = true;
+}
+
+bool CalypsoSamAdapter::isKeyInventoryAvailable() const
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    return mIsKeyInventoryAvailable;
+}
+
+const std::vector<uint8_t> CalypsoSamAdapter::getWorkKeyParameters(const int recordNumber) const
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    const auto it = mWorkKeyParameters.find(recordNumber);
+
+    return it != mWorkKeyParameters.end() ? it->second : std::vector<uint8_t>();
+}
+
+int CalypsoSamAdapter::getWorkKeyRecordNumber(const uint8_t kif, const uint8_t kvc) const
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    const auto it = mWorkKeyRecordNumbers.find(static_cast<uint16_t>((kif << 8) | kvc));
+
+    return it != mWorkKeyRecordNumbers.end() ? it->second : 0;
+}
+
+const Optional<uint8_t> CalypsoSamAdapter::getWorkKeyKif(const uint8_t kvc) const
+{
+    std::lock_guard<std::mutex> lock(mStateMutex);
+
+    Optional<uint8_t> kif = Optional<uint8_t>::empty();
+
+    for (const auto& entry : mWorkKeyRecordNumbers) {
+
+        if ((entry.first & 0xFF) != kvc) {
+            continue;
+        }
+
+        if (kif.isPresent()) {
+            return Optional<uint8_t>::empty();
+        }
+
+        kif = Optional<uint8_t>::of(static_cast<uint8_t>(entry.first >> 8));
+    }
+
+    return kif;
+}
+
 // std::shared_ptr<int> CalypsoSamAdapter::getEventCounter(const int eventCounterNumber) const
 // {
 //     const auto it = mEventCounters.find(eventCounterNumber);
@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <mutex>
 
 /* Calypsonet Terminal Calypso */
 #include "CalypsoSam.h"
@@ -23,6 +25,7 @@
 
 /* Keyple Card Calypso */
 #include "KeypleCardCalypsoExport.h"
+#include "Optional.h"
 
 /* Keyple Core Util */
 #include "LoggerFactory.h"
@@ -179,6 +182,113 @@ public:
      */
     void putEventCeiling(const int eventCeilingNumber, const int eventCeilingValue);
 
+    /**
+     * (package-private)<br>
+     * Sets the key diversifier currently selected in the SAM.
+     *
+     * <p>The state is shared by all the transaction managers using this SAM, so that a key
+     * diversifier already selected during a previous transaction is not selected again.
+     *
+     * @param keyDiversifier The key diversifier (empty if unknown).
+     * @since 2.2.5.6
+     */
+    void setSelectedKeyDiversifier(const std::vector<uint8_t>& keyDiversifier);
+
+    /**
+     * (package-private)<br>
+     * Gets the key diversifier currently selected in the SAM.
+     *
+     * @return An empty array if unknown.
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> getSelectedKeyDiversifier() const;
+
+    /**
+     * (package-private)<br>
+     * Keeps a challenge generated by the SAM in advance for the next secure session.
+     *
+     * @param keyDiversifier The key diversifier selected in the SAM when the challenge was
+     *     generated.
+     * @param challenge The challenge.
+     * @since 2.2.5.6
+     */
+    void setPrefetchedChallenge(const std::vector<uint8_t>& keyDiversifier,
+                                const std::vector<uint8_t>& challenge);
+
+    /**
+     * (package-private)<br>
+     * Gets and discards the prefetched challenge.
+     *
+     * @param keyDiversifier The key diversifier expected for the session.
+     * @param length The expected challenge length.
+     * @return An empty array if no challenge was prefetched with this diversifier and length.
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> takePrefetchedChallenge(const std::vector<uint8_t>& keyDiversifier,
+                                                       const size_t length);
+
+    /**
+     * (package-private)<br>
+     * Discards the prefetched challenge, if any (the SAM forgets it as soon as it receives another
+     * command).
+     *
+     * @since 2.2.5.6
+     */
+    void clearPrefetchedChallenge();
+
+    /**
+     * (package-private)<br>
+     * Replaces the work key inventory by the one read from the SAM and marks it as available.
+     *
+     * <p>The inventory is published at once, so that a partial inventory is never seen as
+     * complete.
+     *
+     * @param workKeyParameters The 13-byte key parameters (KIF, KVC, ALG, PAR1 to PAR10) of the
+     *     non-empty work key records, by record number (1 to 126).
+     * @since 2.2.5.6
+     */
+    void setWorkKeyInventory(const std::map<int, std::vector<uint8_t>>& workKeyParameters);
+
+    /**
+     * (package-private)<br>
+     * Indicates if the work keys of the SAM have been read.
+     *
+     * @return True if the key inventory is available.
+     * @since 2.2.5.6
+     */
+    bool isKeyInventoryAvailable() const;
+
+    /**
+     * (package-private)<br>
+     * Gets the parameters of a work key.
+     *
+     * @param recordNumber The number of the work key record.
+     * @return An empty array if the record is unknown or empty.
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> getWorkKeyParameters(const int recordNumber) const;
+
+    /**
+     * (package-private)<br>
+     * Gets the record number of the work key having the provided KIF and KVC.
+     *
+     * @param kif The KIF.
+     * @param kvc The KVC.
+     * @return 0 if the key is not in the inventory.
+     * @since 2.2.5.6
+     */
+    int getWorkKeyRecordNumber(const uint8_t kif, const uint8_t kvc) const;
+
+    /**
+     * (package-private)<br>
+     * Gets the KIF of the work key having the provided KVC, if there is only one.
+     *
+     * @param kvc The KVC.
+     * @return An empty optional if no key or several keys have this KVC.
+     * @since 2.2.5.6
+     */
+    const Optional<uint8_t> getWorkKeyKif(const uint8_t kvc) const;
+
     // /**
     //  * {@inheritDoc}
     //  *
@@ -211,7 +321,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CalypsoSamAdapter));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -267,6 +377,31 @@ private:
      *
      */
     std::map<int, int> mEventCeilings;
+
+    /**
+     *
+     */
+    std::vector<uint8_t> mSelectedKeyDiversifier;
+
+    /**
+     * Challenge generated in advance and key diversifier selected at that time.
+     */
+    std::vector<uint8_t> mPrefetchedChallenge;
+    std::vector<uint8_t> mPrefetchedChallengeKeyDiversifier;
+
+    /**
+     * Key inventory: parameters of the work keys by record number, and record numbers by KIF/KVC
+     * (KIF in the MSB).
+     */
+    bool mIsKeyInventoryAvailable = false;
+    std::map<int, std::vector<uint8_t>> mWorkKeyParameters;
+    std::map<uint16_t, int> mWorkKeyRecordNumbers;
+
+    /**
+     * C++: protects the SAM state above, the SAM may be shared by concurrent transactions (see
+     * ControlSamScheduler).
+     */
+    mutable std::mutex mStateMutex;
 };
 
 }
@@ -16,6 +16,9 @@ namespace keyple {
 namespace card {
 namespace calypso {
 
+const std::unique_ptr<Logger> CalypsoSamResourceProfileExtensionAdapter::mLogger =
+    LoggerFactory::getLogger(typeid(CalypsoSamResourceProfileExtensionAdapter));
+
 CalypsoSamResourceProfileExtensionAdapter::CalypsoSamResourceProfileExtensionAdapter(
   const std::shared_ptr<CalypsoSamSelection> calypsoSamSelection)
 : mCalypsoSamSelection(calypsoSamSelection) {}
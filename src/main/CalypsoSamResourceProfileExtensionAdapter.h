@@ -61,8 +61,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CalypsoSamResourceProfileExtensionAdapter));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -40,6 +40,9 @@ using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 using namespace keyple::core::util::cpp::exception;
 
+const std::unique_ptr<Logger> CalypsoSamSelectionAdapter::mLogger =
+    LoggerFactory::getLogger(typeid(CalypsoSamSelectionAdapter));
+
 const int CalypsoSamSelectionAdapter::SW_NOT_LOCKED = 0x6985;
 
 CalypsoSamSelectionAdapter::CalypsoSamSelectionAdapter()
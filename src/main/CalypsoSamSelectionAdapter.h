@@ -98,8 +98,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CalypsoSamSelectionAdapter));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -51,36 +51,55 @@ CardControlSamTransactionManagerAdapter::CardControlSamTransactionManagerAdapter
   mTargetCard(targetCard),
   mCardSecuritySetting(securitySetting) {}
 
-std::shared_ptr<uint8_t> CardControlSamTransactionManagerAdapter::computeKvc(
+Optional<uint8_t> CardControlSamTransactionManagerAdapter::computeKvc(
     const WriteAccessLevel writeAccessLevel,
-    const std::shared_ptr<uint8_t> kvc) const
+    const Optional<uint8_t> kvc) const
 {
-    if (kvc != nullptr) {
+    if (kvc.isPresent()) {
         return kvc;
     }
 
     return mCardSecuritySetting->getDefaultKvc(writeAccessLevel);
 }
 
-std::shared_ptr<uint8_t> CardControlSamTransactionManagerAdapter::computeKif(
+Optional<uint8_t> CardControlSamTransactionManagerAdapter::computeKif(
     const WriteAccessLevel writeAccessLevel,
-    const std::shared_ptr<uint8_t> kif,
-    const std::shared_ptr<uint8_t> kvc) const
+    const Optional<uint8_t> kif,
+    const Optional<uint8_t> kvc) const
 {
     /* CL-KEY-KIF.1 */
-    if ((kif != nullptr && *kif != 0xFF) || (kvc == nullptr)) {
+    if ((kif.isPresent() && kif.get() != 0xFF) || !kvc.isPresent()) {
         return kif;
     }
 
     /* CL-KEY-KIFUNK.1 */
-    std::shared_ptr<uint8_t> result = mCardSecuritySetting->getKif(writeAccessLevel, *kvc);
-    if (result == nullptr) {
+    Optional<uint8_t> result = mCardSecuritySetting->getKif(writeAccessLevel, kvc.get());
+
+    /* C++: KIF of the only work key of the control SAM having this KVC, if known */
+    if (!result.isPresent() && mControlSam != nullptr && mControlSam->isKeyInventoryAvailable()) {
+        result = mControlSam->getWorkKeyKif(kvc.get());
+    }
+
+    if (!result.isPresent()) {
         result = mCardSecuritySetting->getDefaultKif(writeAccessLevel);
     }
 
     return result;
 }
 
+bool CardControlSamTransactionManagerAdapter::isKeyAvailable(const Optional<uint8_t> kif,
+                                                             const Optional<uint8_t> kvc) const
+{
+    if (mControlSam == nullptr ||
+        !mControlSam->isKeyInventoryAvailable() ||
+        !kif.isPresent() ||
+        !kvc.isPresent()) {
+        return true;
+    }
+
+    return mControlSam->getWorkKeyRecordNumber(kif.get(), kvc.get()) != 0;
+}
+
 SamTransactionManager& CardControlSamTransactionManagerAdapter::processCommands()
 {
     /*
@@ -101,7 +120,19 @@ SamTransactionManager& CardControlSamTransactionManagerAdapter::processCommands(
         Arrays::addAll(getSamCommands(), samCommands);
     }
 
-    return CommonControlSamTransactionManagerAdapter::processCommands();
+    const std::shared_ptr<CmdSamGetChallenge> cmdSamGetChallengePrefetch =
+        mCmdSamGetChallengePrefetch;
+    mCmdSamGetChallengePrefetch = nullptr;
+
+    CommonControlSamTransactionManagerAdapter::processCommands();
+
+    /* The challenge remains valid in the SAM as long as no other command is sent to it */
+    if (cmdSamGetChallengePrefetch != nullptr) {
+        mControlSam->setPrefetchedChallenge(mTargetCard->getCalypsoSerialNumberFull(),
+                                            cmdSamGetChallengePrefetch->getChallenge());
+    }
+
+    return *this;
 }
 
 std::shared_ptr<CmdSamGetChallenge> CardControlSamTransactionManagerAdapter::prepareGetChallenge()
@@ -116,6 +147,27 @@ std::shared_ptr<CmdSamGetChallenge> CardControlSamTransactionManagerAdapter::pre
     return cmd;
 }
 
+void CardControlSamTransactionManagerAdapter::prepareChallengePrefetch()
+{
+    /* The challenge would be lost as soon as another thread uses the SAM */
+    if (isControlSamScheduled()) {
+        return;
+    }
+
+    mCmdSamGetChallengePrefetch = prepareGetChallenge();
+}
+
+const std::vector<uint8_t> CardControlSamTransactionManagerAdapter::takePrefetchedChallenge()
+{
+    /* Pending commands would be sent before the "Get Challenge" */
+    if (!getSamCommands().empty()) {
+        return std::vector<uint8_t>();
+    }
+
+    return mControlSam->takePrefetchedChallenge(mTargetCard->getCalypsoSerialNumberFull(),
+                                                mTargetCard->isExtendedModeSupported() ? 8 : 4);
+}
+
 void CardControlSamTransactionManagerAdapter::prepareGiveRandom()
 {
     prepareSelectDiversifierIfNeeded();
@@ -157,24 +209,24 @@ const std::shared_ptr<CmdSamCardCipherPin>
         /* No current work key is available (outside secure session) */
         if (newPin.empty()) {
             /* PIN verification */
-            if (mCardSecuritySetting->getPinVerificationCipheringKif() == nullptr ||
-                mCardSecuritySetting->getPinVerificationCipheringKvc() == nullptr) {
+            if (!mCardSecuritySetting->getPinVerificationCipheringKif().isPresent() ||
+                !mCardSecuritySetting->getPinVerificationCipheringKvc().isPresent()) {
                 throw IllegalStateException("No KIF or KVC defined for the PIN verification " \
                                             "ciphering key");
             }
 
-            pinCipheringKif = *mCardSecuritySetting->getPinVerificationCipheringKif();
-            pinCipheringKvc = *mCardSecuritySetting->getPinVerificationCipheringKvc();
+            pinCipheringKif = mCardSecuritySetting->getPinVerificationCipheringKif().get();
+            pinCipheringKvc = mCardSecuritySetting->getPinVerificationCipheringKvc().get();
         } else {
             /* PIN modification */
-            if (mCardSecuritySetting->getPinModificationCipheringKif() == nullptr ||
-                mCardSecuritySetting->getPinModificationCipheringKvc() == nullptr) {
+            if (!mCardSecuritySetting->getPinModificationCipheringKif().isPresent() ||
+                !mCardSecuritySetting->getPinModificationCipheringKvc().isPresent()) {
                 throw IllegalStateException("No KIF or KVC defined for the PIN modification " \
                                             "ciphering key");
             }
 
-            pinCipheringKif = *mCardSecuritySetting->getPinModificationCipheringKif();
-            pinCipheringKvc = *mCardSecuritySetting->getPinModificationCipheringKvc();
+            pinCipheringKif = mCardSecuritySetting->getPinModificationCipheringKif().get();
+            pinCipheringKvc = mCardSecuritySetting->getPinModificationCipheringKvc().get();
         }
     }
 
@@ -27,6 +27,7 @@
 #include "CmdCardSvReload.h"
 #include "CmdCardSvDebitOrUndebit.h"
 #include "CommonControlSamTransactionManagerAdapter.h"
+#include "Optional.h"
 
 namespace keyple {
 namespace card {
@@ -64,11 +65,11 @@ public:
      *
      * @param writeAccessLevel The write access level.
      * @param kvc The card KVC value.
-     * @return Null if the card did not provide a KVC value and if there's no default KVC value.
+     * @return An empty optional if the card did not provide a KVC value and if there's no default KVC value.
      * @since 2.2.0
      */
-    std::shared_ptr<uint8_t> computeKvc(const WriteAccessLevel writeAccessLevel,
-                                        const std::shared_ptr<uint8_t> kvc) const;
+    Optional<uint8_t> computeKvc(const WriteAccessLevel writeAccessLevel,
+                                 const Optional<uint8_t> kvc) const;
 
     /**
      * (package-private)<br>
@@ -77,12 +78,26 @@ public:
      * @param writeAccessLevel The write access level.
      * @param kif The card KIF value.
      * @param kvc The previously computed KVC value.
-     * @return Null if the card did not provide a KIF value and if there's no default KIF value.
+     * @return An empty optional if the card did not provide a KIF value and if there's no default KIF value.
      * @since 2.2.0
      */
-    std::shared_ptr<uint8_t> computeKif(const WriteAccessLevel writeAccessLevel,
-                                        const std::shared_ptr<uint8_t> kif,
-                                        const std::shared_ptr<uint8_t> kvc) const;
+    Optional<uint8_t> computeKif(const WriteAccessLevel writeAccessLevel,
+                                 const Optional<uint8_t> kif,
+                                 const Optional<uint8_t> kvc) const;
+
+    /**
+     * (package-private)<br>
+     * Indicates if a key is present in the control SAM, according to its key inventory.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param kif The KIF.
+     * @param kvc The KVC.
+     * @return False only if the key inventory of the control SAM is available and does not contain
+     *         the key.
+     * @since 2.2.5.6
+     */
+    bool isKeyAvailable(const Optional<uint8_t> kif, const Optional<uint8_t> kvc) const;
 
     /**
      * {@inheritDoc}
@@ -100,6 +115,26 @@ public:
      */
     std::shared_ptr<CmdSamGetChallenge> prepareGetChallenge();
 
+    /**
+     * (package-private)<br>
+     * Prepares a "Get Challenge" SAM command whose challenge is kept by the control SAM for the
+     * next secure session opened with the target card, once the commands are processed.
+     *
+     * <p>Nothing is done if the SAM is shared through a ControlSamScheduler.
+     *
+     * @since 2.2.5.6
+     */
+    void prepareChallengePrefetch();
+
+    /**
+     * (package-private)<br>
+     * Gets the challenge prefetched for the target card, if any, and discards it.
+     *
+     * @return An empty array if no valid challenge is available or if SAM commands are pending.
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> takePrefetchedChallenge();
+
     /**
      * (package-private)<br>
      * Prepares a "Give Random" SAM command.
@@ -350,6 +385,11 @@ private:
      *
      */
     std::shared_ptr<DigestManager> mDigestManager;
+
+    /**
+     * Pending "Get Challenge" SAM command prefetching the challenge of the next session.
+     */
+    std::shared_ptr<CmdSamGetChallenge> mCmdSamGetChallengePrefetch;
 };
 
 }
@@ -0,0 +1,202 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CardImageCache.h"
+
+/* Keyple Card Calypso */
+#include "FileDataAdapter.h"
+
+/* Keyple Core Util */
+#include "KeypleAssert.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util;
+
+/* IMAGE ---------------------------------------------------------------------------------------- */
+
+CardImageCache::Image::Image(const std::shared_ptr<CalypsoCardAdapter> card)
+: mExpectedTransactionCounter(card->getTransactionCounter() - 1)
+{
+    for (const auto& ef : card->getFiles()) {
+
+        if (ef->getSfi() == 0) {
+            continue;
+        }
+
+        /* The bytes padded with 0 by a partial reading are not the ones of the card */
+        const auto fileData = std::dynamic_pointer_cast<FileDataAdapter>(ef->getData());
+        for (const auto& record : fileData->getAllRecordsContent()) {
+
+            if (!record.second.empty() &&
+                fileData->isContentKnown(record.first,
+                                         0,
+                                         static_cast<int>(record.second.size()))) {
+                mRecords[ef->getSfi()].insert(record);
+            }
+        }
+    }
+}
+
+bool CardImageCache::Image::isValid(const int transactionCounter) const
+{
+    return transactionCounter == mExpectedTransactionCounter;
+}
+
+const std::vector<uint8_t>* CardImageCache::Image::getRecord(const uint8_t sfi,
+                                                             const uint8_t recordNumber) const
+{
+    const auto it = mRecords.find(sfi);
+    if (it == mRecords.end()) {
+        return nullptr;
+    }
+
+    const auto itt = it->second.find(recordNumber);
+    if (itt == it->second.end() || itt->second.empty()) {
+        return nullptr;
+    }
+
+    return &itt->second;
+}
+
+/* CARD IMAGE CACHE ----------------------------------------------------------------------------- */
+
+CardImageCache::CardImageCache(const int capacity) : mCapacity(capacity)
+{
+    Assert::getInstance().greaterOrEqual(capacity, 1, "capacity");
+}
+
+int CardImageCache::getCapacity() const
+{
+    return mCapacity;
+}
+
+int CardImageCache::getSize() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return static_cast<int>(mImages.size());
+}
+
+int CardImageCache::getHitCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mHitCount;
+}
+
+int CardImageCache::getMissCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mMissCount;
+}
+
+void CardImageCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mImages.clear();
+    mLruKeys.clear();
+    mHitCount = 0;
+    mMissCount = 0;
+}
+
+std::shared_ptr<const CardImageCache::Image> CardImageCache::get(
+    const std::shared_ptr<CalypsoCardAdapter> card)
+{
+    const Key key = buildKey(card);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    const auto it = mImages.find(key);
+    if (it == mImages.end()) {
+        return nullptr;
+    }
+
+    /* Move the key to the front of the LRU list */
+    mLruKeys.splice(mLruKeys.begin(), mLruKeys, it->second.second);
+
+    return it->second.first;
+}
+
+void CardImageCache::put(const std::shared_ptr<CalypsoCardAdapter> card)
+{
+    const Key key = buildKey(card);
+    const std::shared_ptr<const Image> image = std::make_shared<Image>(card);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    const auto it = mImages.find(key);
+    if (it != mImages.end()) {
+
+        it->second.first = image;
+        mLruKeys.splice(mLruKeys.begin(), mLruKeys, it->second.second);
+        return;
+    }
+
+    if (static_cast<int>(mImages.size()) >= mCapacity) {
+
+        /* Evict the least recently used image */
+        mImages.erase(mLruKeys.back());
+        mLruKeys.pop_back();
+    }
+
+    mLruKeys.push_front(key);
+    mImages.insert({key, {image, mLruKeys.begin()}});
+}
+
+void CardImageCache::remove(const std::shared_ptr<CalypsoCardAdapter> card)
+{
+    const Key key = buildKey(card);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    const auto it = mImages.find(key);
+    if (it != mImages.end()) {
+
+        mLruKeys.erase(it->second.second);
+        mImages.erase(it);
+    }
+}
+
+void CardImageCache::notifyLookup(const bool isHit)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (isHit) {
+        mHitCount++;
+    } else {
+        mMissCount++;
+    }
+}
+
+const CardImageCache::Key CardImageCache::buildKey(const std::shared_ptr<CalypsoCardAdapter> card)
+{
+    const std::vector<uint8_t>& dfName = card->getDfName();
+    const std::vector<uint8_t> serialNumber = card->getApplicationSerialNumber();
+
+    /* The DF name length prefix avoids any ambiguity between the two variable length parts */
+    Key key;
+    key.reserve(1 + dfName.size() + serialNumber.size());
+    key.push_back(static_cast<uint8_t>(dfName.size()));
+    key.insert(key.end(), dfName.begin(), dfName.end());
+    key.insert(key.end(), serialNumber.begin(), serialNumber.end());
+
+    return key;
+}
+
+}
+}
+}
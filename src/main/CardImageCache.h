@@ -0,0 +1,240 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+/**
+ * Bounded LRU cache of card images, keyed by application serial number and DF name.
+ *
+ * <p>An image holds the content of the records of the card files identified by a SFI, entirely
+ * known at the end of the last successfully closed secure session (the records partially read are
+ * left out). It is considered valid for the next
+ * secure session only if the transaction counter returned by the Open Secure Session command
+ * shows that no other session took place in between (the counter is decremented at each session
+ * opening).
+ *
+ * <p>When enabled on the card security setting (see
+ * CardSecuritySettingAdapter::setCardImageCache), the record reads (one or multiple records)
+ * prepared for the opening of a secure session and placed before the first modifying command are
+ * served from a valid image instead of being sent to the card. The other commands are sent
+ * together in a single card request.
+ *
+ * <p>Files modified outside a secure session do not change the transaction counter and therefore
+ * can't be detected: the cache must only be used for files whose write access conditions require
+ * a secure session.
+ *
+ * <p>C++: this class is thread-safe so that a single instance can be shared between several
+ * readers.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API CardImageCache final {
+public:
+    /**
+     * (package-private)<br>
+     * Immutable image of the record files of a card.
+     *
+     * @since 2.2.5.6
+     */
+    class Image final {
+    public:
+        /**
+         * (package-private)<br>
+         * Builds an image from the current content of the provided card.
+         *
+         * @param card The card (a secure session must have been opened).
+         * @since 2.2.5.6
+         */
+        Image(const std::shared_ptr<CalypsoCardAdapter> card);
+
+        /**
+         * (package-private)<br>
+         * Indicates if the image is still up to date according to the transaction counter
+         * returned by the card at the opening of the current secure session.
+         *
+         * @param transactionCounter The current transaction counter of the card.
+         * @return True if no other session was opened since the image was taken.
+         * @since 2.2.5.6
+         */
+        bool isValid(const int transactionCounter) const;
+
+        /**
+         * (package-private)<br>
+         * Gets the content of a record.
+         *
+         * @param sfi The SFI of the file.
+         * @param recordNumber The record number.
+         * @return Null if the record is not part of the image.
+         * @since 2.2.5.6
+         */
+        const std::vector<uint8_t>* getRecord(const uint8_t sfi, const uint8_t recordNumber) const;
+
+    private:
+        /**
+         * The transaction counter expected at the next session opening.
+         */
+        const int mExpectedTransactionCounter;
+
+        /**
+         * Records content by SFI and record number.
+         */
+        std::map<uint8_t, std::map<const uint8_t, std::vector<uint8_t>>> mRecords;
+    };
+
+    /**
+     * Creates a cache able to hold up to the provided number of card images.
+     *
+     * @param capacity The maximum number of images (should be {@code >=} 1).
+     * @throw IllegalArgumentException If the capacity is out of range.
+     * @since 2.2.5.6
+     */
+    CardImageCache(const int capacity);
+
+    /**
+     * Gets the maximum number of card images.
+     *
+     * @return A positive int.
+     * @since 2.2.5.6
+     */
+    int getCapacity() const;
+
+    /**
+     * Gets the current number of card images.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getSize() const;
+
+    /**
+     * Gets the number of session openings for which a valid image was found.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getHitCount() const;
+
+    /**
+     * Gets the number of session openings for which no valid image was found.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getMissCount() const;
+
+    /**
+     * Removes all card images and resets the statistics.
+     *
+     * @since 2.2.5.6
+     */
+    void clear();
+
+    /**
+     * (package-private)<br>
+     * Gets the image of a card and marks it as the most recently used.
+     *
+     * @param card The card.
+     * @return Null if no image is available for this card.
+     * @since 2.2.5.6
+     */
+    std::shared_ptr<const Image> get(const std::shared_ptr<CalypsoCardAdapter> card);
+
+    /**
+     * (package-private)<br>
+     * Stores or replaces the image of a card, evicting the least recently used image if the
+     * capacity is reached.
+     *
+     * @param card The card (a secure session must have been opened).
+     * @since 2.2.5.6
+     */
+    void put(const std::shared_ptr<CalypsoCardAdapter> card);
+
+    /**
+     * (package-private)<br>
+     * Removes the image of a card, if any.
+     *
+     * @param card The card.
+     * @since 2.2.5.6
+     */
+    void remove(const std::shared_ptr<CalypsoCardAdapter> card);
+
+    /**
+     * (package-private)<br>
+     * Records the result of a cache lookup at the opening of a secure session.
+     *
+     * @param isHit True if a valid image was found.
+     * @since 2.2.5.6
+     */
+    void notifyLookup(const bool isHit);
+
+private:
+    /**
+     *
+     */
+    using Key = std::vector<uint8_t>;
+
+    /**
+     *
+     */
+    const int mCapacity;
+
+    /**
+     * Keys ordered from the most recently used to the least recently used.
+     */
+    std::list<Key> mLruKeys;
+
+    /**
+     *
+     */
+    std::map<Key, std::pair<std::shared_ptr<const Image>, std::list<Key>::iterator>> mImages;
+
+    /**
+     *
+     */
+    int mHitCount = 0;
+
+    /**
+     *
+     */
+    int mMissCount = 0;
+
+    /**
+     *
+     */
+    mutable std::mutex mMutex;
+
+    /**
+     * (private)<br>
+     * Builds the cache key of a card from its DF name and application serial number.
+     */
+    static const Key buildKey(const std::shared_ptr<CalypsoCardAdapter> card);
+};
+
+}
+}
+}
@@ -113,8 +113,8 @@ CardSecuritySettingAdapter& CardSecuritySettingAdapter::addAuthorizedSvKey(const
 CardSecuritySettingAdapter& CardSecuritySettingAdapter::setPinVerificationCipheringKey(
     const uint8_t kif, const uint8_t kvc)
 {
-    mPinVerificationCipheringKif = std::make_shared<uint8_t>(kif);
-    mPinVerificationCipheringKvc = std::make_shared<uint8_t>(kvc);
+    mPinVerificationCipheringKif = kif;
+    mPinVerificationCipheringKvc = kvc;
 
     return *this;
 }
@@ -122,8 +122,8 @@ CardSecuritySettingAdapter& CardSecuritySettingAdapter::setPinVerificationCipher
 CardSecuritySettingAdapter& CardSecuritySettingAdapter::setPinModificationCipheringKey(
     const uint8_t kif, const uint8_t kvc)
 {
-    mPinModificationCipheringKif = std::make_shared<uint8_t>(kif);
-    mPinModificationCipheringKvc = std::make_shared<uint8_t>(kvc);
+    mPinModificationCipheringKif = kif;
+    mPinModificationCipheringKvc = kvc;
 
     return *this;
 }
@@ -153,48 +153,48 @@ bool CardSecuritySettingAdapter::isSvNegativeBalanceAuthorized() const
     return mIsSvNegativeBalanceAuthorized;
 }
 
-const std::shared_ptr<uint8_t> CardSecuritySettingAdapter::getKif(
+Optional<uint8_t> CardSecuritySettingAdapter::getKif(
     const WriteAccessLevel writeAccessLevel, const uint8_t kvc) const
 {
     const auto it = mKifMap.find(writeAccessLevel);
     if (it == mKifMap.end()) {
-        return nullptr;
+        return Optional<uint8_t>::empty();
     } else {
         const auto itt = it->second.find(kvc);
         if (itt == it->second.end()) {
-            return nullptr;
+            return Optional<uint8_t>::empty();
         } else {
-            return std::make_shared<uint8_t>(itt->second);
+            return itt->second;
         }
     }
 }
 
-const std::shared_ptr<uint8_t> CardSecuritySettingAdapter::getDefaultKif(
+Optional<uint8_t> CardSecuritySettingAdapter::getDefaultKif(
     const WriteAccessLevel writeAccessLevel) const
 {
     const auto it = mDefaultKifMap.find(writeAccessLevel);
     if (it == mDefaultKifMap.end()) {
-        return nullptr;
+        return Optional<uint8_t>::empty();
     } else {
-        return std::make_shared<uint8_t>(it->second);
+        return it->second;
     }
 }
 
-const std::shared_ptr<uint8_t> CardSecuritySettingAdapter::getDefaultKvc(
+Optional<uint8_t> CardSecuritySettingAdapter::getDefaultKvc(
     const WriteAccessLevel writeAccessLevel) const
 {
     const auto it = mDefaultKvcMap.find(writeAccessLevel);
     if (it == mDefaultKvcMap.end()) {
-        return nullptr;
+        return Optional<uint8_t>::empty();
     } else {
-        return std::make_shared<uint8_t>(it->second);
+        return it->second;
     }
 }
 
-bool CardSecuritySettingAdapter::isSessionKeyAuthorized(const std::shared_ptr<uint8_t> kif,
-                                                        const std::shared_ptr<uint8_t> kvc) const
+bool CardSecuritySettingAdapter::isSessionKeyAuthorized(const Optional<uint8_t> kif,
+                                                        const Optional<uint8_t> kvc) const
 {
-    if (kif == nullptr || kvc == nullptr) {
+    if (!kif.isPresent() || !kvc.isPresent()) {
         return false;
     }
 
@@ -203,13 +203,13 @@ bool CardSecuritySettingAdapter::isSessionKeyAuthorized(const std::shared_ptr<ui
     }
 
     return Arrays::contains(mAuthorizedSessionKeys,
-                            ((*kif.get() << 8) & 0xff00) | (*kvc.get() & 0x00ff));
+                            ((kif.get() << 8) & 0xff00) | (kvc.get() & 0x00ff));
 }
 
-bool CardSecuritySettingAdapter::isSvKeyAuthorized(const std::shared_ptr<uint8_t> kif,
-                                                   const std::shared_ptr<uint8_t> kvc) const
+bool CardSecuritySettingAdapter::isSvKeyAuthorized(const Optional<uint8_t> kif,
+                                                   const Optional<uint8_t> kvc) const
 {
-    if (kif == nullptr || kvc == nullptr) {
+    if (!kif.isPresent() || !kvc.isPresent()) {
         return false;
     }
 
@@ -218,29 +218,56 @@ bool CardSecuritySettingAdapter::isSvKeyAuthorized(const std::shared_ptr<uint8_t
     }
 
     return Arrays::contains(mAuthorizedSvKeys,
-                            ((*kif.get() << 8) & 0xff00) | (*kvc.get() & 0x00ff));
+                            ((kif.get() << 8) & 0xff00) | (kvc.get() & 0x00ff));
 }
 
-const std::shared_ptr<uint8_t> CardSecuritySettingAdapter::getPinVerificationCipheringKif() const
+Optional<uint8_t> CardSecuritySettingAdapter::getPinVerificationCipheringKif() const
 {
     return mPinVerificationCipheringKif;
 }
 
-const std::shared_ptr<uint8_t> CardSecuritySettingAdapter::getPinVerificationCipheringKvc() const
+Optional<uint8_t> CardSecuritySettingAdapter::getPinVerificationCipheringKvc() const
 {
     return mPinVerificationCipheringKvc;
 }
 
-const std::shared_ptr<uint8_t> CardSecuritySettingAdapter::getPinModificationCipheringKif() const
+Optional<uint8_t> CardSecuritySettingAdapter::getPinModificationCipheringKif() const
 {
     return mPinModificationCipheringKif;
 }
 
-const std::shared_ptr<uint8_t> CardSecuritySettingAdapter::getPinModificationCipheringKvc() const
+Optional<uint8_t> CardSecuritySettingAdapter::getPinModificationCipheringKvc() const
 {
     return mPinModificationCipheringKvc;
 }
 
+CardSecuritySettingAdapter& CardSecuritySettingAdapter::setCardImageCache(
+    const std::shared_ptr<CardImageCache> cardImageCache)
+{
+    Assert::getInstance().notNull(cardImageCache, "cardImageCache");
+
+    mCardImageCache = cardImageCache;
+
+    return *this;
+}
+
+const std::shared_ptr<CardImageCache> CardSecuritySettingAdapter::getCardImageCache() const
+{
+    return mCardImageCache;
+}
+
+CardSecuritySettingAdapter& CardSecuritySettingAdapter::enableSamChallengePrefetch()
+{
+    mIsSamChallengePrefetchEnabled = true;
+
+    return *this;
+}
+
+bool CardSecuritySettingAdapter::isSamChallengePrefetchEnabled() const
+{
+    return mIsSamChallengePrefetchEnabled;
+}
+
 }
 }
 }
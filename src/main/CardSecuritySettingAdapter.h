@@ -25,8 +25,10 @@
 #include "CardReader.h"
 
 /* Keyple Card Calypso */
+#include "CardImageCache.h"
 #include "CommonSecuritySettingAdapter.h"
 #include "KeypleCardCalypsoExport.h"
+#include "Optional.h"
 
 namespace keyple {
 namespace card {
@@ -198,34 +200,34 @@ public:
      *
      * @param writeAccessLevel The write access level.
      * @param kvc The KVC value.
-     * @return Null if no KIF is available.
+     * @return An empty optional if no KIF is available.
      * @throws IllegalArgumentException If the provided writeAccessLevel is null.
      * @since 2.0.0
      */
-    const std::shared_ptr<uint8_t> getKif(const WriteAccessLevel writeAccessLevel,
-                                          const uint8_t kvc) const;
+    Optional<uint8_t> getKif(const WriteAccessLevel writeAccessLevel,
+                             const uint8_t kvc) const;
 
     /**
      * (package-private)<br>
      * Gets the default KIF value for the provided write access level.
      *
      * @param writeAccessLevel The write access level.
-     * @return Null if no KIF is available.
+     * @return An empty optional if no KIF is available.
      * @throws IllegalArgumentException If the provided argument is null.
      * @since 2.0.0
      */
-    const std::shared_ptr<uint8_t> getDefaultKif(const WriteAccessLevel writeAccessLevel) const;
+    Optional<uint8_t> getDefaultKif(const WriteAccessLevel writeAccessLevel) const;
 
     /**
      * (package-private)<br>
      * Gets the default KVC value for the provided write access level.
      *
      * @param writeAccessLevel The write access level.
-     * @return Null if no KVC is available.
+     * @return An empty optional if no KVC is available.
      * @throws IllegalArgumentException If the provided argument is null.
      * @since 2.0.0
      */
-    const std::shared_ptr<uint8_t> getDefaultKvc(const WriteAccessLevel writeAccessLevel) const;
+    Optional<uint8_t> getDefaultKvc(const WriteAccessLevel writeAccessLevel) const;
 
     /**
      * (package-private)<br>
@@ -233,11 +235,11 @@ public:
      *
      * @param kif The KIF value.
      * @param kvc The KVC value.
-     * @return False if KIF or KVC is null or unauthorized.
+     * @return False if KIF or KVC is empty or unauthorized.
      * @since 2.0.0
      */
-    bool isSessionKeyAuthorized(const std::shared_ptr<uint8_t> kif,
-                                const std::shared_ptr<uint8_t> kvc) const;
+    bool isSessionKeyAuthorized(const Optional<uint8_t> kif,
+                                const Optional<uint8_t> kvc) const;
 
     /**
      * (package-private)<br>
@@ -245,47 +247,101 @@ public:
      *
      * @param kif The KIF value.
      * @param kvc The KVC value.
-     * @return False if KIF or KVC is null or unauthorized.
+     * @return False if KIF or KVC is empty or unauthorized.
      * @since 2.0.0
      */
-    bool isSvKeyAuthorized(const std::shared_ptr<uint8_t> kif,
-                           const std::shared_ptr<uint8_t> kvc) const;
+    bool isSvKeyAuthorized(const Optional<uint8_t> kif,
+                           const Optional<uint8_t> kvc) const;
 
     /**
      * (package-private)<br>
      * Gets the KIF value of the PIN verification ciphering key.
      *
-     * @return Null if no KIF is available.
+     * @return An empty optional if no KIF is available.
      * @since 2.0.0
      */
-    const std::shared_ptr<uint8_t> getPinVerificationCipheringKif() const;
+    Optional<uint8_t> getPinVerificationCipheringKif() const;
 
     /**
      * (package-private)<br>
      * Gets the KVC value of the PIN verification ciphering key.
      *
-     * @return Null if no KVC is available.
+     * @return An empty optional if no KVC is available.
      * @since 2.0.0
      */
-    const std::shared_ptr<uint8_t> getPinVerificationCipheringKvc() const;
+    Optional<uint8_t> getPinVerificationCipheringKvc() const;
 
     /**
      * (package-private)<br>
      * Gets the KIF value of the PIN modification ciphering key.
      *
-     * @return Null if no KIF is available.
+     * @return An empty optional if no KIF is available.
      * @since 2.0.0
      */
-    const std::shared_ptr<uint8_t> getPinModificationCipheringKif() const;
+    Optional<uint8_t> getPinModificationCipheringKif() const;
 
     /**
      * (package-private)<br>
      * Gets the KVC value of the PIN modification ciphering key.
      *
-     * @return Null if no KVC is available.
+     * @return An empty optional if no KVC is available.
      * @since 2.0.0
      */
-    const std::shared_ptr<uint8_t> getPinModificationCipheringKvc() const;
+    Optional<uint8_t> getPinModificationCipheringKvc() const;
+
+    /**
+     * Enables the serving of card reads from the provided card image cache at the opening of
+     * secure sessions, and the storage of card images at their closing.
+     *
+     * <p>C++: specific to this implementation, the cache is not part of the CardSecuritySetting
+     * API.
+     *
+     * @param cardImageCache The cache to use, may be shared between several security settings.
+     * @return The current instance.
+     * @throw IllegalArgumentException If the provided cache is null.
+     * @since 2.2.5.6
+     */
+    CardSecuritySettingAdapter& setCardImageCache(
+        const std::shared_ptr<CardImageCache> cardImageCache);
+
+    /**
+     * (package-private)<br>
+     * Gets the card image cache.
+     *
+     * @return Null if no cache is enabled.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardImageCache> getCardImageCache() const;
+
+    /**
+     * Enables the prefetching of the SAM challenge of the next secure session.
+     *
+     * <p>The "Get Challenge" SAM command is sent together with the "Digest Authenticate" command
+     * closing a secure session, and the challenge is kept by the control SAM. The next session
+     * opened with the same card (next session of a multiple session transaction, or new
+     * transaction after a card removal) then starts directly with the card "Open Secure Session"
+     * command.
+     *
+     * <p>The prefetched challenge is discarded as soon as any other command is sent to the SAM
+     * through this library. It is only valid if no other application uses the SAM in between and
+     * is therefore not performed when the SAM reader is a ControlSamScheduler.
+     *
+     * <p>C++: specific to this implementation, the prefetching is not part of the
+     * CardSecuritySetting API.
+     *
+     * @return The current instance.
+     * @since 2.2.5.6
+     */
+    CardSecuritySettingAdapter& enableSamChallengePrefetch();
+
+    /**
+     * (package-private)<br>
+     * Indicates if the prefetching of the SAM challenge is enabled.
+     *
+     * @return True if the prefetching is enabled.
+     * @since 2.2.5.6
+     */
+    bool isSamChallengePrefetchEnabled() const;
 
 private:
     /**
@@ -346,22 +402,32 @@ private:
     /**
      *
      */
-    std::shared_ptr<uint8_t> mPinVerificationCipheringKif;
+    Optional<uint8_t> mPinVerificationCipheringKif;
+
+    /**
+     *
+     */
+    Optional<uint8_t> mPinVerificationCipheringKvc;
+
+    /**
+     *
+     */
+    Optional<uint8_t> mPinModificationCipheringKif;
 
     /**
      *
      */
-    std::shared_ptr<uint8_t> mPinVerificationCipheringKvc;
+    Optional<uint8_t> mPinModificationCipheringKvc;
 
     /**
      *
      */
-    std::shared_ptr<uint8_t> mPinModificationCipheringKif;
+    std::shared_ptr<CardImageCache> mCardImageCache;
 
     /**
      *
      */
-    std::shared_ptr<uint8_t> mPinModificationCipheringKvc;
+    bool mIsSamChallengePrefetchEnabled = false;
 };
 
 }
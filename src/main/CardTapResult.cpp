@@ -0,0 +1,50 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CardTapResult.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+CardTapResult::CardTapResult(const std::shared_ptr<CalypsoCard> calypsoCard,
+                             const std::shared_ptr<CardTransactionManager> cardTransaction,
+                             const int exchangeCount,
+                             const uint64_t latency)
+: mCalypsoCard(calypsoCard),
+  mCardTransaction(cardTransaction),
+  mExchangeCount(exchangeCount),
+  mLatency(latency) {}
+
+const std::shared_ptr<CalypsoCard> CardTapResult::getCalypsoCard() const
+{
+    return mCalypsoCard;
+}
+
+const std::shared_ptr<CardTransactionManager> CardTapResult::getCardTransaction() const
+{
+    return mCardTransaction;
+}
+
+int CardTapResult::getExchangeCount() const
+{
+    return mExchangeCount;
+}
+
+uint64_t CardTapResult::getLatency() const
+{
+    return mLatency;
+}
+
+}
+}
+}
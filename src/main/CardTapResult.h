@@ -0,0 +1,115 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+/* Calypsonet Terminal Calypso */
+#include "CalypsoCard.h"
+#include "CardTransactionManager.h"
+
+/* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::calypso::card;
+using namespace calypsonet::terminal::calypso::transaction;
+
+/**
+ * Result of CalypsoExtensionService::processTap: the selected card, the transaction manager
+ * holding the open secure session and the cost of the tap up to the session opening.
+ *
+ * <p>C++: specific to this implementation.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API CardTapResult final {
+public:
+    /**
+     * (package-private)<br>
+     * Constructor.
+     *
+     * @param calypsoCard The selected card.
+     * @param cardTransaction The transaction manager, with an open secure session.
+     * @param exchangeCount The number of card requests transmitted.
+     * @param latency The duration of the tap in microseconds.
+     * @since 2.2.5.6
+     */
+    CardTapResult(const std::shared_ptr<CalypsoCard> calypsoCard,
+                  const std::shared_ptr<CardTransactionManager> cardTransaction,
+                  const int exchangeCount,
+                  const uint64_t latency);
+
+    /**
+     * Gets the card image, filled with the data read during the tap.
+     *
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CalypsoCard> getCalypsoCard() const;
+
+    /**
+     * Gets the transaction manager to use to go on with the transaction, the secure session being
+     * open.
+     *
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardTransactionManager> getCardTransaction() const;
+
+    /**
+     * Gets the number of card requests transmitted to the card reader, from the application
+     * selection to the session opening.
+     *
+     * @return A strictly positive int.
+     * @since 2.2.5.6
+     */
+    int getExchangeCount() const;
+
+    /**
+     * Gets the time elapsed from the application selection to the session opening.
+     *
+     * @return A duration in microseconds.
+     * @since 2.2.5.6
+     */
+    uint64_t getLatency() const;
+
+private:
+    /**
+     *
+     */
+    const std::shared_ptr<CalypsoCard> mCalypsoCard;
+
+    /**
+     *
+     */
+    const std::shared_ptr<CardTransactionManager> mCardTransaction;
+
+    /**
+     *
+     */
+    const int mExchangeCount;
+
+    /**
+     *
+     */
+    const uint64_t mLatency;
+};
+
+}
+}
+}
@@ -40,6 +40,7 @@
 #include "CalypsoSamSecurityDataException.h"
 #include "CardCommandException.h"
 #include "CardDataAccessException.h"
+#include "CardImageCache.h"
 #include "CardRequestAdapter.h"
 #include "CardSecurityDataException.h"
 #include "CardSecuritySettingAdapter.h"
@@ -67,7 +68,11 @@
 #include "CmdCardUpdateRecord.h"
 #include "CmdCardVerifyPin.h"
 #include "CmdCardWriteRecord.h"
+#include "FileDataAdapter.h"
+#include "LocalApduResponseAdapter.h"
+#include "Optional.h"
 #include "SearchCommandDataAdapter.h"
+#include "SvDebitLogRecordAdapter.h"
 
 /* Keyple Core Util */
 #include "Arrays.h"
@@ -93,6 +98,9 @@ using namespace keyple::core::util::cpp;
 using namespace keyple::core::util::cpp::exception;
 
 /* CARD TRANSACTION MANAGER ADAPTER ------------------------------------------------------------- */
+const std::unique_ptr<Logger> CardTransactionManagerAdapter::mLogger =
+    LoggerFactory::getLogger(typeid(CardTransactionManagerAdapter));
+
 const std::string CardTransactionManagerAdapter::PATTERN_1_BYTE_HEX = "%020Xh";
 
 const std::string CardTransactionManagerAdapter::MSG_CARD_READER_COMMUNICATION_ERROR =
@@ -117,9 +125,9 @@ const int CardTransactionManagerAdapter::APDU_HEADER_LENGTH = 5;
 
 
 const std::shared_ptr<ApduResponseApi> CardTransactionManagerAdapter::RESPONSE_OK =
-    std::make_shared<ApduResponseAdapter>(std::vector<uint8_t>({0x90, 0x00}));
+    std::make_shared<LocalApduResponseAdapter>(std::vector<uint8_t>({0x90, 0x00}));
 const std::shared_ptr<ApduResponseApi> CardTransactionManagerAdapter::RESPONSE_OK_POSTPONED =
-    std::make_shared<ApduResponseAdapter>(std::vector<uint8_t>({0x62, 0x00}));
+    std::make_shared<LocalApduResponseAdapter>(std::vector<uint8_t>({0x62, 0x00}));
 
 CardTransactionManagerAdapter::CardTransactionManagerAdapter(
   const std::shared_ptr<ProxyReaderApi> cardReader,
@@ -132,6 +140,9 @@ CardTransactionManagerAdapter::CardTransactionManagerAdapter(
   mCardReader(cardReader),
   mCard(card),
   mSecuritySetting(securitySetting),
+  mControlSamScheduler(securitySetting != nullptr ?
+                       std::dynamic_pointer_cast<ControlSamScheduler>(
+                           securitySetting->getControlSamReader()) : nullptr),
   mModificationsCounter(card->getModificationsCounter())
 {
     if (securitySetting != nullptr && securitySetting->getControlSam() != nullptr) {
@@ -178,7 +189,7 @@ void CardTransactionManagerAdapter::processSamPreparedCommands()
 }
 
 void CardTransactionManagerAdapter::processAtomicOpening(
-    std::vector<std::shared_ptr<AbstractApduCommand>>& cardCommands)
+    std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands)
 {
     if (mSecuritySetting == nullptr) {
         throw IllegalStateException("No security settings are available.");
@@ -186,6 +197,7 @@ void CardTransactionManagerAdapter::processAtomicOpening(
 
     mCard->backupFiles();
     mNbPostponedData = 0;
+    mRecordsReadInSession.clear();
 
     /*
      * Let's check if we have a read record command at the top of the command list.
@@ -201,16 +213,35 @@ void CardTransactionManagerAdapter::processAtomicOpening(
 
     if (!cardCommands.empty()) {
 
-        const auto cardCommand = std::dynamic_pointer_cast<AbstractCardCommand>(cardCommands[0]);
-        if (cardCommand->getCommandRef() == CalypsoCardCommand::READ_RECORDS &&
-            std::dynamic_pointer_cast<CmdCardReadRecords>(cardCommand)->getReadMode() ==
-                CmdCardReadRecords::ReadMode::ONE_RECORD) {
-            sfi = std::dynamic_pointer_cast<CmdCardReadRecords>(cardCommand)->getSfi();
-            recordNumber =
-                std::dynamic_pointer_cast<CmdCardReadRecords>(cardCommand)->getFirstRecordNumber();
-            recordSize =
-                std::dynamic_pointer_cast<CmdCardReadRecords>(cardCommand)->getRecordSize();
-            cardCommands.erase(cardCommands.begin());
+        const std::shared_ptr<AbstractCardCommand>& cardCommand = cardCommands[0];
+        if (cardCommand->getCommandRef() == CalypsoCardCommand::READ_RECORDS) {
+
+            /* The command reference identifies the command class */
+            const auto cmdCardReadRecords = std::static_pointer_cast<CmdCardReadRecords>(cardCommand);
+            if (cmdCardReadRecords->getReadMode() == CmdCardReadRecords::ReadMode::ONE_RECORD) {
+                sfi = cmdCardReadRecords->getSfi();
+                recordNumber = cmdCardReadRecords->getFirstRecordNumber();
+                recordSize = cmdCardReadRecords->getRecordSize();
+                cardCommands.erase(cardCommands.begin());
+            }
+        }
+    }
+
+    /*
+     * If an image of the card is cached, the other commands are deferred until the transaction
+     * counter returned by the open secure session command has been checked.
+     */
+    const std::shared_ptr<CardImageCache> cardImageCache = mSecuritySetting->getCardImageCache();
+    std::shared_ptr<const CardImageCache::Image> cardImage = nullptr;
+    std::vector<std::shared_ptr<AbstractCardCommand>> deferredCardCommands;
+
+    if (cardImageCache != nullptr && !cardCommands.empty()) {
+
+        cardImage = cardImageCache->get(mCard);
+        if (cardImage != nullptr) {
+            deferredCardCommands.swap(cardCommands);
+        } else {
+            cardImageCache->notifyLookup(false);
         }
     }
 
@@ -251,64 +282,64 @@ void CardTransactionManagerAdapter::processAtomicOpening(
     /* Parse all the responses and fill the CalypsoCard object with the command data */
     try {
 
-        /*
-         * C++: cannot cast std::vector<std::shared_ptr<derived>> into
-         *      std::vector<std::shared_ptr<base>> automatically. Need to copy into another vector.
-         */
-        std::vector<std::shared_ptr<AbstractCardCommand>> copy;
-        for (int i = 0; i < static_cast<int>(cardCommands.size()); i++) {
-
-            copy.push_back(std::dynamic_pointer_cast<AbstractCardCommand>(cardCommands[i]));
-        }
-
-        parseApduResponses(copy, apduResponses);
+        parseApduResponses(cardCommands, apduResponses);
 
     } catch (const CardCommandException& e) {
 
-        throw UnexpectedCommandStatusException(MSG_CARD_COMMAND_ERROR +
-                                               "while processing the response to open session: " +
-                                                e.getCommand().getName() +
-                                                getTransactionAuditDataAsString(),
-                                                std::make_shared<CardCommandException>(e));
+        throw withTransactionAuditData(
+                  UnexpectedCommandStatusException(
+                      MSG_CARD_COMMAND_ERROR +
+                      "while processing the response to open session: " +
+                      e.getCommand().getName(),
+                      std::make_shared<CardCommandException>(e)));
 
     } catch (const InconsistentDataException& e) {
 
-        throw InconsistentDataException(e.getMessage() + getTransactionAuditDataAsString());
+        throw withTransactionAuditData(e);
     }
 
     /* Build the "Digest Init" SAM command from card Open Session */
 
     /* The card KIF/KVC (KVC may be null for card Rev 1.0) */
-    const std::shared_ptr<uint8_t> cardKif = cmdCardOpenSession->getSelectedKif();
-    const std::shared_ptr<uint8_t> cardKvc = cmdCardOpenSession->getSelectedKvc();
+    const Optional<uint8_t> cardKif = cmdCardOpenSession->getSelectedKif();
+    const Optional<uint8_t> cardKvc = cmdCardOpenSession->getSelectedKvc();
 
-    const std::string logCardKif = cardKif != nullptr ? std::to_string(*cardKif) : "null";
-    const std::string logCardKvc = cardKvc != nullptr ? std::to_string(*cardKvc) : "null";
+    const std::string logCardKif = cardKif.isPresent() ? std::to_string(cardKif.get()) : "null";
+    const std::string logCardKvc = cardKvc.isPresent() ? std::to_string(cardKvc.get()) : "null";
 
     mLogger->debug("processAtomicOpening => opening: CARD_CHALLENGE=%, CARD_KIF=%, CARD_KVC=%\n",
                    HexUtil::toHex(cmdCardOpenSession->getCardChallenge()),
                    logCardKif,
                    logCardKvc);
 
-    const std::shared_ptr<uint8_t> kvc =
+    const Optional<uint8_t> kvc =
         mControlSamTransactionManager->computeKvc(mWriteAccessLevel, cardKvc);
-    const std::shared_ptr<uint8_t> kif =
+    const Optional<uint8_t> kif =
         mControlSamTransactionManager->computeKif(mWriteAccessLevel, cardKif, kvc);
 
     if (!mSecuritySetting->isSessionKeyAuthorized(kif, kvc)) {
 
-        const std::string logKif = kif != nullptr ? std::to_string(*kif) : "null";
-        const std::string logKvc = kvc != nullptr ? std::to_string(*kvc) : "null";
+        const std::string logKif = kif.isPresent() ? std::to_string(kif.get()) : "null";
+        const std::string logKvc = kvc.isPresent() ? std::to_string(kvc.get()) : "null";
 
-        throw UnauthorizedKeyException("Unauthorized key error: " \
-                                       "KIF=" + logKif + ", " +
-                                       "KVC=" + logKvc + " " +
-                                       getTransactionAuditDataAsString());
+        throw withTransactionAuditData(
+                  UnauthorizedKeyException("Unauthorized key error: " \
+                                           "KIF=" + logKif + ", " +
+                                           "KVC=" + logKvc));
+    }
+
+    /* C++: fail before any SAM exchange if the key is known to be absent from the control SAM */
+    if (!mControlSamTransactionManager->isKeyAvailable(kif, kvc)) {
+
+        throw withTransactionAuditData(
+                  UnauthorizedKeyException("Key not found in the control SAM: " \
+                                           "KIF=" + std::to_string(kif.get()) + ", " +
+                                           "KVC=" + std::to_string(kvc.get())));
     }
 
     /* Initialize a new SAM session. */
     mControlSamTransactionManager
-        ->initializeSession(apduResponses[0]->getDataOut(), *kif, *kvc, false, false);
+        ->initializeSession(apduResponses[0]->getDataOut(), kif.get(), kvc.get(), false, false);
 
     /*
      * Add all commands data to the digest computation. The first command in the list is the
@@ -316,6 +347,108 @@ void CardTransactionManagerAdapter::processAtomicOpening(
      * we skip it and start the loop at index 1.
      */
     mControlSamTransactionManager->updateSession(apduRequests, apduResponses, 1);
+
+    if (cardImage != nullptr) {
+        processDeferredCommandsWithCardImage(cardImageCache, cardImage, deferredCardCommands);
+    }
+}
+
+void CardTransactionManagerAdapter::processDeferredCommandsWithCardImage(
+    const std::shared_ptr<CardImageCache> cardImageCache,
+    const std::shared_ptr<const CardImageCache::Image> image,
+    std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands)
+{
+    const bool isImageValid = image->isValid(mCard->getTransactionCounter());
+    cardImageCache->notifyLookup(isImageValid);
+
+    if (isImageValid) {
+
+        /*
+         * Serve the record reads from the image until the first modifying command, the following
+         * ones may depend on the modifications. The commands not served are kept in order to be
+         * transmitted together.
+         */
+        int nbServedReads = 0;
+        auto it = cardCommands.begin();
+        while (it != cardCommands.end()) {
+
+            const std::shared_ptr<AbstractCardCommand>& command = *it;
+            if (command->isSessionBufferUsed()) {
+                break;
+            }
+
+            if (command->getCommandRef() == CalypsoCardCommand::READ_RECORDS &&
+                serveReadRecordsFromCardImage(
+                    image, std::static_pointer_cast<CmdCardReadRecords>(command))) {
+                it = cardCommands.erase(it);
+                nbServedReads++;
+            } else {
+                ++it;
+            }
+        }
+
+        mLogger->debug("processDeferredCommandsWithCardImage => % read(s) served from the card " \
+                       "image cache\n",
+                       nbServedReads);
+
+    } else {
+
+        /* Another session took place since the image was taken */
+        cardImageCache->remove(mCard);
+    }
+
+    if (!cardCommands.empty()) {
+        processAtomicCardCommands(cardCommands, ChannelControl::KEEP_OPEN);
+    }
+}
+
+bool CardTransactionManagerAdapter::serveReadRecordsFromCardImage(
+    const std::shared_ptr<const CardImageCache::Image> image,
+    const std::shared_ptr<CmdCardReadRecords> command)
+{
+    const uint8_t sfi = command->getSfi();
+    const uint8_t firstRecordNumber = command->getFirstRecordNumber();
+
+    const std::vector<uint8_t>* firstRecord = image->getRecord(sfi, firstRecordNumber);
+    if (firstRecord == nullptr) {
+        return false;
+    }
+
+    /* In multiple mode, the card returns as many records as fit in the expected length */
+    int nbRecords = 1;
+    if (command->getReadMode() == CmdCardReadRecords::ReadMode::MULTIPLE_RECORD) {
+        nbRecords = command->getRecordSize() / (static_cast<int>(firstRecord->size()) + 2);
+    }
+
+    if (nbRecords < 1 || firstRecordNumber + nbRecords - 1 > 0xFF) {
+        return false;
+    }
+
+    std::vector<const std::vector<uint8_t>*> records;
+    records.reserve(nbRecords);
+    records.push_back(firstRecord);
+
+    for (int i = 1; i < nbRecords; i++) {
+
+        const std::vector<uint8_t>* record =
+            image->getRecord(sfi, static_cast<uint8_t>(firstRecordNumber + i));
+        if (record == nullptr || record->size() != firstRecord->size()) {
+            return false;
+        }
+
+        records.push_back(record);
+    }
+
+    for (int i = 0; i < nbRecords; i++) {
+
+        const uint8_t recordNumber = static_cast<uint8_t>(firstRecordNumber + i);
+        mCard->setContent(sfi, recordNumber, *records[i]);
+
+        /* The image matches the content of the card at the opening of the session */
+        mRecordsReadInSession[sfi].push_back(recordNumber);
+    }
+
+    return true;
 }
 
 void CardTransactionManagerAdapter::abortSecureSessionSilently()
@@ -332,6 +465,9 @@ void CardTransactionManagerAdapter::abortSecureSessionSilently()
                           e.getMessage());
         }
 
+        /* A shared SAM must not remain reserved for the aborted session */
+        releaseControlSamLease();
+
         mIsSessionOpen = false;
     }
 }
@@ -339,21 +475,22 @@ void CardTransactionManagerAdapter::abortSecureSessionSilently()
 CardTransactionManager& CardTransactionManagerAdapter::prepareSetCounter(
     const uint8_t sfi, const uint8_t counterNumber, const int newValue)
 {
-    std::shared_ptr<int> oldValue;
+    Optional<int> oldValue;
 
     const std::shared_ptr<ElementaryFile> ef = mCard->getFileBySfi(sfi);
     if (ef != nullptr) {
 
-        oldValue = ef->getData()->getContentAsCounterValue(counterNumber);
+        oldValue = std::dynamic_pointer_cast<FileDataAdapter>(ef->getData())
+                       ->getCounterValue(counterNumber);
     }
 
-    if (oldValue == nullptr) {
+    if (!oldValue.isPresent()) {
 
         throw IllegalStateException("The value for counter " + std::to_string(counterNumber) +
                                     " in file " + std::to_string(sfi) + " is not available");
     }
 
-    const int delta = newValue - *oldValue;
+    const int delta = newValue - oldValue.get();
     if (delta > 0) {
 
         mLogger->trace("Increment counter % (file %) from % to %\n",
@@ -485,7 +622,7 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareIncreaseOrDecrease
 }
 
 void CardTransactionManagerAdapter::processAtomicCardCommands(
-    const std::vector<std::shared_ptr<AbstractApduCommand>> cardCommands,
+    const std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands,
     const ChannelControl channelControl)
 {
     /* Get the list of C-APDU to transmit */
@@ -514,30 +651,20 @@ void CardTransactionManagerAdapter::processAtomicCardCommands(
 
     try {
 
-        /*
-         * C++: cannot cast std::vector<std::shared_ptr<derived>> into
-         *      std::vector<std::shared_ptr<base>> automatically. Need to copy into another vector.
-         */
-        std::vector<std::shared_ptr<AbstractCardCommand>> copy;
-
-        for (int i = 0; i < static_cast<int>(cardCommands.size()); i++) {
-
-            copy.push_back(std::dynamic_pointer_cast<AbstractCardCommand>(cardCommands[i]));
-        }
-
-        parseApduResponses(copy, apduResponses);
+        parseApduResponses(cardCommands, apduResponses);
 
     } catch (const CardCommandException& e) {
 
-        throw UnexpectedCommandStatusException(MSG_CARD_COMMAND_ERROR +
-                                               "while processing responses to card commands: " +
-                                               e.getCommand().getName() +
-                                               getTransactionAuditDataAsString(),
-                                               std::make_shared<CardCommandException>(e));
+        throw withTransactionAuditData(
+                  UnexpectedCommandStatusException(
+                      MSG_CARD_COMMAND_ERROR +
+                      "while processing responses to card commands: " +
+                      e.getCommand().getName(),
+                      std::make_shared<CardCommandException>(e)));
 
     } catch (const InconsistentDataException& e) {
 
-        throw InconsistentDataException(e.getMessage() + getTransactionAuditDataAsString());
+        throw withTransactionAuditData(e);
     }
 }
 
@@ -570,47 +697,44 @@ void CardTransactionManagerAdapter::parseApduResponses(
 
             commands[i]->parseApduResponse(apduResponses[i]);
 
-        } catch (const CardCommandException& e) {
-
-            const CalypsoCardCommand& commandRef = commands[i]->getCommandRef();
-
-            try {
+            if (mIsSessionOpen) {
+                addRecordsReadInSession(commands[i]);
+            }
 
-                (void)dynamic_cast<const CardDataAccessException&>(e);
+        } catch (const CardDataAccessException& e) {
 
-                if (commandRef == CalypsoCardCommand::READ_RECORDS ||
-                    commandRef == CalypsoCardCommand::READ_RECORD_MULTIPLE ||
-                    commandRef == CalypsoCardCommand::SEARCH_RECORD_MULTIPLE ||
-                    commandRef == CalypsoCardCommand::READ_BINARY) {
+            const CalypsoCardCommand& commandRef = commands[i]->getCommandRef();
 
-                    checkResponseStatusForStrictAndBestEffortMode(commands[i], e);
+            if (commandRef == CalypsoCardCommand::READ_RECORDS ||
+                commandRef == CalypsoCardCommand::READ_RECORD_MULTIPLE ||
+                commandRef == CalypsoCardCommand::SEARCH_RECORD_MULTIPLE ||
+                commandRef == CalypsoCardCommand::READ_BINARY) {
 
-                } else if (commandRef == CalypsoCardCommand::SELECT_FILE) {
+                checkResponseStatusForStrictAndBestEffortMode(commands[i], e);
 
-                    throw SelectFileException("File not found",
-                                              std::make_shared<CardCommandException>(e));
+            } else if (commandRef == CalypsoCardCommand::SELECT_FILE) {
 
-                } else {
+                throw SelectFileException("File not found",
+                                          std::make_shared<CardCommandException>(e));
 
-                    throw UnexpectedCommandStatusException(
-                            MSG_CARD_COMMAND_ERROR +
-                            "while processing responses to card commands: " +
-                            e.getCommand().getName() +
-                            getTransactionAuditDataAsString(),
-                            std::make_shared<CardCommandException>(e));
-                }
+            } else {
 
-            } catch (const std::bad_cast& ex) {
+                throw withTransactionAuditData(
+                          UnexpectedCommandStatusException(
+                              MSG_CARD_COMMAND_ERROR +
+                              "while processing responses to card commands: " +
+                              e.getCommand().getName(),
+                              std::make_shared<CardCommandException>(e)));
+            }
 
-                (void)ex;
+        } catch (const CardCommandException& e) {
 
-                throw UnexpectedCommandStatusException(
+            throw withTransactionAuditData(
+                      UnexpectedCommandStatusException(
                           MSG_CARD_COMMAND_ERROR +
                           "while processing responses to card commands: " +
-                          e.getCommand().getName() +
-                          getTransactionAuditDataAsString(),
-                          std::make_shared<CardCommandException>(e));
-            }
+                          e.getCommand().getName(),
+                          std::make_shared<CardCommandException>(e)));
         }
     }
 
@@ -632,9 +756,12 @@ void CardTransactionManagerAdapter::checkResponseStatusForStrictAndBestEffortMod
     const std::shared_ptr<AbstractCardCommand> command,
     const CardCommandException& e) const
 {
+    /* C++: rethrow the exception being handled to keep its dynamic type */
+    (void)e;
+
     if (mIsSessionOpen) {
 
-        throw e;
+        throw;
 
     } else {
 
@@ -645,13 +772,13 @@ void CardTransactionManagerAdapter::checkResponseStatusForStrictAndBestEffortMod
         if (command->getApduResponse()->getStatusWord() != 0x6A82 &&
             command->getApduResponse()->getStatusWord() != 0x6A83) {
 
-            throw e;
+            throw;
         }
     }
 }
 
 void CardTransactionManagerAdapter::processAtomicClosing(
-    const std::vector<std::shared_ptr<AbstractApduCommand>>& cardCommands,
+    const std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands,
     const bool isRatificationMechanismEnabled,
     const ChannelControl channelControl)
 {
@@ -724,7 +851,8 @@ void CardTransactionManagerAdapter::processAtomicClosing(
         if (!isRatificationCommandAdded ||
             cardResponse == nullptr ||
             cardResponse->getApduResponses().size() != apduRequests.size() - 1) {
-            throw e;
+            /* C++: rethrow as is to keep the dynamic type (e.g. AuditedException) */
+            throw;
         }
     }
 
@@ -748,67 +876,73 @@ void CardTransactionManagerAdapter::processAtomicClosing(
      * commands will be taken into account)
      */
     try {
-        /*
-         * C++: cannot cast std::vector<std::shared_ptr<derived>> into
-         *      std::vector<std::shared_ptr<base>> automatically. Need to copy into another vector.
-         */
-        std::vector<std::shared_ptr<AbstractCardCommand>> copy;
-        for (int i = 0; i < static_cast<int>(cardCommands.size()); i++) {
-
-            copy.push_back(std::dynamic_pointer_cast<AbstractCardCommand>(cardCommands[i]));
-        }
-
-        parseApduResponses(copy, apduResponses);
+        parseApduResponses(cardCommands, apduResponses);
 
     } catch (const CardCommandException& e) {
 
-        throw UnexpectedCommandStatusException(MSG_CARD_COMMAND_ERROR +
-                                               "while processing of responses preceding the close" \
-                                               " of the session: " +
-                                               e.getCommand().getName() +
-                                               getTransactionAuditDataAsString(),
-                                               std::make_shared<CardCommandException>(e));
+        throw withTransactionAuditData(
+                  UnexpectedCommandStatusException(
+                      MSG_CARD_COMMAND_ERROR +
+                      "while processing of responses preceding the close of the session: " +
+                      e.getCommand().getName(),
+                      std::make_shared<CardCommandException>(e)));
 
     } catch (const InconsistentDataException& e) {
 
-        throw InconsistentDataException(e.getMessage() + getTransactionAuditDataAsString());
+        throw withTransactionAuditData(e);
     }
 
 
     mIsSessionOpen = false;
 
-    /* Check the card's response to Close Secure Session */
     try {
 
-        cmdCardCloseSession->parseApduResponse(closeSecureSessionApduResponse);
+        /* Check the card's response to Close Secure Session */
+        try {
 
-    } catch (const CardSecurityDataException& e) {
+            cmdCardCloseSession->parseApduResponse(closeSecureSessionApduResponse);
 
-        throw UnexpectedCommandStatusException("Invalid card session" +
-                                              getTransactionAuditDataAsString(),
-                                              std::make_shared<CardSecurityDataException>(e));
+        } catch (const CardSecurityDataException& e) {
 
-    } catch (const CardCommandException& e) {
+            throw withTransactionAuditData(
+                      UnexpectedCommandStatusException(
+                          "Invalid card session",
+                          std::make_shared<CardSecurityDataException>(e)));
 
-        throw UnexpectedCommandStatusException(MSG_CARD_COMMAND_ERROR +
-                                               "while processing the response to close session: " +
-                                               e.getCommand().getName() +
-                                               getTransactionAuditDataAsString(),
-                                               std::make_shared<CardCommandException>(e));
-    }
+        } catch (const CardCommandException& e) {
 
-    /*
-     * Check the card signature
-     * CL-CSS-MACVERIF.1
-     */
-    processSamDigestAuthenticate(cmdCardCloseSession->getSignatureLo());
+            throw withTransactionAuditData(
+                      UnexpectedCommandStatusException(
+                          MSG_CARD_COMMAND_ERROR +
+                          "while processing the response to close session: " +
+                          e.getCommand().getName(),
+                          std::make_shared<CardCommandException>(e)));
+        }
 
-    /*
-     * If necessary, we check the status of the SV after the session has been successfully closed.
-     * CL-SV-POSTPON.1
-     */
-    if (isSvOperationCompleteOneTime()) {
-        processSamSvCheck(cmdCardCloseSession->getPostponedData()[mSvPostponedDataIndex]);
+        /*
+         * Check the card signature
+         * CL-CSS-MACVERIF.1
+         */
+        processSamDigestAuthenticate(cmdCardCloseSession->getSignatureLo());
+
+        /*
+         * If necessary, we check the status of the SV after the session has been successfully
+         * closed.
+         * CL-SV-POSTPON.1
+         */
+        if (isSvOperationCompleteOneTime()) {
+            processSamSvCheck(cmdCardCloseSession->getPostponedData()[mSvPostponedDataIndex]);
+        }
+
+    } catch (const RuntimeException& e) {
+
+        /*
+         * C++: the session is closed on the card side but the "Digest Authenticate" (or the "SV
+         * Check") command has not been sent, a shared SAM must not remain reserved.
+         */
+        (void)e;
+        releaseControlSamLease();
+        throw;
     }
 }
 
@@ -816,9 +950,10 @@ int CardTransactionManagerAdapter::getCounterValue(const uint8_t sfi, const int
 {
     const std::shared_ptr<ElementaryFile> ef = mCard->getFileBySfi(sfi);
     if (ef != nullptr) {
-        const std::shared_ptr<int> counterValue = ef->getData()->getContentAsCounterValue(counter);
-        if (counterValue != nullptr) {
-            return *counterValue;
+        const Optional<int> counterValue =
+            std::dynamic_pointer_cast<FileDataAdapter>(ef->getData())->getCounterValue(counter);
+        if (counterValue.isPresent()) {
+            return counterValue.get();
         }
     }
 
@@ -872,7 +1007,7 @@ const std::shared_ptr<ApduResponseApi>
     response[3] = 0x90;
     response[4] = 0x00;
 
-    return std::make_shared<ApduResponseAdapter>(response);
+    return std::make_shared<LocalApduResponseAdapter>(response);
 }
 
 const std::shared_ptr<ApduResponseApi>
@@ -904,12 +1039,12 @@ const std::shared_ptr<ApduResponseApi>
     response[index] = 0x90;
     response[index + 1] = 0x00;
 
-    return std::make_shared<ApduResponseAdapter>(response);
+    return std::make_shared<LocalApduResponseAdapter>(response);
 }
 
 const std::vector<std::shared_ptr<ApduResponseApi>>
     CardTransactionManagerAdapter::buildAnticipatedResponses(
-        const std::vector<std::shared_ptr<AbstractApduCommand>>& cardCommands)
+        const std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands)
 {
     std::vector<std::shared_ptr<ApduResponseApi>> apduResponses;
 
@@ -917,11 +1052,12 @@ const std::vector<std::shared_ptr<ApduResponseApi>>
 
         for (const auto& command : cardCommands) {
 
-            auto& commandRef = dynamic_cast<const CalypsoCardCommand&>(command->getCommandRef());
+            /* The command reference identifies the command class */
+            const CalypsoCardCommand& commandRef = command->getCommandRef();
             if (commandRef == CalypsoCardCommand::INCREASE ||
                 commandRef == CalypsoCardCommand::DECREASE) {
 
-                auto cmdA = std::dynamic_pointer_cast<CmdCardIncreaseOrDecrease>(command);
+                auto cmdA = std::static_pointer_cast<CmdCardIncreaseOrDecrease>(command);
 
                 const std::vector<uint8_t> anticipatedValue =
                     buildAnticipatedIncreaseDecreaseResponseData(
@@ -944,7 +1080,7 @@ const std::vector<std::shared_ptr<ApduResponseApi>>
             } else if (commandRef == CalypsoCardCommand::INCREASE_MULTIPLE ||
                        commandRef == CalypsoCardCommand::DECREASE_MULTIPLE) {
 
-                auto cmdB = std::dynamic_pointer_cast<CmdCardIncreaseOrDecreaseMultiple>(command);
+                auto cmdB = std::static_pointer_cast<CmdCardIncreaseOrDecreaseMultiple>(command);
                 const std::map<const int, const int>& counterNumberToIncDecValueMap =
                     cmdB->getCounterNumberToIncDecValueMap();
                 apduResponses.push_back(
@@ -978,24 +1114,24 @@ CardTransactionManager& CardTransactionManagerAdapter::processOpening(
 {
     try {
         checkNoSession();
+        checkNoPreparedPinCommand();
 
         /* CL-KEY-INDEXPO.1 */
         mWriteAccessLevel = writeAccessLevel;
 
         /* Create a sublist of AbstractCardCommand to be sent atomically */
-        std::vector<std::shared_ptr<AbstractApduCommand>> cardAtomicCommands;
+        std::vector<std::shared_ptr<AbstractCardCommand>> cardAtomicCommands;
 
-        for (const auto& apduCommand : mCardCommands) {
+        for (const auto& command : mCardCommands) {
 
-            const auto& command = std::dynamic_pointer_cast<AbstractCardCommand>(apduCommand);
             if (command->getCommandRef() == CalypsoCardCommand::GET_DATA
              ||command->getCommandRef() == CalypsoCardCommand::READ_RECORD_MULTIPLE
              ||command->getCommandRef() == CalypsoCardCommand::SEARCH_RECORD_MULTIPLE) {
               throw IllegalStateException("Command not allowed in secure session.");
             }
             if (command->getCommandRef() == CalypsoCardCommand::READ_RECORDS
-             && std::dynamic_pointer_cast<CmdCardReadRecords>(command)->getSfi() != 0
-             && std::dynamic_pointer_cast<CmdCardReadRecords>(command)->getRecordSize() == -1) {
+             && std::static_pointer_cast<CmdCardReadRecords>(command)->getSfi() != 0
+             && std::static_pointer_cast<CmdCardReadRecords>(command)->getRecordSize() == -1) {
               throw IllegalStateException("Explicit record size is expected inside a secure session.");
             }
             /* Check if the command is a modifying command */
@@ -1006,7 +1142,7 @@ CardTransactionManager& CardTransactionManagerAdapter::processOpening(
 
                     /* Process and intermedisate secure session with the current commands */
                     processAtomicOpening(cardAtomicCommands);
-                    std::vector<std::shared_ptr<AbstractApduCommand>> empty;
+                    std::vector<std::shared_ptr<AbstractCardCommand>> empty;
                     processAtomicClosing(empty, false, ChannelControl::KEEP_OPEN);
 
                     /* Reset and update the buffer counter */
@@ -1047,16 +1183,21 @@ void CardTransactionManagerAdapter::checkMultipleSessionEnabled(
      * CL-CSS-INFOCSS.1
      */
     if (!mSecuritySetting->isMultipleSessionEnabled()) {
-        throw SessionBufferOverflowException("ATOMIC mode error! This command would overflow the " \
-                                             "card modifications buffer: " +
-                                             command->getName() +
-                                             getTransactionAuditDataAsString());
+        throw withTransactionAuditData(
+                  SessionBufferOverflowException("ATOMIC mode error! This command would " \
+                                                 "overflow the card modifications buffer: " +
+                                                 command->getName()));
     }
 }
 
 void CardTransactionManagerAdapter::processCommandsOutsideSession(
     const ChannelControl channelControl)
 {
+    /* Ciphered PIN command: the commands prepared before it are sent with the Get Challenge */
+    if (mPinCommandIndex >= 0) {
+        processPreparedPinCommand();
+    }
+
     /* Card commands sent outside a Secure Session. No modifications buffer limitation */
     processAtomicCardCommands(mCardCommands, channelControl);
 
@@ -1077,12 +1218,11 @@ void CardTransactionManagerAdapter::processCommandsInsideSession()
 {
     try {
         /* A session is open, we have to care about the card modifications buffer */
-        std::vector<std::shared_ptr<AbstractApduCommand>> cardAtomicCommands;
+        std::vector<std::shared_ptr<AbstractCardCommand>> cardAtomicCommands;
         bool isAtLeastOneReadCommand = false;
 
-        for (const auto& apduCommand : mCardCommands) {
+        for (const auto& command : mCardCommands) {
 
-            const auto& command = std::dynamic_pointer_cast<AbstractCardCommand>(apduCommand);
 
             /* Check if the command is a modifying command */
             if (command->isSessionBufferUsed()) {
@@ -1099,7 +1239,7 @@ void CardTransactionManagerAdapter::processCommandsInsideSession()
                     }
 
                     processAtomicClosing(cardAtomicCommands, false, ChannelControl::KEEP_OPEN);
-                    std::vector<std::shared_ptr<AbstractApduCommand>> empty;
+                    std::vector<std::shared_ptr<AbstractCardCommand>> empty;
                     processAtomicOpening(empty);
 
                     /* Reset and update the buffer counter */
@@ -1125,8 +1265,10 @@ void CardTransactionManagerAdapter::processCommandsInsideSession()
         processSamPreparedCommands();
 
     } catch (const RuntimeException& e) {
+        /* C++: rethrow as is to keep the dynamic type (e.g. AuditedException) */
+        (void)e;
         abortSecureSessionSilently();
-        throw e;
+        throw;
     }
 }
 
@@ -1164,6 +1306,11 @@ CardTransactionManager& CardTransactionManagerAdapter::processCommands()
         processCommandsOutsideSession(mChannelControl);
     }
 
+    if (mFileHeaderCache != nullptr) {
+        mFileHeaderCache->put(mCard, mIsFileListPrepared);
+    }
+    mIsFileListPrepared = false;
+
     return *this;
 }
 
@@ -1178,12 +1325,11 @@ CardTransactionManager& CardTransactionManagerAdapter::processClosing()
         checkSession();
         finalizeSvCommandIfNeeded();
 
-        std::vector<std::shared_ptr<AbstractApduCommand>> cardAtomicCommands;
+        std::vector<std::shared_ptr<AbstractCardCommand>> cardAtomicCommands;
         bool isAtLeastOneReadCommand = false;
 
-        for (const auto& apduCommand : mCardCommands) {
+        for (const auto& command : mCardCommands) {
 
-            const auto& command = std::dynamic_pointer_cast<AbstractCardCommand>(apduCommand);
 
             /* Check if the command is a modifying command */
             if (command->isSessionBufferUsed()) {
@@ -1201,7 +1347,7 @@ CardTransactionManager& CardTransactionManagerAdapter::processClosing()
                     }
 
                     processAtomicClosing(cardAtomicCommands, false, ChannelControl::KEEP_OPEN);
-                    std::vector<std::shared_ptr<AbstractApduCommand>> empty;
+                    std::vector<std::shared_ptr<AbstractCardCommand>> empty;
                     processAtomicOpening(empty);
 
                    /* Reset and update the buffer counter */
@@ -1229,6 +1375,11 @@ CardTransactionManager& CardTransactionManagerAdapter::processClosing()
                              mSecuritySetting->isRatificationMechanismEnabled(),
                              mChannelControl);
 
+        /* Keep an image of the card for the next session opening */
+        if (mSecuritySetting->getCardImageCache() != nullptr) {
+            mSecuritySetting->getCardImageCache()->put(mCard);
+        }
+
         /* Sets the flag indicating that the commands have been executed */
         notifyCommandsProcessed();
 
@@ -1245,6 +1396,9 @@ CardTransactionManager& CardTransactionManagerAdapter::processCancel()
 {
     checkSession();
 
+    /* The session ends without "Digest Authenticate": a shared SAM is no longer reserved */
+    releaseControlSamLease();
+
     mCard->restoreFiles();
 
     /* Build the card Close Session command (in "abort" mode since no signature is provided) */
@@ -1263,11 +1417,12 @@ CardTransactionManager& CardTransactionManagerAdapter::processCancel()
     try {
         cmdCardCloseSession->parseApduResponse(cardResponse->getApduResponses()[0]);
     } catch (const CardCommandException& e) {
-        throw UnexpectedCommandStatusException(MSG_CARD_COMMAND_ERROR +
-                                               "while processing the response to close session: " +
-                                               e.getCommand().getName() +
-                                               getTransactionAuditDataAsString(),
-                                               std::make_shared<CardCommandException>(e));
+        throw withTransactionAuditData(
+                  UnexpectedCommandStatusException(
+                      MSG_CARD_COMMAND_ERROR +
+                      "while processing the response to close session: " +
+                      e.getCommand().getName(),
+                      std::make_shared<CardCommandException>(e)));
     }
 
     /* Sets the flag indicating that the commands have been executed */
@@ -1294,6 +1449,8 @@ CardTransactionManager& CardTransactionManagerAdapter::processVerifyPin(
             throw UnsupportedOperationException(MSG_PIN_NOT_AVAILABLE);
         }
 
+        checkNoPreparedPinCommand();
+
         if (!mCardCommands.empty()) {
 
             throw IllegalStateException("No commands should have been prepared prior to a PIN " \
@@ -1348,8 +1505,10 @@ CardTransactionManager& CardTransactionManagerAdapter::processVerifyPin(
 
     } catch (const RuntimeException& e) {
 
+        /* C++: rethrow as is to keep the dynamic type (e.g. AuditedException) */
+        (void)e;
         abortSecureSessionSilently();
-        throw e;
+        throw;
 
     }
 }
@@ -1365,6 +1524,125 @@ const std::vector<uint8_t> CardTransactionManagerAdapter::processSamCardCipherPi
     return cmdSamCardCipherPin->getCipheredData();
 }
 
+CardTransactionManagerAdapter& CardTransactionManagerAdapter::prepareVerifyPin(
+    const std::vector<uint8_t>& pin)
+{
+    Assert::getInstance().isEqual(pin.size(), CalypsoCardConstant::PIN_LENGTH, "PIN length");
+
+    preparePinCommand(pin, std::vector<uint8_t>());
+
+    return *this;
+}
+
+CardTransactionManagerAdapter& CardTransactionManagerAdapter::prepareChangePin(
+    const std::vector<uint8_t>& newPin)
+{
+    Assert::getInstance().isEqual(newPin.size(), CalypsoCardConstant::PIN_LENGTH, "PIN length");
+
+    /* All zeros as required */
+    preparePinCommand(std::vector<uint8_t>(4), newPin);
+
+    return *this;
+}
+
+void CardTransactionManagerAdapter::preparePinCommand(const std::vector<uint8_t>& currentPin,
+                                                      const std::vector<uint8_t>& newPin)
+{
+    if (!mCard->isPinFeatureAvailable()) {
+
+        throw UnsupportedOperationException(MSG_PIN_NOT_AVAILABLE);
+    }
+
+    if (mIsSessionOpen) {
+
+        throw IllegalStateException("PIN commands cannot be prepared when a secure session is " \
+                                    "open.");
+    }
+
+    checkNoPreparedPinCommand();
+
+    const bool isChangePin = !newPin.empty();
+
+    /* CL-PIN-PENCRYPT.1, CL-PIN-MENCRYPT.1 */
+    if (mSecuritySetting == nullptr || mSecuritySetting->isPinPlainTransmissionEnabled()) {
+
+        if (!isChangePin) {
+
+            mCardCommands.push_back(std::make_shared<CmdCardVerifyPin>(mCard, false, currentPin));
+
+        } else if (mCard->getPinAttemptRemaining() >= 0) {
+
+            mCardCommands.push_back(std::make_shared<CmdCardChangePin>(mCard, newPin));
+        }
+
+        return;
+    }
+
+    checkControlSam();
+
+    /* CL-PIN-GETCHAL.1 */
+    mCardCommands.push_back(std::make_shared<CmdCardGetChallenge>(mCard));
+
+    mPinCommandIndex = static_cast<int>(mCardCommands.size());
+    mPinCurrentValue = currentPin;
+    mPinNewValue = newPin;
+}
+
+void CardTransactionManagerAdapter::processPreparedPinCommand()
+{
+    /* The PIN values are wiped whatever the result of the processing (finally) */
+    struct PinValuesWiper final {
+        std::vector<uint8_t>& mCurrentPin;
+        std::vector<uint8_t>& mNewPin;
+
+        ~PinValuesWiper()
+        {
+            std::fill(mCurrentPin.begin(), mCurrentPin.end(), 0);
+            mCurrentPin.clear();
+            std::fill(mNewPin.begin(), mNewPin.end(), 0);
+            mNewPin.clear();
+        }
+    } pinValuesWiper = {mPinCurrentValue, mPinNewValue};
+
+    const std::vector<std::shared_ptr<AbstractCardCommand>> challengeCommands(
+        mCardCommands.begin(), mCardCommands.begin() + mPinCommandIndex);
+    std::vector<std::shared_ptr<AbstractCardCommand>> pinCommands(
+        mCardCommands.begin() + mPinCommandIndex, mCardCommands.end());
+
+    const bool isChangePin = !mPinNewValue.empty();
+
+    /*
+     * The PIN command and the commands prepared with it are consumed whatever the result of their
+     * processing: none of them must be sent again by a next processing, without the PIN command.
+     */
+    mPinCommandIndex = -1;
+    mCardCommands.clear();
+
+    /* Transmit and receive data with the card */
+    processAtomicCardCommands(challengeCommands, ChannelControl::KEEP_OPEN);
+
+    /* Get the encrypted PIN with the help of the SAM */
+    const std::vector<uint8_t> cipheredData = processSamCardCipherPin(mPinCurrentValue,
+                                                                      mPinNewValue);
+
+    if (isChangePin) {
+        pinCommands.insert(pinCommands.begin(),
+                           std::make_shared<CmdCardChangePin>(mCard, cipheredData));
+    } else {
+        pinCommands.insert(pinCommands.begin(),
+                           std::make_shared<CmdCardVerifyPin>(mCard, true, cipheredData));
+    }
+
+    mCardCommands = pinCommands;
+}
+
+void CardTransactionManagerAdapter::checkNoPreparedPinCommand() const
+{
+    if (mPinCommandIndex >= 0) {
+        throw IllegalStateException("A PIN command is prepared and not yet processed.");
+    }
+}
+
 CardTransactionManager& CardTransactionManagerAdapter::processChangePin(
     const std::vector<uint8_t>& newPin)
 {
@@ -1382,6 +1660,8 @@ CardTransactionManager& CardTransactionManagerAdapter::processChangePin(
             throw IllegalStateException("'Change PIN' not allowed when a secure session is open.");
         }
 
+        checkNoPreparedPinCommand();
+
         finalizeSvCommandIfNeeded();
 
         /* CL-PIN-MENCRYPT.1 */
@@ -1423,8 +1703,10 @@ CardTransactionManager& CardTransactionManagerAdapter::processChangePin(
 
     } catch (const RuntimeException& e) {
 
+        /* C++: rethrow as is to keep the dynamic type (e.g. AuditedException) */
+        (void)e;
         abortSecureSessionSilently();
-        throw e;
+        throw;
     }
 }
 
@@ -1433,6 +1715,12 @@ CardTransactionManager& CardTransactionManagerAdapter::processChangeKey(const ui
                                                                         const uint8_t newKvc,
                                                                         const uint8_t issuerKif,
                                                                         const uint8_t issuerKvc)
+{
+    return processChangeKeys({{keyIndex, newKif, newKvc, issuerKif, issuerKvc}});
+}
+
+CardTransactionManagerAdapter& CardTransactionManagerAdapter::processChangeKeys(
+    const std::vector<KeyChange>& keyChanges)
 {
     if (mCard->getProductType() == CalypsoCard::ProductType::BASIC) {
 
@@ -1445,26 +1733,46 @@ CardTransactionManager& CardTransactionManagerAdapter::processChangeKey(const ui
         throw IllegalStateException("'Change Key' not allowed when a secure session is open.");
     }
 
-    Assert::getInstance().isInRange(keyIndex, 1, 3, "keyIndex");
+    Assert::getInstance().isTrue(!keyChanges.empty(), "key changes are not empty");
+
+    for (const auto& keyChange : keyChanges) {
+
+        Assert::getInstance().isInRange(keyChange.mKeyIndex, 1, 3, "keyIndex");
+    }
+
+    checkNoPreparedPinCommand();
 
     finalizeSvCommandIfNeeded();
 
     /* CL-KEY-CHANGE.1 */
     mCardCommands.push_back(std::make_shared<CmdCardGetChallenge>(mCard));
 
-    /* Transmit and receive data with the card */
-    processAtomicCardCommands(mCardCommands, ChannelControl::KEEP_OPEN);
+    for (int i = 0; i < static_cast<int>(keyChanges.size()); i++) {
 
-    /* Sets the flag indicating that the commands have been executed */
-    notifyCommandsProcessed();
+        const KeyChange& keyChange = keyChanges[i];
+
+        /* Transmit and receive data with the card */
+        processAtomicCardCommands(mCardCommands, ChannelControl::KEEP_OPEN);
+
+        /* Sets the flag indicating that the commands have been executed */
+        notifyCommandsProcessed();
+
+        /* Get the encrypted key with the help of the SAM */
+        const std::vector<uint8_t> encryptedKey = processSamCardGenerateKey(keyChange.mIssuerKif,
+                                                                            keyChange.mIssuerKvc,
+                                                                            keyChange.mNewKif,
+                                                                            keyChange.mNewKvc);
+
+        mCardCommands.push_back(std::make_shared<CmdCardChangeKey>(mCard,
+                                                                   keyChange.mKeyIndex,
+                                                                   encryptedKey));
 
-    /* Get the encrypted key with the help of the SAM */
-    const std::vector<uint8_t> encryptedKey = processSamCardGenerateKey(issuerKif,
-                                                                        issuerKvc,
-                                                                        newKif,
-                                                                        newKvc);
+        /* The challenge of the next key is requested along with the current key change */
+        if (i + 1 < static_cast<int>(keyChanges.size())) {
 
-    mCardCommands.push_back(std::make_shared<CmdCardChangeKey>(mCard, keyIndex, encryptedKey));
+            mCardCommands.push_back(std::make_shared<CmdCardGetChallenge>(mCard));
+        }
+    }
 
     /* Transmit and receive data with the card */
     processAtomicCardCommands(mCardCommands, mChannelControl);
@@ -1492,30 +1800,50 @@ const std::shared_ptr<CardResponseApi> CardTransactionManagerAdapter::transmitCa
     /* Process card request */
     std::shared_ptr<CardResponseApi> cardResponse = nullptr;
 
+    mCardExchangeCount++;
+
+    renewControlSamLease();
+
     try {
         cardResponse = mCardReader->transmitCardRequest(cardRequest, channelControl);
     } catch (const ReaderBrokenCommunicationException& e) {
         saveTransactionAuditData(cardRequest, e.getCardResponse());
-        throw ReaderIOException(MSG_CARD_READER_COMMUNICATION_ERROR +
-                                MSG_WHILE_TRANSMITTING_COMMANDS +
-                                getTransactionAuditDataAsString(),
-                                std::make_shared<ReaderBrokenCommunicationException>(e));
+        throw withTransactionAuditData(
+                  ReaderIOException(MSG_CARD_READER_COMMUNICATION_ERROR +
+                                    MSG_WHILE_TRANSMITTING_COMMANDS,
+                                    std::make_shared<ReaderBrokenCommunicationException>(e)));
     } catch (const CardBrokenCommunicationException& e) {
         saveTransactionAuditData(cardRequest, e.getCardResponse());
-        throw CardIOException(MSG_CARD_COMMUNICATION_ERROR +
-                              MSG_WHILE_TRANSMITTING_COMMANDS +
-                              getTransactionAuditDataAsString(),
-                              std::make_shared<CardBrokenCommunicationException>(e));
+        throw withTransactionAuditData(
+                  CardIOException(MSG_CARD_COMMUNICATION_ERROR +
+                                  MSG_WHILE_TRANSMITTING_COMMANDS,
+                                  std::make_shared<CardBrokenCommunicationException>(e)));
     } catch (const UnexpectedStatusWordException& e) {
         mLogger->debug("A card command has failed: %\n", e.getMessage());
         cardResponse = e.getCardResponse();
     }
 
+    renewControlSamLease();
+
     saveTransactionAuditData(cardRequest, cardResponse);
 
     return cardResponse;
 }
 
+void CardTransactionManagerAdapter::renewControlSamLease() const
+{
+    if (mControlSamScheduler != nullptr) {
+        mControlSamScheduler->renewLease();
+    }
+}
+
+void CardTransactionManagerAdapter::releaseControlSamLease() const
+{
+    if (mControlSamScheduler != nullptr) {
+        mControlSamScheduler->releaseLease();
+    }
+}
+
 void CardTransactionManagerAdapter::finalizeSvCommandIfNeeded()
 {
     if (mSvLastModifyingCommand == nullptr) {
@@ -1527,7 +1855,7 @@ void CardTransactionManagerAdapter::finalizeSvCommandIfNeeded()
     if (mSvLastModifyingCommand->getCommandRef() == CalypsoCardCommand::SV_RELOAD) {
 
         /* SV RELOAD: get the security data from the SAM. */
-        auto svCommand = std::dynamic_pointer_cast<CmdCardSvReload>(mSvLastModifyingCommand);
+        auto svCommand = std::static_pointer_cast<CmdCardSvReload>(mSvLastModifyingCommand);
 
         svComplementaryData = processSamSvPrepareLoad(mCard->getSvGetHeader(),
                                                       mCard->getSvGetData(),
@@ -1539,7 +1867,7 @@ void CardTransactionManagerAdapter::finalizeSvCommandIfNeeded()
     } else {
 
         /* SV DEBIT/UNDEBIT: get the security data from the SAM. */
-        auto svCommand = std::dynamic_pointer_cast<CmdCardSvDebitOrUndebit>(mSvLastModifyingCommand);
+        auto svCommand = std::static_pointer_cast<CmdCardSvDebitOrUndebit>(mSvLastModifyingCommand);
 
         svComplementaryData = processSamSvPrepareDebitOrUndebit(
                                   svCommand->getCommandRef() == CalypsoCardCommand::SV_DEBIT,
@@ -1619,6 +1947,16 @@ void CardTransactionManagerAdapter::processSamSvCheck(const std::vector<uint8_t>
 
 const std::vector<uint8_t> CardTransactionManagerAdapter::processSamGetChallenge()
 {
+    if (mSecuritySetting->isSamChallengePrefetchEnabled()) {
+        const std::vector<uint8_t> prefetchedChallenge =
+            mControlSamTransactionManager->takePrefetchedChallenge();
+        if (!prefetchedChallenge.empty()) {
+            mLogger->debug("SAM_CHALLENGE=% (prefetched)\n", HexUtil::toHex(prefetchedChallenge));
+
+            return prefetchedChallenge;
+        }
+    }
+
     const std::shared_ptr<CmdSamGetChallenge> cmdSamGetChallenge =
         mControlSamTransactionManager->prepareGetChallenge();
     mControlSamTransactionManager->processCommands();
@@ -1646,6 +1984,10 @@ void CardTransactionManagerAdapter::processSamDigestAuthenticate(
 {
     mControlSamTransactionManager->prepareDigestAuthenticate(cardSignature);
 
+    if (mSecuritySetting->isSamChallengePrefetchEnabled()) {
+        mControlSamTransactionManager->prepareChallengePrefetch();
+    }
+
     try {
         mControlSamTransactionManager->processCommands();
     } catch (const ReaderIOException& e) {
@@ -1739,7 +2081,11 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareGetData(const GetD
             break;
 
         case GetDataTag::EF_LIST:
-            mCardCommands.push_back(std::make_shared<CmdCardGetDataEfList>(mCard));
+            /* C++: the file headers are already known from the file header cache */
+            if (!mIsFileListCached) {
+                mCardCommands.push_back(std::make_shared<CmdCardGetDataEfList>(mCard));
+                mIsFileListPrepared = true;
+            }
             break;
 
         case GetDataTag::TRACEABILITY_INFORMATION:
@@ -1825,58 +2171,16 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareReadRecords(
                                      CalypsoCardConstant::NB_REC_MAX,
                                      "toRecordNumber");
 
-    if (toRecordNumber == fromRecordNumber) {
-
-        /* Create the command and add it to the list of commands */
+    for (const auto& chunk : CmdCardReadRecords::splitRecords(fromRecordNumber,
+                                                              toRecordNumber,
+                                                              recordSize,
+                                                              mCard->getPayloadCapacity())) {
         mCardCommands.push_back(
             std::make_shared<CmdCardReadRecords>(mCard,
                                                  sfi,
-                                                 fromRecordNumber,
-                                                 CmdCardReadRecords::ReadMode::ONE_RECORD,
-                                                 recordSize));
-
-    } else {
-
-        /*
-         * Manages the reading of multiple records taking into account the transmission capacity
-         * of the card and the response format (2 extra bytes).
-         * Multiple APDUs can be generated depending on record size and transmission capacity.
-         */
-        const uint8_t nbBytesPerRecord = recordSize + 2;
-        const uint8_t nbRecordsPerApdu =
-            static_cast<uint8_t>(mCard->getPayloadCapacity() / nbBytesPerRecord);
-        const uint8_t dataSizeMaxPerApdu = nbRecordsPerApdu * nbBytesPerRecord;
-
-        uint8_t currentRecordNumber = fromRecordNumber;
-        uint8_t nbRecordsRemainingToRead = toRecordNumber - fromRecordNumber + 1;
-        uint8_t currentLength;
-
-        while (currentRecordNumber < toRecordNumber) {
-            currentLength = nbRecordsRemainingToRead <= nbRecordsPerApdu ?
-                                nbRecordsRemainingToRead * nbBytesPerRecord :
-                                dataSizeMaxPerApdu;
-
-            mCardCommands.push_back(
-                std::make_shared<CmdCardReadRecords>(mCard,
-                                                     sfi,
-                                                     currentRecordNumber,
-                                                     CmdCardReadRecords::ReadMode::MULTIPLE_RECORD,
-                                                     currentLength));
-
-            currentRecordNumber += (currentLength / nbBytesPerRecord);
-            nbRecordsRemainingToRead -= (currentLength / nbBytesPerRecord);
-        }
-
-        /* Optimization: prepare a read "one record" if possible for last iteration.*/
-        if (currentRecordNumber == toRecordNumber) {
-
-            mCardCommands.push_back(
-                std::make_shared<CmdCardReadRecords>(mCard,
-                                                     sfi,
-                                                     currentRecordNumber,
-                                                     CmdCardReadRecords::ReadMode::ONE_RECORD,
-                                                     recordSize));
-        }
+                                                 chunk.mFirstRecordNumber,
+                                                 chunk.mReadMode,
+                                                 chunk.mExpectedLength));
     }
 
     return *this;
@@ -1971,13 +2275,44 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareReadBinary(
         mCardCommands.push_back(std::make_shared<CmdCardReadBinary>(mCard, sfi, 0, 1));
     }
 
-    const int payloadCapacity = mCard->getPayloadCapacity();
+    addReadBinaryCommands(sfi, offset, nbBytesToRead);
 
-    int currentLength;
-    int currentOffset = offset;
-    int nbBytesRemainingToRead = nbBytesToRead;
+    return *this;
+}
 
-    do {
+CardTransactionManagerAdapter& CardTransactionManagerAdapter::prepareReadBinaryRanges(
+    const uint8_t sfi, const std::vector<std::pair<int, int>>& ranges)
+{
+    Assert::getInstance().isTrue(!ranges.empty(), "ranges");
+
+    /* The first range selects the file if needed */
+    prepareReadBinary(sfi, ranges[0].first, ranges[0].second);
+
+    for (size_t i = 1; i < ranges.size(); i++) {
+
+        Assert::getInstance().isInRange(ranges[i].first,
+                                        ranges[i - 1].first + ranges[i - 1].second,
+                                        CalypsoCardConstant::OFFSET_BINARY_MAX,
+                                        OFFSET)
+                             .greaterOrEqual(ranges[i].second, 1, "nbBytesToRead");
+
+        addReadBinaryCommands(sfi, ranges[i].first, ranges[i].second);
+    }
+
+    return *this;
+}
+
+void CardTransactionManagerAdapter::addReadBinaryCommands(const uint8_t sfi,
+                                                          const int offset,
+                                                          const int nbBytesToRead)
+{
+    const int payloadCapacity = mCard->getPayloadCapacity();
+
+    int currentLength;
+    int currentOffset = offset;
+    int nbBytesRemainingToRead = nbBytesToRead;
+
+    do {
 
         currentLength = std::min(nbBytesRemainingToRead, payloadCapacity);
         mCardCommands.push_back(
@@ -1987,8 +2322,6 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareReadBinary(
         nbBytesRemainingToRead -= currentLength;
 
     } while (nbBytesRemainingToRead > 0);
-
-    return *this;
 }
 
 CardTransactionManager& CardTransactionManagerAdapter::prepareReadCounter(
@@ -2000,6 +2333,15 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareReadCounter(
 CardTransactionManager& CardTransactionManagerAdapter::prepareSearchRecords(
     const std::shared_ptr<SearchCommandData> data)
 {
+    /* C++: search on the card image if possible */
+    if (mIsLocalSearchEnabled) {
+
+        auto dataAdapter = std::dynamic_pointer_cast<SearchCommandDataAdapter>(data);
+        if (dataAdapter != nullptr && searchRecordsLocally(dataAdapter)) {
+            return *this;
+        }
+    }
+
     if (mCard->getProductType() != CalypsoCard::ProductType::PRIME_REVISION_3) {
 
         throw UnsupportedOperationException("The 'Search Record Multiple' command is not " \
@@ -2073,6 +2415,10 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareUpdateRecord(
                                     CalypsoCardConstant::NB_REC_MAX,
                                     RECORD_NUMBER);
 
+    if (isRecordUnchanged(false, sfi, recordNumber, recordData)) {
+        return *this;
+    }
+
     /* Create the command and add it to the list of commands */
     mCardCommands.push_back(
         std::make_shared<CmdCardUpdateRecord>(mCard, sfi, recordNumber, recordData));
@@ -2094,6 +2440,10 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareWriteRecord(
                                      CalypsoCardConstant::NB_REC_MAX,
                                      RECORD_NUMBER);
 
+    if (isRecordUnchanged(true, sfi, recordNumber, recordData)) {
+        return *this;
+    }
+
     /* Create the command and add it to the list of commands */
     mCardCommands.push_back(
         std::make_shared<CmdCardWriteRecord>(mCard, sfi, recordNumber, recordData));
@@ -2146,37 +2496,93 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareUpdateOrWriteBinar
                                     OFFSET)
                          .notEmpty(data, "data");
 
-    if (sfi > 0 && offset > 255) {
+    const uint8_t dataLength = static_cast<uint8_t>(data.size());
+    const uint8_t payloadCapacity = mCard->getPayloadCapacity();
 
-        /* Tips to select the file: add a "Read Binary" command (read one byte at offset 0) */
-        mCardCommands.push_back(std::make_shared<CmdCardReadBinary>(mCard, sfi, 0, 1));
+    /* Number of commands needed to send all the data */
+    const int nbCommands = (dataLength + payloadCapacity - 1) / payloadCapacity +
+                           (sfi > 0 && offset > 255 ? 1 : 0);
+
+    /* Ranges of data to send, all the data by default */
+    std::vector<std::pair<int, int>> ranges(1, std::make_pair(0, static_cast<int>(dataLength)));
+
+    const std::shared_ptr<FileDataAdapter> fileData = getFileDataForDifferentialWrite(sfi);
+    if (fileData != nullptr) {
+
+        const auto& records = fileData->getAllRecordsContent();
+        const auto record = records.find(1);
+
+        if (record != records.end() &&
+            static_cast<int>(record->second.size()) >= offset + dataLength) {
+
+            ranges = computeChangedRanges(!isUpdateCommand,
+                                          *fileData,
+                                          record->second,
+                                          offset,
+                                          data);
+
+            int nbRangeCommands = 0;
+            for (const auto& range : ranges) {
+                nbRangeCommands +=
+                    (range.second - range.first + payloadCapacity - 1) / payloadCapacity;
+            }
+
+            /* Do not send more commands than needed for all the data */
+            if (nbRangeCommands > nbCommands) {
+                ranges = std::vector<std::pair<int, int>>(
+                             1, std::make_pair(ranges.front().first, ranges.back().second));
+            }
+        }
     }
 
-    const uint8_t dataLength = static_cast<uint8_t>(data.size());
-    const uint8_t payloadCapacity = mCard->getPayloadCapacity();
+    const size_t nbCommandsBefore = mCardCommands.size();
+    int nbSentBytes = 0;
 
-    int currentLength;
-    int currentOffset = offset;
-    int currentIndex = 0;
+    for (const auto& range : ranges) {
 
-    do {
+        if (sfi > 0 && offset + range.first > 255 && nbCommandsBefore == mCardCommands.size()) {
 
-        currentLength = static_cast<uint8_t>(
-                            std::min(static_cast<int>(dataLength - currentIndex),
-                                     static_cast<int>(payloadCapacity)));
+            /* Tips to select the file: add a "Read Binary" command (read one byte at offset 0) */
+            mCardCommands.push_back(std::make_shared<CmdCardReadBinary>(mCard, sfi, 0, 1));
+        }
 
-        mCardCommands.push_back(
-            std::make_shared<CmdCardUpdateOrWriteBinary>(
-                isUpdateCommand,
-                mCard,
-                sfi,
-                currentOffset,
-                Arrays::copyOfRange(data, currentIndex, currentIndex + currentLength)));
+        int currentLength;
+        int currentOffset = offset + range.first;
+        int currentIndex = range.first;
 
-        currentOffset += currentLength;
-        currentIndex += currentLength;
+        do {
+
+            currentLength = static_cast<uint8_t>(
+                                std::min(static_cast<int>(range.second - currentIndex),
+                                         static_cast<int>(payloadCapacity)));
 
-    } while (currentIndex < dataLength);
+            mCardCommands.push_back(
+                std::make_shared<CmdCardUpdateOrWriteBinary>(
+                    isUpdateCommand,
+                    mCard,
+                    sfi,
+                    currentOffset,
+                    Arrays::copyOfRange(data, currentIndex, currentIndex + currentLength)));
+
+            currentOffset += currentLength;
+            currentIndex += currentLength;
+
+        } while (currentIndex < range.second);
+
+        nbSentBytes += range.second - range.first;
+    }
+
+    if (nbSentBytes < dataLength) {
+
+        mSavedWriteApduCount += nbCommands - static_cast<int>(mCardCommands.size() -
+                                                              nbCommandsBefore);
+        mSavedWriteByteCount += dataLength - nbSentBytes;
+
+        mLogger->debug("Differential write of binary file %: % byte(s) sent out of %\n",
+                       sfi,
+                       nbSentBytes,
+                       dataLength);
+    }
 
     return *this;
 }
@@ -2375,7 +2781,7 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareSvDebit(const int
     return *this;
 }
 
-CardTransactionManager& CardTransactionManagerAdapter::prepareSvReadAllLogs()
+void CardTransactionManagerAdapter::checkSvApplication() const
 {
     if (!mCard->isSvFeatureAvailable()) {
         throw UnsupportedOperationException("Stored Value is not available for this card.");
@@ -2386,6 +2792,11 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareSvReadAllLogs()
         throw UnsupportedOperationException("The currently selected application is not an SV " \
                                             "application.");
     }
+}
+
+CardTransactionManager& CardTransactionManagerAdapter::prepareSvReadAllLogs()
+{
+    checkSvApplication();
 
     /* Reset SV data in CalypsoCard if any */
     const std::vector<uint8_t> dummy;
@@ -2402,6 +2813,68 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareSvReadAllLogs()
     return *this;
 }
 
+CardTransactionManager& CardTransactionManagerAdapter::processSvReadLogsSince(
+    const int svTNum, const uint8_t nbRecordsPerRead)
+{
+    checkSvApplication();
+
+    Assert::getInstance().isInRange(svTNum, 0, 0xFFFF, "svTNum")
+                         .isInRange(nbRecordsPerRead,
+                                    1,
+                                    CalypsoCardConstant::SV_DEBIT_LOG_FILE_NB_REC,
+                                    "nbRecordsPerRead");
+
+    /* Reset SV data in CalypsoCard if any */
+    const std::vector<uint8_t> dummy;
+    mCard->setSvData(0, dummy, dummy, 0, 0, nullptr, nullptr);
+
+    /* The load log file has a single record, read with the first debit log records */
+    prepareReadRecords(CalypsoCardConstant::SV_RELOAD_LOG_FILE_SFI,
+                       1,
+                       CalypsoCardConstant::SV_RELOAD_LOG_FILE_NB_REC,
+                       CalypsoCardConstant::SV_LOG_FILE_REC_LENGTH);
+
+    uint8_t fromRecordNumber = 1;
+    bool isKnownRecordReached = false;
+
+    while (!isKnownRecordReached &&
+           fromRecordNumber <= CalypsoCardConstant::SV_DEBIT_LOG_FILE_NB_REC) {
+
+        const uint8_t toRecordNumber =
+            static_cast<uint8_t>(std::min(fromRecordNumber + nbRecordsPerRead - 1,
+                                          static_cast<int>(
+                                              CalypsoCardConstant::SV_DEBIT_LOG_FILE_NB_REC)));
+
+        prepareReadRecords(CalypsoCardConstant::SV_DEBIT_LOG_FILE_SFI,
+                           fromRecordNumber,
+                           toRecordNumber,
+                           CalypsoCardConstant::SV_LOG_FILE_REC_LENGTH);
+        processCommands();
+
+        /* The records of the cyclic file are ordered from the most recent one */
+        const std::map<const uint8_t, std::vector<uint8_t>>& logRecords =
+            mCard->getFileBySfi(CalypsoCardConstant::SV_DEBIT_LOG_FILE_SFI)
+                ->getData()
+                ->getAllRecordsContent();
+
+        for (uint8_t i = fromRecordNumber; !isKnownRecordReached && i <= toRecordNumber; i++) {
+
+            const auto it = logRecords.find(i);
+            isKnownRecordReached =
+                it == logRecords.end() ||
+                !CalypsoCardAdapter::isSvTNumMoreRecent(
+                    SvDebitLogRecordAdapter(it->second, 0).getSvTNum(), svTNum);
+        }
+
+        fromRecordNumber = toRecordNumber + 1;
+    }
+
+    mLogger->debug("processSvReadLogsSince => % SV debit log record(s) read\n",
+                   fromRecordNumber - 1);
+
+    return *this;
+}
+
 CardTransactionManager& CardTransactionManagerAdapter::prepareInvalidate()
 {
     if (mCard->isDfInvalidated()) {
@@ -2424,6 +2897,351 @@ CardTransactionManager& CardTransactionManagerAdapter::prepareRehabilitate()
     return *this;
 }
 
+CardTransactionManager& CardTransactionManagerAdapter::prepareTemplate(
+    const CardTransactionTemplate& transactionTemplate,
+    const std::vector<std::vector<uint8_t>>& recordData,
+    const std::vector<int>& counterValues)
+{
+    if (static_cast<int>(recordData.size()) != transactionTemplate.getRecordDataCount()) {
+        throw IllegalArgumentException("Unexpected number of record data: " +
+                                       std::to_string(recordData.size()));
+    }
+
+    if (static_cast<int>(counterValues.size()) != transactionTemplate.getCounterValueCount()) {
+        throw IllegalArgumentException("Unexpected number of counter values: " +
+                                       std::to_string(counterValues.size()));
+    }
+
+    for (const auto counterValue : counterValues) {
+        Assert::getInstance().isInRange(counterValue,
+                                        CalypsoCardConstant::CNT_VALUE_MIN,
+                                        CalypsoCardConstant::CNT_VALUE_MAX,
+                                        "counterValue");
+    }
+
+    const std::shared_ptr<const std::vector<CardTransactionTemplate::Command>> commands =
+        transactionTemplate.getCommands(mCard->getPayloadCapacity());
+
+    mCardCommands.reserve(mCardCommands.size() + commands->size());
+
+    auto data = recordData.begin();
+    auto value = counterValues.begin();
+
+    for (const auto& command : *commands) {
+
+        switch (command.mType) {
+        case CardTransactionTemplate::CommandType::READ_ONE_RECORD:
+            mCardCommands.push_back(
+                std::make_shared<CmdCardReadRecords>(mCard,
+                                                     command.mSfi,
+                                                     command.mNumber,
+                                                     CmdCardReadRecords::ReadMode::ONE_RECORD,
+                                                     command.mLength));
+            break;
+        case CardTransactionTemplate::CommandType::READ_MULTIPLE_RECORD:
+            mCardCommands.push_back(
+                std::make_shared<CmdCardReadRecords>(mCard,
+                                                     command.mSfi,
+                                                     command.mNumber,
+                                                     CmdCardReadRecords::ReadMode::MULTIPLE_RECORD,
+                                                     command.mLength));
+            break;
+        case CardTransactionTemplate::CommandType::APPEND_RECORD:
+            mCardCommands.push_back(
+                std::make_shared<CmdCardAppendRecord>(mCard, command.mSfi, *data++));
+            break;
+        case CardTransactionTemplate::CommandType::UPDATE_RECORD:
+            if (!isRecordUnchanged(false, command.mSfi, command.mNumber, *data)) {
+                mCardCommands.push_back(
+                    std::make_shared<CmdCardUpdateRecord>(mCard,
+                                                          command.mSfi,
+                                                          command.mNumber,
+                                                          *data));
+            }
+            data++;
+            break;
+        case CardTransactionTemplate::CommandType::WRITE_RECORD:
+            if (!isRecordUnchanged(true, command.mSfi, command.mNumber, *data)) {
+                mCardCommands.push_back(
+                    std::make_shared<CmdCardWriteRecord>(mCard,
+                                                         command.mSfi,
+                                                         command.mNumber,
+                                                         *data));
+            }
+            data++;
+            break;
+        case CardTransactionTemplate::CommandType::INCREASE_COUNTER:
+        case CardTransactionTemplate::CommandType::DECREASE_COUNTER:
+            mCardCommands.push_back(
+                std::make_shared<CmdCardIncreaseOrDecrease>(
+                    command.mType == CardTransactionTemplate::CommandType::DECREASE_COUNTER,
+                    mCard,
+                    command.mSfi,
+                    command.mNumber,
+                    *value++));
+            break;
+        }
+    }
+
+    return *this;
+}
+
+CardTransactionManagerAdapter& CardTransactionManagerAdapter::enableDifferentialWrites()
+{
+    mIsDifferentialWriteEnabled = true;
+
+    return *this;
+}
+
+CardTransactionManagerAdapter& CardTransactionManagerAdapter::enableFileHeaderCache(
+    const std::shared_ptr<FileHeaderCache> fileHeaderCache)
+{
+    Assert::getInstance().notNull(fileHeaderCache, "fileHeaderCache");
+
+    mFileHeaderCache = fileHeaderCache;
+    mIsFileListCached = mFileHeaderCache->apply(mCard);
+
+    return *this;
+}
+
+CardTransactionManagerAdapter& CardTransactionManagerAdapter::enableLocalSearch()
+{
+    mIsLocalSearchEnabled = true;
+
+    return *this;
+}
+
+int CardTransactionManagerAdapter::getSavedWriteApduCount() const
+{
+    return mSavedWriteApduCount;
+}
+
+int CardTransactionManagerAdapter::getSavedWriteByteCount() const
+{
+    return mSavedWriteByteCount;
+}
+
+int CardTransactionManagerAdapter::getCardExchangeCount() const
+{
+    return mCardExchangeCount;
+}
+
+const std::shared_ptr<FileDataAdapter>
+    CardTransactionManagerAdapter::getFileDataForDifferentialWrite(const uint8_t sfi) const
+{
+    if (!mIsDifferentialWriteEnabled) {
+        return nullptr;
+    }
+
+    /* A pending modifying command could change the content before the new one is processed */
+    for (const auto& command : mCardCommands) {
+        if (command->isSessionBufferUsed()) {
+            return nullptr;
+        }
+    }
+
+    for (const auto& ef : mCard->getFiles()) {
+
+        if (ef->getSfi() == sfi) {
+
+            return std::dynamic_pointer_cast<FileDataAdapter>(ef->getData());
+        }
+    }
+
+    return nullptr;
+}
+
+bool CardTransactionManagerAdapter::searchRecordsLocally(
+    const std::shared_ptr<SearchCommandDataAdapter> data)
+{
+    const int searchDataLength = static_cast<int>(data->getSearchData().size());
+    if (searchDataLength == 0 || data->getMask().size() > data->getSearchData().size()) {
+        return false;
+    }
+
+    /* A pending modifying command could change the records before the search is processed */
+    for (const auto& command : mCardCommands) {
+        if (command->isSessionBufferUsed()) {
+            return false;
+        }
+    }
+
+    std::shared_ptr<ElementaryFile> ef;
+    for (const auto& file : mCard->getFiles()) {
+        if (file->getSfi() == data->getSfi()) {
+            ef = file;
+            break;
+        }
+    }
+
+    if (ef == nullptr || ef->getHeader() == nullptr) {
+        return false;
+    }
+
+    const std::shared_ptr<FileHeader> header = ef->getHeader();
+    if (header->getEfType() != ElementaryFile::Type::LINEAR &&
+        header->getEfType() != ElementaryFile::Type::CYCLIC) {
+        return false;
+    }
+
+    /* Out of range arguments are reported by the card */
+    const int recordSize = header->getRecordSize();
+    const int recordsNumber = header->getRecordsNumber();
+    if (data->getRecordNumber() < 1 ||
+        data->getRecordNumber() > recordsNumber ||
+        data->getOffset() < 0 ||
+        data->getOffset() + searchDataLength > recordSize) {
+        return false;
+    }
+
+    /* The bytes padded with 0 by a partial reading are not the ones of the card */
+    const auto fileData = std::dynamic_pointer_cast<FileDataAdapter>(ef->getData());
+    for (int i = data->getRecordNumber(); i <= recordsNumber; i++) {
+
+        const uint8_t recordNumber = static_cast<uint8_t>(i);
+        if (!fileData->isContentKnown(recordNumber, 0, recordSize) ||
+            (mIsSessionOpen && !isRecordReadInSession(data->getSfi(), recordNumber))) {
+            return false;
+        }
+    }
+
+    const std::map<const uint8_t, std::vector<uint8_t>>& records =
+        fileData->getAllRecordsContent();
+
+    const std::vector<uint8_t> matchingRecordNumbers =
+        data->findMatchingRecordNumbers(records, recordSize);
+    data->getMatchingRecordNumbers().insert(data->getMatchingRecordNumbers().end(),
+                                            matchingRecordNumbers.begin(),
+                                            matchingRecordNumbers.end());
+
+    return true;
+}
+
+void CardTransactionManagerAdapter::addRecordsReadInSession(
+    const std::shared_ptr<AbstractCardCommand> command)
+{
+    const CalypsoCardCommand& commandRef = command->getCommandRef();
+
+    if (commandRef == CalypsoCardCommand::READ_RECORDS) {
+
+        const auto cmdCardReadRecords = std::static_pointer_cast<CmdCardReadRecords>(command);
+        std::vector<uint8_t>& recordNumbers = mRecordsReadInSession[cmdCardReadRecords->getSfi()];
+        recordNumbers.insert(recordNumbers.end(),
+                             cmdCardReadRecords->getReadRecordNumbers().begin(),
+                             cmdCardReadRecords->getReadRecordNumbers().end());
+
+    } else if (commandRef == CalypsoCardCommand::OPEN_SESSION) {
+
+        const auto cmdCardOpenSession = std::static_pointer_cast<CmdCardOpenSession>(command);
+        if (cmdCardOpenSession->getRecordNumber() != 0) {
+            mRecordsReadInSession[cmdCardOpenSession->getSfi()].push_back(
+                cmdCardOpenSession->getRecordNumber());
+        }
+
+    } else if (commandRef == CalypsoCardCommand::APPEND_RECORD) {
+
+        /* The records of the cyclic file are shifted */
+        mRecordsReadInSession.clear();
+    }
+}
+
+bool CardTransactionManagerAdapter::isRecordReadInSession(const uint8_t sfi,
+                                                          const uint8_t recordNumber) const
+{
+    const auto it = mRecordsReadInSession.find(sfi);
+
+    return it != mRecordsReadInSession.end() &&
+           std::find(it->second.begin(), it->second.end(), recordNumber) != it->second.end();
+}
+
+bool CardTransactionManagerAdapter::isRecordUnchanged(const bool isWriteCommand,
+                                                      const uint8_t sfi,
+                                                      const uint8_t recordNumber,
+                                                      const std::vector<uint8_t>& recordData)
+{
+    const std::shared_ptr<FileDataAdapter> fileData = getFileDataForDifferentialWrite(sfi);
+    if (fileData == nullptr) {
+        return false;
+    }
+
+    const auto& records = fileData->getAllRecordsContent();
+    const auto record = records.find(recordNumber);
+    if (record == records.end() || record->second.empty()) {
+        return false;
+    }
+
+    const std::vector<uint8_t>& content = record->second;
+    bool isUnchanged;
+
+    if (!isWriteCommand) {
+
+        /* The bytes padded with 0 by a partial reading are not the ones of the card */
+        isUnchanged = content == recordData &&
+                      fileData->isContentKnown(recordNumber,
+                                               0,
+                                               static_cast<int>(content.size()));
+
+    } else {
+
+        /*
+         * "Write Record" performs a binary OR with the current content. The bits set in the card
+         * image are always set in the card, including in the padded or OR-ed bytes which are not
+         * known, so they can be compared too.
+         */
+        isUnchanged = content.size() >= recordData.size();
+        for (size_t i = 0; isUnchanged && i < recordData.size(); i++) {
+            isUnchanged = (content[i] | recordData[i]) == content[i];
+        }
+    }
+
+    if (isUnchanged) {
+
+        mSavedWriteApduCount++;
+        mSavedWriteByteCount += static_cast<int>(recordData.size());
+
+        mLogger->debug("Differential write: record % of file % is unchanged\n",
+                       recordNumber,
+                       sfi);
+    }
+
+    return isUnchanged;
+}
+
+std::vector<std::pair<int, int>> CardTransactionManagerAdapter::computeChangedRanges(
+    const bool isWriteCommand,
+    const FileDataAdapter& fileData,
+    const std::vector<uint8_t>& content,
+    const int offset,
+    const std::vector<uint8_t>& data)
+{
+    std::vector<std::pair<int, int>> ranges;
+
+    for (int i = 0; i < static_cast<int>(data.size()); i++) {
+
+        const uint8_t current = content[offset + i];
+        const uint8_t expected = isWriteCommand ? current | data[i] : data[i];
+
+        /* As for the records, only the bits set are reliable in an unknown byte */
+        if (current == expected &&
+            (isWriteCommand || fileData.isContentKnown(1, offset + i, 1))) {
+            continue;
+        }
+
+        /*
+         * A separate command costs SESSION_BUFFER_CMD_ADDITIONAL_COST bytes of session buffer,
+         * resending a shorter gap of unchanged bytes is cheaper.
+         */
+        if (!ranges.empty() &&
+            i - ranges.back().second <= SESSION_BUFFER_CMD_ADDITIONAL_COST) {
+            ranges.back().second = i + 1;
+        } else {
+            ranges.push_back(std::make_pair(i, i + 1));
+        }
+    }
+
+    return ranges;
+}
+
 void CardTransactionManagerAdapter::addStoredValueCommand(
     const std::shared_ptr<AbstractCardCommand> command, const SvOperation svOperation)
 {
@@ -2478,50 +3296,6 @@ bool CardTransactionManagerAdapter::isSvOperationCompleteOneTime()
     return flag;
 }
 
-/* APDU RESPONSE ADAPTER ------------------------------------------------------------------------ */
-
-CardTransactionManagerAdapter::ApduResponseAdapter::ApduResponseAdapter(
-  const std::vector<uint8_t>& apdu)
-: mApdu(apdu),
-  mStatusWord(ByteArrayUtil::extractInt(apdu, apdu.size() - 2, 2, false)) {}
-
-const std::vector<uint8_t>& CardTransactionManagerAdapter::ApduResponseAdapter::getApdu() const
-{
-    return mApdu;
-}
-
-const std::vector<uint8_t> CardTransactionManagerAdapter::ApduResponseAdapter::getDataOut() const
-{
-    return Arrays::copyOfRange(mApdu, 0, mApdu.size() - 2);
-}
-
-int CardTransactionManagerAdapter::ApduResponseAdapter::getStatusWord() const
-{
-    return mStatusWord;
-}
-
-std::ostream& operator<<(std::ostream& os, const CardTransactionManagerAdapter::ApduResponseAdapter& ara)
-{
-    os << "APDU_RESPONSE_ADAPTER: {"
-       << "APDU: " << ara.getApdu() << ", "
-       << "STATUS_WORD: " << ara.getStatusWord()
-       << "}";
-
-    return os;
-}
-
-
-std::ostream& operator<<(std::ostream& os, const std::shared_ptr<CardTransactionManagerAdapter::ApduResponseAdapter> ara)
-{
-    if (ara == nullptr) {
-        os << "APDU_RESPONSE_ADAPTER: null";
-    } else {
-        os << *ara;
-    }
-
-    return os;
-}
-
 }
 }
 }
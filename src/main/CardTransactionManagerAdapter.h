@@ -13,8 +13,11 @@
 #pragma once
 
 #include <atomic>
+#include <map>
 #include <memory>
 #include <ostream>
+#include <utility>
+#include <vector>
 
 /* Calypsonet Terminal Calypso */
 #include "CardSecuritySetting.h"
@@ -34,9 +37,14 @@
 
 /* Keyple Card Calypso */
 #include "CalypsoCardAdapter.h"
+#include "CardImageCache.h"
 #include "CardSecuritySettingAdapter.h"
 #include "CardCommandException.h"
 #include "CardControlSamTransactionManagerAdapter.h"
+#include "CardTransactionTemplate.h"
+#include "CmdCardReadRecords.h"
+#include "ControlSamScheduler.h"
+#include "FileHeaderCache.h"
 
 /* Keyple Core Util */
 #include "Any.h"
@@ -82,6 +90,12 @@ using namespace keyple::core::util::cpp;
  *   <li>CL-CSS-INFOCSS.1
  * </ul>
  *
+ * <p>C++: the exceptions raised after an exchange with the card are AuditedException instances
+ * carrying a snapshot of the transaction audit data. This data is no longer part of getMessage(),
+ * which only returns the message of the error; it is appended by what() and remains available
+ * through getTransactionAuditData(). These exceptions are therefore always rethrown as is, never
+ * by copy, so that their dynamic type is kept.
+ *
  * @since 2.0.0
  */
 class CardTransactionManagerAdapter final
@@ -90,6 +104,22 @@ class CardTransactionManagerAdapter final
                                          CardSecuritySettingAdapter>,
   public CardTransactionManager {
 public:
+    /**
+     * Change of a card key, as described by the arguments of
+     * CardTransactionManager::processChangeKey.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @since 2.2.5.6
+     */
+    struct KeyChange final {
+        uint8_t mKeyIndex;
+        uint8_t mNewKif;
+        uint8_t mNewKvc;
+        uint8_t mIssuerKif;
+        uint8_t mIssuerKvc;
+    };
+
     /**
      * (package-private)<br>
      * Creates an instance of CardTransactionManager.
@@ -482,6 +512,34 @@ public:
      */
     CardTransactionManager& prepareSvReadAllLogs() override;
 
+    /**
+     * Reads the SV logs more recent than a known SV operation.
+     *
+     * <p>Unlike prepareSvReadAllLogs, this method immediately processes the commands: the load log
+     * record is read with the first window of debit log records, then the debit log records are
+     * read one window at a time, starting from the most recent one, until a record which is not
+     * more recent than the known operation is reached. The commands previously prepared are
+     * processed with the first window.
+     *
+     * <p>The new debit log records can then be retrieved with
+     * CalypsoCardAdapter::getSvDebitLogRecordsSince.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param svTNum The SV transaction number of the last known operation.
+     * @param nbRecordsPerRead The number of debit log records read by each command (between 1 and
+     *        the number of records of the debit log file).
+     * @return The current instance.
+     * @throw UnsupportedOperationException If the SV feature is not available for this card or
+     *        if the selected application is not an SV application.
+     * @throw IllegalArgumentException If one of the arguments is out of range.
+     * @throw CardTransactionException (or a derived exception) If a communication or a command
+     *        error occurs.
+     * @since 2.2.5.6
+     */
+    CardTransactionManager& processSvReadLogsSince(const int svTNum,
+                                                   const uint8_t nbRecordsPerRead);
+
     /**
      * {@inheritDoc}
      *
@@ -496,6 +554,203 @@ public:
      */
     CardTransactionManager& prepareRehabilitate() override;
 
+    /**
+     * Prepares the commands of a transaction template.
+     *
+     * <p>The record data and counter values are consumed in the order of the related commands of
+     * the template. Only the counter values are checked, the other arguments having been checked
+     * when the template was built.
+     *
+     * <p>The update and write record commands are subject to the differential writes like the
+     * ones prepared individually (see enableDifferentialWrites).
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param transactionTemplate The transaction template.
+     * @param recordData The data of the append, update and write record commands.
+     * @param counterValues The values of the increase and decrease counter commands.
+     * @return The current instance.
+     * @throw IllegalArgumentException If the number of record data or counter values does not
+     *        match the template, or if a counter value is out of range.
+     * @throw IllegalStateException If the template is empty.
+     * @since 2.2.5.6
+     */
+    CardTransactionManager& prepareTemplate(
+        const CardTransactionTemplate& transactionTemplate,
+        const std::vector<std::vector<uint8_t>>& recordData,
+        const std::vector<int>& counterValues);
+
+    /**
+     * Enables the differential writes.
+     *
+     * <p>When enabled, the record and binary write commands are compared with the content of the
+     * card image (i.e. the data previously read or written):
+     *
+     * <ul>
+     *   <li>an "Update Record" command is not sent if the record already holds the same data,
+     *   <li>a "Write Record" command is not sent if it would not set any new bit,
+     *   <li>an "Update/Write Binary" command only sends the ranges of bytes that change.
+     * </ul>
+     *
+     * <p>The comparison is only done when the related content is known and no modifying command
+     * is already pending, since such a command could change the content before the new one is
+     * processed.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @return The current instance.
+     * @since 2.2.5.6
+     */
+    CardTransactionManagerAdapter& enableDifferentialWrites();
+
+    /**
+     * (package-private)<br>
+     * Prepares the reading of several ranges of a binary file, the file being selected only once.
+     *
+     * <p>C++: specific to this implementation (see BinaryFileView).
+     *
+     * @param sfi The SFI of the EF.
+     * @param ranges The ranges to read (offset and length), in ascending order of offset.
+     * @return The current instance.
+     * @throw UnsupportedOperationException If the "Read Binary" command is not available for this
+     *        card.
+     * @throw IllegalArgumentException If one of the arguments is out of range.
+     * @since 2.2.5.6
+     */
+    CardTransactionManagerAdapter& prepareReadBinaryRanges(
+        const uint8_t sfi, const std::vector<std::pair<int, int>>& ranges);
+
+    /**
+     * Enables the local search of records.
+     *
+     * <p>When enabled, prepareSearchRecords evaluates the search on the card image instead of
+     * preparing a "Search Record Multiple" command when the content of the file is fully known,
+     * i.e. when its header is known and all the records from the start record to the last one
+     * have been entirely read, and no modifying command is pending. Inside a secure session,
+     * these records must also have been read during the session, so that the result reflects the
+     * content authenticated by the session. The matching record numbers are then available
+     * immediately, with the same result as the card would return, whatever the product type.
+     * Otherwise, the command is prepared as usual.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @return The current instance.
+     * @since 2.2.5.6
+     */
+    CardTransactionManagerAdapter& enableLocalSearch();
+
+    /**
+     * Gets the number of APDUs not sent thanks to the differential writes.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getSavedWriteApduCount() const;
+
+    /**
+     * Gets the number of data bytes not sent thanks to the differential writes.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getSavedWriteByteCount() const;
+
+    /**
+     * Gets the number of card requests transmitted to the card reader by this transaction
+     * manager.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getCardExchangeCount() const;
+
+    /**
+     * Enables the file header cache for this transaction.
+     *
+     * <p>The headers cached for the profile of the card (see FileHeaderCache) are immediately set
+     * in the card image when they are not already known, and the headers obtained during the
+     * transaction are added to the cache each time the prepared commands are processed. When the
+     * profile of the card is already cached, the "Get Data" command for the EF list is no longer
+     * sent.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param fileHeaderCache The file header cache, possibly shared with other transactions.
+     * @return The current instance.
+     * @throw IllegalArgumentException If the cache is null.
+     * @since 2.2.5.6
+     */
+    CardTransactionManagerAdapter& enableFileHeaderCache(
+        const std::shared_ptr<FileHeaderCache> fileHeaderCache);
+
+    /**
+     * Prepares the presentation of a PIN, sent with the next processing of the prepared commands.
+     *
+     * <p>Unlike CardTransactionManager::processVerifyPin, previously prepared commands are allowed.
+     * In ciphered mode, the "Get Challenge" command is transmitted with the commands prepared
+     * before this one, and the "Verify PIN" command with the commands prepared after it (e.g. the
+     * reading of files protected by the PIN), once the PIN has been ciphered by the control SAM.
+     * The PIN presentation thus takes two card exchanges instead of three.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param pin The PIN code value (4-byte long byte array).
+     * @return The current instance.
+     * @throw UnsupportedOperationException If the PIN feature is not available for this card.
+     * @throw IllegalArgumentException If the provided argument is out of range.
+     * @throw IllegalStateException If a secure session is open or if a PIN command is already
+     *        prepared.
+     * @since 2.2.5.6
+     */
+    CardTransactionManagerAdapter& prepareVerifyPin(const std::vector<uint8_t>& pin);
+
+    /**
+     * Prepares the replacement of the PIN, sent with the next processing of the prepared commands.
+     *
+     * <p>The commands are scheduled as for prepareVerifyPin.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param newPin The new PIN code value (4-byte long byte array).
+     * @return The current instance.
+     * @throw UnsupportedOperationException If the PIN feature is not available for this card.
+     * @throw IllegalArgumentException If the provided argument is out of range.
+     * @throw IllegalStateException If a secure session is open or if a PIN command is already
+     *        prepared.
+     * @since 2.2.5.6
+     */
+    CardTransactionManagerAdapter& prepareChangePin(const std::vector<uint8_t>& newPin);
+
+    /**
+     * Replaces several keys of the card in a row.
+     *
+     * <p>Each key change needs a new card challenge. The "Get Challenge" command needed by the next
+     * key is thus transmitted in the same card request as the "Change Key" command of the current
+     * one: rotating N keys takes N + 1 card exchanges and N control SAM exchanges, instead of 2N
+     * card exchanges and N control SAM exchanges with successive calls to processChangeKey.
+     *
+     * <p>When the control SAM is shared between several readers (see ControlSamScheduler), the SAM
+     * keeps on generating keys for the other cards while the card requests of this one are
+     * transmitted.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param keyChanges The key changes, processed in order.
+     * @return The current instance.
+     * @throw UnsupportedOperationException If the Change Key command is not available for this
+     *        card.
+     * @throw IllegalArgumentException If the list is empty or if a key index is out of range.
+     * @throw IllegalStateException If a secure session is open.
+     * @since 2.2.5.6
+     */
+    CardTransactionManagerAdapter& processChangeKeys(const std::vector<KeyChange>& keyChanges);
+
     /**
      * (private)<br>
      * Add a StoredValue command to the list.
@@ -537,54 +792,10 @@ public:
     bool isSvOperationCompleteOneTime();
 
 private:
-    /**
-     * (private)<br>
-     * Adapter of ApduResponseApi used to create anticipated card responses.
-     */
-    class ApduResponseAdapter final : public ApduResponseApi {
-    public:
-        /**
-         *
-         */
-        friend class CardTransactionManagerAdapter;
-
-        /**
-         * Constructor
-         */
-        ApduResponseAdapter(const std::vector<uint8_t>& apdu);
-
-        /**
-         * {@inheritDoc}
-         */
-        const std::vector<uint8_t>& getApdu() const override;
-
-        /**
-         * {@inheritDoc}
-         */
-        const std::vector<uint8_t> getDataOut() const override;
-
-        /**
-         * {@inheritDoc}
-         */
-        int getStatusWord() const override;
-
-    private:
-        /**
-         *
-         */
-        const std::vector<uint8_t> mApdu;
-
-        /**
-         *
-         */
-        const int mStatusWord;
-    };
-
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CardTransactionManagerAdapter));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -625,11 +836,16 @@ private:
     const std::shared_ptr<CalypsoCardAdapter> mCard;
     const std::shared_ptr<CardSecuritySettingAdapter> mSecuritySetting;
     std::shared_ptr<CardControlSamTransactionManagerAdapter> mControlSamTransactionManager;
+
     /**
-     * C++: vector of AbstractApduCommand instead of AbstractCardCommand because of vector
-     * vs. polymorphism issues...
+     * C++: scheduler sharing the control SAM, if any, resolved once at construction.
      */
-    std::vector<std::shared_ptr<AbstractApduCommand>> mCardCommands;
+    const std::shared_ptr<ControlSamScheduler> mControlSamScheduler;
+
+    /**
+     *
+     */
+    std::vector<std::shared_ptr<AbstractCardCommand>> mCardCommands;
 
     /**
      * Dynamic fields
@@ -647,6 +863,48 @@ private:
     int mSvPostponedDataIndex = 0;
     int mNbPostponedData = 0;
 
+    /**
+     * Differential writes and their statistics.
+     */
+    bool mIsDifferentialWriteEnabled = false;
+    int mSavedWriteApduCount = 0;
+    int mSavedWriteByteCount = 0;
+
+    /**
+     *
+     */
+    bool mIsLocalSearchEnabled = false;
+
+    /**
+     * C++: numbers of the records read from the card during the current secure session, by SFI.
+     */
+    std::map<const uint8_t, std::vector<uint8_t>> mRecordsReadInSession;
+
+    /**
+     *
+     */
+    int mCardExchangeCount = 0;
+
+    /**
+     * File header cache and indication that the headers of all the files of the card are known by
+     * the cache (EF list already read for the profile of the card).
+     */
+    std::shared_ptr<FileHeaderCache> mFileHeaderCache;
+    bool mIsFileListCached = false;
+
+    /**
+     * C++: indicates that a "Get Data" of the EF list is among the prepared commands.
+     */
+    bool mIsFileListPrepared = false;
+
+    /**
+     * PIN command prepared in ciphered mode: index in the prepared commands of the first command
+     * to send with it, and PIN values to cipher (the new PIN being empty for a presentation).
+     */
+    int mPinCommandIndex = -1;
+    std::vector<uint8_t> mPinCurrentValue;
+    std::vector<uint8_t> mPinNewValue;
+
     /**
      * (private)<br>
      * Process card commands in a Secure Session.
@@ -662,13 +920,11 @@ private:
      * </ul>
      *
      * @param cardCommands the card commands inside session.
-     *        C++: vector of AbstractApduCommand instead of AbstractCardCommand because of vector
-     *        vs. polymorphism issues...
      * @param channelControl indicated if the card channel of the card reader must be closed after
      *        the last command.
      */
     void processAtomicCardCommands(
-        const std::vector<std::shared_ptr<AbstractApduCommand>> cardCommands,
+        const std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands,
         const ChannelControl channelControl);
 
     /**
@@ -691,6 +947,38 @@ private:
     const std::vector<uint8_t> processSamCardCipherPin(const std::vector<uint8_t>& currentPin,
                                                        const std::vector<uint8_t>& newPin);
 
+    /**
+     * (private)<br>
+     * Checks the preconditions of a prepared PIN command and prepares it.
+     *
+     * <p>In plain mode, the PIN command is directly added to the prepared commands. In ciphered
+     * mode, a "Get Challenge" command is added and the PIN values are kept until the commands
+     * are processed.
+     *
+     * @param currentPin The current PIN.
+     * @param newPin The new PIN, or empty in case of a PIN presentation.
+     */
+    void preparePinCommand(const std::vector<uint8_t>& currentPin,
+                           const std::vector<uint8_t>& newPin);
+
+    /**
+     * (private)<br>
+     * Transmits the commands prepared before a ciphered PIN command along with the "Get Challenge"
+     * command, gets the ciphered PIN data from the control SAM, then replaces the prepared commands
+     * with the PIN command followed by the commands prepared after it.
+     *
+     * <p>The prepared commands are discarded and the PIN values wiped if an error occurs.
+     */
+    void processPreparedPinCommand();
+
+    /**
+     * (private)<br>
+     * Throws an exception if a ciphered PIN command is waiting for its processing.
+     *
+     * @throw IllegalStateException If a PIN command is prepared.
+     */
+    void checkNoPreparedPinCommand() const;
+
     /**
      * Close the Secure Session.
      *
@@ -734,15 +1022,13 @@ private:
      * the application level.
      *
      * @param cardCommands The list of last card commands to transmit inside the secure session.
-     *        C++: vector of AbstractApduCommand instead of AbstractCardCommand because of vector
-     *        vs. polymorphism issues...
      * @param isRatificationMechanismEnabled true if the ratification is closed not ratified and a
      *        ratification command must be sent.
      * @param channelControl indicates if the card channel of the card reader must be closed after
      *        the last command.
      */
     void processAtomicClosing(
-        const std::vector<std::shared_ptr<AbstractApduCommand>>& cardCommands,
+        const std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands,
         const bool isRatificationMechanismEnabled,
         const ChannelControl channelControl);
 
@@ -815,13 +1101,11 @@ private:
      * These commands are supposed to be "modifying commands" only.
      *
      * @param cardCommands the list of card commands sent.
-     *        C++: vector of AbstractApduCommand instead of AbstractCardCommand because of vector
-     *        vs. polymorphism issues...
      * @return An empty list if there is no command.
      * @throw IllegalStateException if the anticipation process failed
      */
     const std::vector<std::shared_ptr<ApduResponseApi>> buildAnticipatedResponses(
-        const std::vector<std::shared_ptr<AbstractApduCommand>>& cardCommands);
+        const std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands);
 
     /**
      * Process all prepared card commands (outside a Secure Session).
@@ -868,6 +1152,23 @@ private:
     const std::shared_ptr<CardResponseApi> transmitCardRequest(
         const std::shared_ptr<CardRequestSpi> cardRequest, const ChannelControl channelControl);
 
+    /**
+     * (private)<br>
+     * Restarts the lease timeout of the shared control SAM reserved by the current secure
+     * session, if any (see ControlSamScheduler::renewLease).
+     */
+    void renewControlSamLease() const;
+
+    /**
+     * (private)<br>
+     * Withdraws the exclusive access to the shared control SAM granted to the current secure
+     * session, if any (see ControlSamScheduler::releaseLease).
+     *
+     * <p>Must be called whenever the secure session ends without a "Digest Authenticate" command
+     * being sent to the SAM.
+     */
+    void releaseControlSamLease() const;
+
     /**
      * Gets the terminal challenge from the SAM, and raises exceptions if necessary.
      * (private)<br>
@@ -1023,6 +1324,93 @@ private:
                                                        const int offset,
                                                        const std::vector<uint8_t>& data);
 
+    /**
+     * (private)<br>
+     * Gets the data of a file to be compared with the data of a write command when the
+     * differential writes are enabled.
+     *
+     * @param sfi The SFI.
+     * @return Null if the differential writes are disabled, a modifying command is pending or the
+     *         file is not known.
+     */
+    const std::shared_ptr<FileDataAdapter> getFileDataForDifferentialWrite(const uint8_t sfi) const;
+
+    /**
+     * (private)<br>
+     * Adds the "Read Binary" commands needed to read a range, according to the payload capacity of
+     * the card.
+     *
+     * @param sfi The SFI of the EF.
+     * @param offset The offset.
+     * @param nbBytesToRead The number of bytes to read.
+     */
+    void addReadBinaryCommands(const uint8_t sfi, const int offset, const int nbBytesToRead);
+
+    /**
+     * (private)<br>
+     * Evaluates a search on the card image when the content of the file is fully known.
+     *
+     * @param data The search command data.
+     * @return False if the search has to be made by the card.
+     */
+    bool searchRecordsLocally(const std::shared_ptr<SearchCommandDataAdapter> data);
+
+    /**
+     * (private)<br>
+     * Keeps track of the records read by a command processed inside the secure session.
+     *
+     * @param command The processed command.
+     */
+    void addRecordsReadInSession(const std::shared_ptr<AbstractCardCommand> command);
+
+    /**
+     * (private)<br>
+     * Indicates if a record has been read from the card during the current secure session.
+     *
+     * @param sfi The SFI.
+     * @param recordNumber The record number.
+     * @return True if the record has been read during the session.
+     */
+    bool isRecordReadInSession(const uint8_t sfi, const uint8_t recordNumber) const;
+
+    /**
+     * (private)<br>
+     * Indicates if an "Update/Write Record" command would leave the record unchanged, and counts
+     * it as saved if so.
+     *
+     * @param isWriteCommand True if it is a "Write Record" command.
+     * @param sfi The SFI.
+     * @param recordNumber The record number.
+     * @param recordData The data to update/write.
+     * @return True if the command does not need to be sent.
+     */
+    bool isRecordUnchanged(const bool isWriteCommand,
+                           const uint8_t sfi,
+                           const uint8_t recordNumber,
+                           const std::vector<uint8_t>& recordData);
+
+    /**
+     * (private)<br>
+     * Computes the ranges of the data of an "Update/Write Binary" command which change the
+     * content, merging the ranges whose gap costs less than an additional command.
+     *
+     * <p>The bytes of the content which were neither read nor written are considered as changed
+     * by an "Update Binary" command.
+     *
+     * @param isWriteCommand True if it is a "Write Binary" command.
+     * @param fileData The current data of the file.
+     * @param content The current content of the file.
+     * @param offset The offset of the data in the file.
+     * @param data The data to update/write.
+     * @return The [begin, end) indexes in data of the ranges to send.
+     */
+    static std::vector<std::pair<int, int>> computeChangedRanges(
+        const bool isWriteCommand,
+        const FileDataAdapter& fileData,
+        const std::vector<uint8_t>& content,
+        const int offset,
+        const std::vector<uint8_t>& data);
+
      /**
      * (private)<br>
      * Factorisation of prepareDecreaseCounter and prepareIncreaseCounter.
@@ -1062,11 +1450,40 @@ private:
      * Open a single Secure Session.
      *
      * @param cardCommands the card commands inside session.
-     *        C++: vector of AbstractApduCommand instead of AbstractCardCommand because of vector
-     *        vs. polymorphism issues...
      * @throw IllegalStateException if no CardSecuritySetting is available.
      */
-    void processAtomicOpening(std::vector<std::shared_ptr<AbstractApduCommand>>& cardCommands);
+    void processAtomicOpening(std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands);
+
+    /**
+     * (private)<br>
+     * Processes the commands deferred at the opening of a secure session because an image of the
+     * card is available in the card image cache.
+     *
+     * <p>If the image is still valid according to the transaction counter, the record reads
+     * placed before the first modifying command are served from the image instead of being
+     * transmitted. Otherwise, the image is removed from the cache. The remaining commands are then
+     * transmitted to the card in a single card request.
+     *
+     * @param cardImageCache The card image cache.
+     * @param image The image of the card.
+     * @param cardCommands The deferred card commands.
+     */
+    void processDeferredCommandsWithCardImage(
+        const std::shared_ptr<CardImageCache> cardImageCache,
+        const std::shared_ptr<const CardImageCache::Image> image,
+        std::vector<std::shared_ptr<AbstractCardCommand>>& cardCommands);
+
+    /**
+     * (private)<br>
+     * Serves a "Read Records" command from a card image, when all the records it would return are
+     * part of the image.
+     *
+     * @param image The valid image of the card.
+     * @param command The command.
+     * @return False if the command has to be transmitted to the card.
+     */
+    bool serveReadRecordsFromCardImage(const std::shared_ptr<const CardImageCache::Image> image,
+                                       const std::shared_ptr<CmdCardReadRecords> command);
 
     /**
      * (private)<br>
@@ -1098,6 +1515,15 @@ private:
      */
     void checkSvInsideSession();
 
+    /**
+     * (private)<br>
+     * Checks if the SV logs can be read.
+     *
+     * @throw UnsupportedOperationException If the SV feature is not available for this card or if
+     *        the selected application is not an SV application.
+     */
+    void checkSvApplication() const;
+
     /**
      * (private)<br>
      * CL-CSS-OSSMODE.1<br>
@@ -1123,23 +1549,16 @@ private:
      * (private)<br>
      * Sets the response to the command and check the status for strict and best effort mode.
      *
+     * <p>C++: must be called from the handler of the provided exception, which is rethrown as is
+     * so that its dynamic type is kept.
+     *
      * @param command The command.
+     * @param e The exception being handled.
      * @throw CardCommandException If needed.
      */
     void checkResponseStatusForStrictAndBestEffortMode(
         const std::shared_ptr<AbstractCardCommand> command,
         const CardCommandException& e) const;
-
-    /**
-     *
-     */
-    friend std::ostream& operator<<(std::ostream& os, const ApduResponseAdapter& ara);
-
-    /**
-     *
-     */
-    friend std::ostream& operator<<(std::ostream& os,
-                                    const std::shared_ptr<ApduResponseAdapter> ara);
 };
 
 }
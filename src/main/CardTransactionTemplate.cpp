@@ -0,0 +1,180 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CardTransactionTemplate.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardConstant.h"
+#include "CmdCardReadRecords.h"
+
+/* Keyple Core Util */
+#include "IllegalStateException.h"
+#include "KeypleAssert.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+CardTransactionTemplate& CardTransactionTemplate::addReadRecords(const uint8_t sfi,
+                                                                 const uint8_t fromRecordNumber,
+                                                                 const uint8_t toRecordNumber,
+                                                                 const uint8_t recordSize)
+{
+    Assert::getInstance().isInRange(sfi,
+                                    CalypsoCardConstant::SFI_MIN,
+                                    CalypsoCardConstant::SFI_MAX,
+                                    "sfi")
+                         .isInRange(fromRecordNumber,
+                                    CalypsoCardConstant::NB_REC_MIN,
+                                    CalypsoCardConstant::NB_REC_MAX,
+                                    "fromRecordNumber")
+                         .isInRange(toRecordNumber,
+                                    fromRecordNumber,
+                                    CalypsoCardConstant::NB_REC_MAX,
+                                    "toRecordNumber");
+
+    mSteps.push_back({fromRecordNumber == toRecordNumber ? CommandType::READ_ONE_RECORD :
+                                                           CommandType::READ_MULTIPLE_RECORD,
+                      sfi,
+                      fromRecordNumber,
+                      toRecordNumber,
+                      recordSize});
+
+    return *this;
+}
+
+CardTransactionTemplate& CardTransactionTemplate::addAppendRecord(const uint8_t sfi)
+{
+    return addStep(CommandType::APPEND_RECORD, sfi, 0);
+}
+
+CardTransactionTemplate& CardTransactionTemplate::addUpdateRecord(const uint8_t sfi,
+                                                                  const uint8_t recordNumber)
+{
+    return addStep(CommandType::UPDATE_RECORD, sfi, recordNumber);
+}
+
+CardTransactionTemplate& CardTransactionTemplate::addWriteRecord(const uint8_t sfi,
+                                                                 const uint8_t recordNumber)
+{
+    return addStep(CommandType::WRITE_RECORD, sfi, recordNumber);
+}
+
+CardTransactionTemplate& CardTransactionTemplate::addIncreaseCounter(const uint8_t sfi,
+                                                                     const uint8_t counterNumber)
+{
+    return addStep(CommandType::INCREASE_COUNTER, sfi, counterNumber);
+}
+
+CardTransactionTemplate& CardTransactionTemplate::addDecreaseCounter(const uint8_t sfi,
+                                                                     const uint8_t counterNumber)
+{
+    return addStep(CommandType::DECREASE_COUNTER, sfi, counterNumber);
+}
+
+int CardTransactionTemplate::getRecordDataCount() const
+{
+    return mRecordDataCount;
+}
+
+int CardTransactionTemplate::getCounterValueCount() const
+{
+    return mCounterValueCount;
+}
+
+std::shared_ptr<const std::vector<CardTransactionTemplate::Command>>
+    CardTransactionTemplate::getCommands(const uint8_t payloadCapacity) const
+{
+    if (mSteps.empty()) {
+        throw IllegalStateException("The transaction template is empty.");
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    std::shared_ptr<const std::vector<Command>>& commands = mCommands[payloadCapacity];
+    if (commands == nullptr) {
+        commands = std::make_shared<const std::vector<Command>>(compile(payloadCapacity));
+    }
+
+    return commands;
+}
+
+CardTransactionTemplate& CardTransactionTemplate::addStep(const CommandType type,
+                                                          const uint8_t sfi,
+                                                          const uint8_t number)
+{
+    Assert::getInstance().isInRange(sfi,
+                                    CalypsoCardConstant::SFI_MIN,
+                                    CalypsoCardConstant::SFI_MAX,
+                                    "sfi");
+
+    if (type == CommandType::UPDATE_RECORD || type == CommandType::WRITE_RECORD) {
+
+        Assert::getInstance().isInRange(number,
+                                        CalypsoCardConstant::NB_REC_MIN,
+                                        CalypsoCardConstant::NB_REC_MAX,
+                                        "recordNumber");
+
+    } else if (type == CommandType::INCREASE_COUNTER || type == CommandType::DECREASE_COUNTER) {
+
+        Assert::getInstance().isInRange(number,
+                                        CalypsoCardConstant::NB_CNT_MIN,
+                                        CalypsoCardConstant::NB_CNT_MAX,
+                                        "counterNumber");
+    }
+
+    mSteps.push_back({type, sfi, number, number, 0});
+
+    if (type == CommandType::INCREASE_COUNTER || type == CommandType::DECREASE_COUNTER) {
+        mCounterValueCount++;
+    } else {
+        mRecordDataCount++;
+    }
+
+    return *this;
+}
+
+const std::vector<CardTransactionTemplate::Command> CardTransactionTemplate::compile(
+    const uint8_t payloadCapacity) const
+{
+    std::vector<Command> commands;
+
+    for (const auto& step : mSteps) {
+
+        if (step.mType != CommandType::READ_MULTIPLE_RECORD) {
+
+            commands.push_back({step.mType, step.mSfi, step.mFromNumber, step.mRecordSize});
+            continue;
+        }
+
+        for (const auto& chunk : CmdCardReadRecords::splitRecords(step.mFromNumber,
+                                                                  step.mToNumber,
+                                                                  step.mRecordSize,
+                                                                  payloadCapacity)) {
+            commands.push_back({chunk.mReadMode == CmdCardReadRecords::ReadMode::ONE_RECORD ?
+                                    CommandType::READ_ONE_RECORD :
+                                    CommandType::READ_MULTIPLE_RECORD,
+                                step.mSfi,
+                                chunk.mFirstRecordNumber,
+                                chunk.mExpectedLength});
+        }
+    }
+
+    return commands;
+}
+
+}
+}
+}
@@ -0,0 +1,235 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+/**
+ * Sequence of card commands described once (e.g. per card profile) and prepared at each card
+ * transaction with CardTransactionManagerAdapter::prepareTemplate.
+ *
+ * <p>The static arguments (SFI, record and counter numbers, record sizes) are checked when the
+ * commands are added to the template. The splitting of the multiple record reads according to the
+ * payload capacity of the card is computed the first time the template is used with a given
+ * capacity and then reused. At each transaction, only the dynamic arguments (record data and
+ * counter values) are provided, in the order of the related commands.
+ *
+ * <p>C++: specific to this implementation. This class is thread-safe once all its commands have
+ * been added, so that a single instance can be shared between several readers.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API CardTransactionTemplate final {
+public:
+    /**
+     * (package-private)<br>
+     * Type of a command of the template.
+     *
+     * @since 2.2.5.6
+     */
+    enum class CommandType {
+        READ_ONE_RECORD,
+        READ_MULTIPLE_RECORD,
+        APPEND_RECORD,
+        UPDATE_RECORD,
+        WRITE_RECORD,
+        INCREASE_COUNTER,
+        DECREASE_COUNTER
+    };
+
+    /**
+     * (package-private)<br>
+     * Command ready to be created by the card transaction manager.
+     *
+     * <p>The number field holds the record number or the counter number, the length field the
+     * length of the data expected by a read command.
+     *
+     * @since 2.2.5.6
+     */
+    struct Command final {
+        CommandType mType;
+        uint8_t mSfi;
+        uint8_t mNumber;
+        uint8_t mLength;
+    };
+
+    /**
+     * Creates an empty template.
+     *
+     * @since 2.2.5.6
+     */
+    CardTransactionTemplate() = default;
+
+    /**
+     * Adds the reading of one or more records of a file.
+     *
+     * @param sfi The SFI of the EF.
+     * @param fromRecordNumber The number of the first record to read.
+     * @param toRecordNumber The number of the last record to read.
+     * @param recordSize The record length.
+     * @return The current instance.
+     * @throw IllegalArgumentException If one of the arguments is out of range.
+     * @see CardTransactionManager::prepareReadRecords
+     * @since 2.2.5.6
+     */
+    CardTransactionTemplate& addReadRecords(const uint8_t sfi,
+                                            const uint8_t fromRecordNumber,
+                                            const uint8_t toRecordNumber,
+                                            const uint8_t recordSize);
+
+    /**
+     * Adds the appending of a record to a cyclic file, the record data being provided at each
+     * transaction.
+     *
+     * @param sfi The SFI of the EF.
+     * @return The current instance.
+     * @throw IllegalArgumentException If the SFI is out of range.
+     * @see CardTransactionManager::prepareAppendRecord
+     * @since 2.2.5.6
+     */
+    CardTransactionTemplate& addAppendRecord(const uint8_t sfi);
+
+    /**
+     * Adds the update of a record, the record data being provided at each transaction.
+     *
+     * @param sfi The SFI of the EF.
+     * @param recordNumber The number of the record.
+     * @return The current instance.
+     * @throw IllegalArgumentException If one of the arguments is out of range.
+     * @see CardTransactionManager::prepareUpdateRecord
+     * @since 2.2.5.6
+     */
+    CardTransactionTemplate& addUpdateRecord(const uint8_t sfi, const uint8_t recordNumber);
+
+    /**
+     * Adds the writing of a record, the record data being provided at each transaction.
+     *
+     * @param sfi The SFI of the EF.
+     * @param recordNumber The number of the record.
+     * @return The current instance.
+     * @throw IllegalArgumentException If one of the arguments is out of range.
+     * @see CardTransactionManager::prepareWriteRecord
+     * @since 2.2.5.6
+     */
+    CardTransactionTemplate& addWriteRecord(const uint8_t sfi, const uint8_t recordNumber);
+
+    /**
+     * Adds the increase of a counter, the value being provided at each transaction.
+     *
+     * @param sfi The SFI of the EF.
+     * @param counterNumber The number of the counter.
+     * @return The current instance.
+     * @throw IllegalArgumentException If one of the arguments is out of range.
+     * @see CardTransactionManager::prepareIncreaseCounter
+     * @since 2.2.5.6
+     */
+    CardTransactionTemplate& addIncreaseCounter(const uint8_t sfi, const uint8_t counterNumber);
+
+    /**
+     * Adds the decrease of a counter, the value being provided at each transaction.
+     *
+     * @param sfi The SFI of the EF.
+     * @param counterNumber The number of the counter.
+     * @return The current instance.
+     * @throw IllegalArgumentException If one of the arguments is out of range.
+     * @see CardTransactionManager::prepareDecreaseCounter
+     * @since 2.2.5.6
+     */
+    CardTransactionTemplate& addDecreaseCounter(const uint8_t sfi, const uint8_t counterNumber);
+
+    /**
+     * Gets the number of record data to provide at each transaction.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getRecordDataCount() const;
+
+    /**
+     * Gets the number of counter values to provide at each transaction.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getCounterValueCount() const;
+
+    /**
+     * (package-private)<br>
+     * Gets the commands of the template for a card payload capacity, computing them on first use.
+     *
+     * @param payloadCapacity The payload capacity of the card.
+     * @return A not null pointer.
+     * @throw IllegalStateException If the template is empty.
+     * @since 2.2.5.6
+     */
+    std::shared_ptr<const std::vector<Command>> getCommands(const uint8_t payloadCapacity) const;
+
+private:
+    /**
+     * (private)<br>
+     * Command as added by the user.
+     */
+    struct Step final {
+        CommandType mType;
+        uint8_t mSfi;
+        uint8_t mFromNumber;
+        uint8_t mToNumber;
+        uint8_t mRecordSize;
+    };
+
+    /**
+     *
+     */
+    std::vector<Step> mSteps;
+
+    /**
+     *
+     */
+    int mRecordDataCount = 0;
+    int mCounterValueCount = 0;
+
+    /**
+     * Commands by payload capacity.
+     */
+    mutable std::map<uint8_t, std::shared_ptr<const std::vector<Command>>> mCommands;
+    mutable std::mutex mMutex;
+
+    /**
+     * (private)<br>
+     * Adds a command having a dynamic argument.
+     */
+    CardTransactionTemplate& addStep(const CommandType type,
+                                     const uint8_t sfi,
+                                     const uint8_t number);
+
+    /**
+     * (private)<br>
+     * Computes the commands of the template for a card payload capacity.
+     */
+    const std::vector<Command> compile(const uint8_t payloadCapacity) const;
+};
+
+}
+}
+}
@@ -32,6 +32,9 @@ namespace calypso {
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 
+const std::unique_ptr<Logger> CmdCardAppendRecord::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardAppendRecord));
+
 const CalypsoCardCommand CmdCardAppendRecord::mCommand = CalypsoCardCommand::APPEND_RECORD;
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardAppendRecord::STATUS_TABLE = initStatusTable();
@@ -87,8 +87,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CmdCardAppendRecord));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
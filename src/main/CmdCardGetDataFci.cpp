@@ -28,6 +28,9 @@ namespace calypso {
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 
+const std::unique_ptr<Logger> CmdCardGetDataFci::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardGetDataFci));
+
 const int CmdCardGetDataFci::TAG_DF_NAME = 0x84;
 const int CmdCardGetDataFci::TAG_APPLICATION_SERIAL_NUMBER = 0xC7;
 const int CmdCardGetDataFci::TAG_DISCRETIONARY_DATA = 0x53;
@@ -157,7 +157,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CmdCardGetDataFci));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
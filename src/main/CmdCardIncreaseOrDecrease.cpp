@@ -35,6 +35,9 @@ namespace calypso {
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 
+const std::unique_ptr<Logger> CmdCardIncreaseOrDecrease::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardIncreaseOrDecrease));
+
 const int CmdCardIncreaseOrDecrease::SW_POSTPONED_DATA = 0x6200;
 
 const std::map<const int, const std::shared_ptr<StatusProperties>>
@@ -127,8 +127,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CmdCardIncreaseOrDecrease));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
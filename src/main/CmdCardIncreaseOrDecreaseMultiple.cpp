@@ -34,6 +34,9 @@ namespace calypso {
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 
+const std::unique_ptr<Logger> CmdCardIncreaseOrDecreaseMultiple::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardIncreaseOrDecreaseMultiple));
+
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardIncreaseOrDecreaseMultiple::STATUS_TABLE = initStatusTable();
 
@@ -106,8 +106,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CmdCardIncreaseOrDecreaseMultiple));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
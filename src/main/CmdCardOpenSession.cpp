@@ -44,8 +44,8 @@ CmdCardOpenSession::SecureSession::SecureSession(const std::vector<uint8_t>& cha
                              const std::vector<uint8_t>& challengeRandomNumber,
                              const bool previousSessionRatified,
                              const bool manageSecureSessionAuthorized,
-                             const std::shared_ptr<uint8_t> kif,
-                             const std::shared_ptr<uint8_t> kvc,
+                             const Optional<uint8_t> kif,
+                             const Optional<uint8_t> kvc,
                              const std::vector<uint8_t>& originalData,
                              const std::vector<uint8_t>& secureSessionData)
 : mChallengeTransactionCounter(challengeTransactionCounter),
@@ -78,12 +78,12 @@ bool CmdCardOpenSession::SecureSession::isManageSecureSessionAuthorized() const
     return mManageSecureSessionAuthorized;
 }
 
-const std::shared_ptr<uint8_t> CmdCardOpenSession::SecureSession::getKIF() const
+Optional<uint8_t> CmdCardOpenSession::SecureSession::getKIF() const
 {
     return mKif;
 }
 
-const std::shared_ptr<uint8_t> CmdCardOpenSession::SecureSession::getKVC() const
+Optional<uint8_t> CmdCardOpenSession::SecureSession::getKVC() const
 {
     return mKvc;
 }
@@ -100,6 +100,9 @@ const std::vector<uint8_t>& CmdCardOpenSession::SecureSession::getSecureSessionD
 
 /* CMD CARD OPEN SESSIO ------------------------------------------------------------------------- */
 
+const std::unique_ptr<Logger> CmdCardOpenSession::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardOpenSession));
+
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardOpenSession::STATUS_TABLE = initStatusTable();
 
@@ -310,8 +313,8 @@ void CmdCardOpenSession::parseRev3(const std::vector<uint8_t>& apduResponseData)
         manageSecureSessionAuthorized = false;
     }
 
-    const auto kif = std::make_shared<uint8_t>(apduResponseData[5 + offset]);
-    const auto kvc = std::make_shared<uint8_t>(apduResponseData[6 + offset]);
+    const Optional<uint8_t> kif = apduResponseData[5 + offset];
+    const Optional<uint8_t> kvc = apduResponseData[6 + offset];
     const int dataLength = apduResponseData[7 + offset];
 
     if (dataLength != static_cast<int>(apduResponseData.size() - 8 - offset)) {
@@ -366,7 +369,7 @@ void CmdCardOpenSession::parseRev24(const std::vector<uint8_t>& apduResponseData
                                     std::to_string(apduResponseData.size()));
     }
 
-    const auto kvc = std::make_shared<uint8_t>(apduResponseData[0]);
+    const Optional<uint8_t> kvc = apduResponseData[0];
 
     mSecureSession = std::shared_ptr<SecureSession>(
                          new SecureSession(
@@ -374,7 +377,7 @@ void CmdCardOpenSession::parseRev24(const std::vector<uint8_t>& apduResponseData
                             Arrays::copyOfRange(apduResponseData, 4, 5),
                             previousSessionRatified,
                             false,
-                            nullptr,
+                            Optional<uint8_t>::empty(),
                             kvc,
                             data,
                             apduResponseData));
@@ -413,15 +416,15 @@ void CmdCardOpenSession::parseRev10(const std::vector<uint8_t>& apduResponseData
                                     std::to_string(apduResponseData.size()));
     }
 
-    /* KVC doesn't exist and is set to null for this type of card */
+    /* KIF and KVC don't exist and are left empty for this type of card */
     mSecureSession = std::shared_ptr<SecureSession>(
                          new SecureSession(
                              Arrays::copyOfRange(apduResponseData, 0, 3),
                              Arrays::copyOfRange(apduResponseData, 3, 4),
                              previousSessionRatified,
                              false,
-                             nullptr,
-                             nullptr,
+                             Optional<uint8_t>::empty(),
+                             Optional<uint8_t>::empty(),
                              data,
                              apduResponseData));
 }
@@ -436,12 +439,12 @@ bool CmdCardOpenSession::isManageSecureSessionAuthorized() const
     return mSecureSession->isManageSecureSessionAuthorized();
 }
 
-const std::shared_ptr<uint8_t> CmdCardOpenSession::getSelectedKif() const
+Optional<uint8_t> CmdCardOpenSession::getSelectedKif() const
 {
     return mSecureSession->getKIF();
 }
 
-const std::shared_ptr<uint8_t> CmdCardOpenSession::getSelectedKvc() const
+Optional<uint8_t> CmdCardOpenSession::getSelectedKvc() const
 {
     return mSecureSession->getKVC();
 }
@@ -25,6 +25,7 @@
 #include "AbstractCardCommand.h"
 #include "CalypsoCardAdapter.h"
 #include "CalypsoCardClass.h"
+#include "Optional.h"
 
 /* Keyple Core Util */
 #include "LoggerFactory.h"
@@ -251,7 +252,7 @@ public:
      * @return The current KIF.
      * @since 2.0.1
      */
-    const std::shared_ptr<uint8_t> getSelectedKif() const;
+    Optional<uint8_t> getSelectedKif() const;
 
     /**
      * (package-private)<br>
@@ -259,7 +260,7 @@ public:
      * @return The current KVC.
      * @since 2.0.1
      */
-    const std::shared_ptr<uint8_t> getSelectedKvc() const;
+    Optional<uint8_t> getSelectedKvc() const;
 
     /**
      * {@inheritDoc}
@@ -313,7 +314,7 @@ private:
          * @return A byte
          * @since 2.0.1
          */
-        const std::shared_ptr<uint8_t> getKIF() const;
+        Optional<uint8_t> getKIF() const;
 
         /**
          * Gets the kvc.
@@ -321,7 +322,7 @@ private:
          * @return A byte
          * @since 2.0.1
          */
-        const std::shared_ptr<uint8_t> getKVC() const;
+        Optional<uint8_t> getKVC() const;
 
         /**
          * Gets the original data.
@@ -361,14 +362,14 @@ private:
         const bool mManageSecureSessionAuthorized;
 
         /**
-         * The kif (it may be null if it doesn't exist in the considered card [rev 1.0])
+         * The kif (it may be empty if it doesn't exist in the considered card [rev 1.0])
          */
-        const std::shared_ptr<uint8_t> mKif;
+        const Optional<uint8_t> mKif;
 
         /**
-         * The kvc (it may be null if it doesn't exist in the considered card [rev 1.0])
+         * The kvc (it may be empty if it doesn't exist in the considered card [rev 1.0])
          */
-        const std::shared_ptr<uint8_t> mKvc;
+        const Optional<uint8_t> mKvc;
 
         /**
          * The original data
@@ -399,8 +400,8 @@ private:
                       const std::vector<uint8_t>& challengeRandomNumber,
                       const bool previousSessionRatified,
                       const bool manageSecureSessionAuthorized,
-                      const std::shared_ptr<uint8_t> kif,
-                      const std::shared_ptr<uint8_t> kvc,
+                      const Optional<uint8_t> kif,
+                      const Optional<uint8_t> kvc,
                       const std::vector<uint8_t>& originalData,
                       const std::vector<uint8_t>& secureSessionData);
     };
@@ -408,7 +409,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CmdCardOpenSession));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
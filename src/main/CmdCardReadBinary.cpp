@@ -34,6 +34,9 @@ namespace calypso {
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 
+const std::unique_ptr<Logger> CmdCardReadBinary::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardReadBinary));
+
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardReadBinary::STATUS_TABLE = initStatusTable();
 
@@ -44,6 +47,24 @@ CmdCardReadBinary::CmdCardReadBinary(const std::shared_ptr<CalypsoCardAdapter> c
 : AbstractCardCommand(CalypsoCardCommand::READ_BINARY, length, calypsoCard),
   mSfi(sfi),
   mOffset(offset)
+{
+    buildCommand(calypsoCard->getCardClass(), offset, length);
+}
+
+CmdCardReadBinary::CmdCardReadBinary(const CalypsoCardClass calypsoCardClass,
+                                     const uint8_t sfi,
+                                     const int offset,
+                                     const int length)
+: AbstractCardCommand(CalypsoCardCommand::READ_BINARY, length, nullptr),
+  mSfi(sfi),
+  mOffset(offset)
+{
+    buildCommand(calypsoCardClass, offset, length);
+}
+
+void CmdCardReadBinary::buildCommand(const CalypsoCardClass calypsoCardClass,
+                                     const int offset,
+                                     const int length)
 {
     const uint8_t msb = ((offset & 0xFF00) >> 8);
     const uint8_t lsb = (offset & 0xFF);
@@ -58,14 +79,14 @@ CmdCardReadBinary::CmdCardReadBinary(const std::shared_ptr<CalypsoCardAdapter> c
     setApduRequest(
         std::make_shared<ApduRequestAdapter>(
             ApduUtil::build(
-                calypsoCard->getCardClass().getValue(),
+                calypsoCardClass.getValue(),
                 getCommandRef().getInstructionByte(),
                 p1,
                 lsb,
                 static_cast<uint8_t>(length))));
 
     std::stringstream extraInfo;
-    extraInfo << "SFI:" << sfi << "h, "
+    extraInfo << "SFI:" << mSfi << "h, "
               << "OFFSET:" << offset << ", "
               << "LENGTH:" << length;
 
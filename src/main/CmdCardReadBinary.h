@@ -65,6 +65,21 @@ public:
                       const int offset,
                       const int length);
 
+    /**
+     * (package-private)<br>
+     * Constructor to be used when the card is not yet identified (e.g. during the card selection).
+     *
+     * @param calypsoCardClass Indicates which CLA byte should be used for the Apdu.
+     * @param sfi The sfi to select.
+     * @param offset The offset.
+     * @param length The number of bytes to read.
+     * @since 2.2.5.6
+     */
+    CmdCardReadBinary(const CalypsoCardClass calypsoCardClass,
+                      const uint8_t sfi,
+                      const int offset,
+                      const int length);
+
     /**
      * {@inheritDoc}
      *
@@ -102,7 +117,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CmdCardReadBinary));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -123,6 +138,16 @@ private:
      *
      */
     static const std::map<const int, const std::shared_ptr<StatusProperties>> initStatusTable();
+
+    /**
+     * (private)<br>
+     * Builds the command.
+     *
+     * @param calypsoCardClass Indicates which CLA byte should be used for the Apdu.
+     * @param offset The offset.
+     * @param length The number of bytes to read.
+     */
+    void buildCommand(const CalypsoCardClass calypsoCardClass, const int offset, const int length);
 };
 
 }
@@ -32,6 +32,9 @@ namespace calypso {
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 
+const std::unique_ptr<Logger> CmdCardReadRecordMultiple::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardReadRecordMultiple));
+
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardReadRecordMultiple::STATUS_TABLE = initStatusTable();
 
@@ -47,24 +50,44 @@ CmdCardReadRecordMultiple::CmdCardReadRecordMultiple(
   mOffset(offset),
   mLength(length)
 {
-    const uint8_t p2 = (sfi * 8 + 5);
-    const std::vector<uint8_t> dataIn = {0x54, 0x02, offset, length};
+    buildCommand(calypsoCard->getCardClass());
+}
+
+CmdCardReadRecordMultiple::CmdCardReadRecordMultiple(
+  const CalypsoCardClass calypsoCardClass,
+  const uint8_t sfi,
+  const uint8_t recordNumber,
+  const uint8_t offset,
+  const uint8_t length)
+: AbstractCardCommand(CalypsoCardCommand::READ_RECORD_MULTIPLE, -1, nullptr),
+  mSfi(sfi),
+  mRecordNumber(recordNumber),
+  mOffset(offset),
+  mLength(length)
+{
+    buildCommand(calypsoCardClass);
+}
+
+void CmdCardReadRecordMultiple::buildCommand(const CalypsoCardClass calypsoCardClass)
+{
+    const uint8_t p2 = (mSfi * 8 + 5);
+    const std::vector<uint8_t> dataIn = {0x54, 0x02, mOffset, mLength};
 
     // APDU Case 4 - always outside secure session
     setApduRequest(
         std::make_shared<ApduRequestAdapter>(
-            ApduUtil::build(calypsoCard->getCardClass().getValue(),
+            ApduUtil::build(calypsoCardClass.getValue(),
                             getCommandRef().getInstructionByte(),
-                            recordNumber,
+                            mRecordNumber,
                             p2,
                             dataIn,
                             0)));
 
     std::stringstream extraInfo;
-    extraInfo << "SFI:" << sfi << "h, "
-              << "RECORD_NUMBER:" << recordNumber << ", "
-              << "OFFSET:" << offset << ", "
-              << "LENGTH:" << length;
+    extraInfo << "SFI:" << mSfi << "h, "
+              << "RECORD_NUMBER:" << mRecordNumber << ", "
+              << "OFFSET:" << mOffset << ", "
+              << "LENGTH:" << mLength;
 
     addSubName(extraInfo.str());
 }
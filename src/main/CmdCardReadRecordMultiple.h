@@ -59,6 +59,23 @@ public:
                               const uint8_t offset,
                               const uint8_t length);
 
+    /**
+     * (package-private)<br>
+     * Constructor to be used when the card is not yet identified (e.g. during the card selection).
+     *
+     * @param calypsoCardClass Indicates which CLA byte should be used for the Apdu.
+     * @param sfi The SFI.
+     * @param recordNumber The number of the first record to read.
+     * @param offset The offset from which to read in each record.
+     * @param length The number of bytes to read in each record.
+     * @since 2.2.5.6
+     */
+    CmdCardReadRecordMultiple(const CalypsoCardClass calypsoCardClass,
+                              const uint8_t sfi,
+                              const uint8_t recordNumber,
+                              const uint8_t offset,
+                              const uint8_t length);
+
     /**
      * {@inheritDoc}
      *
@@ -86,8 +103,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CmdCardReadRecordMultiple));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -118,6 +134,14 @@ private:
      *
      */
     static const std::map<const int, const std::shared_ptr<StatusProperties>> initStatusTable();
+
+    /**
+     * (private)<br>
+     * Builds the command.
+     *
+     * @param calypsoCardClass Indicates which CLA byte should be used for the Apdu.
+     */
+    void buildCommand(const CalypsoCardClass calypsoCardClass);
 };
 
 }
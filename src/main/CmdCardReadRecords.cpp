@@ -31,6 +31,9 @@ namespace calypso {
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 
+const std::unique_ptr<Logger> CmdCardReadRecords::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardReadRecords));
+
 const CalypsoCardCommand CmdCardReadRecords::mCommand = CalypsoCardCommand::READ_RECORDS;
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardReadRecords::STATUS_TABLE = initStatusTable();
@@ -145,6 +148,7 @@ void CmdCardReadRecords::parseApduResponse(const std::shared_ptr<ApduResponseApi
     if (mReadMode == CmdCardReadRecords::ReadMode::ONE_RECORD) {
 
         getCalypsoCard()->setContent(mSfi, mFirstRecordNumber, apduResponse->getDataOut());
+        mReadRecordNumbers.push_back(static_cast<uint8_t>(mFirstRecordNumber));
 
     } else {
 
@@ -160,6 +164,7 @@ void CmdCardReadRecords::parseApduResponse(const std::shared_ptr<ApduResponseApi
             getCalypsoCard()->setContent(mSfi,
                                             recordNb,
                                             Arrays::copyOfRange(mApdu, index, index + len));
+            mReadRecordNumbers.push_back(recordNb);
 
             index = index + len;
             apduLen -= (2 + len);
@@ -167,6 +172,11 @@ void CmdCardReadRecords::parseApduResponse(const std::shared_ptr<ApduResponseApi
     }
 }
 
+const std::vector<uint8_t>& CmdCardReadRecords::getReadRecordNumbers() const
+{
+    return mReadRecordNumbers;
+}
+
 uint8_t CmdCardReadRecords::getSfi() const
 {
     return mSfi;
@@ -187,6 +197,41 @@ CmdCardReadRecords::ReadMode CmdCardReadRecords::getReadMode() const
     return mReadMode;
 }
 
+const std::vector<CmdCardReadRecords::Chunk> CmdCardReadRecords::splitRecords(
+    const uint8_t fromRecordNumber,
+    const uint8_t toRecordNumber,
+    const uint8_t recordSize,
+    const int payloadCapacity)
+{
+    std::vector<Chunk> chunks;
+
+    const uint8_t nbBytesPerRecord = recordSize + 2;
+    const uint8_t nbRecordsPerApdu = static_cast<uint8_t>(payloadCapacity / nbBytesPerRecord);
+    const uint8_t dataSizeMaxPerApdu = nbRecordsPerApdu * nbBytesPerRecord;
+
+    uint8_t currentRecordNumber = fromRecordNumber;
+    uint8_t nbRecordsRemainingToRead = toRecordNumber - fromRecordNumber + 1;
+    uint8_t currentLength;
+
+    while (currentRecordNumber < toRecordNumber) {
+        currentLength = nbRecordsRemainingToRead <= nbRecordsPerApdu ?
+                            nbRecordsRemainingToRead * nbBytesPerRecord :
+                            dataSizeMaxPerApdu;
+
+        chunks.push_back({currentRecordNumber, ReadMode::MULTIPLE_RECORD, currentLength});
+
+        currentRecordNumber += (currentLength / nbBytesPerRecord);
+        nbRecordsRemainingToRead -= (currentLength / nbBytesPerRecord);
+    }
+
+    /* Optimization: prepare a read "one record" if possible for last iteration.*/
+    if (currentRecordNumber == toRecordNumber) {
+        chunks.push_back({currentRecordNumber, ReadMode::ONE_RECORD, recordSize});
+    }
+
+    return chunks;
+}
+
 std::ostream& operator<<(std::ostream& os, const CmdCardReadRecords::ReadMode rm)
 {
     os << "READ_MODE: ";
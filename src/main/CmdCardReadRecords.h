@@ -61,6 +61,29 @@ public:
         MULTIPLE_RECORD
     };
 
+    /**
+     * (package-private)<br>
+     * Part of a reading of several records transmitted in one APDU.
+     *
+     * @since 2.2.5.6
+     */
+    struct Chunk final {
+        /**
+         * The first record to read.
+         */
+        uint8_t mFirstRecordNumber;
+
+        /**
+         * The read mode.
+         */
+        ReadMode mReadMode;
+
+        /**
+         * The expected length of the record(s).
+         */
+        uint8_t mExpectedLength;
+    };
+
     /**
      * (package-private)<br>
      * Instantiates a new read records cmd build.
@@ -161,6 +184,38 @@ public:
      */
     const std::map<const uint8_t, const std::vector<uint8_t>>& getRecords() const;
 
+    /**
+     * (package-private)<br>
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @return The numbers of the records returned by the card, empty if the response has not been
+     *         parsed yet.
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t>& getReadRecordNumbers() const;
+
+    /**
+     * (package-private)<br>
+     * Splits the reading of a range of records into APDUs, taking into account the transmission
+     * capacity of the card and the response format of the multiple records reading (2 extra bytes
+     * per record).
+     *
+     * <p>The last record is read with a "one record" reading when it does not fit in the
+     * previous APDU.
+     *
+     * @param fromRecordNumber The number of the first record to read.
+     * @param toRecordNumber The number of the last record to read.
+     * @param recordSize The record size.
+     * @param payloadCapacity The transmission capacity of the card.
+     * @return A not empty list.
+     * @since 2.2.5.6
+     */
+    static const std::vector<Chunk> splitRecords(const uint8_t fromRecordNumber,
+                                                 const uint8_t toRecordNumber,
+                                                 const uint8_t recordSize,
+                                                 const int payloadCapacity);
+
     /**
      *
      */
@@ -170,7 +225,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CmdCardReadRecords));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -198,6 +253,11 @@ private:
      */
     ReadMode mReadMode = ReadMode::ONE_RECORD;
 
+    /**
+     *
+     */
+    std::vector<uint8_t> mReadRecordNumbers;
+
     /**
      *
      */
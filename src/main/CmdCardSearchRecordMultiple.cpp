@@ -34,6 +34,9 @@ namespace calypso {
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 
+const std::unique_ptr<Logger> CmdCardSearchRecordMultiple::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardSearchRecordMultiple));
+
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardSearchRecordMultiple::STATUS_TABLE = initStatusTable();
 
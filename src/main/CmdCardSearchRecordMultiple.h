@@ -81,8 +81,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CmdCardSearchRecordMultiple));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
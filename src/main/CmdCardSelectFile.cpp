@@ -38,6 +38,9 @@ using namespace calypsonet::terminal::calypso;
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp::exception;
 
+const std::unique_ptr<Logger> CmdCardSelectFile::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardSelectFile));
+
 const int CmdCardSelectFile::TAG_PROPRIETARY_INFORMATION = 0x85;
 const CalypsoCardCommand CmdCardSelectFile::mCommand = CalypsoCardCommand::SELECT_FILE;
 const std::map<const int, const std::shared_ptr<StatusProperties>>
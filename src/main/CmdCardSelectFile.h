@@ -152,7 +152,7 @@ private:
     /**
      *
      */
-    const std::shared_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CmdCardSelectFile));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -38,6 +38,9 @@ namespace calypso {
 
 using namespace keyple::core::util;
 
+const std::unique_ptr<Logger> CmdCardSvGet::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardSvGet));
+
 const CalypsoCardCommand CmdCardSvGet::mCommand = CalypsoCardCommand::SV_GET;
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardSvGet::STATUS_TABLE = initStatusTable();
@@ -47,7 +50,22 @@ CmdCardSvGet::CmdCardSvGet(const std::shared_ptr<CalypsoCardAdapter> calypsoCard
                            const bool useExtendedMode)
 : AbstractCardCommand(mCommand, -1, calypsoCard)
 {
-    const uint8_t cla = calypsoCard->getCardClass() == CalypsoCardClass::LEGACY ?
+    buildCommand(calypsoCard->getCardClass(), svOperation, useExtendedMode);
+}
+
+CmdCardSvGet::CmdCardSvGet(const CalypsoCardClass calypsoCardClass,
+                           const SvOperation svOperation,
+                           const bool useExtendedMode)
+: AbstractCardCommand(mCommand, -1, nullptr)
+{
+    buildCommand(calypsoCardClass, svOperation, useExtendedMode);
+}
+
+void CmdCardSvGet::buildCommand(const CalypsoCardClass calypsoCardClass,
+                                const SvOperation svOperation,
+                                const bool useExtendedMode)
+{
+    const uint8_t cla = calypsoCardClass == CalypsoCardClass::LEGACY ?
                         CalypsoCardClass::LEGACY_STORED_VALUE.getValue() :
                         CalypsoCardClass::ISO.getValue();
 
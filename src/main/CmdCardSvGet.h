@@ -62,6 +62,20 @@ public:
                  const SvOperation svOperation,
                  const bool useExtendedMode);
 
+    /**
+     * (package-private)<br>
+     * Instantiates a new CmdCardSvGet when the card is not yet identified (e.g. during the card
+     * selection).
+     *
+     * @param calypsoCardClass The class of the card.
+     * @param svOperation the desired SV operation.
+     * @param useExtendedMode True if the extended mode must be used
+     * @since 2.2.5.6
+     */
+    CmdCardSvGet(const CalypsoCardClass calypsoCardClass,
+                 const SvOperation svOperation,
+                 const bool useExtendedMode);
+
     /**
      * {@inheritDoc}
      *
@@ -89,7 +103,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CmdCardSvGet));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      * The command
@@ -110,6 +124,18 @@ private:
      *
      */
     static const std::map<const int, const std::shared_ptr<StatusProperties>> initStatusTable();
+
+    /**
+     * (private)<br>
+     * Builds the command.
+     *
+     * @param calypsoCardClass The class of the card.
+     * @param svOperation the desired SV operation.
+     * @param useExtendedMode True if the extended mode must be used
+     */
+    void buildCommand(const CalypsoCardClass calypsoCardClass,
+                      const SvOperation svOperation,
+                      const bool useExtendedMode);
 };
 
 }
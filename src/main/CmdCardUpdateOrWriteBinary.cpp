@@ -34,6 +34,9 @@ namespace calypso {
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 
+const std::unique_ptr<Logger> CmdCardUpdateOrWriteBinary::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardUpdateOrWriteBinary));
+
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardUpdateOrWriteBinary::STATUS_TABLE = initStatusTable();
 
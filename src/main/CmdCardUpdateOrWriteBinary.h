@@ -97,8 +97,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CmdCardUpdateOrWriteBinary));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
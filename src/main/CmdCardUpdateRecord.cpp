@@ -30,6 +30,9 @@ namespace calypso {
 
 using namespace keyple::core::util;
 
+const std::unique_ptr<Logger> CmdCardUpdateRecord::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardUpdateRecord));
+
 const CalypsoCardCommand CmdCardUpdateRecord::mCommand = CalypsoCardCommand::UPDATE_RECORD;
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardUpdateRecord::STATUS_TABLE = initStatusTable();
@@ -94,8 +94,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CmdCardUpdateRecord));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
@@ -36,6 +36,9 @@ using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 using namespace keyple::core::util::cpp::exception;
 
+const std::unique_ptr<Logger> CmdCardVerifyPin::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardVerifyPin));
+
 const CalypsoCardCommand CmdCardVerifyPin::mCommand = CalypsoCardCommand::VERIFY_PIN;
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardVerifyPin::STATUS_TABLE = initStatusTable();
@@ -100,7 +100,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(CmdCardVerifyPin));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
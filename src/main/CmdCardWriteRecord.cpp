@@ -30,6 +30,9 @@ namespace calypso {
 
 using namespace keyple::core::util;
 
+const std::unique_ptr<Logger> CmdCardWriteRecord::mLogger =
+    LoggerFactory::getLogger(typeid(CmdCardWriteRecord));
+
 const CalypsoCardCommand CmdCardWriteRecord::mCommand = CalypsoCardCommand::WRITE_RECORD;
 const std::map<const int, const std::shared_ptr<StatusProperties>>
     CmdCardWriteRecord::STATUS_TABLE = initStatusTable();
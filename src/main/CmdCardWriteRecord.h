@@ -89,8 +89,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CmdCardWriteRecord));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      * The command
@@ -47,6 +47,8 @@ CmdSamSelectDiversifier::CmdSamSelectDiversifier(
         diversifier = tmp;
     }
 
+    mDiversifier = diversifier;
+
     setApduRequest(
         std::make_shared<ApduRequestAdapter>(
             ApduUtil::build(SamUtilAdapter::getClassByte(calypsoSam->getProductType()),
@@ -78,6 +80,16 @@ const std::map<const int, const std::shared_ptr<StatusProperties>>&
     return STATUS_TABLE;
 }
 
+void CmdSamSelectDiversifier::parseApduResponse(const std::shared_ptr<ApduResponseApi> apduResponse)
+{
+    /* The selected diversifier is unknown if the command failed */
+    getCalypsoSam()->setSelectedKeyDiversifier(std::vector<uint8_t>());
+
+    AbstractSamCommand::parseApduResponse(apduResponse);
+
+    getCalypsoSam()->setSelectedKeyDiversifier(mDiversifier);
+}
+
 }
 }
 }
@@ -52,7 +52,21 @@ public:
     const std::map<const int, const std::shared_ptr<StatusProperties>>& getStatusTable() const
         override;
 
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Keeps the selected key diversifier in the SAM image.
+     *
+     * @since 2.2.5.6
+     */
+    void parseApduResponse(const std::shared_ptr<ApduResponseApi> apduResponse) override;
+
 private:
+    /**
+     *
+     */
+    std::vector<uint8_t> mDiversifier;
+
     /**
      *
      */
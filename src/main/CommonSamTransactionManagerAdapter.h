@@ -40,6 +40,7 @@
 #include "CommonSignatureComputationData.h"
 #include "CommonSignatureVerificationData.h"
 #include "CommonTransactionManagerAdapter.h"
+#include "ControlSamScheduler.h"
 #include "ReaderBrokenCommunicationException.h"
 #include "SamSecuritySetting.h"
 #include "SamSecuritySettingAdapter.h"
@@ -100,7 +101,9 @@ public:
       mSamReader(samReader),
       mSam(sam),
       mSecuritySetting(securitySetting),
-      mDefaultKeyDiversifier(sam->getSerialNumber()) {}
+      mDefaultKeyDiversifier(sam->getSerialNumber()),
+      mIsControlSamScheduled(
+          std::dynamic_pointer_cast<ControlSamScheduler>(samReader) != nullptr) {}
 
     /**
      * (package-private)<br>
@@ -126,7 +129,9 @@ public:
       mSamReader(securitySetting->getControlSamReader()),
       mSam(securitySetting->getControlSam()),
       mSecuritySetting(securitySetting),
-      mDefaultKeyDiversifier(defaultKeyDiversifier) {}
+      mDefaultKeyDiversifier(defaultKeyDiversifier),
+      mIsControlSamScheduled(std::dynamic_pointer_cast<ControlSamScheduler>(
+                                 securitySetting->getControlSamReader()) != nullptr) {}
 
     /**
      * C++: Ugly hack to avoid ambiguous method lookup. This function should be final in
@@ -409,12 +414,12 @@ public:
             */
             if (apduResponses.size() > apduRequests.size()) {
 
-                throw InconsistentDataException("The number of SAM commands/responses does not " \
-                                                "match: nb commands = " +
-                                                std::to_string(apduRequests.size()) +
-                                                ", nb responses = " +
-                                                std::to_string(apduResponses.size()) +
-                                                getTransactionAuditDataAsString());
+                throw withTransactionAuditData(
+                          InconsistentDataException("The number of SAM commands/responses " \
+                                                    "does not match: nb commands = " +
+                                                    std::to_string(apduRequests.size()) +
+                                                    ", nb responses = " +
+                                                    std::to_string(apduResponses.size())));
             }
 
             /*
@@ -487,12 +492,12 @@ public:
                         throw;
                     }
 
-                    throw UnexpectedCommandStatusException(
-                              MSG_SAM_COMMAND_ERROR +
-                              "while processing responses to SAM commands: " +
-                              e.getCommand().getName() +
-                              getTransactionAuditDataAsString(),
-                              std::make_shared<CalypsoSamCommandException>(e));
+                    throw withTransactionAuditData(
+                              UnexpectedCommandStatusException(
+                                  MSG_SAM_COMMAND_ERROR +
+                                  "while processing responses to SAM commands: " +
+                                  e.getCommand().getName(),
+                                  std::make_shared<CalypsoSamCommandException>(e)));
                 }
             }
 
@@ -502,11 +507,11 @@ public:
             */
             if (apduResponses.size() < apduRequests.size()) {
 
-                throw InconsistentDataException(
-                          "The number of SAM commands/responses does not match:" \
-                          " nb commands = " + std::to_string(apduRequests.size()) +
-                          ", nb responses = " + std::to_string(apduResponses.size()) +
-                          getTransactionAuditDataAsString());
+                throw withTransactionAuditData(
+                          InconsistentDataException(
+                              "The number of SAM commands/responses does not match:" \
+                              " nb commands = " + std::to_string(apduRequests.size()) +
+                              ", nb responses = " + std::to_string(apduResponses.size())));
             }
 
         } catch (const Exception& e) {
@@ -541,6 +546,51 @@ protected:
         return mSamCommands;
     }
 
+    /**
+     * (package-private)<br>
+     * Transmits a card request, processes and converts any exceptions.
+     *
+     * @param cardRequest The card request to transmit.
+     * @return The card response.
+     * @since 2.2.5.6
+     */
+    virtual std::shared_ptr<CardResponseApi> transmitCardRequest(
+        const std::shared_ptr<CardRequestSpi> cardRequest)
+    {
+        std::shared_ptr<CardResponseApi> cardResponse = nullptr;
+
+        /* Any command makes the SAM forget a challenge generated in advance */
+        mSam->clearPrefetchedChallenge();
+
+        try {
+            cardResponse = mSamReader->transmitCardRequest(cardRequest, ChannelControl::KEEP_OPEN);
+
+        } catch (const ReaderBrokenCommunicationException& e) {
+            saveTransactionAuditData(cardRequest, e.getCardResponse());
+            mSam->setSelectedKeyDiversifier(std::vector<uint8_t>());
+            throw withTransactionAuditData(
+                      ReaderIOException(MSG_SAM_READER_COMMUNICATION_ERROR +
+                                        MSG_WHILE_TRANSMITTING_COMMANDS,
+                                        std::make_shared<ReaderBrokenCommunicationException>(e)));
+
+        } catch (const CardBrokenCommunicationException& e) {
+            saveTransactionAuditData(cardRequest, e.getCardResponse());
+            mSam->setSelectedKeyDiversifier(std::vector<uint8_t>());
+            throw withTransactionAuditData(
+                      SamIOException(MSG_SAM_COMMUNICATION_ERROR +
+                                     MSG_WHILE_TRANSMITTING_COMMANDS,
+                                     std::make_shared<CardBrokenCommunicationException>(e)));
+
+        } catch (const UnexpectedStatusWordException& e) {
+            mLogger->debug("A SAM command has failed: %\n", e.getMessage());
+            cardResponse = e.getCardResponse();
+        }
+
+        saveTransactionAuditData(cardRequest, cardResponse);
+
+        return cardResponse;
+    }
+
     /**
      * (package-private)<br>
      * Prepares a "SelectDiversifier" command using a specific or the default key diversifier if it
@@ -551,6 +601,8 @@ protected:
      */
     void prepareSelectDiversifierIfNeeded(const std::vector<uint8_t>& specificKeyDiversifier)
     {
+        synchronizeCurrentKeyDiversifier();
+
         if (!specificKeyDiversifier.empty()) {
             if (!Arrays::equals(specificKeyDiversifier, mCurrentKeyDiversifier)) {
                 mCurrentKeyDiversifier = specificKeyDiversifier;
@@ -570,12 +622,26 @@ protected:
      */
     void prepareSelectDiversifierIfNeeded()
     {
+        synchronizeCurrentKeyDiversifier();
+
         if (!Arrays::equals(mCurrentKeyDiversifier, mDefaultKeyDiversifier)) {
             mCurrentKeyDiversifier = mDefaultKeyDiversifier;
             prepareSelectDiversifier();
         }
     }
 
+    /**
+     * (package-private)<br>
+     * Indicates if the SAM reader is shared with other threads through a ControlSamScheduler.
+     *
+     * @return True if the SAM reader is a ControlSamScheduler.
+     * @since 2.2.5.6
+     */
+    bool isControlSamScheduled() const
+    {
+        return mIsControlSamScheduled;
+    }
+
     // /**
     //  * {@inheritDoc}
     //  *
@@ -644,8 +710,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(CommonSamTransactionManagerAdapter));
+    static const std::unique_ptr<Logger> mLogger;
 
     const std::string MSG_INPUT_OUTPUT_DATA = "input/output data";
     const std::string MSG_SIGNATURE_SIZE = "signature size";
@@ -664,46 +729,23 @@ private:
     std::vector<std::shared_ptr<AbstractApduCommand>> mSamCommands;
     const std::vector<uint8_t> mDefaultKeyDiversifier;
 
+    /* C++: resolved once at construction */
+    const bool mIsControlSamScheduled;
+
     /* Dynamic fields */
     std::vector<uint8_t> mCurrentKeyDiversifier;
 
     /**
      * (private)<br>
-     * Transmits a card request, processes and converts any exceptions.
-     *
-     * @param cardRequest The card request to transmit.
-     * @return The card response.
+     * Retrieves the key diversifier selected in the SAM, possibly by a previous transaction, when
+     * no command is pending.
      */
-    virtual std::shared_ptr<CardResponseApi> transmitCardRequest(
-        const std::shared_ptr<CardRequestSpi> cardRequest)
+    void synchronizeCurrentKeyDiversifier()
     {
-        std::shared_ptr<CardResponseApi> cardResponse = nullptr;
-
-        try {
-            cardResponse = mSamReader->transmitCardRequest(cardRequest, ChannelControl::KEEP_OPEN);
-
-        } catch (const ReaderBrokenCommunicationException& e) {
-            saveTransactionAuditData(cardRequest, e.getCardResponse());
-            throw ReaderIOException(MSG_SAM_READER_COMMUNICATION_ERROR +
-                                    MSG_WHILE_TRANSMITTING_COMMANDS +
-                                    getTransactionAuditDataAsString(),
-                                    std::make_shared<ReaderBrokenCommunicationException>(e));
-
-        } catch (const CardBrokenCommunicationException& e) {
-            saveTransactionAuditData(cardRequest, e.getCardResponse());
-            throw SamIOException(MSG_SAM_COMMUNICATION_ERROR +
-                                MSG_WHILE_TRANSMITTING_COMMANDS +
-                                getTransactionAuditDataAsString(),
-                                std::make_shared<CardBrokenCommunicationException>(e));
-
-        } catch (const UnexpectedStatusWordException& e) {
-            mLogger->debug("A SAM command has failed: %\n", e.getMessage());
-            cardResponse = e.getCardResponse();
+        /* A shared SAM may have been used by another thread in between */
+        if (mSamCommands.empty() && !isControlSamScheduled()) {
+            mCurrentKeyDiversifier = mSam->getSelectedKeyDiversifier();
         }
-
-        saveTransactionAuditData(cardRequest, cardResponse);
-
-        return cardResponse;
     }
 
     /**
@@ -719,6 +761,10 @@ private:
     }
 };
 
+template <typename T>
+const std::unique_ptr<Logger> CommonSamTransactionManagerAdapter<T>::mLogger =
+    LoggerFactory::getLogger(typeid(CommonSamTransactionManagerAdapter<T>));
+
 }
 }
 }
@@ -17,6 +17,9 @@
 /* Calypsonet Terminal Calypso */
 #include "CommonSignatureVerificationData.h"
 
+/* Keyple Card Calypso */
+#include "Optional.h"
+
 /* Keyple Core Util */
 #include "IllegalStateException.h"
 
@@ -75,11 +78,11 @@ public:
      */
     bool isSignatureValid() const override
     {
-        if (mIsSignatureValid == nullptr) {
+        if (!mIsSignatureValid.isPresent()) {
             throw IllegalStateException("The command has not yet been processed");
         }
 
-        return *mIsSignatureValid;
+        return mIsSignatureValid.get();
     }
 
     /**
@@ -136,7 +139,7 @@ public:
      */
     virtual void setSignatureValid(const bool isSignatureValid)
     {
-        mIsSignatureValid = std::make_shared<bool>(isSignatureValid);
+        mIsSignatureValid = isSignatureValid;
     }
 
     /**
@@ -192,7 +195,7 @@ private:
     /**
      *
      */
-    std::shared_ptr<bool> mIsSignatureValid = nullptr;
+    Optional<bool> mIsSignatureValid;
 };
 
 }
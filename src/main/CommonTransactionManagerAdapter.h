@@ -26,7 +26,9 @@
 
 /* Keyple Card Calypso */
 #include "AbstractApduCommand.h"
+#include "AuditedException.h"
 #include "CommonSecuritySettingAdapter.h"
+#include "TransactionAuditData.h"
 
 /* Keyple Core Util */
 #include "HexUtil.h"
@@ -77,7 +79,8 @@ public:
       const std::vector<std::vector<uint8_t>>& transactionAuditData)
     : mTargetSmartCard(targetSmartCard),
       mSecuritySetting(securitySetting),
-      mTransactionAuditData(transactionAuditData) {}
+      mTransactionAuditData(
+          std::make_shared<std::vector<std::vector<uint8_t>>>(transactionAuditData)) {}
 
     /**
      * {@inheritDoc}
@@ -87,21 +90,26 @@ public:
     const std::vector<std::vector<uint8_t>>& getTransactionAuditData() const override
     {
         /* CL-CSS-INFODATA.1 */
-        return mTransactionAuditData;
+        return *mTransactionAuditData;
     }
 
     /**
      * (package-private)<br>
      * Creates a list of ApduRequestSpi from a list of AbstractApduCommand.
      *
+     * <p>C++: template so that lists of AbstractCardCommand or AbstractSamCommand are accepted
+     * without being copied.
+     *
      * @param commands The list of commands.
      * @return An empty list if there is no command.
      * @since 2.2.0
      */
+    template <typename C>
     const std::vector<std::shared_ptr<ApduRequestSpi>> getApduRequests(
-        const std::vector<std::shared_ptr<AbstractApduCommand>>& commands)
+        const std::vector<std::shared_ptr<C>>& commands)
     {
         std::vector<std::shared_ptr<ApduRequestSpi>> apduRequests;
+        apduRequests.reserve(commands.size());
 
         for (const auto& command : commands) {
             apduRequests.push_back(command->getApduRequest());
@@ -128,8 +136,8 @@ public:
                 cardResponse->getApduResponses();
 
             for (int i = 0; i < static_cast<int>(responses.size()); i++) {
-                mTransactionAuditData.push_back(requests[i]->getApdu());
-                mTransactionAuditData.push_back(responses[i]->getApdu());
+                mTransactionAuditData->push_back(requests[i]->getApdu());
+                mTransactionAuditData->push_back(responses[i]->getApdu());
             }
         }
     }
@@ -163,31 +171,25 @@ public:
 
     /**
      * (package-private)<br>
-     * Returns a string representation of the transaction audit data.
+     * Completes the provided exception with a snapshot of the transaction audit data, which will
+     * only be formatted if the message of the exception is requested.
+     *
+     * <p>C++: specific to this implementation.
      *
-     * @return A not empty string.
+     * @param exception The exception to throw.
+     * @return A new exception of a subtype of E.
+     * @since 2.2.5.6
      */
-    const std::string getTransactionAuditDataAsString() const
+    template <typename E>
+    AuditedException<E> withTransactionAuditData(const E& exception) const
     {
-        std::stringstream ss;
-
-        ss << "\nTransaction audit JSON data: {";
-        ss << "\"targetSmartCard\":" << mTargetSmartCard << ",";
-
-        if (mSecuritySetting != nullptr && mSecuritySetting->getControlSam() != nullptr) {
-            ss << "\"controlSam\":" << mSecuritySetting->getControlSam() << ",";
-        }
+        const std::shared_ptr<CalypsoSamAdapter> controlSam =
+            mSecuritySetting != nullptr ? mSecuritySetting->getControlSam() : nullptr;
 
-        ss << "\"apdus\": {";
-        for(auto it = mTransactionAuditData.begin(); it != mTransactionAuditData.end(); it++) {
-            ss << HexUtil::toHex(*it);
-            if (it != mTransactionAuditData.end() - 1) {
-                ss << ", ";
-            }
-        }
-        ss << "}";
-
-        return ss.str();
+        return AuditedException<E>(exception,
+                                   std::make_shared<TransactionAuditData>(mTargetSmartCard,
+                                                                          controlSam,
+                                                                          mTransactionAuditData));
     }
 
 private:
@@ -202,9 +204,9 @@ private:
     std::shared_ptr<CommonSecuritySettingAdapter<U>> mSecuritySetting;
 
     /**
-     *
+     * C++: shared with the snapshots taken by withTransactionAuditData, only ever completed.
      */
-    std::vector<std::vector<uint8_t>> mTransactionAuditData;
+    const std::shared_ptr<std::vector<std::vector<uint8_t>>> mTransactionAuditData;
 };
 
 }
@@ -0,0 +1,565 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "ControlSamScheduler.h"
+
+#include <algorithm>
+
+/* Calypsonet Terminal Card */
+#include "CardBrokenCommunicationException.h"
+#include "ReaderBrokenCommunicationException.h"
+#include "UnexpectedStatusWordException.h"
+
+/* Keyple Card Calypso */
+#include "ApduRequestAdapter.h"
+#include "CalypsoSamCommand.h"
+#include "CardRequestAdapter.h"
+#include "LocalApduResponseAdapter.h"
+#include "LocalCardResponseAdapter.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+#include "KeypleAssert.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp;
+using namespace keyple::core::util::cpp::exception;
+
+const int ControlSamScheduler::DEFAULT_LEASE_TIMEOUT = 2000;
+
+const std::unique_ptr<Logger> ControlSamScheduler::mLogger =
+    LoggerFactory::getLogger(typeid(ControlSamScheduler));
+
+/* CONTROL SAM SCHEDULER ------------------------------------------------------------------------ */
+
+ControlSamScheduler::ControlSamScheduler(const std::shared_ptr<CardReader> samReader)
+: mSamReader(samReader),
+  mSamProxyReader(std::dynamic_pointer_cast<ProxyReaderApi>(samReader)),
+  mLeaseTimeout(DEFAULT_LEASE_TIMEOUT)
+{
+    Assert::getInstance().notNull(samReader, "samReader");
+
+    if (mSamProxyReader == nullptr) {
+        throw IllegalArgumentException("The provided 'samReader' must implement 'ProxyReaderApi'");
+    }
+}
+
+ControlSamScheduler& ControlSamScheduler::setLeaseTimeout(const int leaseTimeout)
+{
+    Assert::getInstance().greaterOrEqual(leaseTimeout, 1, "leaseTimeout");
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mLeaseTimeout = leaseTimeout;
+
+    return *this;
+}
+
+void ControlSamScheduler::renewLease()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mIsLeased && mLeaseHolder == std::this_thread::get_id()) {
+        mLeaseLastUseTime = std::chrono::steady_clock::now();
+    }
+}
+
+void ControlSamScheduler::releaseLease()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mIsLeased && mLeaseHolder == std::this_thread::get_id()) {
+        clearLease();
+        mCondition.notify_all();
+    }
+}
+
+int ControlSamScheduler::getQueueDepth() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return static_cast<int>(mQueue.size());
+}
+
+long ControlSamScheduler::getBatchCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mBatchCount;
+}
+
+long ControlSamScheduler::getMergedBatchCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mMergedBatchCount;
+}
+
+long ControlSamScheduler::getRequestCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mRequestCount;
+}
+
+uint64_t ControlSamScheduler::getTotalWaitTime() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mTotalWaitTime;
+}
+
+uint64_t ControlSamScheduler::getMaxWaitTime() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return mMaxWaitTime;
+}
+
+const std::string& ControlSamScheduler::getName() const
+{
+    return mSamReader->getName();
+}
+
+bool ControlSamScheduler::isContactless()
+{
+    return mSamReader->isContactless();
+}
+
+bool ControlSamScheduler::isCardPresent()
+{
+    return mSamReader->isCardPresent();
+}
+
+const std::shared_ptr<CardResponseApi> ControlSamScheduler::transmitCardRequest(
+    const std::shared_ptr<CardRequestSpi> cardRequest,
+    const ChannelControl channelControl)
+{
+    auto batch = std::make_shared<Batch>();
+    batch->mLane = std::this_thread::get_id();
+    batch->mCardRequest = cardRequest;
+    batch->mChannelControl = channelControl;
+    batch->mSubmissionTime = std::chrono::steady_clock::now();
+    batch->mIsMergeable = channelControl == ChannelControl::KEEP_OPEN &&
+                          !cardRequest->getApduRequests().empty();
+    batch->mIsDone = false;
+
+    for (const auto& apduRequest : cardRequest->getApduRequests()) {
+        batch->mIsMergeable = batch->mIsMergeable && isStateless(getIns(apduRequest->getApdu()));
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    mQueue.push_back(batch);
+    mBatchCount++;
+
+    /* The first thread finding the SAM reader free transmits the next request on behalf of all */
+    while (!batch->mIsDone) {
+
+        if (!mIsBusy) {
+
+            std::vector<std::shared_ptr<Batch>> batches = pollBatches();
+            if (!batches.empty()) {
+
+                mIsBusy = true;
+                transmit(batches, lock);
+                mIsBusy = false;
+
+                mCondition.notify_all();
+                continue;
+            }
+        }
+
+        if (!mIsBusy && mIsLeased) {
+            mCondition.wait_until(lock,
+                                  mLeaseLastUseTime + std::chrono::milliseconds(mLeaseTimeout));
+        } else {
+            mCondition.wait(lock);
+        }
+    }
+
+    if (batch->mException != nullptr) {
+        std::rethrow_exception(batch->mException);
+    }
+
+    return batch->mCardResponse;
+}
+
+void ControlSamScheduler::releaseChannel()
+{
+    mSamProxyReader->releaseChannel();
+}
+
+std::vector<std::shared_ptr<ControlSamScheduler::Batch>> ControlSamScheduler::pollBatches()
+{
+    std::vector<std::shared_ptr<Batch>> batches;
+
+    if (mIsLeased &&
+        std::chrono::steady_clock::now() - mLeaseLastUseTime >=
+            std::chrono::milliseconds(mLeaseTimeout)) {
+
+        mLogger->warn("The SAM is no longer reserved by an inactive thread (lease timeout)\n");
+        clearLease();
+    }
+
+    if (mIsLeased) {
+
+        /* Only the requests of the thread holding the lease can be transmitted */
+        const std::thread::id leaseHolder = mLeaseHolder;
+        const auto it = std::find_if(mQueue.begin(),
+                                     mQueue.end(),
+                                     [leaseHolder](const std::shared_ptr<Batch>& b) {
+                                         return b->mLane == leaseHolder;
+                                     });
+        if (it != mQueue.end()) {
+            batches.push_back(*it);
+            mQueue.erase(it);
+        }
+
+        return batches;
+    }
+
+    if (mQueue.empty()) {
+        return batches;
+    }
+
+    batches.push_back(mQueue.front());
+    mQueue.pop_front();
+
+    if (batches[0]->mIsMergeable) {
+        for (auto it = mQueue.begin(); it != mQueue.end();) {
+            if ((*it)->mIsMergeable) {
+                batches.push_back(*it);
+                it = mQueue.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return batches;
+}
+
+std::vector<std::shared_ptr<ApduRequestSpi>> ControlSamScheduler::buildApduRequests(
+    std::vector<std::shared_ptr<Batch>>& batches) const
+{
+    std::vector<std::shared_ptr<ApduRequestSpi>> apduRequests;
+    std::vector<uint8_t> keyDiversifier = mKeyDiversifier;
+
+    for (const auto& batch : batches) {
+
+        const std::vector<std::shared_ptr<ApduRequestSpi>>& batchApduRequests =
+            batch->mCardRequest->getApduRequests();
+
+        batch->mOffset = apduRequests.size();
+        batch->mPrefixLength = 0;
+        batch->mIsLeadingSelectSkipped = false;
+
+        if (batchApduRequests.empty()) {
+            continue;
+        }
+
+        const std::vector<uint8_t>& firstApdu = batchApduRequests[0]->getApdu();
+
+        if (getIns(firstApdu) == CalypsoSamCommand::SELECT_DIVERSIFIER.getInstructionByte()) {
+
+            /* The state of the SAM is only certain at the beginning of the request */
+            batch->mIsLeadingSelectSkipped = apduRequests.empty() &&
+                                             !keyDiversifier.empty() &&
+                                             getKeyDiversifier(firstApdu) == keyDiversifier;
+        } else {
+
+            /* Restores the key diversifier expected by the thread if another one changed it */
+            const auto it = mLaneSelectDiversifiers.find(batch->mLane);
+            if (it != mLaneSelectDiversifiers.end() &&
+                getKeyDiversifier(it->second) != keyDiversifier) {
+                apduRequests.push_back(std::make_shared<ApduRequestAdapter>(it->second));
+                keyDiversifier = getKeyDiversifier(it->second);
+                batch->mPrefixLength = 1;
+            }
+        }
+
+        for (size_t i = batch->mIsLeadingSelectSkipped ? 1 : 0;
+             i < batchApduRequests.size();
+             i++) {
+            const std::vector<uint8_t>& apdu = batchApduRequests[i]->getApdu();
+            if (getIns(apdu) == CalypsoSamCommand::SELECT_DIVERSIFIER.getInstructionByte()) {
+                keyDiversifier = getKeyDiversifier(apdu);
+            }
+            apduRequests.push_back(batchApduRequests[i]);
+        }
+    }
+
+    return apduRequests;
+}
+
+void ControlSamScheduler::transmit(std::vector<std::shared_ptr<Batch>>& batches,
+                                   std::unique_lock<std::mutex>& lock)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    for (const auto& batch : batches) {
+        const uint64_t waitTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      now - batch->mSubmissionTime).count();
+        mTotalWaitTime += waitTime;
+        mMaxWaitTime = std::max(mMaxWaitTime, waitTime);
+    }
+
+    /* Merged requests are not stopped at the first failure so as not to penalize other threads */
+    const bool isMerged = batches.size() > 1;
+    const bool stopOnUnsuccessfulStatusWord =
+        !isMerged && batches[0]->mCardRequest->stopOnUnsuccessfulStatusWord();
+    const ChannelControl channelControl =
+        isMerged ? ChannelControl::KEEP_OPEN : batches[0]->mChannelControl;
+
+    if (isMerged) {
+        mMergedBatchCount += static_cast<long>(batches.size());
+    }
+
+    const std::vector<std::shared_ptr<ApduRequestSpi>> apduRequests = buildApduRequests(batches);
+
+    std::shared_ptr<CardResponseApi> cardResponse = nullptr;
+    Outcome outcome = Outcome::SUCCESS;
+    std::exception_ptr exception = nullptr;
+
+    if (!apduRequests.empty()) {
+
+        mRequestCount++;
+
+        lock.unlock();
+
+        try {
+
+            cardResponse = mSamProxyReader->transmitCardRequest(
+                               std::make_shared<CardRequestAdapter>(apduRequests,
+                                                                    stopOnUnsuccessfulStatusWord),
+                               channelControl);
+
+        } catch (const UnexpectedStatusWordException& e) {
+
+            /* The failed command is found again when dispatching the responses */
+            cardResponse = e.getCardResponse();
+
+        } catch (const CardBrokenCommunicationException& e) {
+
+            cardResponse = e.getCardResponse();
+            outcome = Outcome::CARD_BROKEN_COMMUNICATION;
+
+        } catch (const ReaderBrokenCommunicationException& e) {
+
+            cardResponse = e.getCardResponse();
+            outcome = Outcome::READER_BROKEN_COMMUNICATION;
+
+        } catch (...) {
+
+            outcome = Outcome::OTHER_EXCEPTION;
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+    }
+
+    const std::vector<std::shared_ptr<ApduResponseApi>> apduResponses =
+        cardResponse != nullptr ? cardResponse->getApduResponses() :
+                                  std::vector<std::shared_ptr<ApduResponseApi>>();
+    const bool isLogicalChannelOpen =
+        cardResponse != nullptr ? cardResponse->isLogicalChannelOpen() : true;
+
+    for (const auto& batch : batches) {
+        dispatch(batch, apduRequests, apduResponses, isLogicalChannelOpen, outcome, exception);
+    }
+
+    /* The state of the SAM is unknown after a communication failure */
+    if (outcome != Outcome::SUCCESS) {
+        mKeyDiversifier.clear();
+        clearLease();
+    }
+}
+
+void ControlSamScheduler::dispatch(
+    const std::shared_ptr<Batch> batch,
+    const std::vector<std::shared_ptr<ApduRequestSpi>>& apduRequests,
+    const std::vector<std::shared_ptr<ApduResponseApi>>& apduResponses,
+    const bool isLogicalChannelOpen,
+    const Outcome outcome,
+    const std::exception_ptr exception)
+{
+    const std::vector<std::shared_ptr<ApduRequestSpi>>& batchApduRequests =
+        batch->mCardRequest->getApduRequests();
+    const bool stopOnUnsuccessfulStatusWord = batch->mCardRequest->stopOnUnsuccessfulStatusWord();
+
+    std::vector<std::shared_ptr<ApduResponseApi>> batchApduResponses;
+    bool isFailed = false;
+    size_t position = batch->mOffset;
+
+    /* Command added by the scheduler */
+    if (batch->mPrefixLength > 0) {
+        if (position < apduResponses.size()) {
+            if (apduResponses[position]->getStatusWord() == 0x9000) {
+                mKeyDiversifier = getKeyDiversifier(apduRequests[position]->getApdu());
+            } else {
+                mKeyDiversifier.clear();
+                isFailed = true;
+            }
+        }
+        position++;
+    }
+
+    for (size_t i = 0; i < batchApduRequests.size(); i++) {
+
+        if (i == 0 && batch->mIsLeadingSelectSkipped) {
+            batchApduResponses.push_back(
+                std::make_shared<LocalApduResponseAdapter>(std::vector<uint8_t>({0x90, 0x00})));
+            continue;
+        }
+
+        if (position >= apduResponses.size()) {
+            break;
+        }
+
+        /* The commands following a failure are ignored but may have been executed by the SAM */
+        const std::vector<uint8_t>& apdu = apduRequests[position]->getApdu();
+        const std::shared_ptr<ApduResponseApi> apduResponse = apduResponses[position++];
+        const uint8_t ins = getIns(apdu);
+        const bool isSuccessful = apduResponse->getStatusWord() == 0x9000;
+
+        if (ins == CalypsoSamCommand::SELECT_DIVERSIFIER.getInstructionByte()) {
+            if (isSuccessful) {
+                mKeyDiversifier = getKeyDiversifier(apdu);
+            } else {
+                mKeyDiversifier.clear();
+            }
+        }
+
+        updatePendingOperations(ins, isSuccessful);
+
+        if (isFailed) {
+            continue;
+        }
+
+        batchApduResponses.push_back(apduResponse);
+
+        if (ins == CalypsoSamCommand::SELECT_DIVERSIFIER.getInstructionByte()) {
+            if (isSuccessful) {
+                mLaneSelectDiversifiers[batch->mLane] = apdu;
+            } else {
+                mLaneSelectDiversifiers.erase(batch->mLane);
+            }
+        }
+
+        const std::vector<int>& successfulStatusWords =
+            batchApduRequests[i]->getSuccessfulStatusWords();
+        if (stopOnUnsuccessfulStatusWord &&
+            std::find(successfulStatusWords.begin(),
+                      successfulStatusWords.end(),
+                      apduResponse->getStatusWord()) == successfulStatusWords.end()) {
+            isFailed = true;
+        }
+    }
+
+    /* Lease of the thread having started a secure session or a SV operation */
+    if (mIsSessionPending || mIsSvOperationPending) {
+        mIsLeased = true;
+        mLeaseHolder = batch->mLane;
+        mLeaseLastUseTime = std::chrono::steady_clock::now();
+    } else if (mIsLeased) {
+        clearLease();
+    }
+
+    const auto cardResponse =
+        std::make_shared<LocalCardResponseAdapter>(batchApduResponses, isLogicalChannelOpen);
+
+    batch->mCardResponse = cardResponse;
+    batch->mIsDone = true;
+
+    if (outcome == Outcome::CARD_BROKEN_COMMUNICATION) {
+        batch->mException = std::make_exception_ptr(
+            CardBrokenCommunicationException(cardResponse,
+                                             false,
+                                             "SAM communication failure (shared SAM)."));
+
+    } else if (outcome == Outcome::READER_BROKEN_COMMUNICATION) {
+        batch->mException = std::make_exception_ptr(
+            ReaderBrokenCommunicationException(cardResponse,
+                                               false,
+                                               "SAM reader communication failure (shared SAM)."));
+
+    } else if (outcome == Outcome::OTHER_EXCEPTION) {
+        batch->mException = exception;
+
+    } else if (isFailed && stopOnUnsuccessfulStatusWord) {
+        batch->mException = std::make_exception_ptr(
+            UnexpectedStatusWordException(cardResponse,
+                                          false,
+                                          "Unexpected status word (shared SAM)."));
+    }
+}
+
+void ControlSamScheduler::updatePendingOperations(const uint8_t ins, const bool isSuccessful)
+{
+    if (ins == CalypsoSamCommand::GET_CHALLENGE.getInstructionByte()) {
+        mIsSessionPending = isSuccessful;
+
+    } else if (ins == CalypsoSamCommand::DIGEST_AUTHENTICATE.getInstructionByte()) {
+        mIsSessionPending = false;
+
+    } else if (ins == CalypsoSamCommand::SV_PREPARE_DEBIT.getInstructionByte() ||
+               ins == CalypsoSamCommand::SV_PREPARE_LOAD.getInstructionByte() ||
+               ins == CalypsoSamCommand::SV_PREPARE_UNDEBIT.getInstructionByte()) {
+        mIsSvOperationPending = isSuccessful;
+
+    } else if (ins == CalypsoSamCommand::SV_CHECK.getInstructionByte()) {
+        mIsSvOperationPending = false;
+    }
+}
+
+void ControlSamScheduler::clearLease()
+{
+    mIsLeased = false;
+    mIsSessionPending = false;
+    mIsSvOperationPending = false;
+}
+
+bool ControlSamScheduler::isStateless(const uint8_t ins)
+{
+    /* Read Ceilings and PSO Compute Signature share the instruction bytes of the last two */
+    return ins == CalypsoSamCommand::SELECT_DIVERSIFIER.getInstructionByte() ||
+           ins == CalypsoSamCommand::READ_KEY_PARAMETERS.getInstructionByte() ||
+           ins == CalypsoSamCommand::READ_EVENT_COUNTER.getInstructionByte() ||
+           ins == CalypsoSamCommand::DATA_CIPHER.getInstructionByte() ||
+           ins == CalypsoSamCommand::PSO_VERIFY_SIGNATURE.getInstructionByte();
+}
+
+uint8_t ControlSamScheduler::getIns(const std::vector<uint8_t>& apdu)
+{
+    return apdu.size() > 1 ? apdu[1] : 0;
+}
+
+const std::vector<uint8_t> ControlSamScheduler::getKeyDiversifier(
+    const std::vector<uint8_t>& apdu)
+{
+    if (apdu.size() <= 5) {
+        return std::vector<uint8_t>();
+    }
+
+    const size_t length = std::min(static_cast<size_t>(apdu[4]), apdu.size() - 5);
+
+    return std::vector<uint8_t>(apdu.begin() + 5, apdu.begin() + 5 + length);
+}
+
+}
+}
+}
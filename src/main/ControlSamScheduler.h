@@ -0,0 +1,406 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Calypsonet Terminal Card */
+#include "ApduResponseApi.h"
+#include "CardResponseApi.h"
+#include "ChannelControl.h"
+#include "ProxyReaderApi.h"
+
+/* Calypsonet Terminal Reader */
+#include "CardReader.h"
+
+/* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
+
+/* Keyple Core Util */
+#include "LoggerFactory.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::card;
+using namespace calypsonet::terminal::card::spi;
+using namespace calypsonet::terminal::reader;
+using namespace keyple::core::util::cpp;
+
+/**
+ * Shares one control SAM reader between card transactions running concurrently in different
+ * threads (e.g. the lanes of a multi-lane gate).
+ *
+ * <p>The scheduler decorates the SAM reader and is provided to
+ * CardSecuritySetting::setControlSamResource in place of it. The SAM requests of all the threads
+ * are queued and transmitted one at a time, in their arrival order, with the following rules:
+ *
+ * <ul>
+ *   <li>A thread which sends a "Get Challenge" or a "SV Prepare" command gets exclusive access to
+ *       the SAM until the related "Digest Authenticate" or "SV Check" command has been sent, its
+ *       secure session is aborted, or it uses neither the SAM nor the card for longer than the
+ *       lease timeout.
+ *   <li>Queued requests made only of stateless commands (Select Diversifier, Read Key Parameters,
+ *       Read Event Counter, Read Ceilings, Data Cipher, PSO Compute/Verify Signature) are merged
+ *       into a single SAM request.
+ *   <li>The key diversifier expected by each thread is selected again if another thread changed
+ *       it in between, and a leading "Select Diversifier" command is not transmitted when the
+ *       diversifier is already selected.
+ * </ul>
+ *
+ * <p>A thread must run each of its card transactions from beginning to end. The SAM challenge
+ * prefetching (see CardSecuritySettingAdapter::enableSamChallengePrefetch) is not available with
+ * a shared SAM.
+ *
+ * <p>C++: specific to this implementation. The scheduler must outlive the transaction managers
+ * using it.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API ControlSamScheduler final
+: public CardReader, public ProxyReaderApi {
+public:
+    /**
+     * Default lease timeout (in milliseconds).
+     *
+     * @since 2.2.5.6
+     */
+    static const int DEFAULT_LEASE_TIMEOUT;
+
+    /**
+     * Creates a scheduler for a SAM reader.
+     *
+     * @param samReader The SAM reader.
+     * @throw IllegalArgumentException If the reader is null or does not implement ProxyReaderApi.
+     * @since 2.2.5.6
+     */
+    explicit ControlSamScheduler(const std::shared_ptr<CardReader> samReader);
+
+    /**
+     * Sets the time after which the exclusive access granted to a thread which no longer uses the
+     * SAM is withdrawn.
+     *
+     * @param leaseTimeout The timeout in milliseconds (default value is
+     *     {@link #DEFAULT_LEASE_TIMEOUT}).
+     * @return The current instance.
+     * @throw IllegalArgumentException If the timeout is not strictly positive.
+     * @since 2.2.5.6
+     */
+    ControlSamScheduler& setLeaseTimeout(const int leaseTimeout);
+
+    /**
+     * Restarts the lease timeout of the exclusive access granted to the calling thread, if any.
+     *
+     * <p>Called by the card transaction manager on each card exchange made while a secure session
+     * is open, so that a session which is slowed down by the card does not lose the SAM.
+     *
+     * @since 2.2.5.6
+     */
+    void renewLease();
+
+    /**
+     * Withdraws the exclusive access granted to the calling thread, if any.
+     *
+     * <p>Called by the card transaction manager when a secure session is aborted.
+     *
+     * @since 2.2.5.6
+     */
+    void releaseLease();
+
+    /**
+     * Gets the number of SAM requests waiting to be transmitted.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getQueueDepth() const;
+
+    /**
+     * Gets the number of requests received from the transaction managers.
+     *
+     * @return A positive or zero long.
+     * @since 2.2.5.6
+     */
+    long getBatchCount() const;
+
+    /**
+     * Gets the number of requests received from the transaction managers which have been merged
+     * with others.
+     *
+     * @return A positive or zero long.
+     * @since 2.2.5.6
+     */
+    long getMergedBatchCount() const;
+
+    /**
+     * Gets the number of requests actually transmitted to the SAM reader.
+     *
+     * @return A positive or zero long.
+     * @since 2.2.5.6
+     */
+    long getRequestCount() const;
+
+    /**
+     * Gets the total time spent by the requests in the queue.
+     *
+     * @return A duration in microseconds.
+     * @since 2.2.5.6
+     */
+    uint64_t getTotalWaitTime() const;
+
+    /**
+     * Gets the longest time spent by a request in the queue.
+     *
+     * @return A duration in microseconds.
+     * @since 2.2.5.6
+     */
+    uint64_t getMaxWaitTime() const;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    const std::string& getName() const override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    bool isContactless() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    bool isCardPresent() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>Blocks the calling thread until its request has been transmitted.
+     *
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardResponseApi> transmitCardRequest(
+        const std::shared_ptr<CardRequestSpi> cardRequest,
+        const ChannelControl channelControl) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    void releaseChannel() override;
+
+private:
+    /**
+     * (private)<br>
+     * Outcome of the transmission of a request to the SAM reader.
+     */
+    enum class Outcome {
+        SUCCESS,
+        CARD_BROKEN_COMMUNICATION,
+        READER_BROKEN_COMMUNICATION,
+        OTHER_EXCEPTION
+    };
+
+    /**
+     * (private)<br>
+     * Request of a thread.
+     */
+    struct Batch final {
+        /**
+         *
+         */
+        std::thread::id mLane;
+
+        /**
+         *
+         */
+        std::shared_ptr<CardRequestSpi> mCardRequest;
+
+        /**
+         *
+         */
+        ChannelControl mChannelControl;
+
+        /**
+         *
+         */
+        std::chrono::steady_clock::time_point mSubmissionTime;
+
+        /**
+         *
+         */
+        bool mIsMergeable;
+
+        /**
+         *
+         */
+        bool mIsDone;
+
+        /**
+         * Result of the request.
+         */
+        std::shared_ptr<CardResponseApi> mCardResponse;
+        std::exception_ptr mException;
+
+        /**
+         * (private)<br>
+         * Position of the commands of the batch in the transmitted request: number of commands
+         * added before them, whether the leading "Select Diversifier" command is not transmitted.
+         */
+        size_t mOffset;
+        size_t mPrefixLength;
+        bool mIsLeadingSelectSkipped;
+    };
+
+    /**
+     *
+     */
+    static const std::unique_ptr<Logger> mLogger;
+
+    /**
+     *
+     */
+    const std::shared_ptr<CardReader> mSamReader;
+
+    /**
+     *
+     */
+    const std::shared_ptr<ProxyReaderApi> mSamProxyReader;
+
+    /**
+     *
+     */
+    int mLeaseTimeout;
+
+    /**
+     * Pending requests in arrival order.
+     */
+    std::deque<std::shared_ptr<Batch>> mQueue;
+
+    /**
+     * True while a thread is transmitting a request to the SAM reader.
+     */
+    bool mIsBusy = false;
+
+    /**
+     * Exclusive access: holder, pending secure session and SV operation, last use.
+     */
+    bool mIsLeased = false;
+    std::thread::id mLeaseHolder;
+    bool mIsSessionPending = false;
+    bool mIsSvOperationPending = false;
+    std::chrono::steady_clock::time_point mLeaseLastUseTime;
+
+    /**
+     * Key diversifier currently selected in the SAM (empty if unknown) and last "Select
+     * Diversifier" command of each thread, giving the key diversifier it expects.
+     */
+    std::vector<uint8_t> mKeyDiversifier;
+    std::map<std::thread::id, std::vector<uint8_t>> mLaneSelectDiversifiers;
+
+    /**
+     * Statistics.
+     */
+    long mBatchCount = 0;
+    long mMergedBatchCount = 0;
+    long mRequestCount = 0;
+    uint64_t mTotalWaitTime = 0;
+    uint64_t mMaxWaitTime = 0;
+
+    /**
+     *
+     */
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+
+    /**
+     * (private)<br>
+     * Removes from the queue the batches to be transmitted in the next request.
+     *
+     * @return An empty list if the SAM is reserved by a thread which has no pending request.
+     */
+    std::vector<std::shared_ptr<Batch>> pollBatches();
+
+    /**
+     * (private)<br>
+     * Builds the request to transmit and sets the position of each batch.
+     */
+    std::vector<std::shared_ptr<ApduRequestSpi>> buildApduRequests(
+        std::vector<std::shared_ptr<Batch>>& batches) const;
+
+    /**
+     * (private)<br>
+     * Transmits the batches and sets their result.
+     */
+    void transmit(std::vector<std::shared_ptr<Batch>>& batches,
+                  std::unique_lock<std::mutex>& lock);
+
+    /**
+     * (private)<br>
+     * Sets the result of a batch from the responses of the SAM (the responses may be missing if
+     * the transmission failed) and updates the diversifier and lease states.
+     */
+    void dispatch(const std::shared_ptr<Batch> batch,
+                  const std::vector<std::shared_ptr<ApduRequestSpi>>& apduRequests,
+                  const std::vector<std::shared_ptr<ApduResponseApi>>& apduResponses,
+                  const bool isLogicalChannelOpen,
+                  const Outcome outcome,
+                  const std::exception_ptr exception);
+
+    /**
+     * (private)<br>
+     * Updates the pending operations after a command has been transmitted to the SAM.
+     */
+    void updatePendingOperations(const uint8_t ins, const bool isSuccessful);
+
+    /**
+     * (private)<br>
+     * Withdraws the exclusive access.
+     */
+    void clearLease();
+
+    /**
+     * (private)<br>
+     * Indicates if a command can be merged with the commands of other threads.
+     */
+    static bool isStateless(const uint8_t ins);
+
+    /**
+     * (private)<br>
+     * Gets the instruction byte of a command, or the key diversifier of a "Select Diversifier"
+     * command.
+     */
+    static uint8_t getIns(const std::vector<uint8_t>& apdu);
+    static const std::vector<uint8_t> getKeyDiversifier(const std::vector<uint8_t>& apdu);
+};
+
+}
+}
+}
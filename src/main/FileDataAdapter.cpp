@@ -12,6 +12,8 @@
 
 #include "FileDataAdapter.h"
 
+#include <algorithm>
+
 /* Keyple Core Util */
 #include "Arrays.h"
 #include "ByteArrayUtil.h"
@@ -28,6 +30,9 @@ using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 using namespace keyple::core::util::cpp::exception;
 
+const std::unique_ptr<Logger> FileDataAdapter::mLogger =
+    LoggerFactory::getLogger(typeid(FileDataAdapter));
+
 FileDataAdapter::FileDataAdapter() {}
 
 FileDataAdapter::FileDataAdapter(const std::shared_ptr<FileData> source)
@@ -38,6 +43,15 @@ FileDataAdapter::FileDataAdapter(const std::shared_ptr<FileData> source)
     for (const auto& entry : sourceContent) {
         mRecords.insert({entry.first, entry.second});
     }
+
+    const auto sourceAdapter = std::dynamic_pointer_cast<FileDataAdapter>(source);
+    if (sourceAdapter != nullptr) {
+        mKnownRanges = sourceAdapter->mKnownRanges;
+    } else {
+        for (const auto& entry : sourceContent) {
+            addKnownRange(entry.first, 0, static_cast<int>(entry.second.size()));
+        }
+    }
 }
 
 const std::map<const uint8_t, std::vector<uint8_t>>& FileDataAdapter::getAllRecordsContent()
@@ -93,13 +107,20 @@ const std::vector<uint8_t> FileDataAdapter::getContent(const uint8_t numRecord,
 }
 
 const std::shared_ptr<int> FileDataAdapter::getContentAsCounterValue(const int numCounter) const
+{
+    const Optional<int> counterValue = getCounterValue(numCounter);
+
+    return counterValue.isPresent() ? std::make_shared<int>(counterValue.get()) : nullptr;
+}
+
+Optional<int> FileDataAdapter::getCounterValue(const int numCounter) const
 {
     Assert::getInstance().greaterOrEqual(numCounter, 1, "numCounter");
 
     const auto it = mRecords.find(1);
     if (it == mRecords.end()) {
         mLogger->warn("Record #1 is not set\n");
-        return nullptr;
+        return Optional<int>::empty();
     }
 
     const std::vector<uint8_t>& rec1 = it->second;
@@ -108,7 +129,7 @@ const std::shared_ptr<int> FileDataAdapter::getContentAsCounterValue(const int n
         mLogger->warn("Counter #% is not set (nb of actual counters = %)\n",
                         numCounter,
                         rec1.size() / 3);
-        return nullptr;
+        return Optional<int>::empty();
     }
 
     if (counterIndex + 3 > static_cast<int>(rec1.size())) {
@@ -117,7 +138,7 @@ const std::shared_ptr<int> FileDataAdapter::getContentAsCounterValue(const int n
                                         std::to_string(rec1.size() / 3) + ").");
     }
 
-    return std::make_shared<int>(ByteArrayUtil::extractInt(rec1, counterIndex, 3, false));
+    return ByteArrayUtil::extractInt(rec1, counterIndex, 3, false);
 }
 
 const std::map<const int, const int> FileDataAdapter::getAllCountersValue() const
@@ -143,6 +164,9 @@ const std::map<const int, const int> FileDataAdapter::getAllCountersValue() cons
 void FileDataAdapter::setContent(const uint8_t numRecord, const std::vector<uint8_t>& content)
 {
     mRecords[numRecord] = content;
+
+    mKnownRanges.erase(numRecord);
+    addKnownRange(numRecord, 0, static_cast<int>(content.size()));
 }
 
 void FileDataAdapter::setCounter(const uint8_t numCounter, const std::vector<uint8_t>& content)
@@ -184,6 +208,8 @@ void FileDataAdapter::setContent(const uint8_t numRecord,
     System::arraycopy(content, 0, newContent, offset, content.size());
 
     mRecords[numRecord] = newContent;
+
+    addKnownRange(numRecord, offset, newLength);
 }
 
 void FileDataAdapter::fillContent(const uint8_t numRecord,
@@ -228,9 +254,72 @@ void FileDataAdapter::addCyclicContent(const std::vector<uint8_t>& content)
 
     for (const auto& i : descendingKeys) {
         mRecords[static_cast<uint8_t>(i + 1)] = mRecords[i];
+
+        const auto it = mKnownRanges.find(i);
+        if (it != mKnownRanges.end()) {
+            mKnownRanges[static_cast<uint8_t>(i + 1)] = it->second;
+        } else {
+            mKnownRanges.erase(static_cast<uint8_t>(i + 1));
+        }
     }
 
     mRecords[static_cast<uint8_t>(1)] = content;
+
+    mKnownRanges.erase(1);
+    addKnownRange(1, 0, static_cast<int>(content.size()));
+}
+
+bool FileDataAdapter::isContentKnown(const uint8_t numRecord,
+                                     const int offset,
+                                     const int length) const
+{
+    if (length <= 0) {
+        return true;
+    }
+
+    const auto it = mKnownRanges.find(numRecord);
+    if (it == mKnownRanges.end()) {
+        return false;
+    }
+
+    for (const auto& range : it->second) {
+        if (range.first <= offset) {
+            if (offset + length <= range.second) {
+                return true;
+            }
+        } else {
+            break;
+        }
+    }
+
+    return false;
+}
+
+void FileDataAdapter::addKnownRange(const uint8_t numRecord, const int from, const int to)
+{
+    if (from >= to) {
+        return;
+    }
+
+    std::vector<std::pair<int, int>>& ranges = mKnownRanges[numRecord];
+
+    int mergedFrom = from;
+    int mergedTo = to;
+    auto it = ranges.begin();
+
+    /* Skip the ranges ending before the new one */
+    while (it != ranges.end() && it->second < from) {
+        ++it;
+    }
+
+    /* Absorb the overlapping or adjacent ranges */
+    while (it != ranges.end() && it->first <= to) {
+        mergedFrom = std::min(mergedFrom, it->first);
+        mergedTo = std::max(mergedTo, it->second);
+        it = ranges.erase(it);
+    }
+
+    ranges.insert(it, std::make_pair(mergedFrom, mergedTo));
 }
 
 std::ostream& operator<<(std::ostream& os, const FileDataAdapter& fda)
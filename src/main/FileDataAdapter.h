@@ -20,6 +20,7 @@
 
 /* Keyple Card Calypso */
 #include "KeypleCardCalypsoExport.h"
+#include "Optional.h"
 
 /* Keyple Core Util */
 #include "LoggerFactory.h"
@@ -97,6 +98,21 @@ public:
      */
     const std::shared_ptr<int> getContentAsCounterValue(const int numCounter) const override;
 
+    /**
+     * (package-private)<br>
+     * Gets the value of the counter #numCounter without allocating it on the heap.
+     *
+     * <p>C++: allocation-free variant of getContentAsCounterValue(int), whose signature is imposed
+     * by the FileData API, to be used internally.
+     *
+     * @param numCounter The counter number (should be {@code >=} 1).
+     * @return An empty optional if record #1 or the counter is not set.
+     * @throw IllegalArgumentException If numCounter is out of range.
+     * @throw IndexOutOfBoundsException If numCounter has a truncated value.
+     * @since 2.2.5.6
+     */
+    Optional<int> getCounterValue(const int numCounter) const;
+
     /**
      * {@inheritDoc}
      *
@@ -168,6 +184,24 @@ public:
      */
     void addCyclicContent(const std::vector<uint8_t>& content);
 
+    /**
+     * (package-private)<br>
+     * Indicates if the bytes of a record in the provided range come from the card (read or
+     * written), as opposed to the bytes padded with 0 when a record is partially set.
+     *
+     * <p>The bytes set by fillContent(uint8_t, std::vector<uint8_t>, int) remain unknown if they
+     * were unknown before, the result of the binary OR being unknown.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param numRecord The record number (should be {@code >=} 1).
+     * @param offset The offset of the first byte (should be {@code >=} 0).
+     * @param length The number of bytes (should be {@code >=} 0).
+     * @return True if all the bytes of the range are known, or if the range is empty.
+     * @since 2.2.5.6
+     */
+    bool isContentKnown(const uint8_t numRecord, const int offset, const int length) const;
+
     /**
      *
      */
@@ -177,13 +211,25 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger = LoggerFactory::getLogger(typeid(FileDataAdapter));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
      */
     std::map<const uint8_t, std::vector<uint8_t>> mRecords;
 
+    /**
+     * Sorted and disjoint ranges [from, to) of the known bytes of each record.
+     */
+    std::map<const uint8_t, std::vector<std::pair<int, int>>> mKnownRanges;
+
+    /**
+     * (private)<br>
+     * Adds the range [from, to) to the known bytes of a record, merging it with the adjacent or
+     * overlapping ranges.
+     */
+    void addKnownRange(const uint8_t numRecord, const int from, const int to);
+
 };
 
 }
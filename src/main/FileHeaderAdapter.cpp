@@ -167,6 +167,14 @@ void FileHeaderAdapter::updateMissingInfoFrom(const std::shared_ptr<FileHeader>
     }
 }
 
+bool FileHeaderAdapter::isMissingInfoIn(const std::shared_ptr<FileHeader> source) const
+{
+    return (mAccessConditions.empty() && !source->getAccessConditions().empty()) ||
+           (mKeyIndexes.empty() && !source->getKeyIndexes().empty()) ||
+           (mDfStatus == nullptr && source->getDfStatus() != nullptr) ||
+           (mSharedReference == nullptr && source->getSharedReference() != nullptr);
+}
+
 bool FileHeaderAdapter::operator==(const FileHeaderAdapter& o) const
 {
     return mLid == o.mLid;
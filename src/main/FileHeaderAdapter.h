@@ -270,6 +270,18 @@ public:
      */
     void updateMissingInfoFrom(const std::shared_ptr<FileHeader> source);
 
+    /**
+     * (package-private)<br>
+     * Indicates if the provided source holds information missing in this header.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param source The header to use.
+     * @return True if updateMissingInfoFrom would modify this header.
+     * @since 2.2.5.6
+     */
+    bool isMissingInfoIn(const std::shared_ptr<FileHeader> source) const;
+
     /**
      * Comparison is based on field "lid".
      *
@@ -0,0 +1,196 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "FileHeaderCache.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+int FileHeaderCache::getSize() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    return static_cast<int>(mProfiles.size());
+}
+
+bool FileHeaderCache::validate(const std::shared_ptr<CalypsoCard> calypsoCard)
+{
+    const Key key = buildKey(calypsoCard);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    const auto it = mProfiles.find(key);
+    if (it == mProfiles.end()) {
+        return true;
+    }
+
+    for (const auto& ef : calypsoCard->getFiles()) {
+
+        const auto itt = it->second->mFileHeaders.find(ef->getSfi());
+        if (itt != it->second->mFileHeaders.end() && !isConsistent(ef->getHeader(), itt->second)) {
+
+            mProfiles.erase(it);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FileHeaderCache::invalidate(const std::shared_ptr<CalypsoCard> calypsoCard)
+{
+    const Key key = buildKey(calypsoCard);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mProfiles.erase(key);
+}
+
+void FileHeaderCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mProfiles.clear();
+}
+
+bool FileHeaderCache::apply(const std::shared_ptr<CalypsoCardAdapter> card) const
+{
+    const Key key = buildKey(card);
+
+    std::shared_ptr<const Profile> profile;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        const auto it = mProfiles.find(key);
+        if (it == mProfiles.end()) {
+            return false;
+        }
+
+        profile = it->second;
+    }
+
+    if (card->getDirectoryHeader() == nullptr && profile->mDirectoryHeader != nullptr) {
+        card->setDirectoryHeader(profile->mDirectoryHeader);
+    }
+
+    for (const auto& entry : profile->mFileHeaders) {
+        card->setFileHeaderIfMissing(entry.first, entry.second);
+    }
+
+    return profile->mIsFileListComplete;
+}
+
+void FileHeaderCache::put(const std::shared_ptr<CalypsoCardAdapter> card,
+                          const bool isFileListComplete)
+{
+    const Key key = buildKey(card);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    std::shared_ptr<const Profile>& profile = mProfiles[key];
+
+    /* The cached profile is never modified since it may be in use, a new one is built if needed */
+    std::shared_ptr<Profile> updatedProfile;
+
+    if (card->getDirectoryHeader() != nullptr &&
+        (profile == nullptr || profile->mDirectoryHeader == nullptr)) {
+
+        updatedProfile = profile != nullptr ? std::make_shared<Profile>(*profile) :
+                                              std::make_shared<Profile>();
+        updatedProfile->mDirectoryHeader = card->getDirectoryHeader();
+    }
+
+    for (const auto& ef : card->getFiles()) {
+
+        if (ef->getSfi() == 0 || ef->getHeader() == nullptr) {
+            continue;
+        }
+
+        if (profile != nullptr &&
+            profile->mFileHeaders.find(ef->getSfi()) != profile->mFileHeaders.end()) {
+            continue;
+        }
+
+        if (updatedProfile == nullptr) {
+            updatedProfile = profile != nullptr ? std::make_shared<Profile>(*profile) :
+                                                  std::make_shared<Profile>();
+        }
+
+        /* The header of the card may still be completed, cache a copy */
+        updatedProfile->mFileHeaders[ef->getSfi()] =
+            std::make_shared<FileHeaderAdapter>(ef->getHeader());
+    }
+
+    if (isFileListComplete && (profile == nullptr || !profile->mIsFileListComplete)) {
+
+        if (updatedProfile == nullptr) {
+            updatedProfile = profile != nullptr ? std::make_shared<Profile>(*profile) :
+                                                  std::make_shared<Profile>();
+        }
+
+        updatedProfile->mIsFileListComplete = true;
+    }
+
+    if (updatedProfile != nullptr) {
+        profile = updatedProfile;
+    } else if (profile == nullptr) {
+        mProfiles.erase(key);
+    }
+}
+
+const FileHeaderCache::Key FileHeaderCache::buildKey(const std::shared_ptr<CalypsoCard> card)
+{
+    const std::vector<uint8_t>& dfName = card->getDfName();
+    const std::vector<uint8_t>& startupInfo = card->getStartupInfoRawData();
+
+    Key key;
+    key.reserve(1 + dfName.size() + startupInfo.size());
+    key.push_back(static_cast<uint8_t>(dfName.size()));
+    key.insert(key.end(), dfName.begin(), dfName.end());
+    key.insert(key.end(), startupInfo.begin(), startupInfo.end());
+
+    return key;
+}
+
+bool FileHeaderCache::isConsistent(const std::shared_ptr<FileHeader> header,
+                                   const std::shared_ptr<FileHeader> cachedHeader)
+{
+    if (header == nullptr) {
+        return true;
+    }
+
+    if (header->getLid() != cachedHeader->getLid() ||
+        header->getEfType() != cachedHeader->getEfType() ||
+        header->getRecordSize() != cachedHeader->getRecordSize() ||
+        header->getRecordsNumber() != cachedHeader->getRecordsNumber()) {
+        return false;
+    }
+
+    if (!header->getAccessConditions().empty() &&
+        !cachedHeader->getAccessConditions().empty() &&
+        header->getAccessConditions() != cachedHeader->getAccessConditions()) {
+        return false;
+    }
+
+    if (!header->getKeyIndexes().empty() &&
+        !cachedHeader->getKeyIndexes().empty() &&
+        header->getKeyIndexes() != cachedHeader->getKeyIndexes()) {
+        return false;
+    }
+
+    return true;
+}
+
+}
+}
+}
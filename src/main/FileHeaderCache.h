@@ -0,0 +1,166 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/* Calypsonet Terminal Calypso */
+#include "CalypsoCard.h"
+#include "DirectoryHeader.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "FileHeaderAdapter.h"
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::calypso::card;
+
+/**
+ * Cache of the file structure of the cards, keyed by issuer profile (DF name and startup
+ * information).
+ *
+ * <p>All the cards of a profile are expected to share the same directory header and file headers.
+ * The headers learned from a card (Select File, Get Data FCP or EF list responses) are stored once
+ * for its profile and then set in the image of the next cards of the same profile when the cache is
+ * enabled on their transaction (see CardTransactionManagerAdapter::enableFileHeaderCache), so that
+ * the applications can skip the commands only used to get them. The headers are shared between the
+ * cards and never modified once cached.
+ *
+ * <p>A profile can be checked against the headers actually returned by a card with validate, and
+ * removed with invalidate when the issuer changes the file structure.
+ *
+ * <p>C++: specific to this implementation. This class is thread-safe so that a single instance can
+ * be shared by the whole process.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API FileHeaderCache final {
+public:
+    /**
+     * Creates an empty cache.
+     *
+     * @since 2.2.5.6
+     */
+    FileHeaderCache() = default;
+
+    /**
+     * Gets the number of cached profiles.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getSize() const;
+
+    /**
+     * Checks the headers of a card against the cached profile of the card and removes the profile
+     * if they differ.
+     *
+     * <p>Only the information actually known in the card image is compared.
+     *
+     * @param calypsoCard The card, whose headers have been read from the card itself.
+     * @return False if the profile was cached and has been removed.
+     * @since 2.2.5.6
+     */
+    bool validate(const std::shared_ptr<CalypsoCard> calypsoCard);
+
+    /**
+     * Removes the cached profile of a card, if any.
+     *
+     * @param calypsoCard The card.
+     * @since 2.2.5.6
+     */
+    void invalidate(const std::shared_ptr<CalypsoCard> calypsoCard);
+
+    /**
+     * Removes all the cached profiles.
+     *
+     * @since 2.2.5.6
+     */
+    void clear();
+
+    /**
+     * (package-private)<br>
+     * Sets the cached headers of the profile of a card in its image, when they are not already
+     * known.
+     *
+     * @param card The card.
+     * @return True if the profile of the card is cached with the headers of all its files, i.e. if
+     *         they have been learned from an EF list.
+     * @since 2.2.5.6
+     */
+    bool apply(const std::shared_ptr<CalypsoCardAdapter> card) const;
+
+    /**
+     * (package-private)<br>
+     * Adds the headers known in a card image to the profile of the card, the headers already
+     * cached being kept.
+     *
+     * @param card The card.
+     * @param isFileListComplete True if the headers of all the files of the card are known (EF
+     *        list read).
+     * @since 2.2.5.6
+     */
+    void put(const std::shared_ptr<CalypsoCardAdapter> card, const bool isFileListComplete);
+
+private:
+    /**
+     * (private)<br>
+     * Immutable headers of a profile.
+     */
+    struct Profile final {
+        std::shared_ptr<DirectoryHeader> mDirectoryHeader;
+        std::map<uint8_t, std::shared_ptr<FileHeaderAdapter>> mFileHeaders;
+        bool mIsFileListComplete = false;
+    };
+
+    /**
+     *
+     */
+    using Key = std::vector<uint8_t>;
+
+    /**
+     *
+     */
+    std::map<Key, std::shared_ptr<const Profile>> mProfiles;
+
+    /**
+     *
+     */
+    mutable std::mutex mMutex;
+
+    /**
+     * (private)<br>
+     * Builds the cache key of a card from its DF name and startup information.
+     */
+    static const Key buildKey(const std::shared_ptr<CalypsoCard> card);
+
+    /**
+     * (private)<br>
+     * Indicates if the information known in a header matches the cached header.
+     */
+    static bool isConsistent(const std::shared_ptr<FileHeader> header,
+                             const std::shared_ptr<FileHeader> cachedHeader);
+};
+
+}
+}
+}
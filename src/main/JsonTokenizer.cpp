@@ -0,0 +1,360 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "JsonTokenizer.h"
+
+#include <climits>
+#include <cstring>
+#include <string>
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util::cpp::exception;
+
+const int JsonTokenizer::MAX_DEPTH = 32;
+
+JsonTokenizer::JsonTokenizer(const char* json, const size_t length)
+: mBegin(json),
+  mPos(json),
+  mEnd(json + length),
+  mTokenStart(json),
+  mTokenLength(0),
+  mDepth(0),
+  mObjectMask(0),
+  mIsNameExpected(false),
+  mIsSeparatorExpected(false),
+  mIsValueExpected(false),
+  mIsRootValueRead(false) {}
+
+JsonTokenizer::TokenType JsonTokenizer::next()
+{
+    skipWhitespaces();
+
+    if (mPos == mEnd) {
+
+        if (mDepth != 0 || !mIsRootValueRead) {
+            fail("Unexpected end of document");
+        }
+
+        return TokenType::END_DOCUMENT;
+    }
+
+    if (mDepth == 0 && mIsRootValueRead) {
+        fail("Unexpected data after the root value");
+    }
+
+    const bool isClosing = *mPos == '}' || *mPos == ']';
+
+    if (mIsValueExpected && isClosing) {
+        fail("Value expected");
+    }
+
+    if (mIsSeparatorExpected && !isClosing) {
+
+        if (*mPos != ',') {
+            fail("',' expected");
+        }
+
+        mPos++;
+        mIsSeparatorExpected = false;
+        mIsNameExpected = isInObject();
+        skipWhitespaces();
+
+        if (mPos == mEnd || *mPos == '}' || *mPos == ']') {
+            fail("Value expected after ','");
+        }
+    }
+
+    switch (*mPos) {
+    case '{':
+        return beginContainer(true);
+    case '[':
+        return beginContainer(false);
+    case '}':
+        return endContainer(true);
+    case ']':
+        return endContainer(false);
+    case '"':
+        readString();
+        if (mIsNameExpected) {
+
+            skipWhitespaces();
+            if (mPos == mEnd || *mPos != ':') {
+                fail("':' expected");
+            }
+
+            mPos++;
+            mIsNameExpected = false;
+            mIsValueExpected = true;
+            return TokenType::NAME;
+        }
+
+        onValueRead();
+        return TokenType::STRING;
+    default:
+        break;
+    }
+
+    if (mIsNameExpected) {
+        fail("Name expected");
+    }
+
+    if (*mPos == '-' || (*mPos >= '0' && *mPos <= '9')) {
+        readNumber();
+        onValueRead();
+        return TokenType::NUMBER;
+    }
+
+    readLiteral();
+    onValueRead();
+    return TokenType::LITERAL;
+}
+
+void JsonTokenizer::skipValue()
+{
+    const int depth = mDepth;
+
+    TokenType type = next();
+    if (type == TokenType::BEGIN_OBJECT || type == TokenType::BEGIN_ARRAY) {
+
+        while (mDepth > depth) {
+
+            type = next();
+            if (type == TokenType::END_DOCUMENT) {
+                fail("Unexpected end of document");
+            }
+        }
+
+    } else if (type != TokenType::STRING &&
+               type != TokenType::NUMBER &&
+               type != TokenType::LITERAL) {
+        fail("Value expected");
+    }
+}
+
+bool JsonTokenizer::isTokenEqualTo(const char* text) const
+{
+    return std::strlen(text) == mTokenLength &&
+           std::memcmp(mTokenStart, text, mTokenLength) == 0;
+}
+
+int JsonTokenizer::getTokenAsInt() const
+{
+    const char* p = mTokenStart;
+    const char* const end = mTokenStart + mTokenLength;
+
+    const bool isNegative = *p == '-';
+    if (isNegative) {
+        p++;
+    }
+
+    if (p == end) {
+        throw IllegalArgumentException("Integer expected: " +
+                                       std::string(mTokenStart, mTokenLength));
+    }
+
+    long long value = 0;
+    for (; p < end; p++) {
+
+        if (*p < '0' || *p > '9') {
+            throw IllegalArgumentException("Integer expected: " +
+                                           std::string(mTokenStart, mTokenLength));
+        }
+
+        value = value * 10 + (*p - '0');
+        if (value > static_cast<long long>(INT_MAX) + 1) {
+            throw IllegalArgumentException("Integer out of range: " +
+                                           std::string(mTokenStart, mTokenLength));
+        }
+    }
+
+    if (isNegative) {
+        value = -value;
+    }
+
+    if (value > INT_MAX) {
+        throw IllegalArgumentException("Integer out of range: " +
+                                       std::string(mTokenStart, mTokenLength));
+    }
+
+    return static_cast<int>(value);
+}
+
+void JsonTokenizer::getTokenAsBytes(std::vector<uint8_t>& bytes) const
+{
+    if (mTokenLength % 2 != 0) {
+        throw IllegalArgumentException("Odd length hex string: " +
+                                       std::string(mTokenStart, mTokenLength));
+    }
+
+    bytes.clear();
+    bytes.reserve(mTokenLength / 2);
+
+    for (size_t i = 0; i < mTokenLength; i += 2) {
+
+        int value = 0;
+        for (size_t j = i; j < i + 2; j++) {
+
+            const char c = mTokenStart[j];
+            int nibble;
+            if (c >= '0' && c <= '9') {
+                nibble = c - '0';
+            } else if (c >= 'A' && c <= 'F') {
+                nibble = c - 'A' + 10;
+            } else if (c >= 'a' && c <= 'f') {
+                nibble = c - 'a' + 10;
+            } else {
+                throw IllegalArgumentException("Invalid hex string: " +
+                                               std::string(mTokenStart, mTokenLength));
+            }
+
+            value = (value << 4) | nibble;
+        }
+
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+}
+
+void JsonTokenizer::fail(const char* message) const
+{
+    throw IllegalArgumentException(std::string(message) + " at position " +
+                                   std::to_string(mPos - mBegin) + ".");
+}
+
+void JsonTokenizer::skipWhitespaces()
+{
+    while (mPos < mEnd && (*mPos == ' ' || *mPos == '\t' || *mPos == '\n' || *mPos == '\r')) {
+        mPos++;
+    }
+}
+
+bool JsonTokenizer::isInObject() const
+{
+    return mDepth > 0 && (mObjectMask & (1u << (mDepth - 1))) != 0;
+}
+
+void JsonTokenizer::onValueRead()
+{
+    mIsValueExpected = false;
+
+    if (mDepth == 0) {
+        mIsRootValueRead = true;
+    } else {
+        mIsSeparatorExpected = true;
+    }
+}
+
+JsonTokenizer::TokenType JsonTokenizer::beginContainer(const bool isObject)
+{
+    if (mDepth == MAX_DEPTH) {
+        fail("Maximum nesting level reached");
+    }
+
+    if (isObject) {
+        mObjectMask |= 1u << mDepth;
+    } else {
+        mObjectMask &= ~(1u << mDepth);
+    }
+
+    mDepth++;
+    mPos++;
+    mIsNameExpected = isObject;
+    mIsSeparatorExpected = false;
+    mIsValueExpected = false;
+
+    return isObject ? TokenType::BEGIN_OBJECT : TokenType::BEGIN_ARRAY;
+}
+
+JsonTokenizer::TokenType JsonTokenizer::endContainer(const bool isObject)
+{
+    if (mDepth == 0 || isInObject() != isObject) {
+        fail("Unexpected closing bracket");
+    }
+
+    mDepth--;
+    mPos++;
+    mIsNameExpected = false;
+    onValueRead();
+
+    return isObject ? TokenType::END_OBJECT : TokenType::END_ARRAY;
+}
+
+void JsonTokenizer::readString()
+{
+    /* Skip the opening quote */
+    mPos++;
+    mTokenStart = mPos;
+
+    while (mPos < mEnd && *mPos != '"') {
+
+        if (*mPos == '\\') {
+            mPos++;
+        }
+
+        mPos++;
+    }
+
+    if (mPos >= mEnd) {
+        fail("Unterminated string");
+    }
+
+    mTokenLength = static_cast<size_t>(mPos - mTokenStart);
+
+    /* Skip the closing quote */
+    mPos++;
+}
+
+void JsonTokenizer::readNumber()
+{
+    mTokenStart = mPos;
+
+    while (mPos < mEnd &&
+           ((*mPos >= '0' && *mPos <= '9') ||
+            *mPos == '-' ||
+            *mPos == '+' ||
+            *mPos == '.' ||
+            *mPos == 'e' ||
+            *mPos == 'E')) {
+        mPos++;
+    }
+
+    mTokenLength = static_cast<size_t>(mPos - mTokenStart);
+}
+
+void JsonTokenizer::readLiteral()
+{
+    static const char* const LITERALS[] = {"true", "false", "null"};
+
+    for (const char* literal : LITERALS) {
+
+        const size_t length = std::strlen(literal);
+        if (static_cast<size_t>(mEnd - mPos) >= length &&
+            std::memcmp(mPos, literal, length) == 0) {
+
+            mTokenStart = mPos;
+            mTokenLength = length;
+            mPos += length;
+            return;
+        }
+    }
+
+    fail("Unexpected character");
+}
+
+}
+}
+}
@@ -0,0 +1,216 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+/**
+ * (package-private)<br>
+ * Single-pass pull tokenizer over a JSON document.
+ *
+ * <p>The tokenizer does not allocate: tokens are returned as views on the input, which must
+ * remain available while the tokenizer is used. Strings are not unescaped (escape sequences are
+ * only skipped), which is sufficient for the names, hex strings and numbers produced by this
+ * library.
+ *
+ * <p>The document structure (separators, nesting, single root value) is checked while reading.
+ * Any syntax error raises an IllegalArgumentException.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API JsonTokenizer final {
+public:
+    /**
+     * (package-private)<br>
+     * Types of token.
+     *
+     * @since 2.2.5.6
+     */
+    enum class TokenType {
+        BEGIN_OBJECT,
+        END_OBJECT,
+        BEGIN_ARRAY,
+        END_ARRAY,
+        NAME,
+        STRING,
+        NUMBER,
+        LITERAL,
+        END_DOCUMENT
+    };
+
+    /**
+     * (package-private)<br>
+     * Creates a tokenizer.
+     *
+     * @param json The first character of the document.
+     * @param length The number of characters.
+     * @since 2.2.5.6
+     */
+    JsonTokenizer(const char* json, const size_t length);
+
+    /**
+     * (package-private)<br>
+     * Reads the next token.
+     *
+     * @return The type of the token read.
+     * @throw IllegalArgumentException If the document is malformed.
+     * @since 2.2.5.6
+     */
+    TokenType next();
+
+    /**
+     * (package-private)<br>
+     * Skips the value following the last read name, including nested objects and arrays.
+     *
+     * @throw IllegalArgumentException If the document is malformed.
+     * @since 2.2.5.6
+     */
+    void skipValue();
+
+    /**
+     * (package-private)<br>
+     * Indicates if the text of the last read token (without quotes for a name or a string) is
+     * equal to the provided null-terminated string.
+     *
+     * @param text The text to compare.
+     * @return True if equal.
+     * @since 2.2.5.6
+     */
+    bool isTokenEqualTo(const char* text) const;
+
+    /**
+     * (package-private)<br>
+     * Converts the last read number token to an int.
+     *
+     * @return The value.
+     * @throw IllegalArgumentException If the number is not an integer or is out of range.
+     * @since 2.2.5.6
+     */
+    int getTokenAsInt() const;
+
+    /**
+     * (package-private)<br>
+     * Decodes the last read string token as an hexadecimal string.
+     *
+     * @param bytes The destination, cleared and filled with the decoded bytes (its capacity is
+     *        reused).
+     * @throw IllegalArgumentException If the string is not a valid hexadecimal string.
+     * @since 2.2.5.6
+     */
+    void getTokenAsBytes(std::vector<uint8_t>& bytes) const;
+
+private:
+    /**
+     * Maximum nesting level of objects and arrays.
+     */
+    static const int MAX_DEPTH;
+
+    /**
+     *
+     */
+    const char* const mBegin;
+
+    /**
+     *
+     */
+    const char* mPos;
+
+    /**
+     *
+     */
+    const char* const mEnd;
+
+    /**
+     * Text of the last read token.
+     */
+    const char* mTokenStart;
+    size_t mTokenLength;
+
+    /**
+     * Current nesting level and container types (bit set if the container at the matching level
+     * is an object).
+     */
+    int mDepth;
+    uint32_t mObjectMask;
+
+    /**
+     * Parsing state.
+     */
+    bool mIsNameExpected;
+    bool mIsSeparatorExpected;
+    bool mIsValueExpected;
+    bool mIsRootValueRead;
+
+    /**
+     * (private)<br>
+     * Throws an IllegalArgumentException indicating the current position.
+     */
+    [[noreturn]] void fail(const char* message) const;
+
+    /**
+     * (private)<br>
+     */
+    void skipWhitespaces();
+
+    /**
+     * (private)<br>
+     */
+    bool isInObject() const;
+
+    /**
+     * (private)<br>
+     * Updates the state after a complete value.
+     */
+    void onValueRead();
+
+    /**
+     * (private)<br>
+     */
+    TokenType beginContainer(const bool isObject);
+
+    /**
+     * (private)<br>
+     */
+    TokenType endContainer(const bool isObject);
+
+    /**
+     * (private)<br>
+     * Reads a string and sets the token to its content.
+     */
+    void readString();
+
+    /**
+     * (private)<br>
+     * Reads a number and sets the token to its text.
+     */
+    void readNumber();
+
+    /**
+     * (private)<br>
+     * Reads true, false or null and sets the token to its text.
+     */
+    void readLiteral();
+};
+
+}
+}
+}
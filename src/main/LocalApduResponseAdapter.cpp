@@ -0,0 +1,70 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "LocalApduResponseAdapter.h"
+
+/* Keyple Core Util */
+#include "KeypleStd.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+LocalApduResponseAdapter::LocalApduResponseAdapter(const std::vector<uint8_t>& apdu)
+: mApdu(apdu),
+  mStatusWord(apdu.size() < 2 ?
+                  0 :
+                  ((apdu[apdu.size() - 2] & 0xFF) << 8) | (apdu[apdu.size() - 1] & 0xFF)) {}
+
+const std::vector<uint8_t>& LocalApduResponseAdapter::getApdu() const
+{
+    return mApdu;
+}
+
+const std::vector<uint8_t> LocalApduResponseAdapter::getDataOut() const
+{
+    if (mApdu.size() < 2) {
+        return std::vector<uint8_t>();
+    }
+
+    return std::vector<uint8_t>(mApdu.begin(), mApdu.end() - 2);
+}
+
+int LocalApduResponseAdapter::getStatusWord() const
+{
+    return mStatusWord;
+}
+
+std::ostream& operator<<(std::ostream& os, const LocalApduResponseAdapter& ara)
+{
+    os << "APDU_RESPONSE_ADAPTER: {"
+       << "APDU: " << ara.getApdu() << ", "
+       << "STATUS_WORD: " << ara.getStatusWord()
+       << "}";
+
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const std::shared_ptr<LocalApduResponseAdapter> ara)
+{
+    if (ara == nullptr) {
+        os << "APDU_RESPONSE_ADAPTER: null";
+    } else {
+        os << *ara;
+    }
+
+    return os;
+}
+
+}
+}
+}
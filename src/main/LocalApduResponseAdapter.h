@@ -0,0 +1,103 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+/* Calypsonet Terminal Card */
+#include "ApduResponseApi.h"
+
+/* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::card;
+
+/**
+ * (package-private)<br>
+ * Adapter of ApduResponseApi for the APDU responses built by the library itself instead of being
+ * received from a reader (anticipated responses, restored snapshots, replayed traces, responses
+ * split by the control SAM scheduler).
+ *
+ * <p>An APDU shorter than 2 bytes has no outgoing data and a status word set to 0, which is not a
+ * valid status word for any command.
+ *
+ * <p>C++: specific to this implementation.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API LocalApduResponseAdapter final : public ApduResponseApi {
+public:
+    /**
+     * (package-private)<br>
+     * Constructor
+     *
+     * @param apdu The raw APDU, outgoing data followed by the status word.
+     * @since 2.2.5.6
+     */
+    LocalApduResponseAdapter(const std::vector<uint8_t>& apdu);
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t>& getApdu() const override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> getDataOut() const override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    int getStatusWord() const override;
+
+    /**
+     *
+     */
+    friend KEYPLECARDCALYPSO_API std::ostream& operator<<(std::ostream& os,
+                                                          const LocalApduResponseAdapter& ara);
+
+    /**
+     *
+     */
+    friend KEYPLECARDCALYPSO_API std::ostream& operator<<(
+        std::ostream& os, const std::shared_ptr<LocalApduResponseAdapter> ara);
+
+private:
+    /**
+     *
+     */
+    const std::vector<uint8_t> mApdu;
+
+    /**
+     *
+     */
+    const int mStatusWord;
+};
+
+}
+}
+}
@@ -0,0 +1,37 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "LocalCardResponseAdapter.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+LocalCardResponseAdapter::LocalCardResponseAdapter(
+  const std::vector<std::shared_ptr<ApduResponseApi>>& apduResponses,
+  const bool isLogicalChannelOpen)
+: mApduResponses(apduResponses), mIsLogicalChannelOpen(isLogicalChannelOpen) {}
+
+const std::vector<std::shared_ptr<ApduResponseApi>>&
+    LocalCardResponseAdapter::getApduResponses() const
+{
+    return mApduResponses;
+}
+
+bool LocalCardResponseAdapter::isLogicalChannelOpen() const
+{
+    return mIsLogicalChannelOpen;
+}
+
+}
+}
+}
@@ -0,0 +1,81 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+/* Calypsonet Terminal Card */
+#include "ApduResponseApi.h"
+#include "CardResponseApi.h"
+
+/* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::card;
+
+/**
+ * (package-private)<br>
+ * Adapter of CardResponseApi for the card responses built by the library itself instead of being
+ * received from a reader (replayed traces, responses split by the control SAM scheduler).
+ *
+ * <p>C++: specific to this implementation.
+ *
+ * @since 2.2.5.6
+ */
+class KEYPLECARDCALYPSO_API LocalCardResponseAdapter final : public CardResponseApi {
+public:
+    /**
+     * (package-private)<br>
+     * Constructor
+     *
+     * @param apduResponses The APDU responses.
+     * @param isLogicalChannelOpen True if the logical channel is left open.
+     * @since 2.2.5.6
+     */
+    LocalCardResponseAdapter(const std::vector<std::shared_ptr<ApduResponseApi>>& apduResponses,
+                             const bool isLogicalChannelOpen);
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    const std::vector<std::shared_ptr<ApduResponseApi>>& getApduResponses() const override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    bool isLogicalChannelOpen() const override;
+
+private:
+    /**
+     *
+     */
+    const std::vector<std::shared_ptr<ApduResponseApi>> mApduResponses;
+
+    /**
+     *
+     */
+    const bool mIsLogicalChannelOpen;
+};
+
+}
+}
+}
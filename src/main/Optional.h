@@ -0,0 +1,176 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <ostream>
+#include <type_traits>
+
+/* Keyple Core Util */
+#include "IllegalStateException.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util::cpp::exception;
+
+/**
+ * (package-private)<br>
+ * Value-type optional holding an immutable scalar (int, uint8_t, bool...) inline.
+ *
+ * <p>C++: replaces the std::shared_ptr<T> used as a nullable scalar in the Java port, avoiding a
+ * heap allocation and an atomic reference count for each optional value. std::optional is not
+ * available with the C++11 baseline.
+ *
+ * @param <T> The type of the held value, which must be a scalar type.
+ * @since 2.2.5.6
+ */
+template <typename T>
+class Optional final {
+public:
+    static_assert(std::is_scalar<T>::value, "Optional<T> requires a scalar type");
+
+    /**
+     * Creates an empty optional.
+     *
+     * @since 2.2.5.6
+     */
+    Optional() : mIsPresent(false), mValue() {}
+
+    /**
+     * Creates an optional holding the provided value.
+     *
+     * @param value The value.
+     * @since 2.2.5.6
+     */
+    Optional(const T value) : mIsPresent(true), mValue(value) {}
+
+    /**
+     * Creates an empty optional.
+     *
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    static Optional<T> empty()
+    {
+        return Optional<T>();
+    }
+
+    /**
+     * Creates an optional holding the provided value.
+     *
+     * @param value The value.
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    static Optional<T> of(const T value)
+    {
+        return Optional<T>(value);
+    }
+
+    /**
+     * Indicates if a value is present.
+     *
+     * @return True if a value is present.
+     * @since 2.2.5.6
+     */
+    bool isPresent() const
+    {
+        return mIsPresent;
+    }
+
+    /**
+     * Gets the held value.
+     *
+     * @return The value.
+     * @throw IllegalStateException If no value is present.
+     * @since 2.2.5.6
+     */
+    T get() const
+    {
+        if (!mIsPresent) {
+            throw IllegalStateException("No value present.");
+        }
+
+        return mValue;
+    }
+
+    /**
+     * Gets the held value or the provided one if no value is present.
+     *
+     * @param other The value to return if no value is present.
+     * @return The held value or other.
+     * @since 2.2.5.6
+     */
+    T orElse(const T other) const
+    {
+        return mIsPresent ? mValue : other;
+    }
+
+    /**
+     * Removes the held value, if any.
+     *
+     * @since 2.2.5.6
+     */
+    void reset()
+    {
+        mIsPresent = false;
+        mValue = T();
+    }
+
+    /**
+     *
+     */
+    bool operator==(const Optional<T>& o) const
+    {
+        return mIsPresent == o.mIsPresent && (!mIsPresent || mValue == o.mValue);
+    }
+
+    /**
+     *
+     */
+    bool operator!=(const Optional<T>& o) const
+    {
+        return !(*this == o);
+    }
+
+    /**
+     *
+     */
+    friend std::ostream& operator<<(std::ostream& os, const Optional<T>& o)
+    {
+        if (!o.mIsPresent) {
+            os << "null";
+        } else {
+            /* Unary + promotes uint8_t to int so that it is not printed as a character */
+            os << +o.mValue;
+        }
+
+        return os;
+    }
+
+private:
+    /**
+     *
+     */
+    bool mIsPresent;
+
+    /**
+     *
+     */
+    T mValue;
+};
+
+}
+}
+}
@@ -16,6 +16,9 @@ namespace keyple {
 namespace card {
 namespace calypso {
 
+const std::unique_ptr<Logger> SamControlSamTransactionManagerAdapter::mLogger =
+    LoggerFactory::getLogger(typeid(SamControlSamTransactionManagerAdapter));
+
 SamControlSamTransactionManagerAdapter::SamControlSamTransactionManagerAdapter(
   const std::shared_ptr<CalypsoSamAdapter> targetSam,
   const std::shared_ptr<SamSecuritySettingAdapter> securitySetting,
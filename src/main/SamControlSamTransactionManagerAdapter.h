@@ -54,8 +54,7 @@ private:
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(SamControlSamTransactionManagerAdapter));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
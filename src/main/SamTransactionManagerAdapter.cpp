@@ -12,10 +12,18 @@
 
 #include "SamTransactionManagerAdapter.h"
 
+#include <map>
+
+/* Keyple Card Calypso */
+#include "CmdSamReadKeyParameters.h"
+
 namespace keyple {
 namespace card {
 namespace calypso {
 
+const std::unique_ptr<Logger> SamTransactionManagerAdapter::mLogger =
+    LoggerFactory::getLogger(typeid(SamTransactionManagerAdapter));
+
 const int SamTransactionManagerAdapter::MIN_EVENT_COUNTER_NUMBER = 0;
 const int SamTransactionManagerAdapter::MAX_EVENT_COUNTER_NUMBER = 26;
 const int SamTransactionManagerAdapter::MIN_EVENT_CEILING_NUMBER = 0;
@@ -26,6 +34,10 @@ const int SamTransactionManagerAdapter::FIRST_COUNTER_REC2 = 9;
 const int SamTransactionManagerAdapter::LAST_COUNTER_REC2 = 17;
 const int SamTransactionManagerAdapter::FIRST_COUNTER_REC3 = 18;
 const int SamTransactionManagerAdapter::LAST_COUNTER_REC3 = 26;
+const int SamTransactionManagerAdapter::WORK_KEY_RECORD_NUMBER_MAX = 126;
+const int SamTransactionManagerAdapter::KEY_PARAMETERS_OFFSET = 8;
+const int SamTransactionManagerAdapter::KEY_PARAMETERS_LENGTH = 13;
+const int SamTransactionManagerAdapter::SW_RECORD_NOT_FOUND = 0x6A83;
 
 SamTransactionManagerAdapter::SamTransactionManagerAdapter(
   const std::shared_ptr<ProxyReaderApi> samReader,
@@ -45,6 +57,85 @@ const std::shared_ptr<CommonSecuritySetting> SamTransactionManagerAdapter::getSe
     return mSecuritySetting;
 }
 
+SamTransactionManagerAdapter& SamTransactionManagerAdapter::processReadKeyInventory()
+{
+    const auto sam = std::dynamic_pointer_cast<CalypsoSamAdapter>(getCalypsoSam());
+
+    std::vector<std::shared_ptr<AbstractApduCommand>> samCommands;
+    for (int recordNumber = 1; recordNumber <= WORK_KEY_RECORD_NUMBER_MAX; recordNumber++) {
+
+        samCommands.push_back(
+            std::make_shared<CmdSamReadKeyParameters>(
+                sam, CmdSamReadKeyParameters::SourceRef::WORK_KEY, recordNumber));
+    }
+
+    /* The processing must not stop on the empty records */
+    const std::vector<std::shared_ptr<ApduRequestSpi>> apduRequests = getApduRequests(samCommands);
+    const std::shared_ptr<CardResponseApi> cardResponse =
+        transmitCardRequest(std::make_shared<CardRequestAdapter>(apduRequests, false));
+
+    const std::vector<std::shared_ptr<ApduResponseApi>>& apduResponses =
+        cardResponse->getApduResponses();
+
+    if (apduResponses.size() != apduRequests.size()) {
+
+        throw withTransactionAuditData(
+                  InconsistentDataException("The number of SAM commands/responses does not " \
+                                            "match: nb commands = " +
+                                            std::to_string(apduRequests.size()) +
+                                            ", nb responses = " +
+                                            std::to_string(apduResponses.size())));
+    }
+
+    /* The inventory is only published once all the responses are parsed */
+    std::map<int, std::vector<uint8_t>> workKeyParameters;
+
+    for (int i = 0; i < static_cast<int>(apduResponses.size()); i++) {
+
+        if (apduResponses[i]->getStatusWord() == SW_RECORD_NOT_FOUND) {
+            continue;
+        }
+
+        const auto command = std::dynamic_pointer_cast<CmdSamReadKeyParameters>(samCommands[i]);
+
+        try {
+
+            command->parseApduResponse(apduResponses[i]);
+
+        } catch (const Exception& ex) {
+
+            /* C++: see CommonSamTransactionManagerAdapter::processCommands */
+            const CalypsoSamCommandException& e =
+                dynamic_cast<const CalypsoSamCommandException&>(ex);
+
+            throw withTransactionAuditData(
+                      UnexpectedCommandStatusException(
+                          MSG_SAM_COMMAND_ERROR +
+                          "while processing responses to SAM commands: " +
+                          e.getCommand().getName(),
+                          std::make_shared<CalypsoSamCommandException>(e)));
+        }
+
+        const std::vector<uint8_t> keyParameters = command->getKeyParameters();
+        if (static_cast<int>(keyParameters.size()) <
+                KEY_PARAMETERS_OFFSET + KEY_PARAMETERS_LENGTH) {
+
+            throw withTransactionAuditData(
+                      InconsistentDataException("Unexpected key parameters length: " +
+                                                std::to_string(keyParameters.size())));
+        }
+
+        workKeyParameters[i + 1] =
+            std::vector<uint8_t>(keyParameters.begin() + KEY_PARAMETERS_OFFSET,
+                                 keyParameters.begin() + KEY_PARAMETERS_OFFSET +
+                                     KEY_PARAMETERS_LENGTH);
+    }
+
+    sam->setWorkKeyInventory(workKeyParameters);
+
+    return *this;
+}
+
 }
 }
 }
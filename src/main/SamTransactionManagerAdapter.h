@@ -53,6 +53,27 @@ public:
      */
     const std::shared_ptr<CommonSecuritySetting> getSecuritySetting() const override;
 
+    /**
+     * Reads the parameters of all the work keys of the SAM and keeps them in the key inventory of
+     * the CalypsoSam.
+     *
+     * <p>The "Read Key Parameters" commands of all the work key records are transmitted in a single
+     * card request, the empty records being expected. Once available, the inventory lets the card
+     * transactions using this SAM as control SAM determine the KIF of a key from its KVC and reject
+     * a key absent from the SAM without any SAM exchange.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @return The current instance.
+     * @throw ReaderIOException If a communication error with the SAM reader occurs.
+     * @throw SamIOException If a communication error with the SAM occurs.
+     * @throw UnexpectedCommandStatusException If a command returns an unexpected status.
+     * @throw InconsistentDataException If the number of responses or the size of the key
+     *        parameters is not as expected.
+     * @since 2.2.5.6
+     */
+    SamTransactionManagerAdapter& processReadKeyInventory();
+
 private:
 
     /**
@@ -68,12 +89,15 @@ private:
     static const int LAST_COUNTER_REC2;
     static const int FIRST_COUNTER_REC3;
     static const int LAST_COUNTER_REC3;
+    static const int WORK_KEY_RECORD_NUMBER_MAX;
+    static const int KEY_PARAMETERS_OFFSET;
+    static const int KEY_PARAMETERS_LENGTH;
+    static const int SW_RECORD_NOT_FOUND;
 
     /**
      *
      */
-    const std::unique_ptr<Logger> mLogger =
-        LoggerFactory::getLogger(typeid(SamTransactionManagerAdapter));
+    static const std::unique_ptr<Logger> mLogger;
 
     /**
      *
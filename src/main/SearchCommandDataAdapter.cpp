@@ -12,6 +12,9 @@
 
 #include "SearchCommandDataAdapter.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace keyple {
 namespace card {
 namespace calypso {
@@ -105,6 +108,74 @@ bool SearchCommandDataAdapter::isFetchFirstMatchingResult() const
     return mFetchFirstMatchingResult;
 }
 
+const std::vector<uint8_t> SearchCommandDataAdapter::findMatchingRecordNumbers(
+    const std::map<const uint8_t, std::vector<uint8_t>>& records, const int recordSize) const
+{
+    const size_t length = mSearchData.size();
+
+    /* CL-CMD-SEARCH.1 */
+    std::vector<uint8_t> mask(length, 0xFF);
+    std::copy(mMask.begin(), mMask.end(), mask.begin());
+
+    std::vector<uint8_t> maskedSearchData(length);
+    for (size_t i = 0; i < length; i++) {
+        maskedSearchData[i] = mSearchData[i] & mask[i];
+    }
+
+    const int lastOffset = mEnableRepeatedOffset ? recordSize - static_cast<int>(length) : mOffset;
+
+    std::vector<uint8_t> matchingRecordNumbers;
+
+    for (auto it = records.lower_bound(mRecordNumber); it != records.end(); ++it) {
+
+        for (int offset = mOffset; offset <= lastOffset; offset++) {
+
+            if (isMatching(it->second.data() + offset,
+                           maskedSearchData.data(),
+                           mask.data(),
+                           length)) {
+
+                matchingRecordNumbers.push_back(it->first);
+                break;
+            }
+        }
+    }
+
+    return matchingRecordNumbers;
+}
+
+bool SearchCommandDataAdapter::isMatching(const uint8_t* data,
+                                          const uint8_t* maskedSearchData,
+                                          const uint8_t* mask,
+                                          const size_t length)
+{
+    size_t i = 0;
+
+    /* Word-wide comparison, the byte order does not matter for an equality */
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+
+        uint64_t dataWord;
+        uint64_t maskedSearchDataWord;
+        uint64_t maskWord;
+        std::memcpy(&dataWord, data + i, sizeof(uint64_t));
+        std::memcpy(&maskedSearchDataWord, maskedSearchData + i, sizeof(uint64_t));
+        std::memcpy(&maskWord, mask + i, sizeof(uint64_t));
+
+        if ((dataWord & maskWord) != maskedSearchDataWord) {
+            return false;
+        }
+    }
+
+    for (; i < length; i++) {
+
+        if ((data[i] & mask[i]) != maskedSearchData[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 }
 }
 }
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -145,6 +146,26 @@ public:
      */
     bool isFetchFirstMatchingResult() const;
 
+    /**
+     * (package-private)<br>
+     * Evaluates the search on records already known, with the same semantics as the card.
+     *
+     * <p>The masked search data is compared with each record from the start record, at the
+     * offset, or at each offset from it to the end of the record when the repeated offset is
+     * enabled. The comparison is made eight bytes at a time.
+     *
+     * <p>C++: specific to this implementation.
+     *
+     * @param records The records of the file by record number, each being recordSize long. The
+     *        mask must not be longer than the search data, which must fit in the record from the
+     *        offset.
+     * @param recordSize The size of the records.
+     * @return The numbers of the matching records, in ascending order.
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> findMatchingRecordNumbers(
+        const std::map<const uint8_t, std::vector<uint8_t>>& records, const int recordSize) const;
+
 private:
     /**
      *
@@ -185,6 +206,15 @@ private:
      *
      */
     std::vector<uint8_t> mMatchingRecordNumbers;
+
+    /**
+     * (private)<br>
+     * Indicates if the masked data matches the masked search data.
+     */
+    static bool isMatching(const uint8_t* data,
+                           const uint8_t* maskedSearchData,
+                           const uint8_t* mask,
+                           const size_t length);
 };
 
 }
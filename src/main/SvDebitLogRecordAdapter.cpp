@@ -34,6 +34,11 @@ const std::vector<uint8_t>& SvDebitLogRecordAdapter::getRawData() const
     return mCardResponse;
 }
 
+int SvDebitLogRecordAdapter::getOffset() const
+{
+    return mOffset;
+}
+
 int SvDebitLogRecordAdapter::getAmount() const
 {
     return ByteArrayUtil::extractInt(mCardResponse, mOffset, 2, true);
@@ -122,10 +127,12 @@ std::ostream& operator<<(std::ostream& os, const std::shared_ptr<SvDebitLogRecor
 const std::string SvDebitLogRecordAdapter::toJSONString() const
 {
     return "{" \
+               "\"offset\":" + std::to_string(mOffset) + ", " \
+               "\"cardResponse\": \"" + HexUtil::toHex(mCardResponse) + "\", " \
                "\"amount\":" + std::to_string(getAmount()) + ", " \
                "\"balance\":" + std::to_string(getBalance()) + ", " \
-               "\"debitDate\":" + HexUtil::toHex(getDebitDate()) + ", " \
-               "\"loadTime\":" + HexUtil::toHex(getDebitDate())  + ", " \
+               "\"debitDate\": \"" + HexUtil::toHex(getDebitDate()) + "\", " \
+               "\"debitTime\": \"" + HexUtil::toHex(getDebitTime()) + "\", " \
                "\"kvc\":" + std::to_string(getKvc()) + ", " \
                "\"samId\": \"" + HexUtil::toHex(getSamId()) + "\", " \
                "\"svTransactionNumber\":" + std::to_string(getSvTNum()) + ", " \
@@ -12,14 +12,26 @@
 
 #include "SvDebitLogRecordJsonDeserializerAdapter.h"
 
+/* Keyple Card Calypso */
+#include "SvLogRecordJsonDeserializerAdapter.h"
+
 namespace keyple {
 namespace card {
 namespace calypso {
 
-std::shared_ptr<SvDebitLogRecordAdapter> SvDebitLogRecordJsonDeserializerAdapter::deserialize()
+const int SvDebitLogRecordJsonDeserializerAdapter::RECORD_LENGTH = 19;
+
+std::shared_ptr<SvDebitLogRecordAdapter> SvDebitLogRecordJsonDeserializerAdapter::deserialize(
+    const std::string& json) const
+{
+    return deserialize(json.data(), json.size());
+}
+
+std::shared_ptr<SvDebitLogRecordAdapter> SvDebitLogRecordJsonDeserializerAdapter::deserialize(
+    const char* json, const size_t length) const
 {
-    // FIXME: to implement
-    return nullptr;
+    return SvLogRecordJsonDeserializerAdapter<SvDebitLogRecordAdapter>::deserialize(
+               json, length, RECORD_LENGTH);
 }
 
 }
@@ -12,9 +12,12 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <string>
 
 /* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
 #include "SvDebitLogRecordAdapter.h"
 
 namespace keyple {
@@ -25,21 +28,43 @@ namespace calypso {
  * (package-private)<br>
  * Deserializer of a SvDebitLogRecord.
  *
+ * <p>C++: the JSON document is the one produced by SvDebitLogRecordAdapter::toJSONString (or by the
+ * Java serializer), only the "offset" and "cardResponse" members are used, the other members
+ * are skipped. The document is read by SvLogRecordJsonDeserializerAdapter.
+ *
  * @since 2.0.0
  */
-class SvDebitLogRecordJsonDeserializerAdapter final {
-    //implements JsonDeserializer<SvDebitLogRecordAdapter>
-
+class KEYPLECARDCALYPSO_API SvDebitLogRecordJsonDeserializerAdapter final {
+public:
     /**
-     * {@inheritDoc}
+     * (package-private)<br>
+     * Deserializes a JSON document.
      *
+     * @param json The JSON document.
+     * @return A not null reference.
+     * @throw IllegalArgumentException If the document is malformed or inconsistent.
      * @since 2.0.0
      */
-    std::shared_ptr<SvDebitLogRecordAdapter> deserialize();
-    //     JsonElement json, Type typeOfT, JsonDeserializationContext context)
-    //     throws JsonParseException {
-    //     return context.deserialize(json, SvDebitLogRecordAdapter.class);
-    // }
+    std::shared_ptr<SvDebitLogRecordAdapter> deserialize(const std::string& json) const;
+
+    /**
+     * (package-private)<br>
+     * Deserializes a JSON document.
+     *
+     * @param json The first character of the JSON document.
+     * @param length The number of characters.
+     * @return A not null reference.
+     * @throw IllegalArgumentException If the document is malformed or inconsistent.
+     * @since 2.2.5.6
+     */
+    std::shared_ptr<SvDebitLogRecordAdapter> deserialize(const char* json,
+                                                         const size_t length) const;
+
+private:
+    /**
+     * Minimum length of the raw data after the offset.
+     */
+    static const int RECORD_LENGTH;
 };
 
 }
@@ -34,6 +34,11 @@ const std::vector<uint8_t>& SvLoadLogRecordAdapter::getRawData() const
     return mCardResponse;
 }
 
+int SvLoadLogRecordAdapter::getOffset() const
+{
+    return mOffset;
+}
+
 int SvLoadLogRecordAdapter::getAmount() const
 {
     return ByteArrayUtil::extractInt(mCardResponse, mOffset + 8, 3, true);
@@ -132,10 +137,12 @@ std::ostream& operator<<(std::ostream& os, const std::shared_ptr<SvLoadLogRecord
 const std::string SvLoadLogRecordAdapter::toJSONString() const
 {
     return "{" \
+               "\"offset\":" + std::to_string(mOffset) + ", " \
+               "\"cardResponse\": \"" + HexUtil::toHex(mCardResponse) + "\", " \
                "\"amount\":" + std::to_string(getAmount()) + ", " \
                "\"balance\":" + std::to_string(getBalance()) + ", " \
-               "\"debitDate\":" + HexUtil::toHex(getLoadDate()) + ", " \
-               "\"loadTime\":" + HexUtil::toHex(getLoadDate())  + ", " \
+               "\"loadDate\": \"" + HexUtil::toHex(getLoadDate()) + "\", " \
+               "\"loadTime\": \"" + HexUtil::toHex(getLoadTime()) + "\", " \
                "\"freeBytes\": \"" + HexUtil::toHex(getFreeData()) + "\", " \
                "\"kvc\":" + std::to_string(getKvc()) + ", " \
                "\"samId\": \"" + HexUtil::toHex(getSamId()) + "\", " \
@@ -136,6 +136,15 @@ public:
      */
     const std::string toJSONString() const;
 
+    /**
+     * (package-private)<br>
+     * Gets the offset of the log record in the raw data.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getOffset() const;
+
 private:
     /**
      *
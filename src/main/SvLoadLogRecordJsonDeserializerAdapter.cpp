@@ -12,14 +12,26 @@
 
 #include "SvLoadLogRecordJsonDeserializerAdapter.h"
 
+/* Keyple Card Calypso */
+#include "SvLogRecordJsonDeserializerAdapter.h"
+
 namespace keyple {
 namespace card {
 namespace calypso {
 
-std::shared_ptr<SvLoadLogRecordAdapter> SvLoadLogRecordJsonDeserializerAdapter::deserialize()
+const int SvLoadLogRecordJsonDeserializerAdapter::RECORD_LENGTH = 22;
+
+std::shared_ptr<SvLoadLogRecordAdapter> SvLoadLogRecordJsonDeserializerAdapter::deserialize(
+    const std::string& json) const
+{
+    return deserialize(json.data(), json.size());
+}
+
+std::shared_ptr<SvLoadLogRecordAdapter> SvLoadLogRecordJsonDeserializerAdapter::deserialize(
+    const char* json, const size_t length) const
 {
-    // FIXME: to implement
-    return nullptr;
+    return SvLogRecordJsonDeserializerAdapter<SvLoadLogRecordAdapter>::deserialize(
+               json, length, RECORD_LENGTH);
 }
 
 }
@@ -12,9 +12,12 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <string>
 
 /* Keyple Card Calypso */
+#include "KeypleCardCalypsoExport.h"
 #include "SvLoadLogRecordAdapter.h"
 
 namespace keyple {
@@ -23,23 +26,45 @@ namespace calypso {
 
 /**
  * (package-private)<br>
- * Deserializer of a {@link org.calypsonet.terminal.calypso.card.SvLoadLogRecord}.
+ * Deserializer of a SvLoadLogRecord.
+ *
+ * <p>C++: the JSON document is the one produced by SvLoadLogRecordAdapter::toJSONString (or by the
+ * Java serializer), only the "offset" and "cardResponse" members are used, the other members
+ * are skipped. The document is read by SvLogRecordJsonDeserializerAdapter.
  *
  * @since 2.0.0
  */
-class SvLoadLogRecordJsonDeserializerAdapter final {
-    //implements JsonDeserializer<SvLoadLogRecordAdapter>
-
+class KEYPLECARDCALYPSO_API SvLoadLogRecordJsonDeserializerAdapter final {
+public:
     /**
-     * {@inheritDoc}
+     * (package-private)<br>
+     * Deserializes a JSON document.
      *
+     * @param json The JSON document.
+     * @return A not null reference.
+     * @throw IllegalArgumentException If the document is malformed or inconsistent.
      * @since 2.0.0
      */
-    std::shared_ptr<SvLoadLogRecordAdapter> deserialize();
-    //     JsonElement json, Type typeOfT, JsonDeserializationContext context)
-    //     throws JsonParseException {
-    //     return context.deserialize(json, SvLoadLogRecordAdapter.class);
-    // }
+    std::shared_ptr<SvLoadLogRecordAdapter> deserialize(const std::string& json) const;
+
+    /**
+     * (package-private)<br>
+     * Deserializes a JSON document.
+     *
+     * @param json The first character of the JSON document.
+     * @param length The number of characters.
+     * @return A not null reference.
+     * @throw IllegalArgumentException If the document is malformed or inconsistent.
+     * @since 2.2.5.6
+     */
+    std::shared_ptr<SvLoadLogRecordAdapter> deserialize(const char* json,
+                                                        const size_t length) const;
+
+private:
+    /**
+     * Minimum length of the raw data after the offset.
+     */
+    static const int RECORD_LENGTH;
 };
 
 }
@@ -0,0 +1,116 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* Keyple Card Calypso */
+#include "JsonTokenizer.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util::cpp::exception;
+
+/**
+ * (package-private)<br>
+ * Deserializer shared by the SV load and SV debit log records.
+ *
+ * <p>Both records are rebuilt from the "offset" and "cardResponse" members of the JSON document,
+ * the other members are skipped. The document is read in a single pass with a JsonTokenizer.
+ *
+ * <p>C++: specific to this implementation.
+ *
+ * @param <R> The type of the log record, built from the card response and the offset.
+ * @since 2.2.5.6
+ */
+template <typename R>
+class SvLogRecordJsonDeserializerAdapter final {
+public:
+    /**
+     * (package-private)<br>
+     * Deserializes a JSON document.
+     *
+     * @param json The first character of the JSON document.
+     * @param length The number of characters.
+     * @param recordLength The minimum length of the raw data after the offset.
+     * @return A not null reference.
+     * @throw IllegalArgumentException If the document is malformed or inconsistent.
+     * @since 2.2.5.6
+     */
+    static std::shared_ptr<R> deserialize(const char* json,
+                                          const size_t length,
+                                          const int recordLength)
+    {
+        using TokenType = JsonTokenizer::TokenType;
+
+        JsonTokenizer tokenizer(json, length);
+
+        if (tokenizer.next() != TokenType::BEGIN_OBJECT) {
+            throw IllegalArgumentException("JSON object expected.");
+        }
+
+        int offset = -1;
+        bool isCardResponseFound = false;
+        std::vector<uint8_t> cardResponse;
+
+        TokenType type;
+        while ((type = tokenizer.next()) == TokenType::NAME) {
+
+            if (tokenizer.isTokenEqualTo("offset")) {
+
+                if (tokenizer.next() != TokenType::NUMBER) {
+                    throw IllegalArgumentException("Number expected for 'offset'.");
+                }
+
+                offset = tokenizer.getTokenAsInt();
+
+            } else if (tokenizer.isTokenEqualTo("cardResponse")) {
+
+                if (tokenizer.next() != TokenType::STRING) {
+                    throw IllegalArgumentException("String expected for 'cardResponse'.");
+                }
+
+                tokenizer.getTokenAsBytes(cardResponse);
+                isCardResponseFound = true;
+
+            } else {
+
+                tokenizer.skipValue();
+            }
+        }
+
+        if (type != TokenType::END_OBJECT || tokenizer.next() != TokenType::END_DOCUMENT) {
+            throw IllegalArgumentException("Single JSON object expected.");
+        }
+
+        if (!isCardResponseFound ||
+            offset < 0 ||
+            static_cast<size_t>(offset) + recordLength > cardResponse.size()) {
+            throw IllegalArgumentException("Missing or inconsistent 'offset' and 'cardResponse'.");
+        }
+
+        return std::make_shared<R>(cardResponse, offset);
+    }
+};
+
+}
+}
+}
@@ -0,0 +1,66 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#include "TransactionAuditData.h"
+
+#include <sstream>
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace keyple::core::util;
+
+TransactionAuditData::TransactionAuditData(
+  const std::shared_ptr<SmartCard> targetSmartCard,
+  const std::shared_ptr<CalypsoSamAdapter> controlSam,
+  const std::shared_ptr<const std::vector<std::vector<uint8_t>>> apdus)
+: mTargetSmartCard(targetSmartCard),
+  mControlSam(controlSam),
+  mApdus(apdus),
+  mApduCount(static_cast<int>(apdus->size())) {}
+
+int TransactionAuditData::getApduCount() const
+{
+    return mApduCount;
+}
+
+const std::string TransactionAuditData::toString() const
+{
+    std::stringstream ss;
+
+    ss << "\nTransaction audit JSON data: {";
+    ss << "\"targetSmartCard\":" << mTargetSmartCard << ",";
+
+    if (mControlSam != nullptr) {
+        ss << "\"controlSam\":" << mControlSam << ",";
+    }
+
+    ss << "\"apdus\": {";
+    for (int i = 0; i < mApduCount; i++) {
+        ss << HexUtil::toHex((*mApdus)[i]);
+        if (i != mApduCount - 1) {
+            ss << ", ";
+        }
+    }
+    ss << "}";
+
+    return ss.str();
+}
+
+}
+}
+}
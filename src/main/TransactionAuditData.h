@@ -0,0 +1,104 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Calypsonet Terminal Reader */
+#include "SmartCard.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoSamAdapter.h"
+
+namespace keyple {
+namespace card {
+namespace calypso {
+
+using namespace calypsonet::terminal::reader::selection::spi;
+
+/**
+ * (package-private)<br>
+ * Snapshot of the transaction audit data of a transaction manager, taken when an exception is
+ * thrown and formatted only on demand.
+ *
+ * <p>The snapshot shares the list of exchanged APDUs with the transaction manager and only records
+ * the number of entries present at the time it was taken. This is possible because the list is
+ * only ever completed. The target smart card and the control SAM are formatted in their state at
+ * the time of the formatting.
+ *
+ * <p>C++: specific to this implementation.
+ *
+ * @since 2.2.5.6
+ */
+class TransactionAuditData final {
+public:
+    /**
+     * (package-private)<br>
+     * Constructor.
+     *
+     * @param targetSmartCard The target card or SAM.
+     * @param controlSam The control SAM (optional).
+     * @param apdus The list of exchanged APDUs of the transaction manager.
+     * @since 2.2.5.6
+     */
+    TransactionAuditData(const std::shared_ptr<SmartCard> targetSmartCard,
+                         const std::shared_ptr<CalypsoSamAdapter> controlSam,
+                         const std::shared_ptr<const std::vector<std::vector<uint8_t>>> apdus);
+
+    /**
+     * (package-private)<br>
+     * Gets the number of APDUs (commands and responses) captured by the snapshot.
+     *
+     * @return A positive or zero int.
+     * @since 2.2.5.6
+     */
+    int getApduCount() const;
+
+    /**
+     * (package-private)<br>
+     * Returns a string representation of the transaction audit data.
+     *
+     * @return A not empty string.
+     * @since 2.2.5.6
+     */
+    const std::string toString() const;
+
+private:
+    /**
+     *
+     */
+    const std::shared_ptr<SmartCard> mTargetSmartCard;
+
+    /**
+     *
+     */
+    const std::shared_ptr<CalypsoSamAdapter> mControlSam;
+
+    /**
+     *
+     */
+    const std::shared_ptr<const std::vector<std::vector<uint8_t>>> mApdus;
+
+    /**
+     *
+     */
+    const int mApduCount;
+};
+
+}
+}
+}
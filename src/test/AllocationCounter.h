@@ -0,0 +1,36 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Global heap allocation counter, used to measure the number of allocations (and allocated bytes)
+ * performed by a piece of code.
+ *
+ * <p>The counters are updated by the replacement of the global operator new defined in
+ * AllocationCounter.cpp, which must be linked only once in the test executable.
+ */
+class AllocationCounter final {
+public:
+    /**
+     * Returns the number of allocations performed since the start of the program.
+     */
+    static long getCount();
+
+    /**
+     * Returns the number of bytes allocated since the start of the program.
+     */
+    static long long getBytes();
+};
@@ -0,0 +1,240 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include <sstream>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Calypsonet Terminal Calypso */
+#include "CardTransactionManager.h"
+
+/* Keyple Card Calypso */
+#include "ApduTraceRecorder.h"
+#include "ApduTraceReplayer.h"
+#include "CalypsoCardAdapter.h"
+#include "CalypsoExtensionService.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
+
+#include "CalypsoEmulatorFixture.h"
+
+using namespace testing;
+
+using namespace calypsonet::terminal::calypso::transaction;
+using namespace keyple::card::calypso;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+static const uint8_t FILE7 = CalypsoEmulatorFixture::FILE7;
+static const std::vector<uint8_t> REC1 = HexUtil::toByteArray("0102030405");
+static const std::vector<uint8_t> REC2 = HexUtil::toByteArray("AABBCC");
+
+static std::shared_ptr<CalypsoEmulatorFixture> emulators;
+static std::shared_ptr<CalypsoCardEmulator> cardEmulator;
+static std::shared_ptr<CalypsoSamEmulator> samEmulator;
+
+static void setUp()
+{
+    emulators = std::make_shared<CalypsoEmulatorFixture>();
+
+    cardEmulator = emulators->getCardEmulator();
+    cardEmulator->setContent(FILE7, 1, REC1);
+
+    samEmulator = emulators->getSamEmulator();
+}
+
+static void tearDown()
+{
+    samEmulator.reset();
+    cardEmulator.reset();
+    emulators.reset();
+}
+
+/**
+ * Runs a secure session reading record 1 and updating record 2 of FILE7, and returns the resulting
+ * card image.
+ */
+static std::shared_ptr<CalypsoCardAdapter> runTransaction(
+    const std::shared_ptr<CardReader> cardReader,
+    const std::shared_ptr<CardReader> samReader,
+    const std::vector<uint8_t>& record2)
+{
+    auto calypsoCard = CalypsoEmulatorFixture::createCalypsoCard(cardEmulator);
+    auto calypsoSam = CalypsoEmulatorFixture::createCalypsoSam(samEmulator);
+
+    auto cardSecuritySetting = CalypsoExtensionService::getInstance()->createCardSecuritySetting();
+    cardSecuritySetting->setControlSamResource(samReader, calypsoSam);
+
+    CalypsoExtensionService::getInstance()
+        ->createCardTransaction(cardReader, calypsoCard, cardSecuritySetting)
+        ->prepareReadRecord(FILE7, 1)
+        .processOpening(WriteAccessLevel::DEBIT)
+        .prepareUpdateRecord(FILE7, 2, record2)
+        .processClosing();
+
+    return calypsoCard;
+}
+
+static const std::vector<uint8_t> recordTransaction()
+{
+    std::ostringstream out;
+    ApduTraceRecorder recorder(out);
+
+    const auto cardReader = recorder.record(cardEmulator);
+    const auto samReader = recorder.record(samEmulator);
+    runTransaction(cardReader, samReader, REC2);
+
+    const std::string trace = out.str();
+
+    return std::vector<uint8_t>(trace.begin(), trace.end());
+}
+
+TEST(ApduTraceRecorderTest, constructor_shouldWriteHeader)
+{
+    std::ostringstream out;
+    ApduTraceRecorder recorder(out);
+
+    ASSERT_EQ(out.str(), std::string("KCAT\x01\x00\x00\x00", 8));
+    ASSERT_EQ(recorder.getExchangeCount(), 0);
+}
+
+TEST(ApduTraceRecorderTest, record_whenReaderIsNull_shouldThrowIAE)
+{
+    std::ostringstream out;
+    ApduTraceRecorder recorder(out);
+
+    EXPECT_THROW(recorder.record(nullptr), IllegalArgumentException);
+}
+
+TEST(ApduTraceRecorderTest, record_shouldRecordCardAndSamExchanges)
+{
+    setUp();
+
+    std::ostringstream out;
+    ApduTraceRecorder recorder(out);
+
+    const auto cardReader = recorder.record(cardEmulator);
+    const auto samReader = recorder.record(samEmulator);
+    runTransaction(cardReader, samReader, REC2);
+
+    ASSERT_EQ(cardReader->getName(), cardEmulator->getName());
+    ASSERT_GT(recorder.getExchangeCount(), 0);
+    ASSERT_EQ(cardEmulator->getContent(FILE7, 2)[0], 0xAA);
+
+    const std::string trace = out.str();
+    ApduTraceReplayer replayer(std::vector<uint8_t>(trace.begin(), trace.end()));
+
+    ASSERT_EQ(replayer.getChannelCount(), 2);
+    ASSERT_EQ(replayer.getExchangeCount(0) + replayer.getExchangeCount(1),
+              recorder.getExchangeCount());
+
+    tearDown();
+}
+
+TEST(ApduTraceRecorderTest, record_whenRecorderIsDestroyed_shouldStopRecording)
+{
+    setUp();
+
+    std::ostringstream out;
+    std::shared_ptr<CardReader> cardReader;
+    std::shared_ptr<CardReader> samReader;
+    {
+        ApduTraceRecorder recorder(out);
+        cardReader = recorder.record(cardEmulator);
+        samReader = recorder.record(samEmulator);
+    }
+
+    const std::string header = out.str();
+    runTransaction(cardReader, samReader, REC2);
+
+    ASSERT_EQ(cardEmulator->getContent(FILE7, 2)[0], 0xAA);
+    ASSERT_EQ(out.str(), header);
+
+    tearDown();
+}
+
+TEST(ApduTraceReplayerTest, constructor_whenTraceIsNotValid_shouldThrowIAE)
+{
+    EXPECT_THROW(ApduTraceReplayer(HexUtil::toByteArray("00000000")), IllegalArgumentException);
+    EXPECT_THROW(ApduTraceReplayer(HexUtil::toByteArray("4B434154020000")),
+                 IllegalArgumentException);
+}
+
+TEST(ApduTraceReplayerTest, getReader_whenChannelIsUnknown_shouldThrowIAE)
+{
+    ApduTraceReplayer replayer(HexUtil::toByteArray("4B43415401000000"));
+
+    EXPECT_THROW(replayer.getReader(0), IllegalArgumentException);
+}
+
+TEST(ApduTraceReplayerTest, replay_whenTransactionIsIdentical_shouldServeRecordedResponses)
+{
+    setUp();
+
+    const std::vector<uint8_t> trace = recordTransaction();
+    const long cardApduCount = cardEmulator->getApduCount();
+    const long samApduCount = samEmulator->getApduCount();
+
+    ApduTraceReplayer replayer(trace);
+    const auto calypsoCard = runTransaction(replayer.getReader(0), replayer.getReader(1), REC2);
+
+    std::vector<uint8_t> expected = REC1;
+    expected.resize(29);
+    ASSERT_EQ(calypsoCard->getFileBySfi(FILE7)->getData()->getContent(1), expected);
+    ASSERT_EQ(replayer.getReplayedExchangeCount(0), replayer.getExchangeCount(0));
+    ASSERT_EQ(replayer.getReplayedExchangeCount(1), replayer.getExchangeCount(1));
+
+    /* No I/O during the replay */
+    ASSERT_EQ(cardEmulator->getApduCount(), cardApduCount);
+    ASSERT_EQ(samEmulator->getApduCount(), samApduCount);
+
+    tearDown();
+}
+
+TEST(ApduTraceReplayerTest, replay_whenTransactionDiffers_shouldThrowISE)
+{
+    setUp();
+
+    ApduTraceReplayer replayer(recordTransaction());
+
+    EXPECT_THROW(runTransaction(replayer.getReader(0),
+                                replayer.getReader(1),
+                                HexUtil::toByteArray("DDEEFF")),
+                 IllegalStateException);
+
+    tearDown();
+}
+
+TEST(ApduTraceReplayerTest, replay_whenReplayerIsDestroyed_shouldServeRecordedResponses)
+{
+    setUp();
+
+    std::shared_ptr<CardReader> cardReader;
+    std::shared_ptr<CardReader> samReader;
+    {
+        ApduTraceReplayer replayer(recordTransaction());
+        cardReader = replayer.getReader(0);
+        samReader = replayer.getReader(1);
+    }
+
+    const auto calypsoCard = runTransaction(cardReader, samReader, REC2);
+
+    std::vector<uint8_t> expected = REC1;
+    expected.resize(29);
+    ASSERT_EQ(calypsoCard->getFileBySfi(FILE7)->getData()->getContent(1), expected);
+
+    tearDown();
+}
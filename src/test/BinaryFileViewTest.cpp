@@ -0,0 +1,140 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Calypsonet Terminal Calypso */
+#include "WriteAccessLevel.h"
+
+/* Keyple Card Calypso */
+#include "BinaryFileView.h"
+#include "CalypsoCardAdapter.h"
+#include "CardTransactionManagerAdapter.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+
+#include "CalypsoEmulatorFixture.h"
+
+using namespace testing;
+
+using namespace calypsonet::terminal::calypso::transaction;
+using namespace keyple::card::calypso;
+using namespace keyple::core::util::cpp::exception;
+
+static const uint8_t FILE4 = 0x04;
+static const uint16_t FILE4_LID = 0x2004;
+static const int FILE4_SIZE = 1000;
+
+static std::vector<uint8_t> binaryContent;
+
+static void addFile4(const CalypsoEmulatorFixture& emulators)
+{
+    binaryContent.resize(FILE4_SIZE);
+    for (int i = 0; i < FILE4_SIZE; i++) {
+        binaryContent[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    emulators.getCardEmulator()->addFile(
+        FILE4,
+        CalypsoEmulatorFixture::createFileHeader(FILE4_LID,
+                                                 1,
+                                                 FILE4_SIZE,
+                                                 ElementaryFile::Type::BINARY));
+    emulators.getCardEmulator()->setContent(FILE4, 1, binaryContent);
+}
+
+static const std::vector<uint8_t> getExpectedContent(const int offset, const int length)
+{
+    return std::vector<uint8_t>(binaryContent.begin() + offset,
+                                binaryContent.begin() + offset + length);
+}
+
+TEST(BinaryFileViewTest, constructor_whenSfiIsZero_shouldThrowIAE)
+{
+    CalypsoEmulatorFixture emulators;
+    addFile4(emulators);
+
+    EXPECT_THROW(BinaryFileView(emulators.createCardTransactionWithoutSecurity(), 0, FILE4_SIZE),
+                 IllegalArgumentException);
+}
+
+TEST(BinaryFileViewTest, read_whenRangeIsOutOfFile_shouldThrowIAE)
+{
+    CalypsoEmulatorFixture emulators;
+    addFile4(emulators);
+
+    BinaryFileView view(emulators.createCardTransactionWithoutSecurity(), FILE4, FILE4_SIZE);
+
+    EXPECT_THROW(view.read(FILE4_SIZE - 2, 3), IllegalArgumentException);
+    EXPECT_THROW(view.read(-1, 1), IllegalArgumentException);
+}
+
+TEST(BinaryFileViewTest, read_shouldReadMissingChunksInOneCardRequest)
+{
+    CalypsoEmulatorFixture emulators;
+    addFile4(emulators);
+
+    /* Chunks of 250 bytes: 0 and 1 are coalesced, 2 is skipped */
+    ASSERT_EQ(emulators.getCalypsoCard()->getPayloadCapacity(), 250);
+
+    const auto cardTransaction = emulators.createCardTransactionWithoutSecurity();
+    BinaryFileView view(cardTransaction, FILE4, FILE4_SIZE);
+    view.prefetch(10, 4).prefetch(300, 8);
+
+    ASSERT_EQ(view.read(900, 2), getExpectedContent(900, 2));
+    ASSERT_EQ(cardTransaction->getCardExchangeCount(), 1);
+    ASSERT_EQ(emulators.getCardEmulator()->getApduCount(), 3);
+    ASSERT_EQ(view.getReadChunkCount(), 3);
+    ASSERT_TRUE(view.isKnown(0, 500));
+    ASSERT_FALSE(view.isKnown(499, 2));
+    ASSERT_EQ(view.read(300, 8), getExpectedContent(300, 8));
+}
+
+TEST(BinaryFileViewTest, read_whenRangeIsKnown_shouldNotReadCard)
+{
+    CalypsoEmulatorFixture emulators;
+    addFile4(emulators);
+
+    BinaryFileView view(emulators.createCardTransactionWithoutSecurity(), FILE4, FILE4_SIZE);
+
+    ASSERT_EQ(view.read(10, 4), getExpectedContent(10, 4));
+
+    const long cardApduCount = emulators.getCardEmulator()->getApduCount();
+
+    ASSERT_EQ(view.read(20, 200), getExpectedContent(20, 200));
+    ASSERT_EQ(emulators.getCardEmulator()->getApduCount(), cardApduCount);
+    ASSERT_EQ(view.getReadChunkCount(), 1);
+}
+
+TEST(BinaryFileViewTest, read_whenSessionIsCancelled_shouldReadRestoredChunksAgain)
+{
+    CalypsoEmulatorFixture emulators;
+    addFile4(emulators);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    BinaryFileView view(cardTransaction, FILE4, FILE4_SIZE);
+
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    ASSERT_EQ(view.read(10, 4), getExpectedContent(10, 4));
+    ASSERT_TRUE(view.isKnown(0, 250));
+
+    /* The card image is restored as it was before the session */
+    cardTransaction->processCancel();
+
+    ASSERT_FALSE(view.isKnown(0, 250));
+    ASSERT_EQ(view.read(10, 4), getExpectedContent(10, 4));
+    ASSERT_EQ(view.getReadChunkCount(), 2);
+}
@@ -13,8 +13,11 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include "AllocationCounter.h"
+
 /* Keyple Card Calypso */
 #include "CalypsoCardAdapter.h"
+#include "CmdCardReadRecords.h"
 
 /* Keyple Core Service */
 #include "ApduResponseAdapter.h"
@@ -456,6 +459,61 @@ TEST(CalypsoCardAdapterTest, initializeWithFci_whenStartupInfoIsLarger_shouldPro
     tearDown();
 }
 
+TEST(CalypsoCardAdapterTest, initializeWithFci_whenRev3PatchIsApplicable_shouldApplyPayloadCapacity)
+{
+    setUp();
+
+    calypsoCardAdapter =
+        buildCalypsoCard(
+            buildSelectApplicationResponse(
+                DF_NAME,
+                CALYPSO_SERIAL_NUMBER,
+                StringUtils::format(STARTUP_INFO_SOFTWARE_VERSION_XX.c_str(), 0x10),
+                SW1SW2_OK));
+
+    ASSERT_EQ(calypsoCardAdapter->getPayloadCapacity(), 235);
+    ASSERT_FALSE(calypsoCardAdapter->isCounterValuePostponed());
+
+    calypsoCardAdapter =
+        buildCalypsoCard(
+            buildSelectApplicationResponse(
+                DF_NAME,
+                CALYPSO_SERIAL_NUMBER,
+                StringUtils::format(STARTUP_INFO_SOFTWARE_VERSION_XX.c_str(), 0x11),
+                SW1SW2_OK));
+
+    ASSERT_EQ(calypsoCardAdapter->getPayloadCapacity(), 250);
+
+    tearDown();
+}
+
+TEST(CalypsoCardAdapterTest, initializeWithFci_whenRev12PatchIsApplicable_shouldPostponeCounterValue)
+{
+    setUp();
+
+    calypsoCardAdapter =
+        buildCalypsoCard(
+            buildSelectApplicationResponse(DF_NAME,
+                                           CALYPSO_SERIAL_NUMBER,
+                                           "0A3C1005151001",
+                                           SW1SW2_OK));
+
+    ASSERT_EQ(calypsoCardAdapter->getProductType(), CalypsoCard::ProductType::PRIME_REVISION_2);
+    ASSERT_EQ(calypsoCardAdapter->getPayloadCapacity(), 128);
+    ASSERT_TRUE(calypsoCardAdapter->isCounterValuePostponed());
+
+    calypsoCardAdapter =
+        buildCalypsoCard(
+            buildSelectApplicationResponse(DF_NAME,
+                                           CALYPSO_SERIAL_NUMBER,
+                                           STARTUP_INFO_PRIME_REVISION_2,
+                                           SW1SW2_OK));
+
+    ASSERT_FALSE(calypsoCardAdapter->isCounterValuePostponed());
+
+    tearDown();
+}
+
 TEST(CalypsoCardAdapterTest, initializeWithFci_whenTagsAreInADifferentOrder_shouldProvideSameResult)
 {
     setUp();
@@ -921,3 +979,79 @@ TEST(CalypsoCardAdapterTest, getTransactionCounter_whenNoSessionWasOpened_should
 
     tearDown();
 }
+
+TEST(CalypsoCardAdapterTest, allocations_benchmark_shouldStayWithinTheTapBudget)
+{
+    static const int ITERATIONS = 1000;
+
+    /*
+     * About 100 allocations are expected per tap: the card image and its initialization (~10),
+     * each read command with its APDU and name (~15), each record set (~7: the file and its data,
+     * the content node and vector, the known range node and vector, the growth of the list of
+     * files) and each record of the backup (~7). The bounds leave a margin for the implementations
+     * of the standard library.
+     */
+    static const long MAX_OBJECTS_PER_TAP = 200;
+    static const long long MAX_BYTES_PER_TAP = 16384;
+
+    const std::vector<uint8_t> record = HexUtil::toByteArray("00112233445566778899AABBCCDDEEFF");
+
+    const long countBefore = AllocationCounter::getCount();
+    const long long bytesBefore = AllocationCounter::getBytes();
+
+    for (int i = 0; i < ITERATIONS; i++) {
+
+        /* Typical tap: selection, reading of 3 files in a session, backup of the card image */
+        const auto card = buildCalypsoCard(POWER_ON_DATA);
+        for (uint8_t sfi = 7; sfi <= 9; sfi++) {
+            const CmdCardReadRecords command(card,
+                                             sfi,
+                                             1,
+                                             CmdCardReadRecords::ReadMode::ONE_RECORD,
+                                             0);
+            card->setContent(sfi, 1, record);
+        }
+        card->backupFiles();
+    }
+
+    const long objectsPerTap = (AllocationCounter::getCount() - countBefore) / ITERATIONS;
+    const long long bytesPerTap = (AllocationCounter::getBytes() - bytesBefore) / ITERATIONS;
+
+    RecordProperty("objectsPerTap", std::to_string(objectsPerTap));
+    RecordProperty("bytesPerTap", std::to_string(bytesPerTap));
+
+    ASSERT_GT(objectsPerTap, 0);
+    ASSERT_LE(objectsPerTap, MAX_OBJECTS_PER_TAP);
+    ASSERT_LE(bytesPerTap, MAX_BYTES_PER_TAP);
+}
+
+TEST(CalypsoCardAdapterTest, isSvTNumMoreRecent_whenCounterRollsOver_shouldReturnTrue)
+{
+    ASSERT_TRUE(CalypsoCardAdapter::isSvTNumMoreRecent(6, 5));
+    ASSERT_TRUE(CalypsoCardAdapter::isSvTNumMoreRecent(1, 0xFFFE));
+    ASSERT_FALSE(CalypsoCardAdapter::isSvTNumMoreRecent(5, 5));
+    ASSERT_FALSE(CalypsoCardAdapter::isSvTNumMoreRecent(0, 5));
+}
+
+TEST(CalypsoCardAdapterTest, getSvDebitLogRecordsSince_shouldStopAtTheKnownRecord)
+{
+    setUp();
+
+    calypsoCardAdapter = buildCalypsoCard(POWER_ON_DATA);
+
+    /* Debit log records with SV transaction numbers 12, 11 and 10 */
+    for (uint8_t i = 1; i <= 3; i++) {
+        std::vector<uint8_t> record(29);
+        record[18] = static_cast<uint8_t>(13 - i);
+        calypsoCardAdapter->setContent(0x15, i, record);
+    }
+
+    const auto svDebitLogRecords = calypsoCardAdapter->getSvDebitLogRecordsSince(10);
+
+    ASSERT_EQ(svDebitLogRecords.size(), 2);
+    ASSERT_EQ(svDebitLogRecords[0]->getSvTNum(), 12);
+    ASSERT_EQ(svDebitLogRecords[1]->getSvTNum(), 11);
+    ASSERT_TRUE(calypsoCardAdapter->getSvDebitLogRecordsSince(12).empty());
+
+    tearDown();
+}
@@ -0,0 +1,1499 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CalypsoCardEmulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* Calypsonet Terminal Calypso */
+#include "WriteAccessLevel.h"
+
+/* Keyple Card Calypso */
+#include "DirectoryHeaderAdapter.h"
+
+/* Keyple Core Service */
+#include "ApduResponseAdapter.h"
+#include "CardResponseAdapter.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+
+using namespace calypsonet::terminal::calypso;
+using namespace keyple::card::calypso;
+using namespace keyple::core::service;
+using namespace keyple::core::util::cpp::exception;
+
+/* SESSION DIGEST ------------------------------------------------------------------------------- */
+
+static const uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325ULL;
+static const uint64_t FNV_PRIME = 0x00000100000001B3ULL;
+
+CalypsoCardEmulator::SessionDigest::SessionDigest(const std::vector<uint8_t>& key)
+: mLane1(FNV_OFFSET_BASIS), mLane2(~FNV_OFFSET_BASIS)
+{
+    update(key);
+}
+
+void CalypsoCardEmulator::SessionDigest::update(const std::vector<uint8_t>& data)
+{
+    /* Length prefix, so that the chunk boundaries are part of the digest */
+    mLane1 = (mLane1 ^ static_cast<uint8_t>(data.size())) * FNV_PRIME;
+    mLane2 = (mLane2 ^ static_cast<uint8_t>(data.size() + 0x5A)) * FNV_PRIME;
+
+    for (const auto b : data) {
+        mLane1 = (mLane1 ^ b) * FNV_PRIME;
+        mLane2 = (mLane2 ^ static_cast<uint8_t>(b ^ 0xA5)) * FNV_PRIME;
+        mLane2 ^= mLane1 >> 29;
+    }
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::SessionDigest::getBytes() const
+{
+    std::vector<uint8_t> bytes(16);
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = static_cast<uint8_t>(mLane1 >> (56 - 8 * i));
+        bytes[8 + i] = static_cast<uint8_t>(mLane2 >> (56 - 8 * i));
+    }
+
+    return bytes;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::SessionDigest::getTerminalSignature(
+    const int length) const
+{
+    const std::vector<uint8_t> bytes = getBytes();
+
+    return std::vector<uint8_t>(bytes.begin(), bytes.begin() + length);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::SessionDigest::getCardSignature(
+    const int length) const
+{
+    const std::vector<uint8_t> bytes = getBytes();
+
+    return std::vector<uint8_t>(bytes.begin() + 8, bytes.begin() + 8 + length);
+}
+
+/* CALYPSO CARD EMULATOR ------------------------------------------------------------------------ */
+
+static const uint8_t INS_GET_DATA = 0xCA;
+static const uint8_t INS_SELECT_FILE = 0xA4;
+static const uint8_t INS_READ_RECORDS = 0xB2;
+static const uint8_t INS_UPDATE_RECORD = 0xDC;
+static const uint8_t INS_WRITE_RECORD = 0xD2;
+static const uint8_t INS_APPEND_RECORD = 0xE2;
+static const uint8_t INS_READ_BINARY = 0xB0;
+static const uint8_t INS_UPDATE_BINARY = 0xD6;
+static const uint8_t INS_WRITE_BINARY = 0xD0;
+static const uint8_t INS_INCREASE = 0x32;
+static const uint8_t INS_DECREASE = 0x30;
+static const uint8_t INS_INCREASE_MULTIPLE = 0x3A;
+static const uint8_t INS_DECREASE_MULTIPLE = 0x38;
+static const uint8_t INS_READ_RECORD_MULTIPLE = 0xB3;
+static const uint8_t INS_SEARCH_RECORD_MULTIPLE = 0xA2;
+static const uint8_t INS_GET_CHALLENGE = 0x84;
+static const uint8_t INS_OPEN_SESSION = 0x8A;
+static const uint8_t INS_CLOSE_SESSION = 0x8E;
+static const uint8_t INS_VERIFY_PIN = 0x20;
+static const uint8_t INS_CHANGE_PIN = 0xD8;
+static const uint8_t INS_SV_GET = 0x7C;
+static const uint8_t INS_SV_RELOAD = 0xB8;
+static const uint8_t INS_SV_DEBIT = 0xBA;
+static const uint8_t INS_SV_UNDEBIT = 0xBC;
+static const uint8_t INS_INVALIDATE = 0x04;
+static const uint8_t INS_REHABILITATE = 0x44;
+
+const int CalypsoCardEmulator::SW_OK = 0x9000;
+const int CalypsoCardEmulator::SW_POSTPONED_DATA = 0x6200;
+const int CalypsoCardEmulator::SW_INVALIDATED = 0x6283;
+const int CalypsoCardEmulator::SW_WRONG_LENGTH = 0x6700;
+const int CalypsoCardEmulator::SW_OVERFLOW = 0x6400;
+const int CalypsoCardEmulator::SW_TRANSACTION_COUNTER_IS_ZERO = 0x6900;
+const int CalypsoCardEmulator::SW_NO_CURRENT_EF = 0x6986;
+const int CalypsoCardEmulator::SW_SECURITY_DATA = 0x6988;
+const int CalypsoCardEmulator::SW_PIN_BLOCKED = 0x6983;
+const int CalypsoCardEmulator::SW_ACCESS_FORBIDDEN = 0x6985;
+const int CalypsoCardEmulator::SW_FILE_NOT_FOUND = 0x6A82;
+const int CalypsoCardEmulator::SW_RECORD_NOT_FOUND = 0x6A83;
+const int CalypsoCardEmulator::SW_WRONG_PARAMETERS = 0x6B00;
+const int CalypsoCardEmulator::SW_DATA_NOT_FOUND = 0x6A88;
+const int CalypsoCardEmulator::SW_INS_NOT_SUPPORTED = 0x6D00;
+const int CalypsoCardEmulator::SV_LOAD_LOG_LENGTH = 22;
+const int CalypsoCardEmulator::SV_DEBIT_LOG_LENGTH = 19;
+const int CalypsoCardEmulator::PIN_ATTEMPTS = 3;
+
+CalypsoCardEmulator::CalypsoCardEmulator(const std::vector<uint8_t>& dfName,
+                                         const std::vector<uint8_t>& serialNumber,
+                                         const std::vector<uint8_t>& startupInfo)
+: mName("CalypsoCardEmulator"),
+  mDfName(dfName),
+  mSerialNumber(serialNumber),
+  mStartupInfo(startupInfo),
+  mIsExtendedModeSupported(startupInfo.size() == 7 && (startupInfo[2] & 0x08) != 0),
+  /* CL-SI-SM.1: buffer size in bytes = 2^((SM + 25) / 4) */
+  mModificationsBufferSize(startupInfo.empty() ?
+                               0 :
+                               static_cast<int>(std::pow(2.0, (startupInfo[0] + 25) / 4.0))),
+  mCurrentSfi(0),
+  mTransactionCounter(0x10000),
+  mRandom(0x12345678),
+  mApduCount(0),
+  mPin({0x30, 0x30, 0x30, 0x30}),
+  mPinAttemptRemaining(PIN_ATTEMPTS),
+  mPinCipheringKif(0x30),
+  mPinCipheringKvc(0x79),
+  mIsSessionOpen(false),
+  mIsSessionExtended(false),
+  mIsPreviousSessionRatified(true),
+  mIsRatificationPending(false),
+  mModificationsBufferUsed(0),
+  mSvKvc(0x79),
+  mIsSvGetDone(false)
+{
+    if (dfName.size() < 5 || dfName.size() > 16 ||
+        serialNumber.size() != 8 ||
+        startupInfo.size() != 7) {
+        throw IllegalArgumentException("Bad DF name, serial number or startup info length.");
+    }
+
+    mDirectoryHeader = DirectoryHeaderAdapter::builder()
+                           ->lid(0x3F00)
+                           .accessConditions({0x10, 0x10, 0x10, 0x10})
+                           .keyIndexes({0x01, 0x01, 0x01, 0x01})
+                           .dfStatus(0x00)
+                           .kif(WriteAccessLevel::PERSONALIZATION, 0x21)
+                           .kif(WriteAccessLevel::LOAD, 0x27)
+                           .kif(WriteAccessLevel::DEBIT, 0x30)
+                           .kvc(WriteAccessLevel::PERSONALIZATION, 0x79)
+                           .kvc(WriteAccessLevel::LOAD, 0x79)
+                           .kvc(WriteAccessLevel::DEBIT, 0x79)
+                           .build();
+
+    mState.svBalance = 0;
+    mState.svTransactionNumber = 0;
+    mState.svLoadLog = std::vector<uint8_t>(SV_LOAD_LOG_LENGTH);
+    mState.svDebitLog = std::vector<uint8_t>(SV_DEBIT_LOG_LENGTH);
+    mState.svLastSignature = std::vector<uint8_t>(6);
+    mState.isInvalidated = false;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::getKey(const uint8_t kif, const uint8_t kvc)
+{
+    std::vector<uint8_t> key(16);
+    for (int i = 0; i < 16; i++) {
+        key[i] = static_cast<uint8_t>((i * 0x11) ^ kif ^ (kvc << (i % 3)));
+    }
+
+    return key;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::cipherPinData(
+    const uint8_t kif,
+    const uint8_t kvc,
+    const std::vector<uint8_t>& cardChallenge,
+    const std::vector<uint8_t>& data)
+{
+    /* Key stream derived from the PIN ciphering key and the card challenge */
+    SessionDigest digest(getKey(kif, kvc));
+    digest.update(cardChallenge);
+
+    std::vector<uint8_t> keyStream = digest.getTerminalSignature(8);
+    const std::vector<uint8_t> keyStreamLo = digest.getCardSignature(8);
+    keyStream.insert(keyStream.end(), keyStreamLo.begin(), keyStreamLo.end());
+
+    std::vector<uint8_t> result(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        result[i] = data[i] ^ keyStream[i];
+    }
+
+    return result;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::getSelectApplicationResponse() const
+{
+    /* 6F L [84 L DF name] [A5 L [BF0C L [C7 08 serial number] [53 07 startup info]]] */
+    const uint8_t discretionaryLength = static_cast<uint8_t>(2 + 8 + 2 + 7);
+    const uint8_t proprietaryLength = static_cast<uint8_t>(3 + discretionaryLength);
+    const uint8_t fciLength =
+        static_cast<uint8_t>(2 + mDfName.size() + 2 + proprietaryLength);
+
+    std::vector<uint8_t> fci = {0x6F, fciLength, 0x84, static_cast<uint8_t>(mDfName.size())};
+    fci.insert(fci.end(), mDfName.begin(), mDfName.end());
+    fci.insert(fci.end(), {0xA5, proprietaryLength, 0xBF, 0x0C, discretionaryLength, 0xC7, 0x08});
+    fci.insert(fci.end(), mSerialNumber.begin(), mSerialNumber.end());
+    fci.insert(fci.end(), {0x53, 0x07});
+    fci.insert(fci.end(), mStartupInfo.begin(), mStartupInfo.end());
+
+    return buildResponse(fci, mState.isInvalidated ? SW_INVALIDATED : SW_OK);
+}
+
+void CalypsoCardEmulator::setDirectoryHeader(
+    const std::shared_ptr<DirectoryHeader> directoryHeader)
+{
+    mDirectoryHeader = directoryHeader;
+}
+
+void CalypsoCardEmulator::addFile(const uint8_t sfi, const std::shared_ptr<FileHeader> fileHeader)
+{
+    File file;
+    file.header = fileHeader;
+
+    const int recordsNumber =
+        fileHeader->getEfType() == ElementaryFile::Type::BINARY ? 1 :
+                                                                  fileHeader->getRecordsNumber();
+    for (int i = 1; i <= recordsNumber; i++) {
+        file.records[i] = std::vector<uint8_t>(fileHeader->getRecordSize());
+    }
+
+    mState.files[sfi] = file;
+}
+
+void CalypsoCardEmulator::setContent(const uint8_t sfi,
+                                     const uint8_t recordNumber,
+                                     const std::vector<uint8_t>& content)
+{
+    File* file = getFile(sfi);
+    if (file == nullptr || file->records.find(recordNumber) == file->records.end()) {
+        throw IllegalArgumentException("Unknown file or record.");
+    }
+
+    std::vector<uint8_t>& record = file->records[recordNumber];
+    if (content.size() > record.size()) {
+        throw IllegalArgumentException("Content too long.");
+    }
+
+    std::fill(record.begin(), record.end(), 0);
+    std::copy(content.begin(), content.end(), record.begin());
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::getContent(const uint8_t sfi,
+                                                           const uint8_t recordNumber) const
+{
+    const auto file = mState.files.find(sfi);
+    if (file == mState.files.end()) {
+        return std::vector<uint8_t>();
+    }
+
+    const auto record = file->second.records.find(recordNumber);
+    if (record == file->second.records.end()) {
+        return std::vector<uint8_t>();
+    }
+
+    return record->second;
+}
+
+void CalypsoCardEmulator::setTransactionCounter(const int transactionCounter)
+{
+    mTransactionCounter = transactionCounter;
+}
+
+int CalypsoCardEmulator::getTransactionCounter() const
+{
+    return mTransactionCounter;
+}
+
+void CalypsoCardEmulator::setPin(const std::vector<uint8_t>& pin)
+{
+    mPin = pin;
+    mPinAttemptRemaining = PIN_ATTEMPTS;
+}
+
+int CalypsoCardEmulator::getPinAttemptRemaining() const
+{
+    return mPinAttemptRemaining;
+}
+
+void CalypsoCardEmulator::setPinCipheringKey(const uint8_t kif, const uint8_t kvc)
+{
+    mPinCipheringKif = kif;
+    mPinCipheringKvc = kvc;
+}
+
+void CalypsoCardEmulator::setSvBalance(const int balance)
+{
+    mState.svBalance = balance;
+}
+
+int CalypsoCardEmulator::getSvBalance() const
+{
+    return mState.svBalance;
+}
+
+int CalypsoCardEmulator::getSvTransactionNumber() const
+{
+    return mState.svTransactionNumber;
+}
+
+bool CalypsoCardEmulator::isSessionOpen() const
+{
+    return mIsSessionOpen;
+}
+
+bool CalypsoCardEmulator::isInvalidated() const
+{
+    return mState.isInvalidated;
+}
+
+long CalypsoCardEmulator::getApduCount() const
+{
+    return mApduCount;
+}
+
+const std::string& CalypsoCardEmulator::getName() const
+{
+    return mName;
+}
+
+bool CalypsoCardEmulator::isContactless()
+{
+    return true;
+}
+
+bool CalypsoCardEmulator::isCardPresent()
+{
+    return true;
+}
+
+const std::shared_ptr<CardResponseApi> CalypsoCardEmulator::transmitCardRequest(
+    const std::shared_ptr<CardRequestSpi> cardRequest,
+    const ChannelControl channelControl)
+{
+    std::vector<std::shared_ptr<ApduResponseApi>> apduResponses;
+
+    for (const auto& apduRequest : cardRequest->getApduRequests()) {
+
+        const std::vector<uint8_t> response = processApdu(apduRequest->getApdu());
+        apduResponses.push_back(std::make_shared<ApduResponseAdapter>(response));
+
+        const int sw = (response[response.size() - 2] << 8) | response[response.size() - 1];
+        const std::vector<int>& successfulStatusWords = apduRequest->getSuccessfulStatusWords();
+
+        if (cardRequest->stopOnUnsuccessfulStatusWord() &&
+            std::find(successfulStatusWords.begin(), successfulStatusWords.end(), sw) ==
+                successfulStatusWords.end()) {
+            break;
+        }
+    }
+
+    if (channelControl == ChannelControl::CLOSE_AFTER) {
+        releaseChannel();
+    }
+
+    return std::make_shared<CardResponseAdapter>(apduResponses,
+                                                 channelControl == ChannelControl::KEEP_OPEN);
+}
+
+void CalypsoCardEmulator::releaseChannel()
+{
+    if (mIsSessionOpen) {
+        abortSession();
+    }
+
+    /* A pending ratification is lost when the card leaves the field */
+    mIsRatificationPending = false;
+    mIsSvGetDone = false;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processApdu(const std::vector<uint8_t>& apdu)
+{
+    mApduCount++;
+
+    /* Any command following a session closed with ratification asked ratifies it */
+    if (mIsRatificationPending) {
+        mIsPreviousSessionRatified = true;
+        mIsRatificationPending = false;
+    }
+
+    const Command command = parseCommand(apdu);
+    if (!command.isValid) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    const bool isDigested = mIsSessionOpen &&
+                            command.ins != INS_OPEN_SESSION &&
+                            command.ins != INS_CLOSE_SESSION;
+
+    std::vector<uint8_t> response;
+    if (mIsSessionOpen && isModifyingCommand(command.ins) && !consumeModificationsBuffer(command)) {
+        response = buildResponse(std::vector<uint8_t>(), SW_OVERFLOW);
+    } else {
+        response = processCommand(command);
+    }
+
+    /* CL-C4-MAC.1: Le is excluded from the digest for case 4 commands */
+    if (isDigested && mIsSessionOpen) {
+        mSessionDigest->update(isCase4(apdu) ?
+                                   std::vector<uint8_t>(apdu.begin(), apdu.end() - 1) :
+                                   apdu);
+        mSessionDigest->update(response);
+    }
+
+    return response;
+}
+
+CalypsoCardEmulator::Command CalypsoCardEmulator::parseCommand(const std::vector<uint8_t>& apdu)
+{
+    Command command;
+    command.isValid = apdu.size() >= 4;
+    command.ins = command.isValid ? apdu[1] : 0;
+    command.p1 = command.isValid ? apdu[2] : 0;
+    command.p2 = command.isValid ? apdu[3] : 0;
+    command.isLePresent = false;
+    command.le = 0;
+
+    if (apdu.size() == 5) {
+
+        /* Case 2 */
+        command.isLePresent = true;
+        command.le = apdu[4];
+
+    } else if (apdu.size() > 5) {
+
+        /* Case 3 or 4 */
+        const size_t lc = apdu[4];
+        if (apdu.size() == 5 + lc || apdu.size() == 6 + lc) {
+            command.data.assign(apdu.begin() + 5, apdu.begin() + 5 + lc);
+            command.isLePresent = apdu.size() == 6 + lc;
+            command.le = command.isLePresent ? apdu[5 + lc] : 0;
+        } else {
+            command.isValid = false;
+        }
+    }
+
+    return command;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::buildResponse(const std::vector<uint8_t>& data,
+                                                              const int sw)
+{
+    std::vector<uint8_t> response;
+    response.reserve(data.size() + 2);
+    response.insert(response.end(), data.begin(), data.end());
+    response.push_back(static_cast<uint8_t>(sw >> 8));
+    response.push_back(static_cast<uint8_t>(sw));
+
+    return response;
+}
+
+int CalypsoCardEmulator::getInt(const std::vector<uint8_t>& src,
+                                const int offset,
+                                const int length,
+                                const bool isSigned)
+{
+    int value = 0;
+    for (int i = 0; i < length; i++) {
+        value = (value << 8) | src[offset + i];
+    }
+
+    if (isSigned && (src[offset] & 0x80) != 0) {
+        value -= 1 << (8 * length);
+    }
+
+    return value;
+}
+
+void CalypsoCardEmulator::setInt(const int value,
+                                 std::vector<uint8_t>& dest,
+                                 const int offset,
+                                 const int length)
+{
+    for (int i = 0; i < length; i++) {
+        dest[offset + i] = static_cast<uint8_t>(value >> (8 * (length - 1 - i)));
+    }
+}
+
+bool CalypsoCardEmulator::isModifyingCommand(const uint8_t ins)
+{
+    switch (ins) {
+    case INS_UPDATE_RECORD:
+    case INS_WRITE_RECORD:
+    case INS_APPEND_RECORD:
+    case INS_UPDATE_BINARY:
+    case INS_WRITE_BINARY:
+    case INS_INCREASE:
+    case INS_DECREASE:
+    case INS_INCREASE_MULTIPLE:
+    case INS_DECREASE_MULTIPLE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool CalypsoCardEmulator::isCase4(const std::vector<uint8_t>& apdu)
+{
+    return apdu.size() > 5 && apdu[4] == apdu.size() - 6;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::nextRandom(const int length)
+{
+    std::vector<uint8_t> random(length);
+    for (auto& b : random) {
+
+        /* xorshift32 */
+        mRandom ^= mRandom << 13;
+        mRandom ^= mRandom >> 17;
+        mRandom ^= mRandom << 5;
+        b = static_cast<uint8_t>(mRandom);
+    }
+
+    return random;
+}
+
+CalypsoCardEmulator::File* CalypsoCardEmulator::getFile(const uint8_t sfi)
+{
+    const auto it = mState.files.find(sfi == 0 ? mCurrentSfi : sfi);
+    if (it == mState.files.end()) {
+        return nullptr;
+    }
+
+    mCurrentSfi = it->first;
+
+    return &it->second;
+}
+
+CalypsoCardEmulator::File* CalypsoCardEmulator::getFileByLid(const uint16_t lid)
+{
+    for (auto& entry : mState.files) {
+        if (entry.second.header->getLid() == lid) {
+            mCurrentSfi = entry.first;
+            return &entry.second;
+        }
+    }
+
+    return nullptr;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processCommand(const Command& command)
+{
+    switch (command.ins) {
+    case INS_GET_DATA:
+        return processGetData(command);
+    case INS_SELECT_FILE:
+        return processSelectFile(command);
+    case INS_READ_RECORDS:
+        return processReadRecords(command);
+    case INS_UPDATE_RECORD:
+    case INS_WRITE_RECORD:
+        return processUpdateOrWriteRecord(command);
+    case INS_APPEND_RECORD:
+        return processAppendRecord(command);
+    case INS_READ_BINARY:
+        return processReadBinary(command);
+    case INS_UPDATE_BINARY:
+    case INS_WRITE_BINARY:
+        return processUpdateOrWriteBinary(command);
+    case INS_INCREASE:
+    case INS_DECREASE:
+        return processIncreaseOrDecrease(command);
+    case INS_INCREASE_MULTIPLE:
+    case INS_DECREASE_MULTIPLE:
+        return processIncreaseOrDecreaseMultiple(command);
+    case INS_READ_RECORD_MULTIPLE:
+        return processReadRecordMultiple(command);
+    case INS_SEARCH_RECORD_MULTIPLE:
+        return processSearchRecordMultiple(command);
+    case INS_GET_CHALLENGE:
+        return processGetChallenge(command);
+    case INS_OPEN_SESSION:
+        return processOpenSession(command);
+    case INS_CLOSE_SESSION:
+        return processCloseSession(command);
+    case INS_VERIFY_PIN:
+        return processVerifyPin(command);
+    case INS_CHANGE_PIN:
+        return processChangePin(command);
+    case INS_SV_GET:
+        return processSvGet(command);
+    case INS_SV_RELOAD:
+        return processSvReload(command);
+    case INS_SV_DEBIT:
+    case INS_SV_UNDEBIT:
+        return processSvDebitOrUndebit(command);
+    case INS_INVALIDATE:
+    case INS_REHABILITATE:
+        return processInvalidateOrRehabilitate(command);
+    default:
+        return buildResponse(std::vector<uint8_t>(), SW_INS_NOT_SUPPORTED);
+    }
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processGetData(const Command& command)
+{
+    if (command.p1 != 0x00 || command.p2 != 0x6F) {
+        return buildResponse(std::vector<uint8_t>(), SW_DATA_NOT_FOUND);
+    }
+
+    std::vector<uint8_t> response = getSelectApplicationResponse();
+    response[response.size() - 2] = 0x90;
+    response[response.size() - 1] = 0x00;
+
+    return response;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processSelectFile(const Command& command)
+{
+    /* Select Application: the DF name must start with the provided AID */
+    if (command.p1 == 0x04) {
+        if (command.data.empty() ||
+            command.data.size() > mDfName.size() ||
+            !std::equal(command.data.begin(), command.data.end(), mDfName.begin())) {
+            return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+        }
+
+        return getSelectApplicationResponse();
+    }
+
+    if (command.data.size() != 2) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    const uint16_t lid = static_cast<uint16_t>(getInt(command.data, 0, 2, false));
+
+    /* Current DF */
+    if ((command.p1 == 0x09 && lid == 0x0000) || lid == mDirectoryHeader->getLid()) {
+        return buildResponse(buildDfProprietaryInformation(), SW_OK);
+    }
+
+    File* file = nullptr;
+
+    if (command.p1 == 0x02 && lid == 0x0000) {
+
+        /* First or next EF */
+        auto it = command.p2 == 0x02 ? mState.files.upper_bound(mCurrentSfi) :
+                                       mState.files.begin();
+        if (it != mState.files.end()) {
+            mCurrentSfi = it->first;
+            file = &it->second;
+        }
+
+    } else {
+
+        file = getFileByLid(lid);
+    }
+
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    return buildResponse(buildFileProprietaryInformation(mCurrentSfi, *file), SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::buildFileProprietaryInformation(
+    const uint8_t sfi,
+    const File& file) const
+{
+    const std::shared_ptr<FileHeader> header = file.header;
+
+    std::vector<uint8_t> info(25);
+    info[0] = 0x85;
+    info[1] = 0x17;
+    info[2] = sfi;
+    info[3] = 0x04;
+
+    switch (header->getEfType()) {
+    case ElementaryFile::Type::BINARY:
+        info[4] = 0x01;
+        setInt(header->getRecordSize(), info, 5, 2);
+        break;
+    case ElementaryFile::Type::LINEAR:
+        info[4] = 0x02;
+        break;
+    case ElementaryFile::Type::CYCLIC:
+        info[4] = 0x04;
+        break;
+    case ElementaryFile::Type::SIMULATED_COUNTERS:
+        info[4] = 0x08;
+        break;
+    case ElementaryFile::Type::COUNTERS:
+        info[4] = 0x09;
+        break;
+    }
+
+    if (header->getEfType() != ElementaryFile::Type::BINARY) {
+        info[5] = static_cast<uint8_t>(header->getRecordSize());
+        info[6] = static_cast<uint8_t>(header->getRecordsNumber());
+    }
+
+    std::copy(header->getAccessConditions().begin(),
+              header->getAccessConditions().end(),
+              info.begin() + 7);
+    std::copy(header->getKeyIndexes().begin(), header->getKeyIndexes().end(), info.begin() + 11);
+    info[15] = header->getDfStatus() != nullptr ? *header->getDfStatus() : 0x00;
+    setInt(header->getSharedReference() != nullptr ? *header->getSharedReference() : 0,
+           info,
+           16,
+           2);
+    setInt(header->getLid(), info, 23, 2);
+
+    return info;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::buildDfProprietaryInformation() const
+{
+    std::vector<uint8_t> info(25);
+    info[0] = 0x85;
+    info[1] = 0x17;
+    info[3] = 0x02;
+
+    std::copy(mDirectoryHeader->getAccessConditions().begin(),
+              mDirectoryHeader->getAccessConditions().end(),
+              info.begin() + 7);
+    std::copy(mDirectoryHeader->getKeyIndexes().begin(),
+              mDirectoryHeader->getKeyIndexes().end(),
+              info.begin() + 11);
+    info[15] = mDirectoryHeader->getDfStatus();
+    info[16] = mDirectoryHeader->getKvc(WriteAccessLevel::PERSONALIZATION);
+    info[17] = mDirectoryHeader->getKvc(WriteAccessLevel::LOAD);
+    info[18] = mDirectoryHeader->getKvc(WriteAccessLevel::DEBIT);
+    info[19] = mDirectoryHeader->getKif(WriteAccessLevel::PERSONALIZATION);
+    info[20] = mDirectoryHeader->getKif(WriteAccessLevel::LOAD);
+    info[21] = mDirectoryHeader->getKif(WriteAccessLevel::DEBIT);
+    setInt(mDirectoryHeader->getLid(), info, 23, 2);
+
+    return info;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processReadRecords(const Command& command)
+{
+    File* file = getFile(command.p2 >> 3);
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    const auto first = file->records.find(command.p1);
+    if (first == file->records.end()) {
+        return buildResponse(std::vector<uint8_t>(), SW_RECORD_NOT_FOUND);
+    }
+
+    if ((command.p2 & 0x07) == 0x04) {
+        return buildResponse(first->second, SW_OK);
+    }
+
+    /* Multiple records: [number][length][content]... up to Le */
+    const size_t maxLength = command.le == 0 ? 255 : command.le;
+    std::vector<uint8_t> data;
+
+    for (auto it = first; it != file->records.end(); it++) {
+
+        if (data.size() + 2 + it->second.size() > maxLength) {
+            break;
+        }
+
+        data.push_back(static_cast<uint8_t>(it->first));
+        data.push_back(static_cast<uint8_t>(it->second.size()));
+        data.insert(data.end(), it->second.begin(), it->second.end());
+    }
+
+    return buildResponse(data, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processUpdateOrWriteRecord(const Command& command)
+{
+    File* file = getFile(command.p2 >> 3);
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    const auto it = file->records.find(command.p1);
+    if (it == file->records.end()) {
+        return buildResponse(std::vector<uint8_t>(), SW_RECORD_NOT_FOUND);
+    }
+
+    std::vector<uint8_t>& record = it->second;
+    if (command.data.empty() || command.data.size() > record.size()) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    if (command.ins == INS_UPDATE_RECORD) {
+        std::fill(record.begin(), record.end(), 0);
+        std::copy(command.data.begin(), command.data.end(), record.begin());
+    } else {
+        for (size_t i = 0; i < command.data.size(); i++) {
+            record[i] |= command.data[i];
+        }
+    }
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processAppendRecord(const Command& command)
+{
+    File* file = getFile(command.p2 >> 3);
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    if (file->header->getEfType() != ElementaryFile::Type::CYCLIC) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    const int recordsNumber = static_cast<int>(file->records.size());
+    if (command.data.empty() || command.data.size() > file->records[1].size()) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    /* The oldest record is lost, the new one becomes record #1 */
+    for (int i = recordsNumber; i > 1; i--) {
+        file->records[i].swap(file->records[i - 1]);
+    }
+
+    std::vector<uint8_t>& record = file->records[1];
+    std::fill(record.begin(), record.end(), 0);
+    std::copy(command.data.begin(), command.data.end(), record.begin());
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processReadBinary(const Command& command)
+{
+    /* P1 = 100xxxxx: SFI, else MSB of the offset in the current EF */
+    const bool isSfiPresent = (command.p1 & 0x80) != 0;
+    File* file = getFile(isSfiPresent ? command.p1 & 0x1F : 0);
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    if (file->header->getEfType() != ElementaryFile::Type::BINARY) {
+        return buildResponse(std::vector<uint8_t>(), SW_NO_CURRENT_EF);
+    }
+
+    const std::vector<uint8_t>& content = file->records[1];
+    const size_t offset = isSfiPresent ? command.p2 : (command.p1 << 8) | command.p2;
+    if (offset >= content.size()) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    const size_t length = std::min(content.size() - offset,
+                                   static_cast<size_t>(command.le == 0 ? 256 : command.le));
+
+    return buildResponse(std::vector<uint8_t>(content.begin() + offset,
+                                              content.begin() + offset + length),
+                         SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processUpdateOrWriteBinary(const Command& command)
+{
+    const bool isSfiPresent = (command.p1 & 0x80) != 0;
+    File* file = getFile(isSfiPresent ? command.p1 & 0x1F : 0);
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    if (file->header->getEfType() != ElementaryFile::Type::BINARY) {
+        return buildResponse(std::vector<uint8_t>(), SW_NO_CURRENT_EF);
+    }
+
+    std::vector<uint8_t>& content = file->records[1];
+    const size_t offset = isSfiPresent ? command.p2 : (command.p1 << 8) | command.p2;
+    if (command.data.empty() || offset + command.data.size() > content.size()) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    for (size_t i = 0; i < command.data.size(); i++) {
+        if (command.ins == INS_UPDATE_BINARY) {
+            content[offset + i] = command.data[i];
+        } else {
+            content[offset + i] |= command.data[i];
+        }
+    }
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+int CalypsoCardEmulator::getCounterValue(const File& file, const int counterNumber) const
+{
+    const std::vector<uint8_t>& record = file.records.at(1);
+
+    return getInt(record, (counterNumber - 1) * 3, 3, false);
+}
+
+bool CalypsoCardEmulator::setCounterValue(File& file, const int counterNumber, const int value)
+{
+    if (value < 0 || value > 0xFFFFFF) {
+        return false;
+    }
+
+    setInt(value, file.records[1], (counterNumber - 1) * 3, 3);
+
+    return true;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processIncreaseOrDecrease(const Command& command)
+{
+    File* file = getFile(command.p2 >> 3);
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    const int counterNumber = command.p1;
+    if (command.data.size() != 3) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    if (counterNumber < 1 || counterNumber * 3 > static_cast<int>(file->records[1].size())) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    const int incDecValue = getInt(command.data, 0, 3, false);
+    const int value = getCounterValue(*file, counterNumber) +
+                      (command.ins == INS_DECREASE ? -incDecValue : incDecValue);
+
+    if (!setCounterValue(*file, counterNumber, value)) {
+        return buildResponse(std::vector<uint8_t>(), SW_OVERFLOW);
+    }
+
+    std::vector<uint8_t> data(3);
+    setInt(value, data, 0, 3);
+
+    return buildResponse(data, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processIncreaseOrDecreaseMultiple(
+    const Command& command)
+{
+    File* file = getFile(command.p2 >> 3);
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    if (command.data.empty() || command.data.size() % 4 != 0) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    /* All counters are checked before any modification */
+    const File backup = *file;
+    std::vector<uint8_t> data;
+
+    for (size_t i = 0; i < command.data.size(); i += 4) {
+
+        const int counterNumber = command.data[i];
+        if (counterNumber < 1 || counterNumber * 3 > static_cast<int>(file->records[1].size())) {
+            *file = backup;
+            return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+        }
+
+        const int incDecValue = getInt(command.data, static_cast<int>(i) + 1, 3, false);
+        const int value =
+            getCounterValue(*file, counterNumber) +
+            (command.ins == INS_DECREASE_MULTIPLE ? -incDecValue : incDecValue);
+
+        if (!setCounterValue(*file, counterNumber, value)) {
+            *file = backup;
+            return buildResponse(std::vector<uint8_t>(), SW_OVERFLOW);
+        }
+
+        data.push_back(static_cast<uint8_t>(counterNumber));
+        data.resize(data.size() + 3);
+        setInt(value, data, static_cast<int>(data.size()) - 3, 3);
+    }
+
+    return buildResponse(data, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processReadRecordMultiple(const Command& command)
+{
+    File* file = getFile(command.p2 >> 3);
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    /* Data in: 54h 02h offset length */
+    if (command.data.size() != 4 || command.data[0] != 0x54 || command.data[1] != 0x02) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    const size_t offset = command.data[2];
+    const size_t length = command.data[3];
+
+    const auto first = file->records.find(command.p1);
+    if (first == file->records.end()) {
+        return buildResponse(std::vector<uint8_t>(), SW_RECORD_NOT_FOUND);
+    }
+
+    if (length == 0 || offset + length > first->second.size()) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    const size_t maxLength = command.le == 0 ? 255 : command.le;
+    std::vector<uint8_t> data;
+
+    for (auto it = first; it != file->records.end() && data.size() + length <= maxLength; it++) {
+        data.insert(data.end(),
+                    it->second.begin() + offset,
+                    it->second.begin() + offset + length);
+    }
+
+    return buildResponse(data, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processSearchRecordMultiple(
+    const Command& command)
+{
+    File* file = getFile(command.p2 >> 3);
+    if (file == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+    }
+
+    /* Data in: flags offset length searchData mask */
+    if (command.data.size() < 3 ||
+        command.data.size() != 3 + 2 * static_cast<size_t>(command.data[2])) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    const bool isRepeatedOffset = (command.data[0] & 0x80) != 0;
+    const bool isFetchFirstMatchingResult = (command.data[0] & 0x01) != 0;
+    const size_t offset = command.data[1];
+    const size_t length = command.data[2];
+    const uint8_t* searchData = command.data.data() + 3;
+    const uint8_t* mask = searchData + length;
+
+    std::vector<uint8_t> matchingRecords;
+
+    for (auto it = file->records.find(command.p1); it != file->records.end(); it++) {
+
+        const std::vector<uint8_t>& record = it->second;
+        const size_t lastOffset = isRepeatedOffset ? record.size() : offset + length;
+
+        for (size_t o = offset; o + length <= record.size() && o + length <= lastOffset; o++) {
+
+            size_t i = 0;
+            while (i < length && (record[o + i] & mask[i]) == (searchData[i] & mask[i])) {
+                i++;
+            }
+
+            if (i == length) {
+                matchingRecords.push_back(static_cast<uint8_t>(it->first));
+                break;
+            }
+        }
+    }
+
+    std::vector<uint8_t> data;
+    data.push_back(static_cast<uint8_t>(matchingRecords.size()));
+    data.insert(data.end(), matchingRecords.begin(), matchingRecords.end());
+
+    if (isFetchFirstMatchingResult && !matchingRecords.empty()) {
+        const std::vector<uint8_t>& record = file->records[matchingRecords[0]];
+        data.insert(data.end(), record.begin(), record.end());
+    }
+
+    return buildResponse(data, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processGetChallenge(const Command& command)
+{
+    (void)command;
+
+    mCardChallenge = nextRandom(8);
+
+    return buildResponse(mCardChallenge, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processOpenSession(const Command& command)
+{
+    const uint8_t mode = command.p2 & 0x07;
+    const uint8_t keyIndex = command.p1 & 0x07;
+    const bool isExtended = mode == 0x02;
+
+    if ((mode != 0x01 && mode != 0x02) ||
+        (isExtended && !mIsExtendedModeSupported) ||
+        keyIndex < 1 || keyIndex > 3) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    if (command.data.size() != (isExtended ? 9u : 4u)) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    if (mIsSessionOpen) {
+        abortSession();
+    }
+
+    if (mTransactionCounter == 0) {
+        return buildResponse(std::vector<uint8_t>(), SW_TRANSACTION_COUNTER_IS_ZERO);
+    }
+
+    /* Record read at the opening */
+    std::vector<uint8_t> record;
+    const uint8_t sfi = command.p2 >> 3;
+    const uint8_t recordNumber = command.p1 >> 3;
+
+    if (sfi != 0 && recordNumber != 0) {
+
+        File* file = getFile(sfi);
+        if (file == nullptr) {
+            return buildResponse(std::vector<uint8_t>(), SW_FILE_NOT_FOUND);
+        }
+
+        const auto it = file->records.find(recordNumber);
+        if (it == file->records.end()) {
+            return buildResponse(std::vector<uint8_t>(), SW_RECORD_NOT_FOUND);
+        }
+
+        record = it->second;
+    }
+
+    const WriteAccessLevel writeAccessLevel =
+        keyIndex == 1 ? WriteAccessLevel::PERSONALIZATION :
+                        (keyIndex == 2 ? WriteAccessLevel::LOAD : WriteAccessLevel::DEBIT);
+    const uint8_t kif = mDirectoryHeader->getKif(writeAccessLevel);
+    const uint8_t kvc = mDirectoryHeader->getKvc(writeAccessLevel);
+
+    mTransactionCounter--;
+
+    /* Card challenge: transaction counter (3) + random (1 or 5) */
+    std::vector<uint8_t> data(3);
+    setInt(mTransactionCounter, data, 0, 3);
+    const std::vector<uint8_t> random = nextRandom(isExtended ? 5 : 1);
+    data.insert(data.end(), random.begin(), random.end());
+
+    /* Ratification byte (compatibility mode) or flags, bit 0 (extended mode) */
+    data.push_back(mIsPreviousSessionRatified ? 0x00 : 0x01);
+
+    data.push_back(kif);
+    data.push_back(kvc);
+    data.push_back(static_cast<uint8_t>(record.size()));
+    data.insert(data.end(), record.begin(), record.end());
+
+    /* The terminal challenge is the last 4 or 8 bytes of the incoming data */
+    const std::vector<uint8_t> samChallenge(command.data.begin() + (isExtended ? 1 : 0),
+                                            command.data.end());
+
+    mSessionBackup = mState;
+    mSessionDigest.reset(new SessionDigest(getKey(kif, kvc)));
+    mSessionDigest->update(samChallenge);
+    mSessionDigest->update(data);
+    mIsSessionOpen = true;
+    mIsSessionExtended = isExtended;
+    mIsPreviousSessionRatified = false;
+    mModificationsBufferUsed = 0;
+    mPostponedData.clear();
+
+    return buildResponse(data, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processCloseSession(const Command& command)
+{
+    if (!mIsSessionOpen) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    /* Abort */
+    if (command.data.empty()) {
+        abortSession();
+        return buildResponse(std::vector<uint8_t>(), SW_OK);
+    }
+
+    const int signatureLength = mIsSessionExtended ? 8 : 4;
+    if (static_cast<int>(command.data.size()) != signatureLength) {
+        abortSession();
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    if (command.data != mSessionDigest->getTerminalSignature(signatureLength)) {
+        abortSession();
+        return buildResponse(std::vector<uint8_t>(), SW_SECURITY_DATA);
+    }
+
+    /* Postponed data ([length including itself][data]...) followed by the card signature */
+    std::vector<uint8_t> data;
+    for (const auto& postponedData : mPostponedData) {
+        data.push_back(static_cast<uint8_t>(postponedData.size() + 1));
+        data.insert(data.end(), postponedData.begin(), postponedData.end());
+    }
+
+    const std::vector<uint8_t> signature = mSessionDigest->getCardSignature(signatureLength);
+    data.insert(data.end(), signature.begin(), signature.end());
+
+    mIsSessionOpen = false;
+    mSessionDigest.reset();
+    mPostponedData.clear();
+
+    /* P1 = 80h: ratification asked, the session is ratified by the next command */
+    if (command.p1 == 0x80) {
+        mIsRatificationPending = true;
+    } else {
+        mIsPreviousSessionRatified = true;
+    }
+
+    return buildResponse(data, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::decipherPinData(const std::vector<uint8_t>& data)
+{
+    const std::vector<uint8_t> plain =
+        cipherPinData(mPinCipheringKif, mPinCipheringKvc, mCardChallenge, data);
+
+    /* The challenge can only be used once */
+    mCardChallenge.clear();
+
+    return plain;
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processVerifyPin(const Command& command)
+{
+    if (mIsSessionOpen) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    if (command.data.empty()) {
+
+        /* Status of the PIN */
+        switch (mPinAttemptRemaining) {
+        case 0:
+            return buildResponse(std::vector<uint8_t>(), SW_PIN_BLOCKED);
+        case PIN_ATTEMPTS:
+            return buildResponse(std::vector<uint8_t>(), SW_OK);
+        default:
+            return buildResponse(std::vector<uint8_t>(), 0x63C0 | mPinAttemptRemaining);
+        }
+    }
+
+    if (command.data.size() != 4 && command.data.size() != 8) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    if (mPinAttemptRemaining == 0) {
+        return buildResponse(std::vector<uint8_t>(), SW_PIN_BLOCKED);
+    }
+
+    if (command.data.size() == 8 && mCardChallenge.empty()) {
+        return buildResponse(std::vector<uint8_t>(), 0x6982);
+    }
+
+    const std::vector<uint8_t> pin =
+        command.data.size() == 4 ? command.data : decipherPinData(command.data);
+
+    if (!std::equal(mPin.begin(), mPin.end(), pin.begin())) {
+
+        mPinAttemptRemaining--;
+
+        return buildResponse(std::vector<uint8_t>(),
+                             mPinAttemptRemaining == 0 ? SW_PIN_BLOCKED :
+                                                         0x63C0 | mPinAttemptRemaining);
+    }
+
+    mPinAttemptRemaining = PIN_ATTEMPTS;
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processChangePin(const Command& command)
+{
+    /* Change Key shares the same instruction byte */
+    if (command.p1 != 0x00 || command.p2 != 0xFF) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    if (mIsSessionOpen) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    if (command.data.size() == 4) {
+        mPin = command.data;
+        mPinAttemptRemaining = PIN_ATTEMPTS;
+        return buildResponse(std::vector<uint8_t>(), SW_OK);
+    }
+
+    if (command.data.size() != 16) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    if (mCardChallenge.empty()) {
+        return buildResponse(std::vector<uint8_t>(), 0x6982);
+    }
+
+    /* Ciphered current PIN (4) + new PIN (4) + padding (8) */
+    const std::vector<uint8_t> plain = decipherPinData(command.data);
+    if (!std::equal(mPin.begin(), mPin.end(), plain.begin())) {
+        return buildResponse(std::vector<uint8_t>(), SW_SECURITY_DATA);
+    }
+
+    mPin.assign(plain.begin() + 4, plain.begin() + 8);
+    mPinAttemptRemaining = PIN_ATTEMPTS;
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processSvGet(const Command& command)
+{
+    if ((mStartupInfo[2] & 0x02) == 0) {
+        return buildResponse(std::vector<uint8_t>(), SW_INS_NOT_SUPPORTED);
+    }
+
+    const bool isExtended = command.p1 == 0x01;
+    const bool isReload = command.p2 == 0x07;
+
+    if ((command.p1 != 0x00 && command.p1 != 0x01) ||
+        (command.p2 != 0x07 && command.p2 != 0x09) ||
+        (isExtended && !mIsExtendedModeSupported)) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> previousSignature = mState.svLastSignature;
+    previousSignature.resize(isExtended ? 6 : 3);
+
+    if (isExtended) {
+
+        /* Challenge (8) KVC TNum (2) previous signature (6) balance (3) load log debit log */
+        data = nextRandom(8);
+        data.push_back(mSvKvc);
+        data.resize(data.size() + 2);
+        setInt(mState.svTransactionNumber, data, 9, 2);
+        data.insert(data.end(), previousSignature.begin(), previousSignature.end());
+        data.resize(data.size() + 3);
+        setInt(mState.svBalance, data, 17, 3);
+        data.insert(data.end(), mState.svLoadLog.begin(), mState.svLoadLog.end());
+        data.insert(data.end(), mState.svDebitLog.begin(), mState.svDebitLog.end());
+
+    } else {
+
+        /* KVC TNum (2) previous signature (3) challenge (2) balance (3) load or debit log */
+        data.push_back(mSvKvc);
+        data.resize(3);
+        setInt(mState.svTransactionNumber, data, 1, 2);
+        data.insert(data.end(), previousSignature.begin(), previousSignature.end());
+        const std::vector<uint8_t> challenge = nextRandom(2);
+        data.insert(data.end(), challenge.begin(), challenge.end());
+        data.resize(data.size() + 3);
+        setInt(mState.svBalance, data, 8, 3);
+        const std::vector<uint8_t>& log = isReload ? mState.svLoadLog : mState.svDebitLog;
+        data.insert(data.end(), log.begin(), log.end());
+    }
+
+    mIsSvGetDone = true;
+
+    return buildResponse(data, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processSvReload(const Command& command)
+{
+    if (!mIsSvGetDone) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    if (command.data.size() != 23 && command.data.size() != 28) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    const std::vector<uint8_t>& d = command.data;
+    const int amount = getInt(d, 6, 3, true);
+    const int balance = mState.svBalance + amount;
+
+    if (balance < -8388608 || balance > 8388607) {
+        return buildResponse(std::vector<uint8_t>(), SW_OVERFLOW);
+    }
+
+    mState.svBalance = balance;
+    mState.svTransactionNumber = (mState.svTransactionNumber + 1) & 0xFFFF;
+
+    /* Date, free, KVC, free, balance, amount, time, SAM ID, SAM TNum, SV TNum */
+    std::vector<uint8_t>& log = mState.svLoadLog;
+    log[0] = d[1];
+    log[1] = d[2];
+    log[2] = d[3];
+    log[3] = d[4];
+    log[4] = d[5];
+    setInt(balance, log, 5, 3);
+    std::copy(d.begin() + 6, d.begin() + 9, log.begin() + 8);
+    std::copy(d.begin() + 9, d.begin() + 11, log.begin() + 11);
+    std::copy(d.begin() + 11, d.begin() + 18, log.begin() + 13);
+    setInt(mState.svTransactionNumber, log, 20, 2);
+
+    return endSvOperation(d);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processSvDebitOrUndebit(const Command& command)
+{
+    if (!mIsSvGetDone) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    if (command.data.size() != 20 && command.data.size() != 25) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    const std::vector<uint8_t>& d = command.data;
+    const int amount = getInt(d, 1, 2, true);
+    const int balance = mState.svBalance + amount;
+
+    if (balance < -8388608 || balance > 8388607) {
+        return buildResponse(std::vector<uint8_t>(), SW_OVERFLOW);
+    }
+
+    mState.svBalance = balance;
+    mState.svTransactionNumber = (mState.svTransactionNumber + 1) & 0xFFFF;
+
+    /* Amount (2) date (2) time (2) KVC SAM ID (4) SAM TNum (3) balance (3) TNum (2) */
+    std::vector<uint8_t>& log = mState.svDebitLog;
+    std::copy(d.begin() + 1, d.begin() + 15, log.begin());
+    setInt(balance, log, 14, 3);
+    setInt(mState.svTransactionNumber, log, 17, 2);
+
+    return endSvOperation(d);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::endSvOperation(const std::vector<uint8_t>& data)
+{
+    /* The length of the incoming data reveals the mode (signatureHi of 5 or 10 bytes) */
+    const bool isExtended = data.size() == 28 || data.size() == 25;
+
+    SessionDigest digest(getKey(0x00, mSvKvc));
+    digest.update(data);
+    mState.svLastSignature = digest.getCardSignature(isExtended ? 6 : 3);
+    mIsSvGetDone = false;
+
+    /* Inside a session, the signature is returned with the response to Close Secure Session */
+    if (mIsSessionOpen) {
+        mPostponedData.push_back(mState.svLastSignature);
+        return buildResponse(std::vector<uint8_t>(), SW_POSTPONED_DATA);
+    }
+
+    return buildResponse(mState.svLastSignature, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoCardEmulator::processInvalidateOrRehabilitate(
+    const Command& command)
+{
+    const bool isInvalidate = command.ins == INS_INVALIDATE;
+    if (mState.isInvalidated == isInvalidate) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    mState.isInvalidated = isInvalidate;
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+bool CalypsoCardEmulator::consumeModificationsBuffer(const Command& command)
+{
+    /* Cost in bytes: data length + 6 (see CL-SI-SM.1) */
+    const int cost = static_cast<int>(command.data.size()) + 6;
+    if (mModificationsBufferUsed + cost > mModificationsBufferSize) {
+        return false;
+    }
+
+    mModificationsBufferUsed += cost;
+
+    return true;
+}
+
+void CalypsoCardEmulator::abortSession()
+{
+    mState = mSessionBackup;
+    mIsSessionOpen = false;
+    mSessionDigest.reset();
+    mPostponedData.clear();
+}
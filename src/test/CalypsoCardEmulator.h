@@ -0,0 +1,473 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Calypsonet Terminal Calypso */
+#include "DirectoryHeader.h"
+#include "FileHeader.h"
+
+/* Calypsonet Terminal Card */
+#include "ProxyReaderApi.h"
+
+/* Calypsonet Terminal Reader */
+#include "CardReader.h"
+
+using namespace calypsonet::terminal::calypso::card;
+using namespace calypsonet::terminal::card;
+using namespace calypsonet::terminal::card::spi;
+using namespace calypsonet::terminal::reader;
+
+/**
+ * Stateful software Calypso Prime revision 3 card, plugged in as a reader.
+ *
+ * <p>The emulator processes the C-APDUs sent by the library and answers with the R-APDUs a real
+ * card would return. It supports:
+ * <ul>
+ *   <li>the selection data (FCI), Select Application (by DF name), Get Data FCI and Select
+ *       File (by LID, first/next EF, current DF),
+ *   <li>binary, linear, cyclic and counters EFs (read, update, write, append, increase,
+ *       decrease, read record multiple, search record multiple),
+ *   <li>the secure session in compatibility and extended modes, with the modifications buffer
+ *       and the rollback of the modifications when the session is aborted,
+ *   <li>the SV purse (SV Get, Reload, Debit, Undebit, inside or outside a session),
+ *   <li>the PIN (plain or ciphered presentation, status, change).
+ * </ul>
+ *
+ * <p>The session signatures are computed with {@link SessionDigest}, which only emulates the
+ * Calypso MAC: it is NOT a cryptographic algorithm. Access conditions are not enforced and the
+ * SV and PIN ciphering keys are the ones returned by {@link getKey}.
+ *
+ * <p>When the card request asks to stop on an unsuccessful status word, the processing stops
+ * after the first failing command and the partial response is returned, as done by the reader
+ * layer.
+ *
+ * @since 2.2.5.6
+ */
+class CalypsoCardEmulator final : public CardReader, public ProxyReaderApi {
+public:
+    /**
+     * Emulation of the Calypso session MAC shared by the card and SAM emulators.
+     *
+     * <p>Two keyed FNV-1a lanes are fed with length-prefixed chunks. The first half of the result
+     * is the terminal (SAM) signature, the second half is the card signature.
+     *
+     * @since 2.2.5.6
+     */
+    class SessionDigest final {
+    public:
+        /**
+         * Creates a digest initialized with the provided 16-byte key.
+         *
+         * @param key The key.
+         * @since 2.2.5.6
+         */
+        explicit SessionDigest(const std::vector<uint8_t>& key);
+
+        /**
+         * Adds a chunk of data to the digest.
+         *
+         * @param data The data.
+         * @since 2.2.5.6
+         */
+        void update(const std::vector<uint8_t>& data);
+
+        /**
+         * Returns the signature computed by the terminal.
+         *
+         * @param length 4 or 8.
+         * @return A not empty array.
+         * @since 2.2.5.6
+         */
+        const std::vector<uint8_t> getTerminalSignature(const int length) const;
+
+        /**
+         * Returns the signature computed by the card.
+         *
+         * @param length 3, 4, 6 or 8.
+         * @return A not empty array.
+         * @since 2.2.5.6
+         */
+        const std::vector<uint8_t> getCardSignature(const int length) const;
+
+    private:
+        /**
+         *
+         */
+        uint64_t mLane1;
+        uint64_t mLane2;
+
+        /**
+         *
+         */
+        const std::vector<uint8_t> getBytes() const;
+    };
+
+    /**
+     * Creates a card with an empty file system, a transaction counter set to 0x10000, the PIN
+     * "0000" and a zero SV balance.
+     *
+     * @param dfName The DF name (5 to 16 bytes).
+     * @param serialNumber The 8-byte application serial number.
+     * @param startupInfo The 7-byte startup information (revision 3 application type).
+     * @since 2.2.5.6
+     */
+    CalypsoCardEmulator(const std::vector<uint8_t>& dfName,
+                        const std::vector<uint8_t>& serialNumber,
+                        const std::vector<uint8_t>& startupInfo);
+
+    /**
+     * Returns the key used by both emulators for the provided KIF and KVC.
+     *
+     * @param kif The KIF.
+     * @param kvc The KVC.
+     * @return A 16-byte array.
+     * @since 2.2.5.6
+     */
+    static const std::vector<uint8_t> getKey(const uint8_t kif, const uint8_t kvc);
+
+    /**
+     * Ciphers or deciphers the PIN data exchanged between the SAM and the card (16 bytes max).
+     *
+     * @param kif The KIF of the PIN ciphering key.
+     * @param kvc The KVC of the PIN ciphering key.
+     * @param cardChallenge The challenge returned by the card.
+     * @param data The data.
+     * @return An array of the same length.
+     * @since 2.2.5.6
+     */
+    static const std::vector<uint8_t> cipherPinData(const uint8_t kif,
+                                                    const uint8_t kvc,
+                                                    const std::vector<uint8_t>& cardChallenge,
+                                                    const std::vector<uint8_t>& data);
+
+    /**
+     * Returns the response to the application selection (FCI followed by the status word).
+     *
+     * @return A not empty array.
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> getSelectApplicationResponse() const;
+
+    /**
+     * Replaces the header of the DF (KIFs and KVCs of the session keys).
+     *
+     * @param directoryHeader The header.
+     * @since 2.2.5.6
+     */
+    void setDirectoryHeader(const std::shared_ptr<DirectoryHeader> directoryHeader);
+
+    /**
+     * Creates an EF. The content of the records is initialized with zeros.
+     *
+     * @param sfi The SFI.
+     * @param fileHeader The header (LID, type, number and size of the records).
+     * @since 2.2.5.6
+     */
+    void addFile(const uint8_t sfi, const std::shared_ptr<FileHeader> fileHeader);
+
+    /**
+     * Sets the content of a record, or of a binary file when the record number is 1.
+     *
+     * @param sfi The SFI of an existing EF.
+     * @param recordNumber The record number.
+     * @param content The content, padded with zeros to the record size.
+     * @since 2.2.5.6
+     */
+    void setContent(const uint8_t sfi,
+                    const uint8_t recordNumber,
+                    const std::vector<uint8_t>& content);
+
+    /**
+     * Returns the content of a record.
+     *
+     * @param sfi The SFI.
+     * @param recordNumber The record number.
+     * @return An empty array if the record does not exist.
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> getContent(const uint8_t sfi, const uint8_t recordNumber) const;
+
+    /**
+     * @since 2.2.5.6
+     */
+    void setTransactionCounter(const int transactionCounter);
+
+    /**
+     * @since 2.2.5.6
+     */
+    int getTransactionCounter() const;
+
+    /**
+     * @since 2.2.5.6
+     */
+    void setPin(const std::vector<uint8_t>& pin);
+
+    /**
+     * @since 2.2.5.6
+     */
+    int getPinAttemptRemaining() const;
+
+    /**
+     * Sets the KIF and KVC of the key used to cipher the PIN.
+     *
+     * @since 2.2.5.6
+     */
+    void setPinCipheringKey(const uint8_t kif, const uint8_t kvc);
+
+    /**
+     * @since 2.2.5.6
+     */
+    void setSvBalance(const int balance);
+
+    /**
+     * @since 2.2.5.6
+     */
+    int getSvBalance() const;
+
+    /**
+     * @since 2.2.5.6
+     */
+    int getSvTransactionNumber() const;
+
+    /**
+     * @since 2.2.5.6
+     */
+    bool isSessionOpen() const;
+
+    /**
+     * @since 2.2.5.6
+     */
+    bool isInvalidated() const;
+
+    /**
+     * Returns the number of C-APDUs processed since the creation of the card.
+     *
+     * @since 2.2.5.6
+     */
+    long getApduCount() const;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    const std::string& getName() const override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    bool isContactless() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    bool isCardPresent() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardResponseApi> transmitCardRequest(
+        const std::shared_ptr<CardRequestSpi> cardRequest,
+        const ChannelControl channelControl) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * <p>An open session is aborted.
+     *
+     * @since 2.2.5.6
+     */
+    void releaseChannel() override;
+
+    /**
+     * Processes a single C-APDU.
+     *
+     * @param apdu The C-APDU.
+     * @return The R-APDU (data followed by the status word).
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> processApdu(const std::vector<uint8_t>& apdu);
+
+private:
+    /**
+     * Decoded C-APDU.
+     */
+    struct Command {
+        bool isValid;
+        uint8_t ins;
+        uint8_t p1;
+        uint8_t p2;
+        std::vector<uint8_t> data;
+        bool isLePresent;
+        uint8_t le;
+    };
+
+    /**
+     * An EF and its records.
+     */
+    struct File {
+        std::shared_ptr<FileHeader> header;
+        std::map<int, std::vector<uint8_t>> records;
+    };
+
+    /**
+     * The state restored when a session is aborted.
+     */
+    struct State {
+        std::map<uint8_t, File> files;
+        int svBalance;
+        int svTransactionNumber;
+        std::vector<uint8_t> svLoadLog;
+        std::vector<uint8_t> svDebitLog;
+        std::vector<uint8_t> svLastSignature;
+        bool isInvalidated;
+    };
+
+    /**
+     *
+     */
+    static const int SW_OK;
+    static const int SW_POSTPONED_DATA;
+    static const int SW_INVALIDATED;
+    static const int SW_WRONG_LENGTH;
+    static const int SW_OVERFLOW;
+    static const int SW_TRANSACTION_COUNTER_IS_ZERO;
+    static const int SW_NO_CURRENT_EF;
+    static const int SW_SECURITY_DATA;
+    static const int SW_PIN_BLOCKED;
+    static const int SW_ACCESS_FORBIDDEN;
+    static const int SW_FILE_NOT_FOUND;
+    static const int SW_RECORD_NOT_FOUND;
+    static const int SW_WRONG_PARAMETERS;
+    static const int SW_DATA_NOT_FOUND;
+    static const int SW_INS_NOT_SUPPORTED;
+    static const int SV_LOAD_LOG_LENGTH;
+    static const int SV_DEBIT_LOG_LENGTH;
+    static const int PIN_ATTEMPTS;
+
+    /**
+     *
+     */
+    const std::string mName;
+    const std::vector<uint8_t> mDfName;
+    const std::vector<uint8_t> mSerialNumber;
+    const std::vector<uint8_t> mStartupInfo;
+    const bool mIsExtendedModeSupported;
+    const int mModificationsBufferSize;
+    std::shared_ptr<DirectoryHeader> mDirectoryHeader;
+
+    /**
+     * Current state (file system, SV purse, DF status).
+     */
+    State mState;
+
+    /**
+     * State saved at the opening of the session.
+     */
+    State mSessionBackup;
+
+    /**
+     *
+     */
+    uint8_t mCurrentSfi;
+    int mTransactionCounter;
+    uint32_t mRandom;
+    std::vector<uint8_t> mCardChallenge;
+    long mApduCount;
+
+    /**
+     * PIN.
+     */
+    std::vector<uint8_t> mPin;
+    int mPinAttemptRemaining;
+    uint8_t mPinCipheringKif;
+    uint8_t mPinCipheringKvc;
+
+    /**
+     * Secure session.
+     */
+    bool mIsSessionOpen;
+    bool mIsSessionExtended;
+    bool mIsPreviousSessionRatified;
+    bool mIsRatificationPending;
+    int mModificationsBufferUsed;
+    std::unique_ptr<SessionDigest> mSessionDigest;
+    std::vector<std::vector<uint8_t>> mPostponedData;
+
+    /**
+     * SV.
+     */
+    uint8_t mSvKvc;
+    bool mIsSvGetDone;
+
+    /**
+     *
+     */
+    static Command parseCommand(const std::vector<uint8_t>& apdu);
+    static const std::vector<uint8_t> buildResponse(const std::vector<uint8_t>& data, const int sw);
+    static int getInt(const std::vector<uint8_t>& src,
+                      const int offset,
+                      const int length,
+                      const bool isSigned);
+    static void setInt(const int value,
+                       std::vector<uint8_t>& dest,
+                       const int offset,
+                       const int length);
+    static bool isModifyingCommand(const uint8_t ins);
+    static bool isCase4(const std::vector<uint8_t>& apdu);
+    const std::vector<uint8_t> nextRandom(const int length);
+    File* getFile(const uint8_t sfi);
+    File* getFileByLid(const uint16_t lid);
+    const std::vector<uint8_t> processCommand(const Command& command);
+    const std::vector<uint8_t> processGetData(const Command& command);
+    const std::vector<uint8_t> processSelectFile(const Command& command);
+    const std::vector<uint8_t> buildFileProprietaryInformation(const uint8_t sfi,
+                                                               const File& file) const;
+    const std::vector<uint8_t> buildDfProprietaryInformation() const;
+    const std::vector<uint8_t> processReadRecords(const Command& command);
+    const std::vector<uint8_t> processUpdateOrWriteRecord(const Command& command);
+    const std::vector<uint8_t> processAppendRecord(const Command& command);
+    const std::vector<uint8_t> processReadBinary(const Command& command);
+    const std::vector<uint8_t> processUpdateOrWriteBinary(const Command& command);
+    const std::vector<uint8_t> processIncreaseOrDecrease(const Command& command);
+    const std::vector<uint8_t> processIncreaseOrDecreaseMultiple(const Command& command);
+    const std::vector<uint8_t> processReadRecordMultiple(const Command& command);
+    const std::vector<uint8_t> processSearchRecordMultiple(const Command& command);
+    const std::vector<uint8_t> processGetChallenge(const Command& command);
+    const std::vector<uint8_t> processOpenSession(const Command& command);
+    const std::vector<uint8_t> processCloseSession(const Command& command);
+    const std::vector<uint8_t> processVerifyPin(const Command& command);
+    const std::vector<uint8_t> processChangePin(const Command& command);
+    const std::vector<uint8_t> processSvGet(const Command& command);
+    const std::vector<uint8_t> processSvReload(const Command& command);
+    const std::vector<uint8_t> processSvDebitOrUndebit(const Command& command);
+    const std::vector<uint8_t> processInvalidateOrRehabilitate(const Command& command);
+    const std::vector<uint8_t> decipherPinData(const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> endSvOperation(const std::vector<uint8_t>& apdu);
+    int getCounterValue(const File& file, const int counterNumber) const;
+    bool setCounterValue(File& file, const int counterNumber, const int value);
+    bool consumeModificationsBuffer(const Command& command);
+    void abortSession();
+};
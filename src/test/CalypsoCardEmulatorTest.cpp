@@ -0,0 +1,323 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include <chrono>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Calypsonet Terminal Calypso */
+#include "CardTransactionManager.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "CalypsoExtensionService.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "IllegalArgumentException.h"
+
+#include "CalypsoEmulatorFixture.h"
+
+using namespace testing;
+
+using namespace calypsonet::terminal::calypso::transaction;
+using namespace keyple::card::calypso;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+static const std::vector<uint8_t> DF_NAME = CalypsoEmulatorFixture::DF_NAME;
+static const std::vector<uint8_t> SERIAL_NUMBER = CalypsoEmulatorFixture::CARD_SERIAL_NUMBER;
+static const uint8_t FILE7 = CalypsoEmulatorFixture::FILE7;
+static const uint8_t FILE_COUNTERS = 0x19;
+static const std::vector<uint8_t> REC1 = HexUtil::toByteArray("0102030405");
+static const std::vector<uint8_t> SAM_CHALLENGE = HexUtil::toByteArray("C1C2C3C4C5C6C7C8");
+
+static std::shared_ptr<CalypsoEmulatorFixture> emulators;
+static std::shared_ptr<CalypsoCardEmulator> emulator;
+static std::shared_ptr<CalypsoCardAdapter> calypsoCard;
+static std::shared_ptr<CardTransactionManager> cardTransactionManager;
+
+static void setUp()
+{
+    emulators = std::make_shared<CalypsoEmulatorFixture>();
+
+    emulator = emulators->getCardEmulator();
+    emulator->addFile(FILE_COUNTERS,
+                      CalypsoEmulatorFixture::createFileHeader(0x2019,
+                                                               1,
+                                                               9,
+                                                               ElementaryFile::Type::COUNTERS));
+    emulator->setContent(FILE7, 1, REC1);
+
+    calypsoCard = emulators->getCalypsoCard();
+    cardTransactionManager = emulators->createCardTransactionWithoutSecurity();
+}
+
+static void tearDown()
+{
+    cardTransactionManager.reset();
+    calypsoCard.reset();
+    emulator.reset();
+    emulators.reset();
+}
+
+static int getStatusWord(const std::vector<uint8_t>& response)
+{
+    return (response[response.size() - 2] << 8) | response[response.size() - 1];
+}
+
+/**
+ * Opens an extended mode session with the DEBIT key and returns the digest computed on the terminal
+ * side.
+ */
+static std::shared_ptr<CalypsoCardEmulator::SessionDigest> openSession()
+{
+    /* P1 = record 1 * 8 + key index 3, P2 = SFI 7 * 8 + 2 (extended mode) */
+    std::vector<uint8_t> apdu = HexUtil::toByteArray("008A0B3A0900");
+    apdu.insert(apdu.end(), SAM_CHALLENGE.begin(), SAM_CHALLENGE.end());
+    apdu.push_back(0x00);
+
+    const std::vector<uint8_t> response = emulator->processApdu(apdu);
+    EXPECT_EQ(getStatusWord(response), 0x9000);
+
+    auto digest = std::make_shared<CalypsoCardEmulator::SessionDigest>(
+                      CalypsoCardEmulator::getKey(0x30, 0x79));
+    digest->update(SAM_CHALLENGE);
+    digest->update(std::vector<uint8_t>(response.begin(), response.end() - 2));
+
+    return digest;
+}
+
+static const std::vector<uint8_t> processInSession(
+    const std::shared_ptr<CalypsoCardEmulator::SessionDigest> digest,
+    const std::vector<uint8_t>& apdu)
+{
+    const std::vector<uint8_t> response = emulator->processApdu(apdu);
+    digest->update(apdu);
+    digest->update(response);
+
+    return response;
+}
+
+static const std::vector<uint8_t> closeSession(
+    const std::shared_ptr<CalypsoCardEmulator::SessionDigest> digest)
+{
+    std::vector<uint8_t> apdu = HexUtil::toByteArray("008E000008");
+    const std::vector<uint8_t> signature = digest->getTerminalSignature(8);
+    apdu.insert(apdu.end(), signature.begin(), signature.end());
+    apdu.push_back(0x00);
+
+    return emulator->processApdu(apdu);
+}
+
+TEST(CalypsoCardEmulatorTest, constructor_whenStartupInfoIsBad_shouldThrowIAE)
+{
+    EXPECT_THROW(CalypsoCardEmulator(DF_NAME, SERIAL_NUMBER, HexUtil::toByteArray("0A3C")),
+                 IllegalArgumentException);
+}
+
+TEST(CalypsoCardEmulatorTest, getSelectApplicationResponse_shouldInitializeCalypsoCard)
+{
+    setUp();
+
+    ASSERT_EQ(calypsoCard->getProductType(), CalypsoCard::ProductType::PRIME_REVISION_3);
+    ASSERT_EQ(calypsoCard->getDfName(), DF_NAME);
+    ASSERT_EQ(calypsoCard->getApplicationSerialNumber(), SERIAL_NUMBER);
+    ASSERT_TRUE(calypsoCard->isExtendedModeSupported());
+    ASSERT_TRUE(calypsoCard->isSvFeatureAvailable());
+    ASSERT_TRUE(calypsoCard->isPinFeatureAvailable());
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, processCommands_whenReadingRecords_shouldFillCardImage)
+{
+    setUp();
+
+    cardTransactionManager->prepareReadRecord(FILE7, 1);
+    cardTransactionManager->processCommands();
+
+    std::vector<uint8_t> expected = REC1;
+    expected.resize(29);
+    ASSERT_EQ(calypsoCard->getFileBySfi(FILE7)->getData()->getContent(1), expected);
+    ASSERT_EQ(emulator->getApduCount(), 1);
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, processCommands_whenUpdatingAndIncreasing_shouldModifyEmulatedFiles)
+{
+    setUp();
+
+    cardTransactionManager->prepareUpdateRecord(FILE7, 2, HexUtil::toByteArray("AABBCC"));
+    cardTransactionManager->prepareIncreaseCounter(FILE_COUNTERS, 2, 100);
+    cardTransactionManager->processCommands();
+
+    ASSERT_EQ(emulator->getContent(FILE7, 2)[0], 0xAA);
+    ASSERT_EQ(emulator->getContent(FILE_COUNTERS, 1),
+              HexUtil::toByteArray("000000000064000000"));
+    ASSERT_EQ(*calypsoCard->getFileBySfi(FILE_COUNTERS)->getData()->getContentAsCounterValue(2),
+              100);
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, processApdu_whenRecordDoesNotExist_shouldReturn6A83)
+{
+    setUp();
+
+    ASSERT_EQ(getStatusWord(emulator->processApdu(HexUtil::toByteArray("00B2043C00"))), 0x6A83);
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, closeSession_whenSignatureIsValid_shouldCommitModifications)
+{
+    setUp();
+
+    const int transactionCounter = emulator->getTransactionCounter();
+    const auto digest = openSession();
+    ASSERT_TRUE(emulator->isSessionOpen());
+    ASSERT_EQ(emulator->getTransactionCounter(), transactionCounter - 1);
+
+    processInSession(digest, HexUtil::toByteArray("00DC023C03AABBCC"));
+
+    const std::vector<uint8_t> response = closeSession(digest);
+    ASSERT_EQ(getStatusWord(response), 0x9000);
+    ASSERT_EQ(std::vector<uint8_t>(response.begin(), response.end() - 2),
+              digest->getCardSignature(8));
+    ASSERT_FALSE(emulator->isSessionOpen());
+    ASSERT_EQ(emulator->getContent(FILE7, 2)[0], 0xAA);
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, closeSession_whenSignatureIsBad_shouldReturn6988AndRollback)
+{
+    setUp();
+
+    openSession();
+    emulator->processApdu(HexUtil::toByteArray("00DC023C03AABBCC"));
+
+    const std::vector<uint8_t> response =
+        emulator->processApdu(HexUtil::toByteArray("008E0000080000000000000000"));
+
+    ASSERT_EQ(getStatusWord(response), 0x6988);
+    ASSERT_FALSE(emulator->isSessionOpen());
+    ASSERT_EQ(emulator->getContent(FILE7, 2)[0], 0x00);
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, closeSession_whenAborted_shouldRollback)
+{
+    setUp();
+
+    openSession();
+    emulator->processApdu(HexUtil::toByteArray("00DC023C03AABBCC"));
+    ASSERT_EQ(emulator->getContent(FILE7, 2)[0], 0xAA);
+
+    ASSERT_EQ(getStatusWord(emulator->processApdu(HexUtil::toByteArray("008E0000"))), 0x9000);
+    ASSERT_EQ(emulator->getContent(FILE7, 2)[0], 0x00);
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, processApdu_whenModificationsBufferIsFull_shouldReturn6400)
+{
+    setUp();
+
+    const auto digest = openSession();
+
+    std::vector<uint8_t> apdu = HexUtil::toByteArray("00DC023C1D");
+    apdu.resize(apdu.size() + 29);
+
+    int sw = 0x9000;
+    for (int i = 0; i < 20 && sw == 0x9000; i++) {
+        sw = getStatusWord(processInSession(digest, apdu));
+    }
+
+    ASSERT_EQ(sw, 0x6400);
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, svDebit_whenInsideSession_shouldPostponeTheSignature)
+{
+    setUp();
+
+    emulator->setSvBalance(50);
+    const auto digest = openSession();
+
+    ASSERT_EQ(getStatusWord(processInSession(digest, HexUtil::toByteArray("007C010900"))),
+              0x9000);
+
+    /* Amount -10, extended mode (25 bytes) */
+    std::vector<uint8_t> apdu = HexUtil::toByteArray("00BA000019");
+    apdu.resize(apdu.size() + 25);
+    apdu[6] = 0xFF;
+    apdu[7] = 0xF6;
+    ASSERT_EQ(getStatusWord(processInSession(digest, apdu)), 0x6200);
+
+    const std::vector<uint8_t> response = closeSession(digest);
+    ASSERT_EQ(getStatusWord(response), 0x9000);
+    ASSERT_EQ(response.size(), 1 + 6 + 8 + 2);
+    ASSERT_EQ(response[0], 7);
+    ASSERT_EQ(emulator->getSvBalance(), 40);
+    ASSERT_EQ(emulator->getSvTransactionNumber(), 1);
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, verifyPin_whenPinIsWrong_shouldDecrementAttemptCounter)
+{
+    setUp();
+
+    ASSERT_EQ(getStatusWord(emulator->processApdu(HexUtil::toByteArray("002000000431323334"))),
+              0x63C2);
+    ASSERT_EQ(emulator->getPinAttemptRemaining(), 2);
+    ASSERT_EQ(getStatusWord(emulator->processApdu(HexUtil::toByteArray("00200000"))), 0x63C2);
+    ASSERT_EQ(getStatusWord(emulator->processApdu(HexUtil::toByteArray("002000000430303030"))),
+              0x9000);
+    ASSERT_EQ(emulator->getPinAttemptRemaining(), 3);
+
+    tearDown();
+}
+
+TEST(CalypsoCardEmulatorTest, processCommands_benchmark_shouldReportApdusPerSecond)
+{
+    setUp();
+
+    static const int ITERATIONS = 10000;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        cardTransactionManager->prepareReadRecord(FILE7, 1);
+        cardTransactionManager->prepareIncreaseCounter(FILE_COUNTERS, 1, 1);
+        cardTransactionManager->processCommands();
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - start).count();
+    const long long apdusPerSecond = emulator->getApduCount() * 1000000LL /
+                                     (elapsed > 0 ? elapsed : 1);
+
+    RecordProperty("apdusPerSecond", std::to_string(apdusPerSecond));
+
+    ASSERT_EQ(emulator->getApduCount(), 2 * ITERATIONS);
+    ASSERT_EQ(*calypsoCard->getFileBySfi(FILE_COUNTERS)->getData()->getContentAsCounterValue(1),
+              ITERATIONS);
+
+    tearDown();
+}
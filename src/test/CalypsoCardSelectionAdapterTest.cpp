@@ -19,6 +19,10 @@
 /* Keyple Card Calypso */
 #include "CalypsoCardSelectionAdapter.h"
 #include "CalypsoExtensionService.h"
+#include "FileHeaderAdapter.h"
+
+/* Keyple Core Service */
+#include "ApduResponseAdapter.h"
 
 /* Keyple Core Util */
 #include "Arrays.h"
@@ -28,14 +32,24 @@
 /* Mock */
 #include "CardSelectionResponseApiMock.h"
 
+#include "CalypsoCardEmulator.h"
+
 using namespace testing;
 
 using namespace calypsonet::terminal::card::spi;
 using namespace keyple::card::calypso;
+using namespace keyple::core::service;
 using namespace keyple::core::util;
 using namespace keyple::core::util::cpp;
 using namespace keyple::core::util::cpp::exception;
 
+static const std::vector<uint8_t> DF_NAME = HexUtil::toByteArray("315449432E49434131");
+static const std::vector<uint8_t> CARD_SERIAL_NUMBER = HexUtil::toByteArray("0000000011223344");
+static const std::vector<uint8_t> STARTUP_INFO = HexUtil::toByteArray("0A3C2B05141001");
+static const std::string POWER_ON_DATA = "";
+static const uint8_t FILE7 = 0x07;
+static const uint8_t FILE8 = 0x08;
+
 static std::shared_ptr<CalypsoCardSelectionAdapter> cardSelection;
 
 static void setUp()
@@ -368,3 +382,127 @@ TEST(CalypsoCardSelectionAdapterTest, parse_whenCommandsResponsesMismatch_should
 
     tearDown();
 }
+
+/**
+ * Transmits the prepared commands to a card emulator and parses the selection response.
+ */
+static std::shared_ptr<CalypsoCardAdapter> selectCard(
+    const std::shared_ptr<CalypsoCardEmulator> cardEmulator)
+{
+    const std::shared_ptr<CardResponseApi> cardResponse =
+        cardEmulator->transmitCardRequest(
+            cardSelection->getCardSelectionRequest()->getCardRequest(),
+            ChannelControl::KEEP_OPEN);
+
+    auto cardSelectionResponseApi = std::make_shared<CardSelectionResponseApiMock>();
+    EXPECT_CALL(*cardSelectionResponseApi, getCardResponse()).WillRepeatedly(Return(cardResponse));
+    EXPECT_CALL(*cardSelectionResponseApi, getPowerOnData())
+        .WillRepeatedly(ReturnRef(POWER_ON_DATA));
+    EXPECT_CALL(*cardSelectionResponseApi, getSelectApplicationResponse())
+        .WillRepeatedly(Return(std::make_shared<ApduResponseAdapter>(
+                                   cardEmulator->getSelectApplicationResponse())));
+
+    return std::dynamic_pointer_cast<CalypsoCardAdapter>(
+               cardSelection->parse(cardSelectionResponseApi));
+}
+
+TEST(CalypsoCardSelectionAdapterTest, prepareReadRecords_whenRecordSizeIsTooLarge_shouldThrowIAE)
+{
+    setUp();
+
+    EXPECT_THROW(cardSelection->prepareReadRecords(FILE7, 1, 2, 127), IllegalArgumentException);
+
+    tearDown();
+}
+
+TEST(CalypsoCardSelectionAdapterTest,
+     prepareReadRecordsPartially_whenNbBytesToReadIsTooLarge_shouldThrowIAE)
+{
+    setUp();
+
+    EXPECT_THROW(cardSelection->prepareReadRecordsPartially(FILE7, 1, 2, 0, 127),
+                 IllegalArgumentException);
+
+    tearDown();
+}
+
+TEST(CalypsoCardSelectionAdapterTest,
+     prepareReadRecords_shouldSplitReadingAccordingToTheLowestPayloadCapacity)
+{
+    setUp();
+
+    cardSelection->prepareReadRecords(FILE7, 1, 6, 29);
+
+    const std::vector<std::shared_ptr<ApduRequestSpi>>& apduRequests =
+        cardSelection->getCardSelectionRequest()->getCardRequest()->getApduRequests();
+
+    ASSERT_EQ(apduRequests.size(), 2);
+    ASSERT_EQ(apduRequests[0]->getApdu(), HexUtil::toByteArray("00B2013D7C"));
+    ASSERT_EQ(apduRequests[1]->getApdu(), HexUtil::toByteArray("00B2053D3E"));
+
+    tearDown();
+}
+
+TEST(CalypsoCardSelectionAdapterTest, parse_whenReadingsArePrepared_shouldFillCardImage)
+{
+    setUp();
+
+    auto cardEmulator =
+        std::make_shared<CalypsoCardEmulator>(DF_NAME, CARD_SERIAL_NUMBER, STARTUP_INFO);
+    cardEmulator->addFile(FILE7,
+                          FileHeaderAdapter::builder()
+                              ->lid(0x2010)
+                              .recordsNumber(6)
+                              .recordSize(29)
+                              .type(ElementaryFile::Type::LINEAR)
+                              .accessConditions(HexUtil::toByteArray("1F101010"))
+                              .keyIndexes(HexUtil::toByteArray("01030303"))
+                              .build());
+    cardEmulator->addFile(FILE8,
+                          FileHeaderAdapter::builder()
+                              ->lid(0x2020)
+                              .recordsNumber(1)
+                              .recordSize(200)
+                              .type(ElementaryFile::Type::BINARY)
+                              .accessConditions(HexUtil::toByteArray("1F101010"))
+                              .keyIndexes(HexUtil::toByteArray("01030303"))
+                              .build());
+    for (uint8_t i = 1; i <= 6; i++) {
+        cardEmulator->setContent(FILE7, i, std::vector<uint8_t>(29, i));
+    }
+    cardEmulator->setContent(FILE8, 1, std::vector<uint8_t>(200, 0x55));
+    cardEmulator->setSvBalance(1000);
+
+    cardSelection->prepareReadRecords(FILE7, 1, 6, 29)
+                  .prepareReadRecordsPartially(FILE7, 1, 2, 28, 1)
+                  .prepareReadBinary(FILE8, 0, 200)
+                  .prepareSvGet(SvOperation::DEBIT);
+
+    const std::shared_ptr<CalypsoCardAdapter> calypsoCard = selectCard(cardEmulator);
+
+    const auto& records = calypsoCard->getFileBySfi(FILE7)->getData()->getAllRecordsContent();
+    ASSERT_EQ(records.size(), 6);
+    ASSERT_EQ(records.at(6), std::vector<uint8_t>(29, 6));
+    ASSERT_EQ(calypsoCard->getFileBySfi(FILE8)->getData()->getContent(),
+              std::vector<uint8_t>(200, 0x55));
+    ASSERT_EQ(calypsoCard->getSvBalance(), 1000);
+    ASSERT_NE(calypsoCard->getSvDebitLogLastRecord(), nullptr);
+
+    tearDown();
+}
+
+TEST(CalypsoCardSelectionAdapterTest, parse_whenFileIsNotFound_shouldIgnoreReadBinaryError)
+{
+    setUp();
+
+    auto cardEmulator =
+        std::make_shared<CalypsoCardEmulator>(DF_NAME, CARD_SERIAL_NUMBER, STARTUP_INFO);
+
+    cardSelection->prepareReadBinary(FILE8, 0, 10);
+
+    const std::shared_ptr<CalypsoCardAdapter> calypsoCard = selectCard(cardEmulator);
+
+    ASSERT_EQ(calypsoCard->getFileBySfi(FILE8), nullptr);
+
+    tearDown();
+}
@@ -0,0 +1,195 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Calypsonet Terminal Calypso */
+#include "WriteAccessLevel.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "CalypsoCardSnapshot.h"
+#include "DirectoryHeaderAdapter.h"
+#include "FileHeaderAdapter.h"
+#include "SvDebitLogRecordAdapter.h"
+#include "SvLoadLogRecordAdapter.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "IllegalArgumentException.h"
+
+/* Mock */
+#include "CardSelectionResponseAdapterMock.h"
+
+using namespace testing;
+
+using namespace calypsonet::terminal::calypso;
+using namespace keyple::card::calypso;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+static const std::string POWER_ON_DATA = "3B8F8001805A0A010320031112345678829000F7";
+static const std::vector<uint8_t> REC1 = HexUtil::toByteArray("1111111111");
+static const std::vector<uint8_t> REC2 = HexUtil::toByteArray("2222222222");
+static const std::vector<uint8_t> SV_LOAD_LOG =
+    HexUtil::toByteArray("0102030405060708090A0B0C0D0E0F101112131415161718");
+
+static std::shared_ptr<CalypsoCardAdapter> buildCalypsoCard()
+{
+    auto card = std::make_shared<CalypsoCardAdapter>();
+    card->initialize(std::make_shared<CardSelectionResponseAdapterMock>(POWER_ON_DATA));
+
+    card->setDirectoryHeader(
+        DirectoryHeaderAdapter::builder()
+            ->lid(0x2000)
+            .accessConditions(HexUtil::toByteArray("10100000"))
+            .keyIndexes(HexUtil::toByteArray("01030101"))
+            .dfStatus(0x00)
+            .kif(WriteAccessLevel::PERSONALIZATION, 0x21)
+            .kif(WriteAccessLevel::LOAD, 0x27)
+            .kif(WriteAccessLevel::DEBIT, 0x30)
+            .kvc(WriteAccessLevel::PERSONALIZATION, 0x79)
+            .kvc(WriteAccessLevel::LOAD, 0x7A)
+            .kvc(WriteAccessLevel::DEBIT, 0x7B)
+            .build());
+
+    card->setFileHeader(7,
+                        FileHeaderAdapter::builder()
+                            ->lid(0x2010)
+                            .recordsNumber(3)
+                            .recordSize(5)
+                            .type(ElementaryFile::Type::LINEAR)
+                            .accessConditions(HexUtil::toByteArray("1F101010"))
+                            .keyIndexes(HexUtil::toByteArray("01030303"))
+                            .sharedReference(0x3F02)
+                            .build());
+    card->setContent(7, 1, REC1);
+    card->setContent(7, 2, REC2);
+    card->setContent(8, 1, REC2);
+
+    card->setTransactionCounter(0x123456);
+    card->setDfRatified(true);
+    card->setSvData(0x7A,
+                    HexUtil::toByteArray("007C0700"),
+                    HexUtil::toByteArray("00112233"),
+                    1234,
+                    42,
+                    std::make_shared<SvLoadLogRecordAdapter>(SV_LOAD_LOG, 2),
+                    nullptr);
+
+    return card;
+}
+
+TEST(CalypsoCardSnapshotTest, constructor_whenDataIsNull_shouldThrowIAE)
+{
+    EXPECT_THROW(CalypsoCardSnapshot(nullptr, 0), IllegalArgumentException);
+}
+
+TEST(CalypsoCardSnapshotTest, constructor_whenMagicIsBad_shouldThrowIAE)
+{
+    std::vector<uint8_t> data = CalypsoCardSnapshot::write(buildCalypsoCard());
+    data[0] = 0x00;
+
+    EXPECT_THROW(CalypsoCardSnapshot(data.data(), data.size()), IllegalArgumentException);
+}
+
+TEST(CalypsoCardSnapshotTest, constructor_whenVersionIsUnknown_shouldThrowIAE)
+{
+    std::vector<uint8_t> data = CalypsoCardSnapshot::write(buildCalypsoCard());
+    data[4] = 0xFF;
+
+    EXPECT_THROW(CalypsoCardSnapshot(data.data(), data.size()), IllegalArgumentException);
+}
+
+TEST(CalypsoCardSnapshotTest, constructor_whenDataIsTruncated_shouldThrowIAE)
+{
+    const std::vector<uint8_t> data = CalypsoCardSnapshot::write(buildCalypsoCard());
+
+    EXPECT_THROW(CalypsoCardSnapshot(data.data(), data.size() - 1), IllegalArgumentException);
+}
+
+TEST(CalypsoCardSnapshotTest, getters_shouldReadValuesInPlace)
+{
+    const std::vector<uint8_t> data = CalypsoCardSnapshot::write(buildCalypsoCard());
+    const CalypsoCardSnapshot snapshot(data.data(), data.size());
+
+    ASSERT_EQ(snapshot.getVersion(), CalypsoCardSnapshot::VERSION);
+    ASSERT_EQ(snapshot.getSize(), data.size());
+    ASSERT_EQ(snapshot.getDfName().size(), 0);
+    ASSERT_EQ(snapshot.getCalypsoSerialNumberFull().toVector(),
+              HexUtil::toByteArray("0000000012345678"));
+    ASSERT_EQ(snapshot.getTransactionCounter(), Optional<int>(0x123456));
+    ASSERT_EQ(snapshot.getSvBalance(), Optional<int>(1234));
+    ASSERT_EQ(snapshot.getFileCount(), 2);
+
+    /* The record content is a view on the snapshot itself */
+    const CalypsoCardSnapshot::Bytes record = snapshot.getRecord(7, 2);
+    ASSERT_GE(record.data(), data.data());
+    ASSERT_LT(record.data(), data.data() + data.size());
+    ASSERT_EQ(record.toVector(), REC2);
+
+    ASSERT_EQ(snapshot.getRecord(7, 3).size(), 0);
+    ASSERT_EQ(snapshot.getRecord(9, 1).size(), 0);
+}
+
+TEST(CalypsoCardSnapshotTest, restore_shouldRebuildTheWholeCardImage)
+{
+    const auto card = buildCalypsoCard();
+    const std::vector<uint8_t> data = CalypsoCardSnapshot::write(card);
+    const auto restored = CalypsoCardSnapshot(data.data(), data.size()).restore();
+
+    ASSERT_EQ(restored->getPowerOnData(), card->getPowerOnData());
+    ASSERT_EQ(restored->getProductType(), card->getProductType());
+    ASSERT_EQ(restored->getCardClass(), card->getCardClass());
+    ASSERT_EQ(restored->getApplicationSerialNumber(), card->getApplicationSerialNumber());
+    ASSERT_EQ(restored->getStartupInfoRawData(), card->getStartupInfoRawData());
+    ASSERT_EQ(restored->getModificationsCounter(), card->getModificationsCounter());
+    ASSERT_EQ(restored->isModificationsCounterInBytes(), card->isModificationsCounterInBytes());
+    ASSERT_EQ(restored->isRatificationOnDeselectSupported(),
+              card->isRatificationOnDeselectSupported());
+    ASSERT_EQ(restored->getTransactionCounter(), 0x123456);
+    ASSERT_TRUE(restored->isDfRatified());
+
+    ASSERT_EQ(restored->getDirectoryHeader()->getLid(), 0x2000);
+    ASSERT_EQ(restored->getDirectoryHeader()->getKif(WriteAccessLevel::LOAD), 0x27);
+    ASSERT_EQ(restored->getDirectoryHeader()->getKvc(WriteAccessLevel::DEBIT), 0x7B);
+    ASSERT_EQ(restored->getDirectoryHeader()->getAccessConditions(),
+              HexUtil::toByteArray("10100000"));
+
+    const auto ef = restored->getFileBySfi(7);
+    ASSERT_EQ(ef->getHeader()->getLid(), 0x2010);
+    ASSERT_EQ(ef->getHeader()->getRecordsNumber(), 3);
+    ASSERT_EQ(ef->getHeader()->getEfType(), ElementaryFile::Type::LINEAR);
+    ASSERT_EQ(*ef->getHeader()->getSharedReference(), 0x3F02);
+    ASSERT_EQ(ef->getHeader()->getDfStatus(), nullptr);
+    ASSERT_EQ(ef->getData()->getContent(1), REC1);
+    ASSERT_EQ(ef->getData()->getContent(2), REC2);
+    ASSERT_EQ(restored->getFileBySfi(8)->getHeader(), nullptr);
+    ASSERT_EQ(restored->getFileBySfi(8)->getData()->getContent(1), REC2);
+
+    ASSERT_EQ(restored->getSvKvc(), 0x7A);
+    ASSERT_EQ(restored->getSvGetHeader(), HexUtil::toByteArray("007C0700"));
+    ASSERT_EQ(restored->getSvBalance(), 1234);
+    ASSERT_EQ(restored->getSvLastTNum(), 42);
+    ASSERT_EQ(restored->getSvLoadLogRecord()->getRawData(), SV_LOAD_LOG);
+    ASSERT_EQ(restored->getSvLoadLogRecord()->getAmount(),
+              card->getSvLoadLogRecord()->getAmount());
+}
+
+TEST(CalypsoCardSnapshotTest, write_whenRestoredCardIsWritten_shouldProduceSameSnapshot)
+{
+    const std::vector<uint8_t> data = CalypsoCardSnapshot::write(buildCalypsoCard());
+    const auto restored = CalypsoCardSnapshot(data.data(), data.size()).restore();
+
+    ASSERT_EQ(CalypsoCardSnapshot::write(restored), data);
+}
@@ -0,0 +1,148 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#include "CalypsoEmulatorFixture.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoExtensionService.h"
+#include "FileHeaderAdapter.h"
+
+/* Keyple Core Service */
+#include "ApduResponseAdapter.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+
+/* Mock */
+#include "CardSelectionResponseAdapterMock.h"
+
+using namespace keyple::core::service;
+using namespace keyple::core::util;
+
+const std::vector<uint8_t> CalypsoEmulatorFixture::DF_NAME =
+    HexUtil::toByteArray("315449432E49434131");
+const std::vector<uint8_t> CalypsoEmulatorFixture::CARD_SERIAL_NUMBER =
+    HexUtil::toByteArray("0000000011223344");
+const std::vector<uint8_t> CalypsoEmulatorFixture::STARTUP_INFO =
+    HexUtil::toByteArray("0A3C2B05141001");
+const std::vector<uint8_t> CalypsoEmulatorFixture::SAM_SERIAL_NUMBER =
+    HexUtil::toByteArray("C1C2C3C4");
+const uint8_t CalypsoEmulatorFixture::FILE7 = 0x07;
+const uint16_t CalypsoEmulatorFixture::FILE7_LID = 0x2010;
+const int CalypsoEmulatorFixture::FILE7_RECORDS_NUMBER = 3;
+const int CalypsoEmulatorFixture::FILE7_RECORD_SIZE = 29;
+
+CalypsoEmulatorFixture::CalypsoEmulatorFixture()
+: mCardEmulator(createCardEmulator(CARD_SERIAL_NUMBER)),
+  mSamEmulator(std::make_shared<CalypsoSamEmulator>(SAM_SERIAL_NUMBER)),
+  mCalypsoCard(createCalypsoCard(mCardEmulator)),
+  mCalypsoSam(createCalypsoSam(mSamEmulator)),
+  mCardSecuritySetting(CalypsoExtensionService::getInstance()->createCardSecuritySetting())
+{
+    mCardSecuritySetting->setControlSamResource(mSamEmulator, mCalypsoSam);
+}
+
+const std::shared_ptr<FileHeader> CalypsoEmulatorFixture::createFileHeader(
+    const uint16_t lid,
+    const int recordsNumber,
+    const int recordSize,
+    const ElementaryFile::Type type)
+{
+    return FileHeaderAdapter::builder()
+               ->lid(lid)
+                .recordsNumber(recordsNumber)
+                .recordSize(recordSize)
+                .type(type)
+                .accessConditions(HexUtil::toByteArray("1F101010"))
+                .keyIndexes(HexUtil::toByteArray("01030303"))
+                .build();
+}
+
+const std::shared_ptr<CalypsoCardEmulator> CalypsoEmulatorFixture::createCardEmulator(
+    const std::vector<uint8_t>& serialNumber)
+{
+    auto cardEmulator = std::make_shared<CalypsoCardEmulator>(DF_NAME, serialNumber, STARTUP_INFO);
+    cardEmulator->addFile(FILE7,
+                          createFileHeader(FILE7_LID,
+                                           FILE7_RECORDS_NUMBER,
+                                           FILE7_RECORD_SIZE,
+                                           ElementaryFile::Type::LINEAR));
+
+    return cardEmulator;
+}
+
+const std::shared_ptr<CalypsoCardAdapter> CalypsoEmulatorFixture::createCalypsoCard(
+    const std::shared_ptr<CalypsoCardEmulator> cardEmulator)
+{
+    auto calypsoCard = std::make_shared<CalypsoCardAdapter>();
+    calypsoCard->initialize(
+        std::make_shared<CardSelectionResponseAdapterMock>(
+            std::make_shared<ApduResponseAdapter>(cardEmulator->getSelectApplicationResponse())));
+
+    return calypsoCard;
+}
+
+const std::shared_ptr<CalypsoSamAdapter> CalypsoEmulatorFixture::createCalypsoSam(
+    const std::shared_ptr<CalypsoSamEmulator> samEmulator)
+{
+    return std::make_shared<CalypsoSamAdapter>(
+               std::make_shared<CardSelectionResponseAdapterMock>(samEmulator->getPowerOnData()));
+}
+
+const std::shared_ptr<CalypsoCardEmulator> CalypsoEmulatorFixture::getCardEmulator() const
+{
+    return mCardEmulator;
+}
+
+const std::shared_ptr<CalypsoSamEmulator> CalypsoEmulatorFixture::getSamEmulator() const
+{
+    return mSamEmulator;
+}
+
+const std::shared_ptr<CalypsoCardAdapter> CalypsoEmulatorFixture::getCalypsoCard() const
+{
+    return mCalypsoCard;
+}
+
+const std::shared_ptr<CalypsoSamAdapter> CalypsoEmulatorFixture::getCalypsoSam() const
+{
+    return mCalypsoSam;
+}
+
+const std::shared_ptr<CardSecuritySetting> CalypsoEmulatorFixture::getCardSecuritySetting() const
+{
+    return mCardSecuritySetting;
+}
+
+const std::shared_ptr<CalypsoCardAdapter> CalypsoEmulatorFixture::selectCard()
+{
+    mCalypsoCard = createCalypsoCard(mCardEmulator);
+
+    return mCalypsoCard;
+}
+
+const std::shared_ptr<CardTransactionManagerAdapter>
+    CalypsoEmulatorFixture::createCardTransaction() const
+{
+    return std::dynamic_pointer_cast<CardTransactionManagerAdapter>(
+               CalypsoExtensionService::getInstance()
+                   ->createCardTransaction(mCardEmulator, mCalypsoCard, mCardSecuritySetting));
+}
+
+const std::shared_ptr<CardTransactionManagerAdapter>
+    CalypsoEmulatorFixture::createCardTransactionWithoutSecurity() const
+{
+    return std::dynamic_pointer_cast<CardTransactionManagerAdapter>(
+               CalypsoExtensionService::getInstance()
+                   ->createCardTransactionWithoutSecurity(mCardEmulator, mCalypsoCard));
+}
@@ -0,0 +1,183 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* Calypsonet Terminal Calypso */
+#include "CardSecuritySetting.h"
+#include "ElementaryFile.h"
+#include "FileHeader.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "CalypsoSamAdapter.h"
+#include "CardTransactionManagerAdapter.h"
+
+#include "CalypsoCardEmulator.h"
+#include "CalypsoSamEmulator.h"
+
+using namespace calypsonet::terminal::calypso::card;
+using namespace calypsonet::terminal::calypso::transaction;
+using namespace keyple::card::calypso;
+
+/**
+ * Card and SAM emulators set up for the tests running complete transactions in memory.
+ *
+ * <p>The card contains the linear file FILE7 (LID 2010h, 3 records of 29 bytes), its image is
+ * initialized with the response to the application selection, and the card security setting uses
+ * the SAM emulator as control SAM.
+ *
+ * @since 2.2.5.6
+ */
+class CalypsoEmulatorFixture final {
+public:
+    static const std::vector<uint8_t> DF_NAME;
+    static const std::vector<uint8_t> CARD_SERIAL_NUMBER;
+    static const std::vector<uint8_t> STARTUP_INFO;
+    static const std::vector<uint8_t> SAM_SERIAL_NUMBER;
+    static const uint8_t FILE7;
+    static const uint16_t FILE7_LID;
+    static const int FILE7_RECORDS_NUMBER;
+    static const int FILE7_RECORD_SIZE;
+
+    /**
+     * Creates the emulators, the card and SAM images and the card security setting.
+     *
+     * @since 2.2.5.6
+     */
+    CalypsoEmulatorFixture();
+
+    /**
+     * Builds the header of an EF with the access conditions and key indexes used by all the
+     * emulated files.
+     *
+     * @param lid The LID.
+     * @param recordsNumber The number of records.
+     * @param recordSize The record size (the file size for a binary file).
+     * @param type The file type.
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    static const std::shared_ptr<FileHeader> createFileHeader(const uint16_t lid,
+                                                              const int recordsNumber,
+                                                              const int recordSize,
+                                                              const ElementaryFile::Type type);
+
+    /**
+     * Creates a card emulator containing FILE7.
+     *
+     * @param serialNumber The 8-byte application serial number.
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    static const std::shared_ptr<CalypsoCardEmulator> createCardEmulator(
+        const std::vector<uint8_t>& serialNumber);
+
+    /**
+     * Creates a card image initialized with the response of the emulator to the application
+     * selection.
+     *
+     * @param cardEmulator The card emulator.
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    static const std::shared_ptr<CalypsoCardAdapter> createCalypsoCard(
+        const std::shared_ptr<CalypsoCardEmulator> cardEmulator);
+
+    /**
+     * Creates a SAM image initialized with the power-on data of the emulator.
+     *
+     * @param samEmulator The SAM emulator.
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    static const std::shared_ptr<CalypsoSamAdapter> createCalypsoSam(
+        const std::shared_ptr<CalypsoSamEmulator> samEmulator);
+
+    /**
+     * @return The card emulator.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CalypsoCardEmulator> getCardEmulator() const;
+
+    /**
+     * @return The SAM emulator.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CalypsoSamEmulator> getSamEmulator() const;
+
+    /**
+     * @return The current card image.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CalypsoCardAdapter> getCalypsoCard() const;
+
+    /**
+     * @return The SAM image.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CalypsoSamAdapter> getCalypsoSam() const;
+
+    /**
+     * @return The card security setting, which can be completed by the test.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardSecuritySetting> getCardSecuritySetting() const;
+
+    /**
+     * Replaces the card image by a new one, as done by a new selection of the card.
+     *
+     * @return The new card image.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CalypsoCardAdapter> selectCard();
+
+    /**
+     * Creates a card transaction manager using the card security setting.
+     *
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardTransactionManagerAdapter> createCardTransaction() const;
+
+    /**
+     * Creates a card transaction manager without security setting.
+     *
+     * @return A not null reference.
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardTransactionManagerAdapter> createCardTransactionWithoutSecurity()
+        const;
+
+private:
+    /**
+     *
+     */
+    const std::shared_ptr<CalypsoCardEmulator> mCardEmulator;
+    const std::shared_ptr<CalypsoSamEmulator> mSamEmulator;
+
+    /**
+     *
+     */
+    std::shared_ptr<CalypsoCardAdapter> mCalypsoCard;
+    const std::shared_ptr<CalypsoSamAdapter> mCalypsoSam;
+
+    /**
+     *
+     */
+    const std::shared_ptr<CardSecuritySetting> mCardSecuritySetting;
+};
@@ -25,12 +25,15 @@
 #include "CalypsoExtensionService.h"
 #include "CalypsoSamSelectionMock.h"
 #include "CardSecuritySettingAdapter.h"
+#include "FileHeaderAdapter.h"
 
 /* Keyple Core Common */
 #include "CommonApiProperties.h"
 
 /* Keyple Core Util */
+#include "HexUtil.h"
 #include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
 
 /* Keyple Core Service */
 #include "CardSelectionResponseAdapter.h"
@@ -41,6 +44,9 @@
 #include "CardSelectionResponseApiMock.h"
 #include "ReaderMock.h"
 
+#include "CalypsoCardEmulator.h"
+#include "CalypsoSamEmulator.h"
+
 using namespace testing;
 
 using namespace calypsonet::terminal::card;
@@ -48,6 +54,7 @@ using namespace calypsonet::terminal::reader;
 using namespace keyple::card::calypso;
 using namespace keyple::core::common;
 using namespace keyple::core::service;
+using namespace keyple::core::util;
 using namespace keyple::core::util::cpp::exception;
 
 static const std::string POWER_ON_DATA = "3B8F8001805A0A010320031124B77FE7829000F7";
@@ -499,3 +506,149 @@ TEST(CalypsoExtensionServiceTest,
 
     tearDown();
 }
+
+/**
+ * Creates a card emulator holding FILE7 and a security setting using a SAM emulator.
+ */
+static std::shared_ptr<CalypsoCardEmulator> setUpTap(
+    std::shared_ptr<CalypsoSamEmulator>& samEmulator)
+{
+    auto cardEmulator =
+        std::make_shared<CalypsoCardEmulator>(HexUtil::toByteArray("315449432E49434131"),
+                                              HexUtil::toByteArray("0000000011223344"),
+                                              HexUtil::toByteArray("0A3C2B05141001"));
+    cardEmulator->addFile(0x07,
+                          FileHeaderAdapter::builder()
+                              ->lid(0x2010)
+                              .recordsNumber(3)
+                              .recordSize(29)
+                              .type(ElementaryFile::Type::LINEAR)
+                              .accessConditions(HexUtil::toByteArray("1F101010"))
+                              .keyIndexes(HexUtil::toByteArray("01030303"))
+                              .build());
+    cardEmulator->setContent(0x07, 1, HexUtil::toByteArray("0102030405"));
+    cardEmulator->setContent(0x07, 2, HexUtil::toByteArray("AABBCC"));
+
+    samEmulator = std::make_shared<CalypsoSamEmulator>(HexUtil::toByteArray("C1C2C3C4"));
+    cardSecuritySetting->setControlSamResource(
+        samEmulator,
+        std::make_shared<CalypsoSamAdapter>(
+            std::make_shared<CardSelectionResponseAdapterMock>(samEmulator->getPowerOnData())));
+
+    return cardEmulator;
+}
+
+TEST(CalypsoExtensionServiceTest, processTap_whenTemplateContainsWrites_shouldThrowIAE)
+{
+    setUp();
+
+    std::shared_ptr<CalypsoSamEmulator> samEmulator;
+    const auto cardEmulator = setUpTap(samEmulator);
+
+    CardTransactionTemplate readTemplate;
+    readTemplate.addReadRecords(0x07, 1, 2, 29).addUpdateRecord(0x07, 3);
+
+    EXPECT_THROW(service->processTap(cardEmulator,
+                                     service->createCardSelection(),
+                                     cardSecuritySetting,
+                                     readTemplate,
+                                     WriteAccessLevel::DEBIT),
+                 IllegalArgumentException);
+
+    tearDown();
+}
+
+TEST(CalypsoExtensionServiceTest, processTap_whenSelectionDoesNotFilterByDfName_shouldThrowISE)
+{
+    setUp();
+
+    std::shared_ptr<CalypsoSamEmulator> samEmulator;
+    const auto cardEmulator = setUpTap(samEmulator);
+
+    CardTransactionTemplate readTemplate;
+    readTemplate.addReadRecords(0x07, 1, 2, 29);
+
+    EXPECT_THROW(service->processTap(cardEmulator,
+                                     service->createCardSelection(),
+                                     cardSecuritySetting,
+                                     readTemplate,
+                                     WriteAccessLevel::DEBIT),
+                 IllegalStateException);
+
+    tearDown();
+}
+
+TEST(CalypsoExtensionServiceTest, processTap_whenDfNameDoesNotMatch_shouldThrowISE)
+{
+    setUp();
+
+    std::shared_ptr<CalypsoSamEmulator> samEmulator;
+    const auto cardEmulator = setUpTap(samEmulator);
+
+    CardTransactionTemplate readTemplate;
+    readTemplate.addReadRecords(0x07, 1, 2, 29);
+
+    auto cardSelection = service->createCardSelection();
+    cardSelection->filterByDfName("A000000291");
+
+    EXPECT_THROW(service->processTap(cardEmulator,
+                                     cardSelection,
+                                     cardSecuritySetting,
+                                     readTemplate,
+                                     WriteAccessLevel::DEBIT),
+                 IllegalStateException);
+
+    tearDown();
+}
+
+TEST(CalypsoExtensionServiceTest, processTap_shouldSelectAndOpenSessionInTwoExchanges)
+{
+    setUp();
+
+    std::shared_ptr<CalypsoSamEmulator> samEmulator;
+    const auto cardEmulator = setUpTap(samEmulator);
+    std::dynamic_pointer_cast<CardSecuritySettingAdapter>(cardSecuritySetting)
+        ->enableSamChallengePrefetch();
+
+    CardTransactionTemplate readTemplate;
+    readTemplate.addReadRecords(0x07, 1, 2, 29);
+
+    auto cardSelection = service->createCardSelection();
+    cardSelection->filterByDfName("315449432E494341");
+
+    /* First tap: the SAM challenge is fetched at the opening and prefetched at the closing */
+    auto tap = service->processTap(cardEmulator,
+                                   cardSelection,
+                                   cardSecuritySetting,
+                                   readTemplate,
+                                   WriteAccessLevel::DEBIT);
+
+    /* "Select Diversifier" and "Get Challenge" */
+    ASSERT_EQ(tap->getExchangeCount(), 2);
+    ASSERT_EQ(samEmulator->getApduCount(), 2);
+    ASSERT_TRUE(cardEmulator->isSessionOpen());
+    ASSERT_EQ(tap->getCalypsoCard()->getFileBySfi(0x07)->getData()->getContent(2)[0], 0xAA);
+
+    tap->getCardTransaction()->processClosing();
+
+    /* Second tap of the same card: the prefetched challenge is used, no SAM exchange */
+    const long samApduCount = samEmulator->getApduCount();
+
+    tap = service->processTap(cardEmulator,
+                              cardSelection,
+                              cardSecuritySetting,
+                              readTemplate,
+                              WriteAccessLevel::DEBIT);
+
+    ASSERT_EQ(tap->getExchangeCount(), 2);
+    ASSERT_EQ(samEmulator->getApduCount(), samApduCount);
+    ASSERT_EQ(tap->getCalypsoCard()->getFileBySfi(0x07)->getData()->getContent(1)[0], 0x01);
+
+    tap->getCardTransaction()->prepareUpdateRecord(0x07, 3, HexUtil::toByteArray("112233"))
+                              .processClosing();
+
+    ASSERT_FALSE(cardEmulator->isSessionOpen());
+    ASSERT_EQ(cardEmulator->getContent(0x07, 3)[0], 0x11);
+
+    tearDown();
+}
@@ -0,0 +1,568 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "CalypsoSamEmulator.h"
+
+#include <algorithm>
+
+/* Keyple Core Service */
+#include "ApduResponseAdapter.h"
+#include "CardResponseAdapter.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "IllegalArgumentException.h"
+
+using namespace keyple::core::service;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+static const uint8_t INS_SELECT_DIVERSIFIER = 0x14;
+static const uint8_t INS_GET_CHALLENGE = 0x84;
+static const uint8_t INS_GIVE_RANDOM = 0x86;
+static const uint8_t INS_DIGEST_INIT = 0x8A;
+static const uint8_t INS_DIGEST_UPDATE = 0x8C;
+static const uint8_t INS_DIGEST_CLOSE = 0x8E;
+static const uint8_t INS_DIGEST_AUTHENTICATE = 0x82;
+static const uint8_t INS_CARD_CIPHER_PIN = 0x12;
+static const uint8_t INS_SV_PREPARE_DEBIT = 0x54;
+static const uint8_t INS_SV_PREPARE_LOAD = 0x56;
+static const uint8_t INS_SV_PREPARE_UNDEBIT = 0x5C;
+static const uint8_t INS_SV_CHECK = 0x58;
+static const uint8_t INS_PSO = 0x2A;
+static const uint8_t INS_DATA_CIPHER = 0x1C;
+
+const int CalypsoSamEmulator::SW_OK = 0x9000;
+const int CalypsoSamEmulator::SW_WRONG_LENGTH = 0x6700;
+const int CalypsoSamEmulator::SW_ACCESS_FORBIDDEN = 0x6985;
+const int CalypsoSamEmulator::SW_SECURITY_DATA = 0x6988;
+const int CalypsoSamEmulator::SW_INCORRECT_DATA = 0x6A80;
+const int CalypsoSamEmulator::SW_WRONG_PARAMETERS = 0x6B00;
+const int CalypsoSamEmulator::SW_INS_NOT_SUPPORTED = 0x6D00;
+
+CalypsoSamEmulator::CalypsoSamEmulator(const std::vector<uint8_t>& serialNumber)
+: mName("CalypsoSamEmulator"),
+  mSerialNumber(serialNumber),
+  /* SAM C1 ATR, the serial number is at offset 12 */
+  mPowerOnData("3B3F9600805A4880C1205017" + HexUtil::toHex(serialNumber) + "829000"),
+  mRandom(0x87654321),
+  mApduCount(0),
+  mIsSessionExtended(false),
+  mTransactionNumber(0)
+{
+    if (serialNumber.size() != 4) {
+        throw IllegalArgumentException("Bad serial number length.");
+    }
+}
+
+const std::string& CalypsoSamEmulator::getPowerOnData() const
+{
+    return mPowerOnData;
+}
+
+void CalypsoSamEmulator::setCommandStatusWord(const uint8_t ins, const int statusWord)
+{
+    mCommandStatusWords[ins] = statusWord;
+}
+
+long CalypsoSamEmulator::getApduCount() const
+{
+    return mApduCount;
+}
+
+const std::string& CalypsoSamEmulator::getName() const
+{
+    return mName;
+}
+
+bool CalypsoSamEmulator::isContactless()
+{
+    return false;
+}
+
+bool CalypsoSamEmulator::isCardPresent()
+{
+    return true;
+}
+
+const std::shared_ptr<CardResponseApi> CalypsoSamEmulator::transmitCardRequest(
+    const std::shared_ptr<CardRequestSpi> cardRequest,
+    const ChannelControl channelControl)
+{
+    std::vector<std::shared_ptr<ApduResponseApi>> apduResponses;
+
+    for (const auto& apduRequest : cardRequest->getApduRequests()) {
+
+        const std::vector<uint8_t> response = processApdu(apduRequest->getApdu());
+        apduResponses.push_back(std::make_shared<ApduResponseAdapter>(response));
+
+        const int sw = (response[response.size() - 2] << 8) | response[response.size() - 1];
+        const std::vector<int>& successfulStatusWords = apduRequest->getSuccessfulStatusWords();
+
+        if (cardRequest->stopOnUnsuccessfulStatusWord() &&
+            std::find(successfulStatusWords.begin(), successfulStatusWords.end(), sw) ==
+                successfulStatusWords.end()) {
+            break;
+        }
+    }
+
+    if (channelControl == ChannelControl::CLOSE_AFTER) {
+        releaseChannel();
+    }
+
+    return std::make_shared<CardResponseAdapter>(apduResponses,
+                                                 channelControl == ChannelControl::KEEP_OPEN);
+}
+
+void CalypsoSamEmulator::releaseChannel()
+{
+    /* Nothing to do, the SAM keeps its state as a real SAM in its slot */
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processApdu(const std::vector<uint8_t>& apdu)
+{
+    mApduCount++;
+
+    if (apdu.size() < 4) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    std::vector<uint8_t> data;
+    int le = -1;
+
+    if (apdu.size() == 5) {
+
+        /* Case 2 */
+        le = apdu[4];
+
+    } else if (apdu.size() > 5) {
+
+        /* Case 3 or 4 */
+        const size_t lc = apdu[4];
+        if (apdu.size() != 5 + lc && apdu.size() != 6 + lc) {
+            return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+        }
+
+        data.assign(apdu.begin() + 5, apdu.begin() + 5 + lc);
+        le = apdu.size() == 6 + lc ? apdu[5 + lc] : -1;
+    }
+
+    const auto it = mCommandStatusWords.find(apdu[1]);
+    if (it != mCommandStatusWords.end()) {
+        return buildResponse(std::vector<uint8_t>(), it->second);
+    }
+
+    return processCommand(apdu[1], apdu[2], apdu[3], data, le);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::buildResponse(const std::vector<uint8_t>& data,
+                                                             const int sw)
+{
+    std::vector<uint8_t> response;
+    response.reserve(data.size() + 2);
+    response.insert(response.end(), data.begin(), data.end());
+    response.push_back(static_cast<uint8_t>(sw >> 8));
+    response.push_back(static_cast<uint8_t>(sw));
+
+    return response;
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::computeSignature(const uint8_t kif,
+                                                                const uint8_t kvc,
+                                                                const std::vector<uint8_t>& data,
+                                                                const int length)
+{
+    CalypsoCardEmulator::SessionDigest digest(CalypsoCardEmulator::getKey(kif, kvc));
+    digest.update(data);
+
+    std::vector<uint8_t> signature = digest.getTerminalSignature(8);
+    const std::vector<uint8_t> signatureLo = digest.getCardSignature(8);
+    signature.insert(signature.end(), signatureLo.begin(), signatureLo.end());
+    signature.resize(length);
+
+    return signature;
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::nextRandom(const int length)
+{
+    std::vector<uint8_t> random(length);
+    for (auto& b : random) {
+
+        /* xorshift32 */
+        mRandom ^= mRandom << 13;
+        mRandom ^= mRandom >> 17;
+        mRandom ^= mRandom << 5;
+        b = static_cast<uint8_t>(mRandom);
+    }
+
+    return random;
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processCommand(const uint8_t ins,
+                                                              const uint8_t p1,
+                                                              const uint8_t p2,
+                                                              const std::vector<uint8_t>& data,
+                                                              const int le)
+{
+    switch (ins) {
+    case INS_SELECT_DIVERSIFIER:
+        return processSelectDiversifier(data);
+    case INS_GET_CHALLENGE:
+        return processGetChallenge(le);
+    case INS_GIVE_RANDOM:
+        return processGiveRandom(data);
+    case INS_DIGEST_INIT:
+        return processDigestInit(p1, data);
+    case INS_DIGEST_UPDATE:
+        return processDigestUpdate(p1, data);
+    case INS_DIGEST_CLOSE:
+        return processDigestClose();
+    case INS_DIGEST_AUTHENTICATE:
+        return processDigestAuthenticate(data);
+    case INS_CARD_CIPHER_PIN:
+        return processCardCipherPin(p1, data);
+    case INS_SV_PREPARE_LOAD:
+    case INS_SV_PREPARE_DEBIT:
+    case INS_SV_PREPARE_UNDEBIT:
+        return processSvPrepare(ins, data);
+    case INS_SV_CHECK:
+        return processSvCheck(data);
+    case INS_PSO:
+        return processPsoSignature(p1, p2, data);
+    case INS_DATA_CIPHER:
+        return processDataCipher(p1, data);
+    default:
+        return buildResponse(std::vector<uint8_t>(), SW_INS_NOT_SUPPORTED);
+    }
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processSelectDiversifier(
+    const std::vector<uint8_t>& data)
+{
+    if (data.size() != 4 && data.size() != 8) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    mDiversifier = data;
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processGetChallenge(const int le)
+{
+    if (le != 4 && le != 8) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    mChallenge = nextRandom(le);
+
+    return buildResponse(mChallenge, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processGiveRandom(const std::vector<uint8_t>& data)
+{
+    if (data.size() != 8) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    mCardChallenge = data;
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processDigestInit(const uint8_t p1,
+                                                                 const std::vector<uint8_t>& data)
+{
+    if (data.size() < 3) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    /* The challenge is the one of the previous Get Challenge */
+    if (mChallenge.empty()) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    /* Data in: KIF KVC open secure session data out */
+    mSessionDigest.reset(
+        new CalypsoCardEmulator::SessionDigest(CalypsoCardEmulator::getKey(data[0], data[1])));
+    mSessionDigest->update(mChallenge);
+    mSessionDigest->update(std::vector<uint8_t>(data.begin() + 2, data.end()));
+    mIsSessionExtended = (p1 & 0x02) != 0;
+    mExpectedCardSignature.clear();
+    mChallenge.clear();
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processDigestUpdate(
+    const uint8_t p1,
+    const std::vector<uint8_t>& data)
+{
+    if (mSessionDigest == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    if (p1 != 0x80) {
+        mSessionDigest->update(data);
+        return buildResponse(std::vector<uint8_t>(), SW_OK);
+    }
+
+    /* Digest Update Multiple: [length][data]... */
+    size_t i = 0;
+    while (i < data.size()) {
+
+        const size_t length = data[i++];
+        if (length == 0 || i + length > data.size()) {
+            return buildResponse(std::vector<uint8_t>(), SW_INCORRECT_DATA);
+        }
+
+        mSessionDigest->update(std::vector<uint8_t>(data.begin() + i, data.begin() + i + length));
+        i += length;
+    }
+
+    return buildResponse(std::vector<uint8_t>(), SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processDigestClose()
+{
+    if (mSessionDigest == nullptr) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    const int signatureLength = mIsSessionExtended ? 8 : 4;
+    const std::vector<uint8_t> signature = mSessionDigest->getTerminalSignature(signatureLength);
+    mExpectedCardSignature = mSessionDigest->getCardSignature(signatureLength);
+    mSessionDigest.reset();
+
+    return buildResponse(signature, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processDigestAuthenticate(
+    const std::vector<uint8_t>& data)
+{
+    if (mExpectedCardSignature.empty()) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    const bool isValid = data == mExpectedCardSignature;
+    mExpectedCardSignature.clear();
+
+    return buildResponse(std::vector<uint8_t>(), isValid ? SW_OK : SW_SECURITY_DATA);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processCardCipherPin(
+    const uint8_t p1,
+    const std::vector<uint8_t>& data)
+{
+    /* P1 = 80h: PIN verification, 40h: PIN modification (Card Generate Key is not supported) */
+    if (p1 != 0x80 && p1 != 0x40) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    if (data.size() != (p1 == 0x80 ? 6u : 10u)) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    if (mCardChallenge.empty()) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    /* Verification: current PIN + padding (8), modification: current + new PIN + padding (16) */
+    std::vector<uint8_t> plain(data.begin() + 2, data.end());
+    plain.resize(p1 == 0x80 ? 8 : 16);
+
+    const std::vector<uint8_t> ciphered =
+        CalypsoCardEmulator::cipherPinData(data[0], data[1], mCardChallenge, plain);
+    mCardChallenge.clear();
+
+    return buildResponse(ciphered, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processSvPrepare(const uint8_t ins,
+                                                                const std::vector<uint8_t>& data)
+{
+    /*
+     * Data in: SV Get header (4) + SV Get data + SV command data, made of the instruction byte,
+     * P1 P2 (ignored), Lc and the fixed part of the card data in (11 bytes for a reload, 8 bytes
+     * for a debit or undebit)
+     */
+    const bool isLoad = ins == INS_SV_PREPARE_LOAD;
+    const size_t commandDataLength = isLoad ? 15 : 12;
+    if (data.size() < 4 + commandDataLength) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    const std::vector<uint8_t> commandData(data.end() - commandDataLength, data.end());
+    const size_t cardDataLength = commandData[3];
+    const size_t fixedPartLength = commandDataLength - 4;
+    const size_t signatureHiLength = cardDataLength - fixedPartLength - 7;
+
+    if (signatureHiLength != 5 && signatureHiLength != 10) {
+        return buildResponse(std::vector<uint8_t>(), SW_INCORRECT_DATA);
+    }
+
+    /* Rebuild the card data in, as it will be sent by the terminal to the card */
+    std::vector<uint8_t> cardData(cardDataLength);
+    const std::vector<uint8_t> random = nextRandom(3);
+    cardData[0] = random[2];
+    std::copy(commandData.begin() + 5, commandData.end(), cardData.begin() + 1);
+
+    mTransactionNumber++;
+    std::copy(mSerialNumber.begin(), mSerialNumber.end(), cardData.begin() + fixedPartLength);
+    cardData[fixedPartLength + 4] = static_cast<uint8_t>(mTransactionNumber >> 16);
+    cardData[fixedPartLength + 5] = static_cast<uint8_t>(mTransactionNumber >> 8);
+    cardData[fixedPartLength + 6] = static_cast<uint8_t>(mTransactionNumber);
+
+    /* The SV KVC is at offset 4 (reload) or 7 (debit/undebit) of the card data */
+    const uint8_t svKvc = cardData[isLoad ? 4 : 7];
+    const std::vector<uint8_t> signatureHi =
+        computeSignature(0x00,
+                         svKvc,
+                         std::vector<uint8_t>(cardData.begin(),
+                                              cardData.begin() + fixedPartLength + 7),
+                         static_cast<int>(signatureHiLength));
+    std::copy(signatureHi.begin(), signatureHi.end(), cardData.begin() + fixedPartLength + 7);
+
+    /* Signature expected from the card, checked by SV Check */
+    CalypsoCardEmulator::SessionDigest digest(CalypsoCardEmulator::getKey(0x00, svKvc));
+    digest.update(cardData);
+    mExpectedSvSignature = digest.getCardSignature(signatureHiLength == 10 ? 6 : 3);
+
+    /* Data out: SAM ID (4) P1 P2 data in [0] SAM TNum (3) signatureHi (5 or 10) */
+    std::vector<uint8_t> response(mSerialNumber);
+    response.push_back(random[0]);
+    response.push_back(random[1]);
+    response.push_back(cardData[0]);
+    response.insert(response.end(),
+                    cardData.begin() + fixedPartLength + 4,
+                    cardData.begin() + fixedPartLength + 7);
+    response.insert(response.end(), signatureHi.begin(), signatureHi.end());
+
+    return buildResponse(response, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processSvCheck(const std::vector<uint8_t>& data)
+{
+    if (mExpectedSvSignature.empty()) {
+        return buildResponse(std::vector<uint8_t>(), SW_ACCESS_FORBIDDEN);
+    }
+
+    const std::vector<uint8_t> expectedSignature = mExpectedSvSignature;
+    mExpectedSvSignature.clear();
+
+    /* A single byte aborts the SV operation */
+    if (data.size() == 1) {
+        return buildResponse(std::vector<uint8_t>(), SW_OK);
+    }
+
+    return buildResponse(std::vector<uint8_t>(),
+                         data == expectedSignature ? SW_OK : SW_SECURITY_DATA);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processPsoSignature(
+    const uint8_t p1,
+    const uint8_t p2,
+    const std::vector<uint8_t>& data)
+{
+    /* P1P2 = 9E9Ah: compute, 00A8h: verify */
+    const bool isCompute = p1 == 0x9E && p2 == 0x9A;
+    if (!isCompute && !(p1 == 0x00 && p2 == 0xA8)) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    if (data.size() < 4 || data[0] != 0xFF) {
+        return buildResponse(std::vector<uint8_t>(), SW_INCORRECT_DATA);
+    }
+
+    /* OpMode: traceability (bits 6-5), signature size (bits 3-0) */
+    const uint8_t opMode = data[3];
+    const bool isTraceabilityMode = (opMode & 0x40) != 0;
+    const bool isPartialSerialNumber = (opMode & 0x20) == 0;
+    const size_t signatureSize = opMode & 0x0F;
+    const size_t messageOffset = isTraceabilityMode ? 6 : 4;
+
+    if (signatureSize < 1 || signatureSize > 8 ||
+        data.size() <= messageOffset + (isCompute ? 0 : signatureSize)) {
+        return buildResponse(std::vector<uint8_t>(), SW_INCORRECT_DATA);
+    }
+
+    std::vector<uint8_t> message(data.begin() + messageOffset,
+                                 data.end() - (isCompute ? 0 : signatureSize));
+
+    /* Insert the SAM serial number (3 or 4 bytes) and a 3-byte counter at the given bit offset */
+    if (isTraceabilityMode && isCompute) {
+
+        std::vector<uint8_t> traceabilityData(mSerialNumber.begin() +
+                                                  (isPartialSerialNumber ? 1 : 0),
+                                              mSerialNumber.end());
+        mTransactionNumber++;
+        traceabilityData.push_back(static_cast<uint8_t>(mTransactionNumber >> 16));
+        traceabilityData.push_back(static_cast<uint8_t>(mTransactionNumber >> 8));
+        traceabilityData.push_back(static_cast<uint8_t>(mTransactionNumber));
+
+        const size_t bitOffset = (data[4] << 8) | data[5];
+        if (bitOffset + traceabilityData.size() * 8 > message.size() * 8) {
+            return buildResponse(std::vector<uint8_t>(), SW_INCORRECT_DATA);
+        }
+
+        for (size_t i = 0; i < traceabilityData.size() * 8; i++) {
+
+            const size_t bit = bitOffset + i;
+            const uint8_t mask = static_cast<uint8_t>(0x80 >> (bit % 8));
+            if ((traceabilityData[i / 8] & (0x80 >> (i % 8))) != 0) {
+                message[bit / 8] |= mask;
+            } else {
+                message[bit / 8] &= static_cast<uint8_t>(~mask);
+            }
+        }
+    }
+
+    const std::vector<uint8_t> signature =
+        computeSignature(data[1], data[2], message, static_cast<int>(signatureSize));
+
+    if (!isCompute) {
+        return buildResponse(std::vector<uint8_t>(),
+                             std::equal(signature.begin(), signature.end(),
+                                        data.end() - signatureSize) ?
+                                 SW_OK :
+                                 SW_SECURITY_DATA);
+    }
+
+    /* Data out: [signed data (traceability mode only)] signature */
+    std::vector<uint8_t> response;
+    if (isTraceabilityMode) {
+        response = message;
+    }
+
+    response.insert(response.end(), signature.begin(), signature.end());
+
+    return buildResponse(response, SW_OK);
+}
+
+const std::vector<uint8_t> CalypsoSamEmulator::processDataCipher(const uint8_t p1,
+                                                                 const std::vector<uint8_t>& data)
+{
+    /* Only the signature computation mode is used by the library */
+    if (p1 != 0x40) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_PARAMETERS);
+    }
+
+    if (data.size() < 3) {
+        return buildResponse(std::vector<uint8_t>(), SW_WRONG_LENGTH);
+    }
+
+    return buildResponse(computeSignature(data[0],
+                                          data[1],
+                                          std::vector<uint8_t>(data.begin() + 2, data.end()),
+                                          8),
+                         SW_OK);
+}
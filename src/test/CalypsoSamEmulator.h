@@ -0,0 +1,216 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Calypsonet Terminal Card */
+#include "ProxyReaderApi.h"
+
+/* Calypsonet Terminal Reader */
+#include "CardReader.h"
+
+#include "CalypsoCardEmulator.h"
+
+using namespace calypsonet::terminal::card;
+using namespace calypsonet::terminal::card::spi;
+using namespace calypsonet::terminal::reader;
+
+/**
+ * Software control SAM (C1), plugged in as a reader.
+ *
+ * <p>The emulator answers the SAM commands issued by the library with the test keys of
+ * {@link CalypsoCardEmulator::getKey}, so that it can be paired with a {@link CalypsoCardEmulator}
+ * to run complete secure transactions in memory:
+ * <ul>
+ *   <li>Select Diversifier, Get Challenge, Give Random,
+ *   <li>Digest Init, Digest Update, Digest Update Multiple, Digest Close, Digest Authenticate,
+ *   <li>Card Cipher PIN,
+ *   <li>SV Prepare Load, SV Prepare Debit, SV Prepare Undebit, SV Check,
+ *   <li>PSO Compute Signature, PSO Verify Signature, Data Cipher (signature computation).
+ * </ul>
+ *
+ * <p>The signatures are computed with {@link CalypsoCardEmulator::SessionDigest}: they are NOT
+ * cryptographic. Event counters, ceilings and key parameters are not emulated.
+ *
+ * @since 2.2.5.6
+ */
+class CalypsoSamEmulator final : public CardReader, public ProxyReaderApi {
+public:
+    /**
+     * Creates a SAM C1.
+     *
+     * @param serialNumber The 4-byte serial number.
+     * @since 2.2.5.6
+     */
+    explicit CalypsoSamEmulator(const std::vector<uint8_t>& serialNumber);
+
+    /**
+     * Returns the power-on data (ATR) of the SAM, to be provided to the SAM selection.
+     *
+     * @return A not empty hex string.
+     * @since 2.2.5.6
+     */
+    const std::string& getPowerOnData() const;
+
+    /**
+     * Makes the SAM reject all the next commands having the provided instruction byte.
+     *
+     * @param ins The instruction byte.
+     * @param statusWord The status word returned instead of processing the command.
+     * @since 2.2.5.6
+     */
+    void setCommandStatusWord(const uint8_t ins, const int statusWord);
+
+    /**
+     * Returns the number of C-APDUs processed since the creation of the SAM.
+     *
+     * @since 2.2.5.6
+     */
+    long getApduCount() const;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    const std::string& getName() const override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    bool isContactless() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    bool isCardPresent() override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    const std::shared_ptr<CardResponseApi> transmitCardRequest(
+        const std::shared_ptr<CardRequestSpi> cardRequest,
+        const ChannelControl channelControl) override;
+
+    /**
+     * {@inheritDoc}
+     *
+     * @since 2.2.5.6
+     */
+    void releaseChannel() override;
+
+    /**
+     * Processes a single C-APDU.
+     *
+     * @param apdu The C-APDU.
+     * @return The R-APDU (data followed by the status word).
+     * @since 2.2.5.6
+     */
+    const std::vector<uint8_t> processApdu(const std::vector<uint8_t>& apdu);
+
+private:
+    /**
+     *
+     */
+    static const int SW_OK;
+    static const int SW_WRONG_LENGTH;
+    static const int SW_ACCESS_FORBIDDEN;
+    static const int SW_SECURITY_DATA;
+    static const int SW_INCORRECT_DATA;
+    static const int SW_WRONG_PARAMETERS;
+    static const int SW_INS_NOT_SUPPORTED;
+
+    /**
+     *
+     */
+    const std::string mName;
+    const std::vector<uint8_t> mSerialNumber;
+    const std::string mPowerOnData;
+    uint32_t mRandom;
+    long mApduCount;
+
+    /**
+     * Status words forced by instruction byte.
+     */
+    std::map<uint8_t, int> mCommandStatusWords;
+
+    /**
+     * Data provided by the previous commands.
+     */
+    std::vector<uint8_t> mDiversifier;
+    std::vector<uint8_t> mChallenge;
+    std::vector<uint8_t> mCardChallenge;
+
+    /**
+     * Session digest (null when no digest is in progress) and card signature expected by Digest
+     * Authenticate (empty when none is expected).
+     */
+    std::unique_ptr<CalypsoCardEmulator::SessionDigest> mSessionDigest;
+    bool mIsSessionExtended;
+    std::vector<uint8_t> mExpectedCardSignature;
+
+    /**
+     * SAM transaction number, incremented by the SV operations and the traceable signatures.
+     */
+    int mTransactionNumber;
+
+    /**
+     * Card signature expected by SV Check (empty when no SV operation is in progress).
+     */
+    std::vector<uint8_t> mExpectedSvSignature;
+
+    /**
+     *
+     */
+    static const std::vector<uint8_t> buildResponse(const std::vector<uint8_t>& data, const int sw);
+    static const std::vector<uint8_t> computeSignature(const uint8_t kif,
+                                                       const uint8_t kvc,
+                                                       const std::vector<uint8_t>& data,
+                                                       const int length);
+    const std::vector<uint8_t> nextRandom(const int length);
+    const std::vector<uint8_t> processCommand(const uint8_t ins,
+                                              const uint8_t p1,
+                                              const uint8_t p2,
+                                              const std::vector<uint8_t>& data,
+                                              const int le);
+    const std::vector<uint8_t> processSelectDiversifier(const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> processGetChallenge(const int le);
+    const std::vector<uint8_t> processGiveRandom(const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> processDigestInit(const uint8_t p1,
+                                                 const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> processDigestUpdate(const uint8_t p1,
+                                                   const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> processDigestClose();
+    const std::vector<uint8_t> processDigestAuthenticate(const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> processCardCipherPin(const uint8_t p1,
+                                                    const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> processSvPrepare(const uint8_t ins,
+                                                const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> processSvCheck(const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> processPsoSignature(const uint8_t p1,
+                                                   const uint8_t p2,
+                                                   const std::vector<uint8_t>& data);
+    const std::vector<uint8_t> processDataCipher(const uint8_t p1,
+                                                 const std::vector<uint8_t>& data);
+};
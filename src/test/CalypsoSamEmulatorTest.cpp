@@ -0,0 +1,209 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include <chrono>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Calypsonet Terminal Calypso */
+#include "CardTransactionManager.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "CalypsoSamAdapter.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "IllegalArgumentException.h"
+
+#include "CalypsoEmulatorFixture.h"
+
+using namespace testing;
+
+using namespace calypsonet::terminal::calypso::transaction;
+using namespace keyple::card::calypso;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+static const std::vector<uint8_t> SAM_SERIAL_NUMBER = CalypsoEmulatorFixture::SAM_SERIAL_NUMBER;
+static const uint8_t FILE7 = CalypsoEmulatorFixture::FILE7;
+
+static std::shared_ptr<CalypsoEmulatorFixture> emulators;
+static std::shared_ptr<CalypsoCardEmulator> cardEmulator;
+static std::shared_ptr<CalypsoSamEmulator> samEmulator;
+static std::shared_ptr<CalypsoCardAdapter> calypsoCard;
+static std::shared_ptr<CalypsoSamAdapter> calypsoSam;
+static std::shared_ptr<CardSecuritySetting> cardSecuritySetting;
+static std::shared_ptr<CardTransactionManager> cardTransactionManager;
+
+static void setUp()
+{
+    emulators = std::make_shared<CalypsoEmulatorFixture>();
+
+    cardEmulator = emulators->getCardEmulator();
+    samEmulator = emulators->getSamEmulator();
+    calypsoCard = emulators->getCalypsoCard();
+    calypsoSam = emulators->getCalypsoSam();
+
+    cardSecuritySetting = emulators->getCardSecuritySetting();
+    cardSecuritySetting->setPinVerificationCipheringKey(0x30, 0x79);
+
+    cardTransactionManager = emulators->createCardTransaction();
+}
+
+static void tearDown()
+{
+    cardTransactionManager.reset();
+    cardSecuritySetting.reset();
+    calypsoSam.reset();
+    calypsoCard.reset();
+    samEmulator.reset();
+    cardEmulator.reset();
+    emulators.reset();
+}
+
+static int getStatusWord(const std::vector<uint8_t>& response)
+{
+    return (response[response.size() - 2] << 8) | response[response.size() - 1];
+}
+
+TEST(CalypsoSamEmulatorTest, constructor_whenSerialNumberIsBad_shouldThrowIAE)
+{
+    EXPECT_THROW(CalypsoSamEmulator(HexUtil::toByteArray("C1C2")), IllegalArgumentException);
+}
+
+TEST(CalypsoSamEmulatorTest, getPowerOnData_shouldInitializeCalypsoSam)
+{
+    setUp();
+
+    ASSERT_EQ(calypsoSam->getProductType(), CalypsoSam::ProductType::SAM_C1);
+    ASSERT_EQ(calypsoSam->getSerialNumber(), SAM_SERIAL_NUMBER);
+
+    tearDown();
+}
+
+TEST(CalypsoSamEmulatorTest, processClosing_whenSessionIsValid_shouldCommitModifications)
+{
+    setUp();
+
+    cardTransactionManager->processOpening(WriteAccessLevel::DEBIT);
+    ASSERT_TRUE(cardEmulator->isSessionOpen());
+
+    cardTransactionManager->prepareUpdateRecord(FILE7, 2, HexUtil::toByteArray("AABBCC"));
+    cardTransactionManager->processClosing();
+
+    ASSERT_FALSE(cardEmulator->isSessionOpen());
+    ASSERT_EQ(cardEmulator->getContent(FILE7, 2)[0], 0xAA);
+
+    tearDown();
+}
+
+TEST(CalypsoSamEmulatorTest, digestAuthenticate_whenCardSignatureIsBad_shouldReturn6988)
+{
+    setUp();
+
+    ASSERT_EQ(getStatusWord(samEmulator->processApdu(HexUtil::toByteArray("8084000008"))),
+              0x9000);
+    ASSERT_EQ(getStatusWord(samEmulator->processApdu(
+                  HexUtil::toByteArray("808A02FF053079000000"))),
+              0x9000);
+    ASSERT_EQ(getStatusWord(samEmulator->processApdu(HexUtil::toByteArray("808E000008"))),
+              0x9000);
+    ASSERT_EQ(getStatusWord(samEmulator->processApdu(
+                  HexUtil::toByteArray("80820000080000000000000000"))),
+              0x6988);
+
+    /* The expected signature is consumed */
+    ASSERT_EQ(getStatusWord(samEmulator->processApdu(
+                  HexUtil::toByteArray("80820000080000000000000000"))),
+              0x6985);
+
+    tearDown();
+}
+
+TEST(CalypsoSamEmulatorTest, processCommands_whenSvDebit_shouldCheckCardSignature)
+{
+    setUp();
+
+    cardEmulator->setSvBalance(50);
+
+    cardTransactionManager->prepareSvGet(SvOperation::DEBIT, SvAction::DO);
+    cardTransactionManager->processCommands();
+    cardTransactionManager->prepareSvDebit(10);
+    cardTransactionManager->processCommands();
+
+    ASSERT_EQ(cardEmulator->getSvBalance(), 40);
+
+    tearDown();
+}
+
+TEST(CalypsoSamEmulatorTest, processVerifyPin_whenPinIsCiphered_shouldBeAcceptedByTheCard)
+{
+    setUp();
+
+    cardTransactionManager->processVerifyPin(HexUtil::toByteArray("30303030"));
+
+    ASSERT_EQ(cardEmulator->getPinAttemptRemaining(), 3);
+    ASSERT_EQ(calypsoCard->getPinAttemptRemaining(), 3);
+
+    tearDown();
+}
+
+TEST(CalypsoSamEmulatorTest, psoVerifySignature_whenSignatureIsComputedBySam_shouldReturn9000)
+{
+    setUp();
+
+    /* Traceability mode, full serial number, 8-byte signature, traceability data at offset 8 */
+    std::vector<uint8_t> response =
+        samEmulator->processApdu(
+            HexUtil::toByteArray("802A9E9A14FF2A79680008000000000000000000000000000000"));
+    ASSERT_EQ(getStatusWord(response), 0x9000);
+    ASSERT_EQ(response.size(), 14 + 8 + 2);
+    ASSERT_EQ(std::vector<uint8_t>(response.begin() + 1, response.begin() + 5), SAM_SERIAL_NUMBER);
+
+    std::vector<uint8_t> apdu = HexUtil::toByteArray("802A00A81CFF2A79680008");
+    apdu.insert(apdu.end(), response.begin(), response.end() - 2);
+    ASSERT_EQ(getStatusWord(samEmulator->processApdu(apdu)), 0x9000);
+
+    apdu[apdu.size() - 1] ^= 0x01;
+    ASSERT_EQ(getStatusWord(samEmulator->processApdu(apdu)), 0x6988);
+
+    tearDown();
+}
+
+TEST(CalypsoSamEmulatorTest, processClosing_benchmark_shouldReportSessionsPerSecond)
+{
+    setUp();
+
+    static const int ITERATIONS = 1000;
+
+    const int transactionCounter = cardEmulator->getTransactionCounter();
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        cardTransactionManager->processOpening(WriteAccessLevel::DEBIT);
+        cardTransactionManager->prepareUpdateRecord(FILE7, 1, HexUtil::toByteArray("0102030405"));
+        cardTransactionManager->processClosing();
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - start).count();
+    const long long sessionsPerSecond = ITERATIONS * 1000000LL / (elapsed > 0 ? elapsed : 1);
+
+    RecordProperty("sessionsPerSecond", std::to_string(sessionsPerSecond));
+
+    ASSERT_EQ(cardEmulator->getTransactionCounter(), transactionCounter - ITERATIONS);
+    ASSERT_FALSE(cardEmulator->isSessionOpen());
+
+    tearDown();
+}
@@ -0,0 +1,162 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "CardImageCache.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "IllegalArgumentException.h"
+
+/* Mock */
+#include "CardSelectionResponseAdapterMock.h"
+
+using namespace testing;
+
+using namespace keyple::card::calypso;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+static const std::string POWER_ON_DATA_PREFIX = "3B8F8001805A0A0103200311";
+static const std::string POWER_ON_DATA_SUFFIX = "829000F7";
+static const std::vector<uint8_t> REC1 = HexUtil::toByteArray("1111111111");
+static const std::vector<uint8_t> REC2 = HexUtil::toByteArray("2222222222");
+
+static std::shared_ptr<CardImageCache> cache;
+
+static void setUp()
+{
+    cache = std::make_shared<CardImageCache>(2);
+}
+
+static void tearDown()
+{
+    cache.reset();
+}
+
+static std::shared_ptr<CalypsoCardAdapter> buildCalypsoCard(const std::string& serialNumber,
+                                                            const int transactionCounter)
+{
+    auto card = std::make_shared<CalypsoCardAdapter>();
+    card->initialize(
+        std::make_shared<CardSelectionResponseAdapterMock>(POWER_ON_DATA_PREFIX +
+                                                           serialNumber +
+                                                           POWER_ON_DATA_SUFFIX));
+    card->setTransactionCounter(transactionCounter);
+    card->setContent(7, 1, REC1);
+    card->setContent(7, 2, REC2);
+
+    return card;
+}
+
+TEST(CardImageCacheTest, constructor_whenCapacityIsZero_shouldThrowIAE)
+{
+    EXPECT_THROW(std::make_shared<CardImageCache>(0), IllegalArgumentException);
+}
+
+TEST(CardImageCacheTest, get_whenNoImage_shouldReturnNull)
+{
+    setUp();
+
+    ASSERT_EQ(cache->get(buildCalypsoCard("12345678", 100)), nullptr);
+
+    tearDown();
+}
+
+TEST(CardImageCacheTest, get_whenImageStored_shouldProvideRecords)
+{
+    setUp();
+
+    cache->put(buildCalypsoCard("12345678", 100));
+
+    const auto image = cache->get(buildCalypsoCard("12345678", 99));
+
+    ASSERT_NE(image, nullptr);
+    ASSERT_EQ(*image->getRecord(7, 1), REC1);
+    ASSERT_EQ(*image->getRecord(7, 2), REC2);
+    ASSERT_EQ(image->getRecord(7, 3), nullptr);
+    ASSERT_EQ(image->getRecord(8, 1), nullptr);
+
+    tearDown();
+}
+
+TEST(CardImageCacheTest, isValid_shouldOnlyAcceptTheNextTransactionCounter)
+{
+    setUp();
+
+    cache->put(buildCalypsoCard("12345678", 100));
+
+    const auto image = cache->get(buildCalypsoCard("12345678", 99));
+
+    ASSERT_TRUE(image->isValid(99));
+    ASSERT_FALSE(image->isValid(100));
+    ASSERT_FALSE(image->isValid(98));
+
+    tearDown();
+}
+
+TEST(CardImageCacheTest, put_whenCapacityIsReached_shouldEvictLeastRecentlyUsedImage)
+{
+    setUp();
+
+    cache->put(buildCalypsoCard("11111111", 100));
+    cache->put(buildCalypsoCard("22222222", 100));
+
+    /* Card 1 becomes the most recently used */
+    ASSERT_NE(cache->get(buildCalypsoCard("11111111", 99)), nullptr);
+
+    cache->put(buildCalypsoCard("33333333", 100));
+
+    ASSERT_EQ(cache->getSize(), 2);
+    ASSERT_NE(cache->get(buildCalypsoCard("11111111", 99)), nullptr);
+    ASSERT_EQ(cache->get(buildCalypsoCard("22222222", 99)), nullptr);
+    ASSERT_NE(cache->get(buildCalypsoCard("33333333", 99)), nullptr);
+
+    tearDown();
+}
+
+TEST(CardImageCacheTest, remove_shouldRemoveImage)
+{
+    setUp();
+
+    const auto card = buildCalypsoCard("12345678", 100);
+    cache->put(card);
+    cache->remove(card);
+
+    ASSERT_EQ(cache->getSize(), 0);
+    ASSERT_EQ(cache->get(card), nullptr);
+
+    tearDown();
+}
+
+TEST(CardImageCacheTest, notifyLookup_shouldUpdateStatistics)
+{
+    setUp();
+
+    cache->notifyLookup(true);
+    cache->notifyLookup(false);
+    cache->notifyLookup(false);
+
+    ASSERT_EQ(cache->getHitCount(), 1);
+    ASSERT_EQ(cache->getMissCount(), 2);
+
+    cache->clear();
+
+    ASSERT_EQ(cache->getHitCount(), 0);
+    ASSERT_EQ(cache->getMissCount(), 0);
+
+    tearDown();
+}
@@ -10,12 +10,15 @@
  * SPDX-License-Identifier: EPL-2.0                                                               *
  **************************************************************************************************/
 
+#include <algorithm>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
 /* Calypsonet Terminal Calypso */
 #include "CardTransactionManager.h"
 #include "UnauthorizedKeyException.h"
+#include "UnexpectedCommandStatusException.h"
 
 /* Calypsonet Terminal Card */
 #include "CardSelectionResponseApi.h"
@@ -27,10 +30,16 @@
 #include "CalypsoSamAdapter.h"
 #include "CardRequestAdapter.h"
 #include "CardResponseAdapter.h"
+#include "CardSecuritySettingAdapter.h"
+#include "CardImageCache.h"
+#include "CardTransactionManagerAdapter.h"
+#include "FileHeaderAdapter.h"
+#include "FileHeaderCache.h"
 
 /* Keyple Core Util */
 #include "HexUtil.h"
 #include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
 
 /* Keyple Core Service */
 #include "CardSelectionResponseAdapter.h"
@@ -43,6 +52,8 @@
 #include "ReaderMock.h"
 #include "SearchCommandDataMock.h"
 
+#include "CalypsoEmulatorFixture.h"
+
 using namespace testing;
 
 using namespace calypsonet::terminal::calypso::transaction;
@@ -703,6 +714,202 @@ TEST(CardTransactionManagerAdapterTest,
     tearDown();
 }
 
+TEST(CardTransactionManagerAdapterTest,
+     processOpening_whenSamDiversifierIsAlreadySelected_shouldNotSelectIt)
+{
+    CalypsoEmulatorFixture emulators;
+
+    auto cardTransaction = emulators.createCardTransaction();
+    long samApduCount = emulators.getSamEmulator()->getApduCount();
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    /* "Select Diversifier" and "Get Challenge" */
+    ASSERT_EQ(emulators.getSamEmulator()->getApduCount(), samApduCount + 2);
+
+    cardTransaction->processClosing();
+
+    /* New transaction with the same SAM */
+    cardTransaction = emulators.createCardTransaction();
+
+    samApduCount = emulators.getSamEmulator()->getApduCount();
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    /* "Get Challenge" */
+    ASSERT_EQ(emulators.getSamEmulator()->getApduCount(), samApduCount + 1);
+    ASSERT_EQ(emulators.getCalypsoSam()->getSelectedKeyDiversifier(),
+              CalypsoEmulatorFixture::CARD_SERIAL_NUMBER);
+
+    cardTransaction->processClosing();
+
+    ASSERT_FALSE(emulators.getCardEmulator()->isSessionOpen());
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     processCommands_whenCommandFailsInSession_shouldThrowExceptionWithAuditData)
+{
+    CalypsoEmulatorFixture emulators;
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    /* FILE7 has no record 4: the card answers "record not found" */
+    cardTransaction->prepareUpdateRecord(FILE7, 4, HexUtil::toByteArray("0102030405"));
+
+    try {
+        cardTransaction->processCommands();
+        FAIL() << "UnexpectedCommandStatusException expected";
+
+    } catch (const UnexpectedCommandStatusException& e) {
+
+        const std::string what = e.what();
+        ASSERT_NE(what.find("Transaction audit JSON data"), std::string::npos);
+        ASSERT_NE(what.find("6A83"), std::string::npos);
+        ASSERT_EQ(e.getMessage().find("Transaction audit JSON data"), std::string::npos);
+    }
+
+    ASSERT_FALSE(emulators.getCardEmulator()->isSessionOpen());
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     processOpening_whenSamChallengeIsPrefetched_shouldNotSendSamCommand)
+{
+    CalypsoEmulatorFixture emulators;
+    std::dynamic_pointer_cast<CardSecuritySettingAdapter>(emulators.getCardSecuritySetting())
+        ->enableSamChallengePrefetch();
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+    cardTransaction->prepareUpdateRecord(FILE7, 1, HexUtil::toByteArray("0102030405"));
+    cardTransaction->processClosing();
+
+    const long samApduCount = emulators.getSamEmulator()->getApduCount();
+
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    /* The "Digest Init" SAM command is deferred, no SAM command at all */
+    ASSERT_EQ(emulators.getSamEmulator()->getApduCount(), samApduCount);
+
+    cardTransaction->prepareUpdateRecord(FILE7, 2, HexUtil::toByteArray("AABBCC"));
+    cardTransaction->processClosing();
+
+    ASSERT_EQ(emulators.getCardEmulator()->getContent(FILE7, 2)[0], 0xAA);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     processOpening_whenSamIsUsedAfterChallengePrefetch_shouldGetNewChallenge)
+{
+    CalypsoEmulatorFixture emulators;
+    emulators.getCardSecuritySetting()->setPinVerificationCipheringKey(0x30, 0x79);
+    std::dynamic_pointer_cast<CardSecuritySettingAdapter>(emulators.getCardSecuritySetting())
+        ->enableSamChallengePrefetch();
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+    cardTransaction->processClosing();
+    cardTransaction->processVerifyPin(HexUtil::toByteArray("30303030"));
+
+    const long samApduCount = emulators.getSamEmulator()->getApduCount();
+
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    /* "Get Challenge" */
+    ASSERT_EQ(emulators.getSamEmulator()->getApduCount(), samApduCount + 1);
+
+    cardTransaction->processClosing();
+
+    ASSERT_FALSE(emulators.getCardEmulator()->isSessionOpen());
+}
+
+static std::shared_ptr<CardImageCache> setUpCardImageCache(CalypsoEmulatorFixture& emulators)
+{
+    const auto cardImageCache = std::make_shared<CardImageCache>(10);
+    std::dynamic_pointer_cast<CardSecuritySettingAdapter>(emulators.getCardSecuritySetting())
+        ->setCardImageCache(cardImageCache);
+    emulators.getCardEmulator()->setContent(FILE7, 2, HexUtil::toByteArray("1122"));
+
+    /* First session: no image, the reads are sent with the opening and the image is stored */
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->prepareReadRecords(FILE7,
+                                        1,
+                                        CalypsoEmulatorFixture::FILE7_RECORDS_NUMBER,
+                                        CalypsoEmulatorFixture::FILE7_RECORD_SIZE);
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    EXPECT_EQ(cardTransaction->getCardExchangeCount(), 1);
+
+    cardTransaction->processClosing();
+
+    EXPECT_EQ(cardImageCache->getSize(), 1);
+
+    return cardImageCache;
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     processOpening_whenCardImageIsValid_shouldServeReadsAndBatchOtherCommands)
+{
+    CalypsoEmulatorFixture emulators;
+    const auto cardImageCache = setUpCardImageCache(emulators);
+
+    /* Next tap of the same card */
+    emulators.selectCard();
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->prepareReadRecords(FILE7,
+                                        1,
+                                        CalypsoEmulatorFixture::FILE7_RECORDS_NUMBER,
+                                        CalypsoEmulatorFixture::FILE7_RECORD_SIZE);
+    cardTransaction->prepareUpdateRecord(FILE7, 1, HexUtil::toByteArray("AABB"));
+    cardTransaction->prepareReadRecords(FILE7, 2, 2, CalypsoEmulatorFixture::FILE7_RECORD_SIZE);
+
+    const long cardApduCount = emulators.getCardEmulator()->getApduCount();
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    /* Open Secure Session, then Update Record and Read Record together */
+    ASSERT_EQ(cardTransaction->getCardExchangeCount(), 2);
+    ASSERT_EQ(emulators.getCardEmulator()->getApduCount(), cardApduCount + 3);
+    ASSERT_EQ(cardImageCache->getHitCount(), 1);
+    ASSERT_EQ(emulators.getCalypsoCard()->getFileBySfi(FILE7)->getData()->getContent(2)[0], 0x11);
+    ASSERT_EQ(static_cast<int>(
+                  emulators.getCalypsoCard()->getFileBySfi(FILE7)->getData()->getContent(3).size()),
+              CalypsoEmulatorFixture::FILE7_RECORD_SIZE);
+
+    cardTransaction->processClosing();
+
+    ASSERT_EQ(emulators.getCardEmulator()->getContent(FILE7, 1)[0], 0xAA);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     processOpening_whenCardImageIsOutdated_shouldSendReadsInOneExchange)
+{
+    CalypsoEmulatorFixture emulators;
+    const auto cardImageCache = setUpCardImageCache(emulators);
+
+    /* Another session took place elsewhere */
+    emulators.getCardEmulator()->setTransactionCounter(
+        emulators.getCardEmulator()->getTransactionCounter() - 1);
+
+    emulators.selectCard();
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->prepareReadRecords(FILE7,
+                                        1,
+                                        CalypsoEmulatorFixture::FILE7_RECORDS_NUMBER,
+                                        CalypsoEmulatorFixture::FILE7_RECORD_SIZE);
+
+    const long cardApduCount = emulators.getCardEmulator()->getApduCount();
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    /* Open Secure Session, then the deferred Read Records */
+    ASSERT_EQ(cardTransaction->getCardExchangeCount(), 2);
+    ASSERT_EQ(emulators.getCardEmulator()->getApduCount(), cardApduCount + 2);
+    ASSERT_EQ(cardImageCache->getHitCount(), 0);
+    ASSERT_EQ(cardImageCache->getMissCount(), 2);
+    ASSERT_EQ(cardImageCache->getSize(), 0);
+    ASSERT_EQ(emulators.getCalypsoCard()->getFileBySfi(FILE7)->getData()->getContent(2)[0], 0x11);
+
+    cardTransaction->processClosing();
+
+    ASSERT_EQ(cardImageCache->getSize(), 1);
+}
+
 TEST(CardTransactionManagerAdapterTest,
      processCommands_whenOutOfSession_shouldExchangeApduWithCardOnly)
 {
@@ -1123,6 +1330,144 @@ TEST(CardTransactionManagerAdapterTest,
     tearDown();
 }
 
+static const uint8_t EMULATED_PIN_CIPHERING_KIF = 0x30;
+static const uint8_t EMULATED_PIN_CIPHERING_KVC = 0x79;
+static const std::vector<uint8_t> EMULATED_PIN = HexUtil::toByteArray("30303030");
+static const std::vector<uint8_t> EMULATED_WRONG_PIN = HexUtil::toByteArray("31313131");
+static const std::vector<uint8_t> EMULATED_NEW_PIN = HexUtil::toByteArray("34353637");
+
+static void setUpEmulatedPin(CalypsoEmulatorFixture& emulators)
+{
+    const auto cardEmulator = emulators.getCardEmulator();
+    cardEmulator->setContent(FILE7, 1, HexUtil::toByteArray("0102030405"));
+    cardEmulator->setContent(FILE7, 2, HexUtil::toByteArray("AABBCC"));
+    cardEmulator->setPin(EMULATED_PIN);
+    cardEmulator->setPinCipheringKey(EMULATED_PIN_CIPHERING_KIF, EMULATED_PIN_CIPHERING_KVC);
+
+    emulators.getCardSecuritySetting()
+        ->setPinVerificationCipheringKey(EMULATED_PIN_CIPHERING_KIF, EMULATED_PIN_CIPHERING_KVC)
+        .setPinModificationCipheringKey(EMULATED_PIN_CIPHERING_KIF, EMULATED_PIN_CIPHERING_KVC);
+}
+
+TEST(CardTransactionManagerAdapterTest, prepareVerifyPin_whenCiphered_shouldTakeTwoCardExchanges)
+{
+    CalypsoEmulatorFixture emulators;
+    setUpEmulatedPin(emulators);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    const long samApduCount = emulators.getSamEmulator()->getApduCount();
+
+    cardTransaction->prepareReadRecord(FILE7, 1);
+    cardTransaction->prepareVerifyPin(EMULATED_PIN)
+                   .prepareReadRecord(FILE7, 2)
+                   .processCommands();
+
+    const auto calypsoCard = emulators.getCalypsoCard();
+
+    ASSERT_EQ(cardTransaction->getCardExchangeCount(), 2);
+    ASSERT_GT(emulators.getSamEmulator()->getApduCount(), samApduCount);
+    ASSERT_FALSE(calypsoCard->isPinBlocked());
+    ASSERT_EQ(calypsoCard->getPinAttemptRemaining(), 3);
+    ASSERT_EQ(calypsoCard->getFileBySfi(FILE7)->getData()->getContent(1)[0], 0x01);
+    ASSERT_EQ(calypsoCard->getFileBySfi(FILE7)->getData()->getContent(2)[0], 0xAA);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareVerifyPin_whenPinIsWrong_shouldThrowAndDecrementAttempts)
+{
+    CalypsoEmulatorFixture emulators;
+    setUpEmulatedPin(emulators);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->prepareVerifyPin(EMULATED_WRONG_PIN);
+
+    EXPECT_THROW(cardTransaction->processCommands(), UnexpectedCommandStatusException);
+    ASSERT_EQ(emulators.getCardEmulator()->getPinAttemptRemaining(), 2);
+
+    emulators.createCardTransaction()->prepareVerifyPin(EMULATED_PIN).processCommands();
+
+    ASSERT_EQ(emulators.getCardEmulator()->getPinAttemptRemaining(), 3);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareVerifyPin_whenSamFails_shouldDiscardPreparedCommands)
+{
+    CalypsoEmulatorFixture emulators;
+    setUpEmulatedPin(emulators);
+
+    /* "Card Cipher PIN" */
+    emulators.getSamEmulator()->setCommandStatusWord(0x12, 0x6985);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->prepareReadRecord(FILE7, 1);
+    cardTransaction->prepareVerifyPin(EMULATED_PIN)
+                   .prepareReadRecord(FILE7, 2);
+
+    EXPECT_THROW(cardTransaction->processCommands(), UnexpectedCommandStatusException);
+
+    /* Only the commands prepared before the PIN command were sent, with the "Get Challenge" */
+    ASSERT_EQ(cardTransaction->getCardExchangeCount(), 1);
+    ASSERT_EQ(emulators.getCardEmulator()->getPinAttemptRemaining(), 3);
+
+    /* Nothing is left to send and a new PIN command can be prepared */
+    const long cardApduCount = emulators.getCardEmulator()->getApduCount();
+    cardTransaction->prepareReadRecord(FILE7, 1).processCommands();
+
+    ASSERT_EQ(emulators.getCardEmulator()->getApduCount(), cardApduCount + 1);
+    EXPECT_NO_THROW(cardTransaction->prepareVerifyPin(EMULATED_PIN));
+}
+
+TEST(CardTransactionManagerAdapterTest, prepareVerifyPin_whenPlain_shouldTakeOneCardExchange)
+{
+    CalypsoEmulatorFixture emulators;
+    setUpEmulatedPin(emulators);
+
+    std::dynamic_pointer_cast<CardSecuritySettingAdapter>(emulators.getCardSecuritySetting())
+        ->enablePinPlainTransmission();
+    const auto cardTransaction = emulators.createCardTransaction();
+    const long samApduCount = emulators.getSamEmulator()->getApduCount();
+
+    cardTransaction->prepareVerifyPin(EMULATED_PIN)
+                   .prepareReadRecord(FILE7, 2)
+                   .processCommands();
+
+    ASSERT_EQ(cardTransaction->getCardExchangeCount(), 1);
+    ASSERT_EQ(emulators.getSamEmulator()->getApduCount(), samApduCount);
+    ASSERT_EQ(emulators.getCardEmulator()->getPinAttemptRemaining(), 3);
+}
+
+TEST(CardTransactionManagerAdapterTest, prepareChangePin_whenCiphered_shouldChangePin)
+{
+    CalypsoEmulatorFixture emulators;
+    setUpEmulatedPin(emulators);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+
+    cardTransaction->prepareVerifyPin(EMULATED_PIN).processCommands();
+    cardTransaction->prepareChangePin(EMULATED_NEW_PIN).processCommands();
+
+    ASSERT_EQ(cardTransaction->getCardExchangeCount(), 4);
+
+    cardTransaction->prepareVerifyPin(EMULATED_NEW_PIN).processCommands();
+
+    ASSERT_EQ(emulators.getCardEmulator()->getPinAttemptRemaining(), 3);
+}
+
+TEST(CardTransactionManagerAdapterTest, prepareVerifyPin_whenAlreadyPrepared_shouldThrowISE)
+{
+    CalypsoEmulatorFixture emulators;
+    setUpEmulatedPin(emulators);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+
+    cardTransaction->prepareVerifyPin(EMULATED_PIN);
+
+    EXPECT_THROW(cardTransaction->prepareVerifyPin(EMULATED_PIN), IllegalStateException);
+    EXPECT_THROW(cardTransaction->processVerifyPin(EMULATED_PIN), IllegalStateException);
+    EXPECT_THROW(cardTransaction->processOpening(WriteAccessLevel::DEBIT),
+                 IllegalStateException);
+}
+
 TEST(CardTransactionManagerAdapterTest, processChangeKey_shouldSendApdusToTheCardAndTheSAM)
 {
     setUp();
@@ -1158,6 +1503,58 @@ TEST(CardTransactionManagerAdapterTest, processChangeKey_shouldSendApdusToTheCar
     tearDown();
 }
 
+TEST(CardTransactionManagerAdapterTest,
+     processChangeKeys_shouldRequestNextChallengeWithCurrentKeyChange)
+{
+    setUp();
+
+    cardSecuritySetting = CalypsoExtensionService::getInstance()->createCardSecuritySetting();
+    cardSecuritySetting->setControlSamResource(samReader, calypsoSam);
+    cardSecuritySetting->enablePinPlainTransmission();
+
+    initCalypsoCard(SELECT_APPLICATION_RESPONSE_PRIME_REVISION_3_WITH_PIN);
+
+    const auto cardGetChallengeCardResponse = createCardResponse({CARD_GET_CHALLENGE_RSP});
+    const auto cardChangeKeyGetChallengeCardResponse =
+        createCardResponse({SW1SW2_OK, CARD_GET_CHALLENGE_RSP});
+    const auto cardChangeKeyCardResponse = createCardResponse({SW1SW2_OK});
+
+    const auto samFirstCardResponse = createCardResponse({SW1SW2_OK,
+                                                          SW1SW2_OK,
+                                                          SAM_CARD_GENERATE_KEY_RSP});
+    const auto samNextCardResponse = createCardResponse({SW1SW2_OK, SAM_CARD_GENERATE_KEY_RSP});
+
+    /* 3 keys: 4 card requests and 3 SAM requests */
+    EXPECT_CALL(*cardReader, transmitCardRequest(_, _))
+        .WillOnce(Return(cardGetChallengeCardResponse))
+        .WillOnce(Return(cardChangeKeyGetChallengeCardResponse))
+        .WillOnce(Return(cardChangeKeyGetChallengeCardResponse))
+        .WillOnce(Return(cardChangeKeyCardResponse));
+
+    EXPECT_CALL(*samReader, transmitCardRequest(_, _))
+        .WillOnce(Return(samFirstCardResponse))
+        .WillOnce(Return(samNextCardResponse))
+        .WillOnce(Return(samNextCardResponse));
+
+    std::dynamic_pointer_cast<CardTransactionManagerAdapter>(cardTransactionManager)
+        ->processChangeKeys({{1, 2, 3, 4, 5}, {2, 2, 3, 4, 5}, {3, 2, 3, 4, 5}});
+
+    tearDown();
+}
+
+TEST(CardTransactionManagerAdapterTest, processChangeKeys_whenKeyIndexIsOutOfRange_shouldThrowIAE)
+{
+    setUp();
+
+    initCalypsoCard(SELECT_APPLICATION_RESPONSE_PRIME_REVISION_3_WITH_PIN);
+
+    EXPECT_THROW(std::dynamic_pointer_cast<CardTransactionManagerAdapter>(cardTransactionManager)
+                     ->processChangeKeys({{1, 2, 3, 4, 5}, {4, 2, 3, 4, 5}}),
+                 IllegalArgumentException);
+
+    tearDown();
+}
+
 TEST(CardTransactionManagerAdapterTest,
      prepareSelectFileDeprecated_whenLidIsLessThan2ByteLong_shouldThrowIAE)
 {
@@ -1354,6 +1751,42 @@ TEST(CardTransactionManagerAdapterTest,
     tearDown();
 }
 
+TEST(CardTransactionManagerAdapterTest,
+     prepareGetData_whenGetDataTagIsEF_LISTAndProfileIsCached_shouldNotSendGetData)
+{
+    setUp();
+
+    const auto fileHeaderCache = std::make_shared<FileHeaderCache>();
+
+    /* First card of the profile: the EF list is read and cached */
+    EXPECT_CALL(*cardReader, transmitCardRequest(_, _))
+        .WillOnce(Return(createCardResponse({CARD_GET_DATA_EF_LIST_RSP})))
+        .WillOnce(Return(createCardResponse({CARD_GET_DATA_TRACEABILITY_INFORMATION_RSP})));
+
+    std::dynamic_pointer_cast<CardTransactionManagerAdapter>(cardTransactionManager)
+        ->enableFileHeaderCache(fileHeaderCache);
+    cardTransactionManager->prepareGetData(GetDataTag::EF_LIST);
+    cardTransactionManager->processCommands();
+
+    ASSERT_EQ(fileHeaderCache->getSize(), 1);
+
+    /* Next card of the profile: only the traceability information is requested */
+    initCalypsoCard(SELECT_APPLICATION_RESPONSE_PRIME_REVISION_3);
+
+    std::dynamic_pointer_cast<CardTransactionManagerAdapter>(cardTransactionManager)
+        ->enableFileHeaderCache(fileHeaderCache);
+    cardTransactionManager->prepareGetData(GetDataTag::EF_LIST);
+    cardTransactionManager->prepareGetData(GetDataTag::TRACEABILITY_INFORMATION);
+    cardTransactionManager->processCommands();
+
+    ASSERT_EQ(calypsoCard->getFiles().size(), 5);
+    ASSERT_EQ(calypsoCard->getFileBySfi(0x07)->getHeader()->getLid(), 0x2001);
+    ASSERT_EQ(calypsoCard->getTraceabilityInformation(),
+              HexUtil::toByteArray("00112233445566778899"));
+
+    tearDown();
+}
+
 TEST(CardTransactionManagerAdapterTest,
      prepareGetData_whenGetDataTagIsTRACEABILITY_INFORMATION_shouldPopulateCalypsoCard)
 {
@@ -1924,6 +2357,133 @@ TEST(CardTransactionManagerAdapterTest, prepareSearchRecords_whenFullMask_should
     tearDown();
 }
 
+static void setSearchableFile()
+{
+    calypsoCard->setFileHeader(4,
+                               FileHeaderAdapter::builder()
+                                   ->lid(0x2040)
+                                    .recordsNumber(4)
+                                    .recordSize(12)
+                                    .type(ElementaryFile::Type::LINEAR)
+                                    .build());
+    calypsoCard->setContent(4, 1, HexUtil::toByteArray("AA11223344556677889900BB"));
+    calypsoCard->setContent(4, 2, HexUtil::toByteArray("0011223344556677889901BB"));
+    calypsoCard->setContent(4, 3, HexUtil::toByteArray("112233445566778899000000"));
+    calypsoCard->setContent(4, 4, HexUtil::toByteArray("1122334455667788FF000000"));
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareSearchRecords_whenLocalSearchAndFileIsKnown_shouldNotSendCommand)
+{
+    setUp();
+
+    setSearchableFile();
+
+    EXPECT_CALL(*cardReader, transmitCardRequest(_, _)).Times(0);
+
+    std::dynamic_pointer_cast<CardTransactionManagerAdapter>(cardTransactionManager)
+        ->enableLocalSearch();
+
+    auto data = CalypsoExtensionService::getInstance()->createSearchCommandData();
+    data->setSfi(4)
+         .startAtRecord(2)
+         .enableRepeatedOffset()
+         .setSearchData(HexUtil::toByteArray("11223344556677889900"))
+         .setMask(HexUtil::toByteArray("FFFFFFFFFFFFFFFFFFF0"));
+
+    cardTransactionManager->prepareSearchRecords(data);
+
+    ASSERT_TRUE(Arrays::equals(data->getMatchingRecordNumbers(), {2, 3}));
+
+    auto dataAtOffset = CalypsoExtensionService::getInstance()->createSearchCommandData();
+    dataAtOffset->setSfi(4).setOffset(1).setSearchData(HexUtil::toByteArray("11223344556677889900"));
+
+    cardTransactionManager->prepareSearchRecords(dataAtOffset);
+
+    ASSERT_TRUE(Arrays::equals(dataAtOffset->getMatchingRecordNumbers(), {1}));
+
+    tearDown();
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareSearchRecords_whenLocalSearchAndRecordIsMissing_shouldPrepareCommand)
+{
+    setUp();
+
+    initCalypsoCard(SELECT_APPLICATION_RESPONSE_PRIME_REVISION_2);
+    setSearchableFile();
+    calypsoCard->setContent(4, 4, std::vector<uint8_t>());
+
+    std::dynamic_pointer_cast<CardTransactionManagerAdapter>(cardTransactionManager)
+        ->enableLocalSearch();
+
+    auto data = CalypsoExtensionService::getInstance()->createSearchCommandData();
+    data->setSfi(4).setSearchData(HexUtil::toByteArray("1122"));
+
+    /* The command is not available for this card */
+    EXPECT_THROW(cardTransactionManager->prepareSearchRecords(data), UnsupportedOperationException);
+
+    tearDown();
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareSearchRecords_whenLocalSearchAndRecordIsPartiallyRead_shouldPrepareCommand)
+{
+    setUp();
+
+    initCalypsoCard(SELECT_APPLICATION_RESPONSE_PRIME_REVISION_2);
+    setSearchableFile();
+    calypsoCard->setContent(4, 4, std::vector<uint8_t>());
+    calypsoCard->setContent(4, 4, HexUtil::toByteArray("FF000000"), 8);
+
+    std::dynamic_pointer_cast<CardTransactionManagerAdapter>(cardTransactionManager)
+        ->enableLocalSearch();
+
+    auto data = CalypsoExtensionService::getInstance()->createSearchCommandData();
+    data->setSfi(4).setSearchData(HexUtil::toByteArray("1122"));
+
+    /* The 8 first bytes of the record 4 are padded with zeros, the command is prepared */
+    EXPECT_THROW(cardTransactionManager->prepareSearchRecords(data), UnsupportedOperationException);
+
+    tearDown();
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareSearchRecords_whenLocalSearchInSession_shouldUseRecordsReadInSessionOnly)
+{
+    CalypsoEmulatorFixture emulators;
+    emulators.getCardEmulator()->setContent(FILE7, 2, HexUtil::toByteArray("1122"));
+    emulators.getCalypsoCard()->setFileHeader(
+        FILE7,
+        std::dynamic_pointer_cast<FileHeaderAdapter>(
+            CalypsoEmulatorFixture::createFileHeader(CalypsoEmulatorFixture::FILE7_LID,
+                                                     CalypsoEmulatorFixture::FILE7_RECORDS_NUMBER,
+                                                     CalypsoEmulatorFixture::FILE7_RECORD_SIZE,
+                                                     ElementaryFile::Type::LINEAR)));
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->enableLocalSearch();
+    cardTransaction->prepareReadRecords(FILE7, 1, 3, CalypsoEmulatorFixture::FILE7_RECORD_SIZE);
+    cardTransaction->processCommands();
+    cardTransaction->processOpening(WriteAccessLevel::DEBIT);
+
+    auto data = CalypsoExtensionService::getInstance()->createSearchCommandData();
+    data->setSfi(FILE7).setSearchData(HexUtil::toByteArray("1122"));
+
+    /* Records read before the session: the search is left to the card */
+    EXPECT_THROW(cardTransaction->prepareSearchRecords(data), IllegalStateException);
+
+    cardTransaction->prepareReadRecords(FILE7, 1, 3, CalypsoEmulatorFixture::FILE7_RECORD_SIZE);
+    cardTransaction->processCommands();
+    cardTransaction->prepareSearchRecords(data);
+
+    ASSERT_TRUE(Arrays::equals(data->getMatchingRecordNumbers(), {2}));
+
+    cardTransaction->processClosing();
+
+    ASSERT_FALSE(emulators.getCardEmulator()->isSessionOpen());
+}
+
 TEST(CardTransactionManagerAdapterTest,
      prepareReadRecordsPartially_whenProductTypeIsNotPrimeRev3OrLight_shouldThrowUOE)
 {
@@ -2313,6 +2873,151 @@ TEST(CardTransactionManagerAdapterTest,
     tearDown();
 }
 
+static const uint8_t FILE4 = 0x04;
+static const std::vector<uint8_t> FILE4_CONTENT =
+    HexUtil::toByteArray("000102030405060708090A0B0C0D0E0F10111213");
+static const std::vector<uint8_t> FILE7_REC1_5B_BYTES = HexUtil::toByteArray("0102030405");
+
+static void addFile4(CalypsoEmulatorFixture& emulators)
+{
+    emulators.getCardEmulator()->addFile(
+        FILE4,
+        CalypsoEmulatorFixture::createFileHeader(0x2004, 1, 20, ElementaryFile::Type::BINARY));
+    emulators.getCardEmulator()->setContent(FILE4, 1, FILE4_CONTENT);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareUpdateRecord_whenDifferentialWritesAreDisabled_shouldSendCommand)
+{
+    CalypsoEmulatorFixture emulators;
+    emulators.getCardEmulator()->setContent(FILE7, 1, FILE7_REC1_5B_BYTES);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->prepareReadRecords(FILE7, 1, 1, 29).processCommands();
+
+    const long cardApduCount = emulators.getCardEmulator()->getApduCount();
+    cardTransaction->prepareUpdateRecord(FILE7,
+                                         1,
+                                         emulators.getCalypsoCard()->getFileBySfi(FILE7)
+                                                                   ->getData()
+                                                                   ->getContent(1))
+                   .processCommands();
+
+    ASSERT_EQ(emulators.getCardEmulator()->getApduCount(), cardApduCount + 1);
+    ASSERT_EQ(cardTransaction->getSavedWriteApduCount(), 0);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareUpdateRecord_whenRecordIsUnchanged_shouldNotSendCommand)
+{
+    CalypsoEmulatorFixture emulators;
+    emulators.getCardEmulator()->setContent(FILE7, 1, FILE7_REC1_5B_BYTES);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->enableDifferentialWrites();
+    cardTransaction->prepareReadRecords(FILE7, 1, 1, 29).processCommands();
+
+    std::vector<uint8_t> record = FILE7_REC1_5B_BYTES;
+    record.resize(29);
+
+    const long cardApduCount = emulators.getCardEmulator()->getApduCount();
+    cardTransaction->prepareUpdateRecord(FILE7, 1, record).processCommands();
+
+    ASSERT_EQ(emulators.getCardEmulator()->getApduCount(), cardApduCount);
+    ASSERT_EQ(cardTransaction->getSavedWriteApduCount(), 1);
+    ASSERT_EQ(cardTransaction->getSavedWriteByteCount(), 29);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareUpdateRecord_whenZerosAreWrittenIntoUnreadPrefix_shouldSendCommand)
+{
+    CalypsoEmulatorFixture emulators;
+    emulators.getCardEmulator()->setContent(FILE7, 1, FILE7_REC1_5B_BYTES);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->enableDifferentialWrites();
+
+    /* The first 5 bytes are padded with 0 in the card image */
+    cardTransaction->prepareReadRecordsPartially(FILE7, 1, 1, 5, 24).processCommands();
+
+    const std::vector<uint8_t> zeros(29);
+    ASSERT_EQ(emulators.getCalypsoCard()->getFileBySfi(FILE7)->getData()->getContent(1), zeros);
+
+    const long cardApduCount = emulators.getCardEmulator()->getApduCount();
+    cardTransaction->prepareUpdateRecord(FILE7, 1, zeros).processCommands();
+
+    ASSERT_EQ(emulators.getCardEmulator()->getApduCount(), cardApduCount + 1);
+    ASSERT_EQ(emulators.getCardEmulator()->getContent(FILE7, 1), zeros);
+    ASSERT_EQ(cardTransaction->getSavedWriteApduCount(), 0);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareWriteRecord_whenNoNewBitIsSet_shouldNotSendCommand)
+{
+    CalypsoEmulatorFixture emulators;
+    emulators.getCardEmulator()->setContent(FILE7, 1, FILE7_REC1_5B_BYTES);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->enableDifferentialWrites();
+    cardTransaction->prepareReadRecords(FILE7, 1, 1, 29).processCommands();
+
+    const long cardApduCount = emulators.getCardEmulator()->getApduCount();
+    cardTransaction->prepareWriteRecord(FILE7, 1, HexUtil::toByteArray("0102"))
+                   .prepareWriteRecord(FILE7, 1, HexUtil::toByteArray("0302"))
+                   .processCommands();
+
+    /* The first command is skipped, the second one sets a new bit */
+    ASSERT_EQ(emulators.getCardEmulator()->getApduCount(), cardApduCount + 1);
+    ASSERT_EQ(emulators.getCardEmulator()->getContent(FILE7, 1)[0], 0x03);
+    ASSERT_EQ(cardTransaction->getSavedWriteApduCount(), 1);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareUpdateBinary_whenContentIsKnown_shouldSendChangedBytesOnly)
+{
+    CalypsoEmulatorFixture emulators;
+    addFile4(emulators);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->enableDifferentialWrites();
+    cardTransaction->prepareReadBinary(FILE4, 0, 20).processCommands();
+
+    std::vector<uint8_t> data = FILE4_CONTENT;
+    data[5] = 0xA5;
+    data[15] = 0xAF;
+
+    cardTransaction->prepareUpdateBinary(FILE4, 0, data).processCommands();
+
+    /* Bytes 5 to 15 are sent in a single command */
+    ASSERT_EQ(emulators.getCardEmulator()->getContent(FILE4, 1), data);
+    ASSERT_EQ(emulators.getCalypsoCard()->getFileBySfi(FILE4)->getData()->getContent(), data);
+    ASSERT_EQ(cardTransaction->getSavedWriteApduCount(), 0);
+    ASSERT_EQ(cardTransaction->getSavedWriteByteCount(), 9);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     prepareUpdateBinary_whenZerosAreWrittenIntoUnreadPrefix_shouldSendThem)
+{
+    CalypsoEmulatorFixture emulators;
+    addFile4(emulators);
+
+    const auto cardTransaction = emulators.createCardTransaction();
+    cardTransaction->enableDifferentialWrites();
+
+    /* The first 10 bytes are padded with 0 in the card image */
+    cardTransaction->prepareReadBinary(FILE4, 10, 10).processCommands();
+
+    std::vector<uint8_t> data = FILE4_CONTENT;
+    std::fill(data.begin(), data.begin() + 10, 0);
+    data[15] = 0xAF;
+
+    cardTransaction->prepareUpdateBinary(FILE4, 0, data).processCommands();
+
+    /* Bytes 0 to 15 are sent, only the last 4 bytes are saved */
+    ASSERT_EQ(emulators.getCardEmulator()->getContent(FILE4, 1), data);
+    ASSERT_EQ(cardTransaction->getSavedWriteByteCount(), 4);
+}
+
 // C++: that test requires mocking a final class, doesn't work
 // TEST(CardTransactionManagerAdapterTest,
 //      prepareUpdateBinary_whenDataLengthIsLessThanPayLoad_shouldPrepareOneCommand)
@@ -3034,6 +3739,102 @@ TEST(CardTransactionManagerAdapterTest, prepareSvReadAllLogs_whenNotAnSVApplicat
     tearDown();
 }
 
+static const std::vector<uint8_t> SV_STARTUP_INFO = HexUtil::toByteArray("0A3C2B20141001");
+static const uint8_t SV_LOAD_LOG_FILE = 0x14;
+static const uint8_t SV_DEBIT_LOG_FILE = 0x15;
+
+/**
+ * Creates an SV application emulator whose debit log records hold the provided SV transaction
+ * numbers, the most recent one first.
+ */
+static const std::shared_ptr<CalypsoCardEmulator> createSvCardEmulator(
+    const std::vector<int>& svTNums)
+{
+    auto cardEmulator =
+        std::make_shared<CalypsoCardEmulator>(CalypsoEmulatorFixture::DF_NAME,
+                                              CalypsoEmulatorFixture::CARD_SERIAL_NUMBER,
+                                              SV_STARTUP_INFO);
+    cardEmulator->addFile(SV_LOAD_LOG_FILE,
+                          CalypsoEmulatorFixture::createFileHeader(0x1014,
+                                                                   1,
+                                                                   29,
+                                                                   ElementaryFile::Type::LINEAR));
+    cardEmulator->addFile(SV_DEBIT_LOG_FILE,
+                          CalypsoEmulatorFixture::createFileHeader(0x1015,
+                                                                   3,
+                                                                   29,
+                                                                   ElementaryFile::Type::CYCLIC));
+
+    for (size_t i = 0; i < svTNums.size(); i++) {
+        std::vector<uint8_t> record(29);
+        record[17] = static_cast<uint8_t>(svTNums[i] >> 8);
+        record[18] = static_cast<uint8_t>(svTNums[i]);
+        cardEmulator->setContent(SV_DEBIT_LOG_FILE, static_cast<uint8_t>(i + 1), record);
+    }
+
+    return cardEmulator;
+}
+
+static const std::shared_ptr<CardTransactionManagerAdapter> createSvCardTransaction(
+    const std::shared_ptr<CalypsoCardEmulator> cardEmulator,
+    const std::shared_ptr<CalypsoCardAdapter> calypsoCard)
+{
+    return std::dynamic_pointer_cast<CardTransactionManagerAdapter>(
+               CalypsoExtensionService::getInstance()
+                   ->createCardTransactionWithoutSecurity(cardEmulator, calypsoCard));
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     processSvReadLogsSince_whenKnownRecordIsReached_shouldStopReading)
+{
+    const auto cardEmulator = createSvCardEmulator({12, 11, 10});
+    const auto calypsoCard = CalypsoEmulatorFixture::createCalypsoCard(cardEmulator);
+
+    createSvCardTransaction(cardEmulator, calypsoCard)->processSvReadLogsSince(11, 1);
+
+    /* Load log with debit log record 1, then debit log record 2 */
+    ASSERT_EQ(cardEmulator->getApduCount(), 3);
+    ASSERT_EQ(calypsoCard->getFileBySfi(SV_DEBIT_LOG_FILE)
+                         ->getData()
+                         ->getAllRecordsContent()
+                         .size(),
+              2);
+
+    const auto svDebitLogRecords = calypsoCard->getSvDebitLogRecordsSince(11);
+    ASSERT_EQ(svDebitLogRecords.size(), 1);
+    ASSERT_EQ(svDebitLogRecords[0]->getSvTNum(), 12);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     processSvReadLogsSince_whenSvTNumWrapsAround_shouldReadRecordsAfterRollover)
+{
+    const auto cardEmulator = createSvCardEmulator({0x0001, 0x0000, 0xFFFF});
+    const auto calypsoCard = CalypsoEmulatorFixture::createCalypsoCard(cardEmulator);
+
+    createSvCardTransaction(cardEmulator, calypsoCard)->processSvReadLogsSince(0xFFFF, 2);
+
+    /* Load log with debit log records 1 and 2, then debit log record 3 */
+    ASSERT_EQ(cardEmulator->getApduCount(), 3);
+
+    const auto svDebitLogRecords = calypsoCard->getSvDebitLogRecordsSince(0xFFFF);
+    ASSERT_EQ(svDebitLogRecords.size(), 2);
+    ASSERT_EQ(svDebitLogRecords[0]->getSvTNum(), 0x0001);
+    ASSERT_EQ(svDebitLogRecords[1]->getSvTNum(), 0x0000);
+}
+
+TEST(CardTransactionManagerAdapterTest,
+     processSvReadLogsSince_whenNoNewLog_shouldReadMostRecentRecordOnly)
+{
+    const auto cardEmulator = createSvCardEmulator({10, 9, 8});
+    const auto calypsoCard = CalypsoEmulatorFixture::createCalypsoCard(cardEmulator);
+
+    createSvCardTransaction(cardEmulator, calypsoCard)->processSvReadLogsSince(10, 1);
+
+    /* Load log with debit log record 1 */
+    ASSERT_EQ(cardEmulator->getApduCount(), 2);
+    ASSERT_TRUE(calypsoCard->getSvDebitLogRecordsSince(10).empty());
+}
+
 TEST(CardTransactionManagerAdapterTest, prepareInvalidate_whenCardIsInvalidated_shouldThrowISE)
 {
     setUp();
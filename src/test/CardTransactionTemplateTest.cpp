@@ -0,0 +1,161 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Calypsonet Terminal Calypso */
+#include "CardTransactionManager.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "CardTransactionManagerAdapter.h"
+#include "CardTransactionTemplate.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "IllegalArgumentException.h"
+#include "IllegalStateException.h"
+
+#include "CalypsoEmulatorFixture.h"
+
+using namespace testing;
+
+using namespace calypsonet::terminal::calypso::transaction;
+using namespace keyple::card::calypso;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+static const uint8_t FILE7 = CalypsoEmulatorFixture::FILE7;
+static const std::vector<uint8_t> REC1 = HexUtil::toByteArray("0102030405");
+static const std::vector<uint8_t> REC2 = HexUtil::toByteArray("AABBCC");
+
+static std::shared_ptr<CalypsoEmulatorFixture> emulators;
+static std::shared_ptr<CalypsoCardEmulator> cardEmulator;
+static std::shared_ptr<CalypsoCardAdapter> calypsoCard;
+static std::shared_ptr<CardTransactionManagerAdapter> cardTransactionManager;
+
+static void setUp()
+{
+    emulators = std::make_shared<CalypsoEmulatorFixture>();
+    cardEmulator = emulators->getCardEmulator();
+    cardEmulator->setContent(FILE7, 1, REC1);
+    calypsoCard = emulators->getCalypsoCard();
+    cardTransactionManager = emulators->createCardTransaction();
+}
+
+static void tearDown()
+{
+    cardTransactionManager.reset();
+    calypsoCard.reset();
+    cardEmulator.reset();
+    emulators.reset();
+}
+
+TEST(CardTransactionTemplateTest, addReadRecords_whenRecordNumbersAreInverted_shouldThrowIAE)
+{
+    CardTransactionTemplate transactionTemplate;
+
+    EXPECT_THROW(transactionTemplate.addReadRecords(FILE7, 2, 1, 29), IllegalArgumentException);
+}
+
+TEST(CardTransactionTemplateTest, addIncreaseCounter_whenCounterNumberIsZero_shouldThrowIAE)
+{
+    CardTransactionTemplate transactionTemplate;
+
+    EXPECT_THROW(transactionTemplate.addIncreaseCounter(FILE7, 0), IllegalArgumentException);
+}
+
+TEST(CardTransactionTemplateTest, getCommands_whenTemplateIsEmpty_shouldThrowISE)
+{
+    CardTransactionTemplate transactionTemplate;
+
+    EXPECT_THROW(transactionTemplate.getCommands(250), IllegalStateException);
+}
+
+TEST(CardTransactionTemplateTest, getCommands_shouldSplitReadsAndReuseThem)
+{
+    CardTransactionTemplate transactionTemplate;
+    transactionTemplate.addReadRecords(FILE7, 1, 10, 29)
+                       .addIncreaseCounter(0x19, 1)
+                       .addAppendRecord(0x08);
+
+    const auto commands = transactionTemplate.getCommands(250);
+
+    /* 8 records of 29 + 2 bytes in the first APDU, 2 records in the second one */
+    ASSERT_EQ(commands->size(), 4);
+    ASSERT_EQ((*commands)[0].mType, CardTransactionTemplate::CommandType::READ_MULTIPLE_RECORD);
+    ASSERT_EQ((*commands)[0].mLength, 248);
+    ASSERT_EQ((*commands)[1].mNumber, 9);
+    ASSERT_EQ((*commands)[1].mLength, 62);
+    ASSERT_EQ(transactionTemplate.getCommands(250), commands);
+    ASSERT_EQ(transactionTemplate.getRecordDataCount(), 1);
+    ASSERT_EQ(transactionTemplate.getCounterValueCount(), 1);
+}
+
+TEST(CardTransactionTemplateTest, prepareTemplate_whenRecordDataCountIsWrong_shouldThrowIAE)
+{
+    setUp();
+
+    CardTransactionTemplate transactionTemplate;
+    transactionTemplate.addUpdateRecord(FILE7, 2);
+
+    EXPECT_THROW(cardTransactionManager->prepareTemplate(transactionTemplate, {}, {}),
+                 IllegalArgumentException);
+
+    tearDown();
+}
+
+TEST(CardTransactionTemplateTest, prepareTemplate_shouldPrepareTemplateCommands)
+{
+    setUp();
+
+    CardTransactionTemplate transactionTemplate;
+    transactionTemplate.addReadRecords(FILE7, 1, 1, 29)
+                       .addUpdateRecord(FILE7, 2);
+
+    cardTransactionManager->prepareTemplate(transactionTemplate, {REC2}, {});
+    cardTransactionManager->processOpening(WriteAccessLevel::DEBIT).processClosing();
+
+    std::vector<uint8_t> expected = REC1;
+    expected.resize(29);
+    ASSERT_EQ(calypsoCard->getFileBySfi(FILE7)->getData()->getContent(1), expected);
+    ASSERT_EQ(cardEmulator->getContent(FILE7, 2)[0], 0xAA);
+
+    tearDown();
+}
+
+TEST(CardTransactionTemplateTest, prepareTemplate_whenRecordIsUnchanged_shouldNotUpdateIt)
+{
+    setUp();
+
+    cardTransactionManager->enableDifferentialWrites();
+
+    std::vector<uint8_t> rec1 = REC1;
+    rec1.resize(29);
+
+    CardTransactionTemplate transactionTemplate;
+    transactionTemplate.addUpdateRecord(FILE7, 1);
+
+    cardTransactionManager->prepareReadRecord(FILE7, 1)
+                           .processCommands();
+
+    const long cardApduCount = cardEmulator->getApduCount();
+
+    cardTransactionManager->prepareTemplate(transactionTemplate, {rec1}, {});
+    cardTransactionManager->processCommands();
+
+    ASSERT_EQ(cardEmulator->getApduCount(), cardApduCount);
+    ASSERT_EQ(cardTransactionManager->getSavedWriteApduCount(), 1);
+
+    tearDown();
+}
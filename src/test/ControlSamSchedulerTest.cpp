@@ -0,0 +1,396 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Calypsonet Terminal Calypso */
+#include "CardTransactionManager.h"
+
+/* Keyple Card Calypso */
+#include "ApduRequestAdapter.h"
+#include "CalypsoCardAdapter.h"
+#include "CalypsoExtensionService.h"
+#include "CalypsoSamAdapter.h"
+#include "CardRequestAdapter.h"
+#include "ControlSamScheduler.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "IllegalArgumentException.h"
+
+#include "CalypsoEmulatorFixture.h"
+
+using namespace testing;
+
+using namespace calypsonet::terminal::calypso::transaction;
+using namespace keyple::card::calypso;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+static const uint8_t FILE7 = CalypsoEmulatorFixture::FILE7;
+
+static std::shared_ptr<CalypsoSamEmulator> samEmulator;
+static std::shared_ptr<CalypsoSamAdapter> calypsoSam;
+static std::shared_ptr<ControlSamScheduler> controlSamScheduler;
+
+static void setUp()
+{
+    samEmulator =
+        std::make_shared<CalypsoSamEmulator>(CalypsoEmulatorFixture::SAM_SERIAL_NUMBER);
+    calypsoSam = CalypsoEmulatorFixture::createCalypsoSam(samEmulator);
+    controlSamScheduler = std::make_shared<ControlSamScheduler>(samEmulator);
+}
+
+static void tearDown()
+{
+    controlSamScheduler.reset();
+    calypsoSam.reset();
+    samEmulator.reset();
+}
+
+static std::shared_ptr<CalypsoCardEmulator> createCardEmulator(const uint8_t lane)
+{
+    std::vector<uint8_t> cardSerialNumber = CalypsoEmulatorFixture::CARD_SERIAL_NUMBER;
+    cardSerialNumber[7] = lane;
+
+    return CalypsoEmulatorFixture::createCardEmulator(cardSerialNumber);
+}
+
+static std::shared_ptr<CardTransactionManager> createCardTransaction(
+    const std::shared_ptr<CalypsoCardEmulator> cardEmulator)
+{
+    auto cardSecuritySetting = CalypsoExtensionService::getInstance()->createCardSecuritySetting();
+    cardSecuritySetting->setControlSamResource(controlSamScheduler, calypsoSam);
+
+    return CalypsoExtensionService::getInstance()
+               ->createCardTransaction(cardEmulator,
+                                       CalypsoEmulatorFixture::createCalypsoCard(cardEmulator),
+                                       cardSecuritySetting);
+}
+
+static std::vector<uint8_t> getKeyDiversifier(const uint8_t lane)
+{
+    std::vector<uint8_t> keyDiversifier = CalypsoEmulatorFixture::CARD_SERIAL_NUMBER;
+    keyDiversifier[7] = lane;
+
+    return keyDiversifier;
+}
+
+static std::vector<uint8_t> buildSelectDiversifierApdu(const uint8_t lane)
+{
+    std::vector<uint8_t> apdu = HexUtil::toByteArray("8014000008");
+    const std::vector<uint8_t> keyDiversifier = getKeyDiversifier(lane);
+    apdu.insert(apdu.end(), keyDiversifier.begin(), keyDiversifier.end());
+
+    return apdu;
+}
+
+/* PSO Compute Signature (stateless) of a message specific to the lane */
+static std::vector<uint8_t> buildPsoComputeSignatureApdu(const uint8_t lane)
+{
+    std::vector<uint8_t> apdu = HexUtil::toByteArray("802A9E9A08FF307A08");
+    apdu.insert(apdu.end(), 4, lane);
+    apdu.push_back(0x00);
+
+    return apdu;
+}
+
+static std::shared_ptr<CardResponseApi> transmitSamApdus(
+    const std::vector<std::vector<uint8_t>>& apdus)
+{
+    std::vector<std::shared_ptr<ApduRequestSpi>> apduRequests;
+    for (const auto& apdu : apdus) {
+        apduRequests.push_back(std::make_shared<ApduRequestAdapter>(apdu));
+    }
+
+    return controlSamScheduler->transmitCardRequest(
+               std::make_shared<CardRequestAdapter>(apduRequests, true),
+               ChannelControl::KEEP_OPEN);
+}
+
+TEST(ControlSamSchedulerTest, constructor_whenReaderIsNull_shouldThrowIAE)
+{
+    EXPECT_THROW(ControlSamScheduler(nullptr), IllegalArgumentException);
+}
+
+TEST(ControlSamSchedulerTest, setLeaseTimeout_whenTimeoutIsNotPositive_shouldThrowIAE)
+{
+    setUp();
+
+    EXPECT_THROW(controlSamScheduler->setLeaseTimeout(0), IllegalArgumentException);
+
+    tearDown();
+}
+
+TEST(ControlSamSchedulerTest, processOpening_whenDiversifierIsAlreadySelected_shouldNotSelectIt)
+{
+    setUp();
+
+    const auto cardEmulator = createCardEmulator(1);
+
+    long samApduCount = samEmulator->getApduCount();
+    createCardTransaction(cardEmulator)->processOpening(WriteAccessLevel::DEBIT).processClosing();
+    const long firstSamApduCount = samEmulator->getApduCount() - samApduCount;
+
+    samApduCount = samEmulator->getApduCount();
+    createCardTransaction(cardEmulator)->processOpening(WriteAccessLevel::DEBIT).processClosing();
+
+    /* Same exchanges without "Select Diversifier" */
+    ASSERT_EQ(samEmulator->getApduCount() - samApduCount, firstSamApduCount - 1);
+    ASSERT_FALSE(cardEmulator->isSessionOpen());
+    ASSERT_EQ(controlSamScheduler->getQueueDepth(), 0);
+
+    tearDown();
+}
+
+TEST(ControlSamSchedulerTest, processClosing_whenLanesAreConcurrent_shouldCommitAllSessions)
+{
+    setUp();
+
+    static const int LANES = 4;
+    static const int SESSIONS = 25;
+
+    std::vector<std::shared_ptr<CalypsoCardEmulator>> cardEmulators;
+    for (int lane = 0; lane < LANES; lane++) {
+        cardEmulators.push_back(createCardEmulator(static_cast<uint8_t>(lane)));
+    }
+
+    std::atomic<int> failureCount(0);
+    std::vector<std::thread> threads;
+
+    for (int lane = 0; lane < LANES; lane++) {
+        threads.push_back(std::thread([&cardEmulators, &failureCount, lane]() {
+            for (int i = 0; i < SESSIONS; i++) {
+                try {
+                    createCardTransaction(cardEmulators[lane])
+                        ->processOpening(WriteAccessLevel::DEBIT)
+                        .prepareUpdateRecord(FILE7, 1, std::vector<uint8_t>(1, i))
+                        .processClosing();
+                } catch (const std::exception& e) {
+                    (void)e;
+                    failureCount++;
+                }
+            }
+        }));
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(failureCount, 0);
+    for (const auto& cardEmulator : cardEmulators) {
+        ASSERT_EQ(cardEmulator->getContent(FILE7, 1)[0], SESSIONS - 1);
+        ASSERT_FALSE(cardEmulator->isSessionOpen());
+    }
+
+    ASSERT_EQ(controlSamScheduler->getQueueDepth(), 0);
+    ASSERT_GE(controlSamScheduler->getBatchCount(), controlSamScheduler->getRequestCount());
+    ASSERT_GE(controlSamScheduler->getTotalWaitTime(), controlSamScheduler->getMaxWaitTime());
+
+    tearDown();
+}
+
+TEST(ControlSamSchedulerTest, processClosing_whenCardExchangesLastLongerThanLease_shouldKeepSam)
+{
+    setUp();
+
+    controlSamScheduler->setLeaseTimeout(200);
+
+    const auto cardEmulator1 = createCardEmulator(1);
+    const auto cardEmulator2 = createCardEmulator(2);
+
+    /* Session of lane 1 lasting twice the lease timeout, without any SAM exchange */
+    const auto cardTransaction1 = createCardTransaction(cardEmulator1);
+    cardTransaction1->processOpening(WriteAccessLevel::DEBIT);
+
+    std::atomic<bool> isLane2Done(false);
+    std::thread lane2([&cardEmulator2, &isLane2Done]() {
+        try {
+            createCardTransaction(cardEmulator2)
+                ->processOpening(WriteAccessLevel::DEBIT)
+                .processClosing();
+            isLane2Done = true;
+        } catch (const std::exception& e) {
+            (void)e;
+        }
+    });
+
+    for (int i = 0; i < 4; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        cardTransaction1->prepareReadRecord(FILE7, 1).processCommands();
+    }
+
+    /* Lane 2 is still waiting for the SAM */
+    EXPECT_FALSE(isLane2Done);
+
+    cardTransaction1->prepareUpdateRecord(FILE7, 1, HexUtil::toByteArray("AABBCC"))
+        .processClosing();
+
+    lane2.join();
+
+    ASSERT_EQ(cardEmulator1->getContent(FILE7, 1)[0], 0xAA);
+    ASSERT_TRUE(isLane2Done);
+    ASSERT_FALSE(cardEmulator2->isSessionOpen());
+
+    tearDown();
+}
+
+TEST(ControlSamSchedulerTest, processCancel_shouldReleaseSamAtOnce)
+{
+    setUp();
+
+    controlSamScheduler->setLeaseTimeout(5000);
+
+    const auto cardEmulator1 = createCardEmulator(1);
+    const auto cardEmulator2 = createCardEmulator(2);
+
+    /* Session of lane 1 cancelled by the application (e.g. rejected ticket) */
+    createCardTransaction(cardEmulator1)->processOpening(WriteAccessLevel::DEBIT).processCancel();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::atomic<bool> isLane2Done(false);
+    std::thread lane2([&cardEmulator2, &isLane2Done]() {
+        try {
+            createCardTransaction(cardEmulator2)
+                ->processOpening(WriteAccessLevel::DEBIT)
+                .processClosing();
+            isLane2Done = true;
+        } catch (const std::exception& e) {
+            (void)e;
+        }
+    });
+
+    lane2.join();
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             std::chrono::steady_clock::now() - start).count();
+
+    ASSERT_TRUE(isLane2Done);
+    ASSERT_LT(elapsed, 2500);
+    ASSERT_FALSE(cardEmulator1->isSessionOpen());
+    ASSERT_FALSE(cardEmulator2->isSessionOpen());
+
+    tearDown();
+}
+
+TEST(ControlSamSchedulerTest,
+     transmitCardRequest_whenStatelessBatchesAreQueued_shouldMergeThemAndDispatchResponses)
+{
+    setUp();
+
+    static const int LANES = 3;
+
+    const auto cardEmulator0 = createCardEmulator(0);
+
+    /* SAM exchanges of the closing of a session of lane 0 */
+    auto cardTransaction0 = createCardTransaction(cardEmulator0);
+    cardTransaction0->processOpening(WriteAccessLevel::DEBIT);
+    long samApduCount = samEmulator->getApduCount();
+    long requestCount = controlSamScheduler->getRequestCount();
+    cardTransaction0->processClosing();
+    const long closingSamApduCount = samEmulator->getApduCount() - samApduCount;
+    const long closingRequestCount = controlSamScheduler->getRequestCount() - requestCount;
+
+    std::atomic<int> readyCount(0);
+    std::atomic<int> turn(0);
+    std::atomic<int> failureCount(0);
+    std::vector<std::shared_ptr<CardResponseApi>> cardResponses(LANES + 1);
+    std::vector<std::thread> threads;
+
+    for (int lane = 1; lane <= LANES; lane++) {
+        threads.push_back(std::thread([&readyCount, &turn, &failureCount, &cardResponses, lane]() {
+            try {
+                /* Diversifier expected by the lane */
+                transmitSamApdus({buildSelectDiversifierApdu(static_cast<uint8_t>(lane))});
+                readyCount++;
+
+                while (turn != lane) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+
+                /*
+                 * Lane 1 selects the diversifier left by lane 0 (not transmitted), the other lanes
+                 * rely on the scheduler to select their diversifier again.
+                 */
+                if (lane == 1) {
+                    cardResponses[lane] =
+                        transmitSamApdus({buildSelectDiversifierApdu(0),
+                                          buildPsoComputeSignatureApdu(1)});
+                } else {
+                    cardResponses[lane] = transmitSamApdus(
+                        {buildPsoComputeSignatureApdu(static_cast<uint8_t>(lane))});
+                }
+            } catch (const std::exception& e) {
+                (void)e;
+                failureCount++;
+            }
+        }));
+    }
+
+    while (readyCount != LANES) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    /* The SAM is reserved by lane 0 while the batches of the other lanes are queued */
+    cardTransaction0 = createCardTransaction(cardEmulator0);
+    cardTransaction0->processOpening(WriteAccessLevel::DEBIT);
+
+    for (int lane = 1; lane <= LANES; lane++) {
+        turn = lane;
+        while (controlSamScheduler->getQueueDepth() != lane) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    samApduCount = samEmulator->getApduCount();
+    requestCount = controlSamScheduler->getRequestCount();
+    const long mergedBatchCount = controlSamScheduler->getMergedBatchCount();
+
+    cardTransaction0->processClosing();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(failureCount, 0);
+    ASSERT_EQ(controlSamScheduler->getMergedBatchCount() - mergedBatchCount, LANES);
+    ASSERT_EQ(controlSamScheduler->getRequestCount() - requestCount, closingRequestCount + 1);
+
+    /* PSO 1, then Select Diversifier and PSO for lanes 2 and 3 */
+    ASSERT_EQ(samEmulator->getApduCount() - samApduCount, closingSamApduCount + 5);
+
+    /* Each lane receives its own responses */
+    CalypsoSamEmulator referenceSamEmulator(CalypsoEmulatorFixture::SAM_SERIAL_NUMBER);
+
+    ASSERT_EQ(cardResponses[1]->getApduResponses().size(), 2u);
+    ASSERT_EQ(cardResponses[1]->getApduResponses()[0]->getStatusWord(), 0x9000);
+    ASSERT_EQ(cardResponses[1]->getApduResponses()[1]->getApdu(),
+              referenceSamEmulator.processApdu(buildPsoComputeSignatureApdu(1)));
+
+    for (int lane = 2; lane <= LANES; lane++) {
+        ASSERT_EQ(cardResponses[lane]->getApduResponses().size(), 1u);
+        ASSERT_EQ(cardResponses[lane]->getApduResponses()[0]->getApdu(),
+                  referenceSamEmulator.processApdu(
+                      buildPsoComputeSignatureApdu(static_cast<uint8_t>(lane))));
+    }
+
+    ASSERT_EQ(controlSamScheduler->getQueueDepth(), 0);
+
+    tearDown();
+}
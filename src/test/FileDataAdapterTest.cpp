@@ -13,6 +13,8 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include "AllocationCounter.h"
+
 /* Calypsonet Terminal Calypso */
 #include "FileDataAdapter.h"
 
@@ -43,6 +45,18 @@ static void tearDown()
     file.reset();
 }
 
+TEST(FileDataAdapterTest, constructor_shouldNotAllocate)
+{
+    const long before = AllocationCounter::getCount();
+
+    {
+        /* The logger is shared by all the instances of the class */
+        const FileDataAdapter fileData;
+    }
+
+    ASSERT_EQ(AllocationCounter::getCount() - before, 0);
+}
+
 TEST(FileDataAdapterTest, getAllRecordsContent_shouldReturnAReference)
 {
     setUp();
@@ -466,6 +480,68 @@ TEST(FileDataAdapterTest, addCyclicContent_shouldShiftAllRecordsAndSetContentToR
     tearDown();
 }
 
+TEST(FileDataAdapterTest, isContentKnown_whenContentIsSetAtOffset_shouldNotKnowPaddedBytes)
+{
+    setUp();
+
+    file->setContent(1, data2, 2);
+
+    ASSERT_FALSE(file->isContentKnown(1, 0, 4));
+    ASSERT_FALSE(file->isContentKnown(1, 1, 1));
+    ASSERT_TRUE(file->isContentKnown(1, 2, 2));
+    ASSERT_FALSE(file->isContentKnown(2, 0, 1));
+
+    file->setContent(1, data2, 0);
+
+    ASSERT_TRUE(file->isContentKnown(1, 0, 4));
+
+    tearDown();
+}
+
+TEST(FileDataAdapterTest, isContentKnown_whenContentIsFilled_shouldNotKnowUnknownBytes)
+{
+    setUp();
+
+    file->fillContent(1, data2, 0);
+
+    ASSERT_FALSE(file->isContentKnown(1, 0, 1));
+
+    file->setContent(2, data2);
+    file->fillContent(2, data4, 0);
+
+    ASSERT_TRUE(file->isContentKnown(2, 0, 2));
+    ASSERT_FALSE(file->isContentKnown(2, 0, 3));
+
+    tearDown();
+}
+
+TEST(FileDataAdapterTest, isContentKnown_whenCyclicContentIsAdded_shouldShiftKnownBytes)
+{
+    setUp();
+
+    file->setContent(1, data2, 1);
+    file->addCyclicContent(data3);
+
+    ASSERT_TRUE(file->isContentKnown(1, 0, 3));
+    ASSERT_FALSE(file->isContentKnown(2, 0, 3));
+    ASSERT_TRUE(file->isContentKnown(2, 1, 2));
+
+    tearDown();
+}
+
+TEST(FileDataAdapterTest, cloningConstructor_shouldCopyKnownBytes)
+{
+    setUp();
+
+    file->setContent(1, data2, 2);
+    const auto clone = std::make_shared<FileDataAdapter>(file);
+
+    ASSERT_FALSE(clone->isContentKnown(1, 0, 4));
+    ASSERT_TRUE(clone->isContentKnown(1, 2, 2));
+
+    tearDown();
+}
+
 /* C++: test is irrelevant since getContent() returns a copy already, can't be the same */
 // TEST(FileDataAdapterTest, cloningConstructor_shouldReturnACopy)
 // {
@@ -0,0 +1,208 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Keyple Card Calypso */
+#include "CalypsoCardAdapter.h"
+#include "FileHeaderAdapter.h"
+#include "FileHeaderCache.h"
+
+/* Mock */
+#include "CardSelectionResponseAdapterMock.h"
+
+#include "CalypsoEmulatorFixture.h"
+
+using namespace testing;
+
+using namespace keyple::card::calypso;
+
+static const std::string POWER_ON_DATA_PREFIX = "3B8F8001805A0A0103200311";
+static const std::string POWER_ON_DATA_SUFFIX = "829000F7";
+static const std::string POWER_ON_DATA_OTHER_PROFILE_PREFIX = "3B8F8001805A0A0103200411";
+
+static std::shared_ptr<FileHeaderCache> cache;
+
+static void setUp()
+{
+    cache = std::make_shared<FileHeaderCache>();
+}
+
+static void tearDown()
+{
+    cache.reset();
+}
+
+static std::shared_ptr<CalypsoCardAdapter> buildCalypsoCard(const std::string& powerOnDataPrefix,
+                                                            const std::string& serialNumber)
+{
+    auto card = std::make_shared<CalypsoCardAdapter>();
+    card->initialize(
+        std::make_shared<CardSelectionResponseAdapterMock>(powerOnDataPrefix +
+                                                           serialNumber +
+                                                           POWER_ON_DATA_SUFFIX));
+
+    return card;
+}
+
+static std::shared_ptr<FileHeaderAdapter> buildFileHeader(const uint16_t lid,
+                                                          const int recordsNumber)
+{
+    return std::dynamic_pointer_cast<FileHeaderAdapter>(
+               CalypsoEmulatorFixture::createFileHeader(lid,
+                                                        recordsNumber,
+                                                        29,
+                                                        ElementaryFile::Type::LINEAR));
+}
+
+TEST(FileHeaderCacheTest, apply_whenProfileIsNotCached_shouldReturnFalse)
+{
+    setUp();
+
+    const auto card = buildCalypsoCard(POWER_ON_DATA_PREFIX, "12345678");
+
+    ASSERT_FALSE(cache->apply(card));
+    ASSERT_EQ(card->getFiles().size(), 0);
+
+    tearDown();
+}
+
+TEST(FileHeaderCacheTest, apply_whenProfileIsCached_shouldSetSharedHeaders)
+{
+    setUp();
+
+    const auto card1 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "11111111");
+    card1->setFileHeader(7, buildFileHeader(0x2010, 3));
+    card1->setFileHeader(8, buildFileHeader(0x2020, 1));
+    cache->put(card1, true);
+
+    const auto card2 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "22222222");
+    const auto card3 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "33333333");
+
+    ASSERT_TRUE(cache->apply(card2));
+    ASSERT_TRUE(cache->apply(card3));
+    ASSERT_EQ(cache->getSize(), 1);
+    ASSERT_EQ(card2->getFiles().size(), 2);
+    ASSERT_EQ(card2->getFileBySfi(7)->getHeader()->getLid(), 0x2010);
+    ASSERT_EQ(card2->getFileBySfi(8)->getHeader()->getRecordsNumber(), 1);
+    ASSERT_EQ(card2->getFileBySfi(7)->getHeader(), card3->getFileBySfi(7)->getHeader());
+
+    tearDown();
+}
+
+TEST(FileHeaderCacheTest, apply_whenFileListIsNotComplete_shouldSetHeadersAndReturnFalse)
+{
+    setUp();
+
+    const auto card1 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "11111111");
+    card1->setFileHeader(7, buildFileHeader(0x2010, 3));
+    cache->put(card1, false);
+
+    const auto card2 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "22222222");
+
+    ASSERT_FALSE(cache->apply(card2));
+    ASSERT_EQ(card2->getFileBySfi(7)->getHeader()->getLid(), 0x2010);
+
+    /* The EF list of a later card completes the profile */
+    card2->setFileHeader(8, buildFileHeader(0x2020, 1));
+    cache->put(card2, true);
+
+    const auto card3 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "33333333");
+
+    ASSERT_TRUE(cache->apply(card3));
+    ASSERT_EQ(card3->getFiles().size(), 2);
+
+    tearDown();
+}
+
+TEST(FileHeaderCacheTest, apply_whenStartupInfoDiffers_shouldReturnFalse)
+{
+    setUp();
+
+    const auto card1 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "11111111");
+    card1->setFileHeader(7, buildFileHeader(0x2010, 3));
+    cache->put(card1, true);
+
+    ASSERT_FALSE(cache->apply(buildCalypsoCard(POWER_ON_DATA_OTHER_PROFILE_PREFIX, "22222222")));
+
+    tearDown();
+}
+
+TEST(FileHeaderCacheTest, setFileHeader_whenHeaderIsShared_shouldNotModifyCachedHeader)
+{
+    setUp();
+
+    const auto card1 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "11111111");
+    card1->setFileHeader(7,
+                         FileHeaderAdapter::builder()
+                             ->lid(0x2010)
+                              .recordsNumber(3)
+                              .recordSize(29)
+                              .type(ElementaryFile::Type::LINEAR)
+                              .build());
+    cache->put(card1, false);
+
+    const auto card2 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "22222222");
+    cache->apply(card2);
+    card2->setFileHeader(7, buildFileHeader(0x2010, 3));
+
+    const auto card3 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "33333333");
+    cache->apply(card3);
+
+    ASSERT_EQ(card2->getFileBySfi(7)->getHeader()->getAccessConditions().size(), 4);
+    ASSERT_TRUE(card3->getFileBySfi(7)->getHeader()->getAccessConditions().empty());
+
+    tearDown();
+}
+
+TEST(FileHeaderCacheTest, setFileHeader_whenNothingIsMissing_shouldKeepSharedHeader)
+{
+    setUp();
+
+    const auto card1 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "11111111");
+    card1->setFileHeader(7, buildFileHeader(0x2010, 3));
+    cache->put(card1, false);
+
+    const auto card2 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "22222222");
+    cache->apply(card2);
+    const auto sharedHeader = card2->getFileBySfi(7)->getHeader();
+    card2->setFileHeader(7, buildFileHeader(0x2010, 3));
+
+    ASSERT_EQ(card2->getFileBySfi(7)->getHeader(), sharedHeader);
+
+    tearDown();
+}
+
+TEST(FileHeaderCacheTest, validate_whenHeadersDiffer_shouldInvalidateProfile)
+{
+    setUp();
+
+    const auto card1 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "11111111");
+    card1->setFileHeader(7, buildFileHeader(0x2010, 3));
+    cache->put(card1, false);
+
+    const auto card2 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "22222222");
+    card2->setFileHeader(7, buildFileHeader(0x2010, 3));
+
+    ASSERT_TRUE(cache->validate(card2));
+    ASSERT_EQ(cache->getSize(), 1);
+
+    const auto card3 = buildCalypsoCard(POWER_ON_DATA_PREFIX, "33333333");
+    card3->setFileHeader(7, buildFileHeader(0x2010, 5));
+
+    ASSERT_FALSE(cache->validate(card3));
+    ASSERT_EQ(cache->getSize(), 0);
+
+    tearDown();
+}
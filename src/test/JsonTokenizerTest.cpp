@@ -0,0 +1,107 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Keyple Card Calypso */
+#include "JsonTokenizer.h"
+
+/* Keyple Core Util */
+#include "IllegalArgumentException.h"
+
+using namespace testing;
+
+using namespace keyple::card::calypso;
+using namespace keyple::core::util::cpp::exception;
+
+using TokenType = JsonTokenizer::TokenType;
+
+static void readAll(const std::string& json)
+{
+    JsonTokenizer tokenizer(json.data(), json.size());
+    while (tokenizer.next() != TokenType::END_DOCUMENT) {}
+}
+
+TEST(JsonTokenizerTest, next_shouldReturnTokensInDocumentOrder)
+{
+    const std::string json = "{\"a\": [1, \"x\\\"y\", true], \"b\": {}}";
+    JsonTokenizer tokenizer(json.data(), json.size());
+
+    ASSERT_EQ(tokenizer.next(), TokenType::BEGIN_OBJECT);
+    ASSERT_EQ(tokenizer.next(), TokenType::NAME);
+    ASSERT_TRUE(tokenizer.isTokenEqualTo("a"));
+    ASSERT_EQ(tokenizer.next(), TokenType::BEGIN_ARRAY);
+    ASSERT_EQ(tokenizer.next(), TokenType::NUMBER);
+    ASSERT_EQ(tokenizer.getTokenAsInt(), 1);
+    ASSERT_EQ(tokenizer.next(), TokenType::STRING);
+    ASSERT_TRUE(tokenizer.isTokenEqualTo("x\\\"y"));
+    ASSERT_EQ(tokenizer.next(), TokenType::LITERAL);
+    ASSERT_TRUE(tokenizer.isTokenEqualTo("true"));
+    ASSERT_EQ(tokenizer.next(), TokenType::END_ARRAY);
+    ASSERT_EQ(tokenizer.next(), TokenType::NAME);
+    ASSERT_EQ(tokenizer.next(), TokenType::BEGIN_OBJECT);
+    ASSERT_EQ(tokenizer.next(), TokenType::END_OBJECT);
+    ASSERT_EQ(tokenizer.next(), TokenType::END_OBJECT);
+    ASSERT_EQ(tokenizer.next(), TokenType::END_DOCUMENT);
+}
+
+TEST(JsonTokenizerTest, skipValue_shouldSkipNestedValues)
+{
+    const std::string json = "{\"a\": {\"b\": [[1], {\"c\": null}]}, \"d\": -2}";
+    JsonTokenizer tokenizer(json.data(), json.size());
+
+    tokenizer.next();
+    tokenizer.next();
+    tokenizer.skipValue();
+
+    ASSERT_EQ(tokenizer.next(), TokenType::NAME);
+    ASSERT_TRUE(tokenizer.isTokenEqualTo("d"));
+    ASSERT_EQ(tokenizer.next(), TokenType::NUMBER);
+    ASSERT_EQ(tokenizer.getTokenAsInt(), -2);
+}
+
+TEST(JsonTokenizerTest, getTokenAsBytes_shouldDecodeHexString)
+{
+    const std::string json = "\"00aBFf\"";
+    JsonTokenizer tokenizer(json.data(), json.size());
+    std::vector<uint8_t> bytes;
+
+    tokenizer.next();
+    tokenizer.getTokenAsBytes(bytes);
+
+    ASSERT_EQ(bytes, std::vector<uint8_t>({0x00, 0xAB, 0xFF}));
+}
+
+TEST(JsonTokenizerTest, getTokenAsInt_whenOutOfRange_shouldThrowIAE)
+{
+    const std::string json = "2147483648";
+    JsonTokenizer tokenizer(json.data(), json.size());
+
+    tokenizer.next();
+
+    EXPECT_THROW(tokenizer.getTokenAsInt(), IllegalArgumentException);
+}
+
+TEST(JsonTokenizerTest, next_whenDocumentIsMalformed_shouldThrowIAE)
+{
+    EXPECT_THROW(readAll(""), IllegalArgumentException);
+    EXPECT_THROW(readAll("{"), IllegalArgumentException);
+    EXPECT_THROW(readAll("{\"a\":}"), IllegalArgumentException);
+    EXPECT_THROW(readAll("{\"a\" 1}"), IllegalArgumentException);
+    EXPECT_THROW(readAll("{\"a\":1,}"), IllegalArgumentException);
+    EXPECT_THROW(readAll("[1 2]"), IllegalArgumentException);
+    EXPECT_THROW(readAll("{1:2}"), IllegalArgumentException);
+    EXPECT_THROW(readAll("{\"a\":1]"), IllegalArgumentException);
+    EXPECT_THROW(readAll("{} {}"), IllegalArgumentException);
+    EXPECT_THROW(readAll("\"abc"), IllegalArgumentException);
+}
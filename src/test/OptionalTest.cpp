@@ -0,0 +1,122 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "AllocationCounter.h"
+
+/* Keyple Card Calypso */
+#include "FileDataAdapter.h"
+#include "Optional.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+#include "IllegalStateException.h"
+
+using namespace testing;
+
+using namespace keyple::card::calypso;
+using namespace keyple::core::util;
+using namespace keyple::core::util::cpp::exception;
+
+static const int ITERATIONS = 10000;
+
+TEST(OptionalTest, empty_shouldNotBePresent)
+{
+    const Optional<int> optional = Optional<int>::empty();
+
+    ASSERT_FALSE(optional.isPresent());
+    ASSERT_EQ(optional.orElse(12), 12);
+}
+
+TEST(OptionalTest, get_whenEmpty_shouldThrowISE)
+{
+    const Optional<uint8_t> optional;
+
+    EXPECT_THROW(optional.get(), IllegalStateException);
+}
+
+TEST(OptionalTest, of_shouldHoldValue)
+{
+    const Optional<uint8_t> optional = Optional<uint8_t>::of(0xFF);
+
+    ASSERT_TRUE(optional.isPresent());
+    ASSERT_EQ(optional.get(), 0xFF);
+    ASSERT_EQ(optional, Optional<uint8_t>(0xFF));
+    ASSERT_NE(optional, Optional<uint8_t>::empty());
+}
+
+TEST(OptionalTest, reset_shouldEmptyOptional)
+{
+    Optional<bool> optional = true;
+    optional.reset();
+
+    ASSERT_FALSE(optional.isPresent());
+}
+
+TEST(OptionalTest, allocations_whenOptionalIsUsed_shouldBeZero)
+{
+    const long before = AllocationCounter::getCount();
+
+    int sum = 0;
+    for (int i = 0; i < ITERATIONS; i++) {
+        const Optional<int> value = i;
+        sum += value.get();
+    }
+
+    ASSERT_EQ(AllocationCounter::getCount() - before, 0);
+    ASSERT_GT(sum, 0);
+}
+
+TEST(OptionalTest, allocations_whenSharedPtrIsUsed_shouldBeOnePerValue)
+{
+    std::vector<std::shared_ptr<int>> values;
+    values.reserve(ITERATIONS);
+
+    const long before = AllocationCounter::getCount();
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        values.push_back(std::make_shared<int>(i));
+    }
+
+    ASSERT_EQ(AllocationCounter::getCount() - before, ITERATIONS);
+}
+
+TEST(OptionalTest, allocations_getCounterValue_shouldBeZero)
+{
+    const auto file = std::make_shared<FileDataAdapter>();
+    file->setContent(1, HexUtil::toByteArray("000001000002000003"));
+
+    const long before = AllocationCounter::getCount();
+
+    int sum = 0;
+    int expectedSum = 0;
+    for (int i = 0; i < ITERATIONS; i++) {
+        sum += file->getCounterValue(1 + i % 3).get();
+        expectedSum += 1 + i % 3;
+    }
+
+    ASSERT_EQ(AllocationCounter::getCount() - before, 0);
+    ASSERT_EQ(sum, expectedSum);
+
+    const long beforeApi = AllocationCounter::getCount();
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        sum += *file->getContentAsCounterValue(1 + i % 3);
+    }
+
+    /* The FileData API still returns a heap-allocated value */
+    ASSERT_EQ(AllocationCounter::getCount() - beforeApi, ITERATIONS);
+}
@@ -1891,3 +1891,73 @@ TEST(SamTransactionManagerAdapterTest, processCommands_whenError_shouldClearComm
 
     tearDown();
 }
+
+TEST(SamTransactionManagerAdapterTest, processReadKeyInventory_shouldFillKeyInventoryInOneRequest)
+{
+    setUp();
+
+    /* Records 1 and 2 hold a key, the other records are empty */
+    std::vector<std::string> apduResponses(126, "6A83");
+    apduResponses[0] = "0000000000000000" "217990000000000000000000000000000000000000" + R_9000;
+    apduResponses[1] = "0000000000000000" "307A90000000000000000000000000000000000000" + R_9000;
+    const auto cardResponse = createCardResponse(apduResponses);
+
+    EXPECT_CALL(*samReader, transmitCardRequest(_, _)).WillOnce(Return(cardResponse));
+
+    std::dynamic_pointer_cast<SamTransactionManagerAdapter>(samTransactionManager)
+        ->processReadKeyInventory();
+
+    const auto sam = std::dynamic_pointer_cast<CalypsoSamAdapter>(_sam);
+    ASSERT_TRUE(sam->isKeyInventoryAvailable());
+    ASSERT_EQ(sam->getWorkKeyRecordNumber(0x21, 0x79), 1);
+    ASSERT_EQ(sam->getWorkKeyRecordNumber(0x30, 0x7A), 2);
+    ASSERT_EQ(sam->getWorkKeyRecordNumber(0x30, 0x79), 0);
+    ASSERT_EQ(sam->getWorkKeyParameters(1).size(), 13u);
+    ASSERT_EQ(sam->getWorkKeyKif(0x7A).get(), 0x30);
+    ASSERT_TRUE(sam->getWorkKeyParameters(3).empty());
+
+    tearDown();
+}
+
+TEST(SamTransactionManagerAdapterTest,
+     processReadKeyInventory_whenUnexpectedStatus_shouldThrowUnexpectedCommandStatusException)
+{
+    setUp();
+
+    std::vector<std::string> apduResponses(126, "6A83");
+    apduResponses[5] = "6A00";
+    const auto cardResponse = createCardResponse(apduResponses);
+
+    EXPECT_CALL(*samReader, transmitCardRequest(_, _)).WillOnce(Return(cardResponse));
+
+    EXPECT_THROW(std::dynamic_pointer_cast<SamTransactionManagerAdapter>(samTransactionManager)
+                     ->processReadKeyInventory(),
+                 UnexpectedCommandStatusException);
+
+    tearDown();
+}
+
+TEST(SamTransactionManagerAdapterTest,
+     processReadKeyInventory_whenOneRecordIsNotReadable_shouldNotPublishPartialInventory)
+{
+    setUp();
+
+    /* Record 1 holds a key, record 2 is not readable, record 3 holds a key */
+    std::vector<std::string> apduResponses(126, "6A83");
+    apduResponses[0] = "0000000000000000" "217990000000000000000000000000000000000000" + R_9000;
+    apduResponses[1] = "6985";
+    apduResponses[2] = "0000000000000000" "307A90000000000000000000000000000000000000" + R_9000;
+    const auto cardResponse = createCardResponse(apduResponses);
+
+    EXPECT_CALL(*samReader, transmitCardRequest(_, _)).WillOnce(Return(cardResponse));
+
+    EXPECT_THROW(std::dynamic_pointer_cast<SamTransactionManagerAdapter>(samTransactionManager)
+                     ->processReadKeyInventory(),
+                 UnexpectedCommandStatusException);
+
+    const auto sam = std::dynamic_pointer_cast<CalypsoSamAdapter>(_sam);
+    ASSERT_FALSE(sam->isKeyInventoryAvailable());
+    ASSERT_EQ(sam->getWorkKeyRecordNumber(0x21, 0x79), 0);
+
+    tearDown();
+}
@@ -17,6 +17,7 @@
 
 /* Calypsonet Terminal Calypso */
 #include "SvDebitLogRecordAdapter.h"
+#include "SvDebitLogRecordJsonDeserializerAdapter.h"
 
 /* Keyple Core Util */
 #include "HexUtil.h"
@@ -160,3 +161,41 @@ TEST(SvDebitLogRecordTest, toString_shouldContainSamID)
 
     tearDown();
 }
+
+TEST(SvDebitLogRecordTest, deserialize_whenJsonIsProducedByToJSONString_shouldRestoreRecord)
+{
+    setUp();
+
+    const auto record = SvDebitLogRecordJsonDeserializerAdapter().deserialize(svDebitLogRecordAdapter->toJSONString());
+
+    ASSERT_EQ(record->getRawData(), svDebitLogRecordAdapter->getRawData());
+    ASSERT_EQ(record->getAmount(), AMOUNT);
+    ASSERT_EQ(record->getBalance(), BALANCE);
+    ASSERT_EQ(record->getSamId(), SAMID);
+    ASSERT_EQ(record->getSamTNum(), SAM_TNUM);
+    ASSERT_EQ(record->getSvTNum(), SV_TNUM);
+
+    tearDown();
+}
+
+TEST(SvDebitLogRecordTest, deserialize_whenUnknownMembers_shouldSkipThem)
+{
+    setUp();
+
+    const std::string json = "{\"unknown\": {\"a\": [1, true, null]}, \"offset\": 11, " \
+                             "\"cardResponse\": \"" + HexUtil::toHex(svDebitLogRecordAdapter->getRawData()) +
+                             "\"}";
+
+    ASSERT_EQ(SvDebitLogRecordJsonDeserializerAdapter().deserialize(json)->getSvTNum(), SV_TNUM);
+
+    tearDown();
+}
+
+TEST(SvDebitLogRecordTest, deserialize_whenJsonIsMalformed_shouldThrowIAE)
+{
+    EXPECT_THROW(SvDebitLogRecordJsonDeserializerAdapter().deserialize("{\"offset\": 0,"), IllegalArgumentException);
+    EXPECT_THROW(SvDebitLogRecordJsonDeserializerAdapter().deserialize("[]"), IllegalArgumentException);
+    EXPECT_THROW(SvDebitLogRecordJsonDeserializerAdapter().deserialize("{\"offset\": 0}"), IllegalArgumentException);
+    EXPECT_THROW(SvDebitLogRecordJsonDeserializerAdapter().deserialize("{\"offset\": 1, \"cardResponse\": \"00\"}"),
+                 IllegalArgumentException);
+}
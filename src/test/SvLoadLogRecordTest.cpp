@@ -10,6 +10,7 @@
  * SPDX-License-Identifier: EPL-2.0                                                               *
  **************************************************************************************************/
 
+#include <chrono>
 #include <sstream>
 
 #include "gmock/gmock.h"
@@ -17,6 +18,7 @@
 
 /* Calypsonet Terminal Calypso */
 #include "SvLoadLogRecordAdapter.h"
+#include "SvLoadLogRecordJsonDeserializerAdapter.h"
 
 /* Keyple Core Util */
 #include "HexUtil.h"
@@ -171,3 +173,67 @@ TEST(SvLoadLogRecordAdapterTest, toString_shouldContainSamID)
 
     tearDown();
 }
+
+TEST(SvLoadLogRecordAdapterTest, deserialize_whenJsonIsProducedByToJSONString_shouldRestoreRecord)
+{
+    setUp();
+
+    const auto record = SvLoadLogRecordJsonDeserializerAdapter().deserialize(svLoadLogRecordAdapter->toJSONString());
+
+    ASSERT_EQ(record->getRawData(), svLoadLogRecordAdapter->getRawData());
+    ASSERT_EQ(record->getAmount(), AMOUNT);
+    ASSERT_EQ(record->getBalance(), BALANCE);
+    ASSERT_EQ(record->getSamId(), SAMID);
+    ASSERT_EQ(record->getSamTNum(), SAM_TNUM);
+    ASSERT_EQ(record->getSvTNum(), SV_TNUM);
+
+    tearDown();
+}
+
+TEST(SvLoadLogRecordAdapterTest, deserialize_whenUnknownMembers_shouldSkipThem)
+{
+    setUp();
+
+    const std::string json = "{\"unknown\": {\"a\": [1, true, null]}, \"offset\": 11, " \
+                             "\"cardResponse\": \"" + HexUtil::toHex(svLoadLogRecordAdapter->getRawData()) +
+                             "\"}";
+
+    ASSERT_EQ(SvLoadLogRecordJsonDeserializerAdapter().deserialize(json)->getSvTNum(), SV_TNUM);
+
+    tearDown();
+}
+
+TEST(SvLoadLogRecordAdapterTest, deserialize_whenJsonIsMalformed_shouldThrowIAE)
+{
+    EXPECT_THROW(SvLoadLogRecordJsonDeserializerAdapter().deserialize("{\"offset\": 0,"), IllegalArgumentException);
+    EXPECT_THROW(SvLoadLogRecordJsonDeserializerAdapter().deserialize("[]"), IllegalArgumentException);
+    EXPECT_THROW(SvLoadLogRecordJsonDeserializerAdapter().deserialize("{\"offset\": 0}"), IllegalArgumentException);
+    EXPECT_THROW(SvLoadLogRecordJsonDeserializerAdapter().deserialize("{\"offset\": 1, \"cardResponse\": \"00\"}"),
+                 IllegalArgumentException);
+}
+
+TEST(SvLoadLogRecordAdapterTest, deserialize_benchmark_shouldReportRecordsPerSecond)
+{
+    setUp();
+
+    static const int ITERATIONS = 100000;
+    const std::string json = svLoadLogRecordAdapter->toJSONString();
+    SvLoadLogRecordJsonDeserializerAdapter deserializer;
+
+    long long checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        checksum += deserializer.deserialize(json)->getSvTNum();
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - start).count();
+    const long long recordsPerSecond = ITERATIONS * 1000000LL / (elapsed > 0 ? elapsed : 1);
+
+    RecordProperty("recordsPerSecond", std::to_string(recordsPerSecond));
+
+    ASSERT_EQ(checksum, static_cast<long long>(ITERATIONS) * SV_TNUM);
+
+    tearDown();
+}
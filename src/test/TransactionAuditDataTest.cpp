@@ -0,0 +1,137 @@
+/**************************************************************************************************
+ * Copyright (c) 2023 Calypso Networks Association https://calypsonet.org/                        *
+ *                                                                                                *
+ * See the NOTICE file(s) distributed with this work for additional information regarding         *
+ * copyright ownership.                                                                           *
+ *                                                                                                *
+ * This program and the accompanying materials are made available under the terms of the Eclipse  *
+ * Public License 2.0 which is available at http://www.eclipse.org/legal/epl-2.0                  *
+ *                                                                                                *
+ * SPDX-License-Identifier: EPL-2.0                                                               *
+ **************************************************************************************************/
+
+
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/* Calypsonet Terminal Calypso */
+#include "InconsistentDataException.h"
+
+/* Keyple Card Calypso */
+#include "AuditedException.h"
+#include "CalypsoCardAdapter.h"
+#include "TransactionAuditData.h"
+
+/* Keyple Core Util */
+#include "HexUtil.h"
+
+/* Mock */
+#include "CardSelectionResponseAdapterMock.h"
+
+using namespace testing;
+
+using namespace calypsonet::terminal::calypso::transaction;
+using namespace keyple::card::calypso;
+using namespace keyple::core::util;
+
+static const std::string POWER_ON_DATA = "3B8F8001805A0A010320031112345678829000F7";
+static const std::string APDU_1 = "00B2014400";
+static const std::string APDU_2 = "0102039000";
+static const std::string APDU_3 = "00B2024400";
+
+static std::shared_ptr<CalypsoCardAdapter> calypsoCard;
+static std::shared_ptr<std::vector<std::vector<uint8_t>>> apdus;
+
+static void setUp()
+{
+    calypsoCard = std::make_shared<CalypsoCardAdapter>();
+    calypsoCard->initialize(std::make_shared<CardSelectionResponseAdapterMock>(POWER_ON_DATA));
+
+    apdus = std::make_shared<std::vector<std::vector<uint8_t>>>();
+    apdus->push_back(HexUtil::toByteArray(APDU_1));
+    apdus->push_back(HexUtil::toByteArray(APDU_2));
+}
+
+static void tearDown()
+{
+    calypsoCard.reset();
+    apdus.reset();
+}
+
+TEST(TransactionAuditDataTest, toString_shouldContainApdus)
+{
+    setUp();
+
+    const TransactionAuditData auditData(calypsoCard, nullptr, apdus);
+
+    const std::string str = auditData.toString();
+
+    ASSERT_NE(str.find("Transaction audit JSON data"), std::string::npos);
+    ASSERT_NE(str.find(APDU_1 + ", " + APDU_2), std::string::npos);
+    ASSERT_EQ(str.find("controlSam"), std::string::npos);
+
+    tearDown();
+}
+
+TEST(TransactionAuditDataTest, toString_whenApdusAreAddedAfterSnapshot_shouldIgnoreThem)
+{
+    setUp();
+
+    const TransactionAuditData auditData(calypsoCard, nullptr, apdus);
+    apdus->push_back(HexUtil::toByteArray(APDU_3));
+
+    ASSERT_EQ(auditData.getApduCount(), 2);
+    ASSERT_EQ(auditData.toString().find(APDU_3), std::string::npos);
+
+    tearDown();
+}
+
+TEST(TransactionAuditDataTest, auditedException_getMessage_shouldNotContainAuditData)
+{
+    setUp();
+
+    const AuditedException<InconsistentDataException> e(
+        InconsistentDataException("Inconsistent data"),
+        std::make_shared<TransactionAuditData>(calypsoCard, nullptr, apdus));
+
+    ASSERT_EQ(e.getMessage(), "Inconsistent data");
+    ASSERT_EQ(e.getTransactionAuditData()->getApduCount(), 2);
+
+    tearDown();
+}
+
+TEST(TransactionAuditDataTest, auditedException_whenCaughtAsBaseType_whatShouldContainAuditData)
+{
+    setUp();
+
+    try {
+
+        throw AuditedException<InconsistentDataException>(
+                  InconsistentDataException("Inconsistent data"),
+                  std::make_shared<TransactionAuditData>(calypsoCard, nullptr, apdus));
+
+    } catch (const InconsistentDataException& e) {
+
+        const std::string what = e.what();
+
+        ASSERT_EQ(what.find("Inconsistent data"), 0u);
+        ASSERT_NE(what.find(APDU_1 + ", " + APDU_2), std::string::npos);
+    }
+
+    tearDown();
+}
+
+TEST(TransactionAuditDataTest, auditedException_copies_shouldShareTheFormattedMessage)
+{
+    setUp();
+
+    const AuditedException<InconsistentDataException> e(
+        InconsistentDataException("Inconsistent data"),
+        std::make_shared<TransactionAuditData>(calypsoCard, nullptr, apdus));
+    const AuditedException<InconsistentDataException> copy(e);
+
+    ASSERT_EQ(e.what(), copy.what());
+
+    tearDown();
+}